@@ -118,7 +118,7 @@ bool AttributeFormModelBase::setData( const QModelIndex &index, const QVariant &
         int fieldIndex = item->data( AttributeFormModel::FieldIndex ).toInt();
         mFeatureModel->setData( mFeatureModel->index( fieldIndex ), value, FeatureModel::AttributeAllowEdit );
         item->setData( value, AttributeFormModel::AttributeAllowEdit );
-        updateVisibilityAndConstraints( fieldIndex );
+        updateVisibilityAndConstraints( { fieldIndex } );
         break;
       }
 
@@ -140,8 +140,13 @@ bool AttributeFormModelBase::setData( const QModelIndex &index, const QVariant &
           mExpressionContext << QgsExpressionContextUtils::formScope( mFeatureModel->feature() );
           synchronizeFieldValue( fieldIndex, value );
         }
-        updateDefaultValues( fieldIndex );
-        updateVisibilityAndConstraints( fieldIndex );
+        const QSet<int> changedFields = updateDefaultValues( fieldIndex );
+        if ( !changedFields.isEmpty() )
+        {
+          updateDataDefinedProperties( changedFields );
+          updateEditorWidgetCodes( changedFields );
+          updateVisibilityAndConstraints( changedFields );
+        }
         return changed;
       }
     }
@@ -186,7 +191,8 @@ void AttributeFormModelBase::resetModel()
   mAliasExpressions.clear();
   mReadOnlyExpressions.clear();
   mEditorWidgetCodes.clear();
-  mEditorWidgetCodesRequirements.clear();
+  mDefaultValueExpressions.clear();
+  mConstraintDependencies.clear();
 
   setConstraintsHardValid( true );
   setConstraintsSoftValid( true );
@@ -251,7 +257,7 @@ void AttributeFormModelBase::resetModel()
           QString visibilityExpression;
           if ( container->visibilityExpression().enabled() )
           {
-            mVisibilityExpressions.append( qMakePair( container->visibilityExpression().data(), item ) );
+            mVisibilityExpressions.append( qMakePair( compileExpression( container->visibilityExpression().data().expression() ), item ) );
             visibilityExpression = container->visibilityExpression().data().expression();
           }
 
@@ -271,6 +277,8 @@ void AttributeFormModelBase::resetModel()
     {
       container->setData( container->index(), AttributeFormModel::GroupIndex );
     }
+
+    buildDependencies();
   }
 }
 
@@ -281,6 +289,8 @@ void AttributeFormModelBase::applyFeatureModel()
   mExpressionContext.setFeature( mFeatureModel->feature() );
   mExpressionContext << QgsExpressionContextUtils::formScope( mFeatureModel->feature() );
 
+  prepareExpressions();
+
   for ( int i = 0; i < invisibleRootItem()->rowCount(); ++i )
   {
     updateAttributeValue( invisibleRootItem()->child( i ) );
@@ -344,7 +354,7 @@ void AttributeFormModelBase::applyRelationshipDefaultValues()
       if ( success )
       {
         synchronizeFieldValue( fidx, defaultValue );
-        updateVisibilityAndConstraints( fidx );
+        updateVisibilityAndConstraints( { fidx } );
       }
     }
   }
@@ -411,72 +421,30 @@ void AttributeFormModelBase::updateAttributeValue( QStandardItem *item )
     }
     else
     {
-      if ( mReadOnlyExpressions.contains( item ) )
+      auto readOnlyExpression = mReadOnlyExpressions.find( item );
+      if ( readOnlyExpression != mReadOnlyExpressions.end() )
       {
-        QgsExpression exp( mReadOnlyExpressions[item] );
-        exp.prepare( &mExpressionContext );
-        QVariant result = exp.evaluate( &mExpressionContext );
+        QVariant result = readOnlyExpression->expression.evaluate( &mExpressionContext );
         item->setData( result.isValid() && result.toBool() == true, AttributeFormModel::AttributeEditable );
       }
     }
 
-    if ( mAliasExpressions.contains( item ) )
+    auto aliasExpression = mAliasExpressions.find( item );
+    if ( aliasExpression != mAliasExpressions.end() )
     {
-      QgsExpression exp( mAliasExpressions[item] );
-      exp.prepare( &mExpressionContext );
-      QVariant result = exp.evaluate( &mExpressionContext );
+      QVariant result = aliasExpression->expression.evaluate( &mExpressionContext );
       if ( result.isValid() )
       {
         item->setData( result, AttributeFormModel::Name );
       }
     }
   }
-  else if ( item->data( AttributeFormModel::ElementType ) == QStringLiteral( "qml" ) || item->data( AttributeFormModel::ElementType ) == QStringLiteral( "html" ) )
+  else if ( item->data( AttributeFormModel::ElementType ) == QStringLiteral( "qml" ) || item->data( AttributeFormModel::ElementType ) == QStringLiteral( "html" ) || item->data( AttributeFormModel::ElementType ) == QStringLiteral( "text" ) )
   {
-    QString code = mEditorWidgetCodes[item];
-
-    QRegularExpression re( R"re(expression\.evaluate\s*\(\s*"(.*?[^\\])"\))re", QRegularExpression::PatternOption::MultilineOption | QRegularExpression::PatternOption::DotMatchesEverythingOption );
-    QRegularExpressionMatch match = re.match( code );
-    while ( match.hasMatch() )
-    {
-      QString expression = match.captured( 1 );
-      expression = expression.replace( QStringLiteral( "\\\"" ), QStringLiteral( "\"" ) );
-
-      mExpressionContext.setFeature( mFeatureModel->feature() );
-
-      QgsExpression exp = QgsExpression( expression );
-      exp.prepare( &mExpressionContext );
-      QVariant result = exp.evaluate( &mExpressionContext );
-
-      QString resultString;
-      switch ( static_cast<QMetaType::Type>( result.typeId() ) )
-      {
-        case QMetaType::Int:
-        case QMetaType::UInt:
-        case QMetaType::Double:
-        case QMetaType::LongLong:
-        case QMetaType::ULongLong:
-          resultString = result.toString();
-          break;
-        case QMetaType::Bool:
-          resultString = result.toBool() ? QStringLiteral( "true" ) : QStringLiteral( "false" );
-          break;
-        default:
-          resultString = QStringLiteral( "'%1'" ).arg( result.toString() );
-          break;
-      }
-      code = code.mid( 0, match.capturedStart( 0 ) ) + resultString + code.mid( match.capturedEnd( 0 ) );
-      match = re.match( code );
-    }
-    item->setData( code, AttributeFormModel::EditorWidgetCode );
-  }
-  else if ( item->data( AttributeFormModel::ElementType ) == QStringLiteral( "text" ) )
-  {
-    QString code = mEditorWidgetCodes[item];
-
     mExpressionContext.setFeature( mFeatureModel->feature() );
-    code = QgsExpression::replaceExpressionText( code, &mExpressionContext );
-    item->setData( code, AttributeFormModel::EditorWidgetCode );
+
+    auto editorWidgetCode = mEditorWidgetCodes.find( item );
+    item->setData( editorWidgetCode != mEditorWidgetCodes.end() ? evaluateEditorWidgetCode( *editorWidgetCode ) : QString(), AttributeFormModel::EditorWidgetCode );
   }
   else
   {
@@ -540,7 +508,7 @@ void AttributeFormModelBase::buildForm( QgsAttributeEditorContainer *container,
         containers << item;
 
         if ( !visibilityExpression.isEmpty() )
-          mVisibilityExpressions.append( qMakePair( QgsExpression( visibilityExpression ), item ) );
+          mVisibilityExpressions.append( qMakePair( compileExpression( visibilityExpression ), item ) );
         break;
       }
 
@@ -605,12 +573,12 @@ void AttributeFormModelBase::buildForm( QgsAttributeEditorContainer *container,
         QgsProperty property = mLayer->editFormConfig().dataDefinedFieldProperties( field.name() ).property( QgsEditFormConfig::DataDefinedProperty::Alias );
         if ( property.isActive() )
         {
-          mAliasExpressions.insert( item, property.asExpression() );
+          mAliasExpressions.insert( item, compileExpression( property.asExpression() ) );
         }
         property = mLayer->editFormConfig().dataDefinedFieldProperties( field.name() ).property( QgsEditFormConfig::DataDefinedProperty::Editable );
         if ( property.isActive() )
         {
-          mReadOnlyExpressions.insert( item, property.asExpression() );
+          mReadOnlyExpressions.insert( item, compileExpression( property.asExpression() ) );
         }
 
         updateAttributeValue( item );
@@ -665,7 +633,7 @@ void AttributeFormModelBase::buildForm( QgsAttributeEditorContainer *container,
 
         updateAttributeValue( item );
         parent->appendRow( item );
-        mEditorWidgetCodes.insert( item, qmlElement->qmlCode() );
+        mEditorWidgetCodes.insert( item, compileEditorWidgetCode( qmlElement->qmlCode(), false ) );
         break;
       }
 
@@ -685,7 +653,7 @@ void AttributeFormModelBase::buildForm( QgsAttributeEditorContainer *container,
 
         updateAttributeValue( item );
         parent->appendRow( item );
-        mEditorWidgetCodes.insert( item, htmlElement->htmlCode() );
+        mEditorWidgetCodes.insert( item, compileEditorWidgetCode( htmlElement->htmlCode(), false ) );
         break;
       }
 
@@ -702,7 +670,7 @@ void AttributeFormModelBase::buildForm( QgsAttributeEditorContainer *container,
 
         updateAttributeValue( item );
         parent->appendRow( item );
-        mEditorWidgetCodes.insert( item, textElement->text() );
+        mEditorWidgetCodes.insert( item, compileEditorWidgetCode( textElement->text(), true ) );
         break;
       }
       case Qgis::AttributeEditorType::Action:
@@ -733,104 +701,254 @@ void AttributeFormModelBase::synchronizeFieldValue( int fieldIndex, QVariant val
   }
 }
 
-void AttributeFormModelBase::updateDefaultValues( int fieldIndex, QVector<int> updatedFields )
+AttributeFormModelBase::ExpressionDependencies AttributeFormModelBase::expressionDependencies( const QgsExpression &expression ) const
 {
-  const QgsFields fields = mFeatureModel->feature().fields();
-  if ( fieldIndex < 0 || fieldIndex >= fields.size() )
-    return;
-  const QString fieldName = fields.at( fieldIndex ).name();
+  ExpressionDependencies dependencies;
+  const QSet<QString> referencedColumns = expression.referencedColumns();
+  dependencies.allFields = referencedColumns.contains( QgsFeatureRequest::ALL_ATTRIBUTES ) || QgsValueRelationFieldFormatter::expressionRequiresFormScope( expression.expression() );
 
-  mExpressionContext.setFields( fields );
-  mExpressionContext.setFeature( mFeatureModel->feature() );
+  const QgsFields fields = mLayer->fields();
+  for ( const QString &referencedColumn : referencedColumns )
+  {
+    const int fieldIndex = fields.indexOf( referencedColumn );
+    if ( fieldIndex > -1 )
+      dependencies.fieldIndexes << fieldIndex;
+  }
 
-  QMap<QStandardItem *, int>::ConstIterator fieldIterator( mFields.constBegin() );
-  for ( ; fieldIterator != mFields.constEnd(); ++fieldIterator )
+  return dependencies;
+}
+
+AttributeFormModelBase::CompiledExpression AttributeFormModelBase::compileExpression( const QString &expression ) const
+{
+  CompiledExpression compiledExpression;
+  compiledExpression.expression = QgsExpression( expression );
+  compiledExpression.dependencies = expressionDependencies( compiledExpression.expression );
+  return compiledExpression;
+}
+
+AttributeFormModelBase::EditorWidgetCode AttributeFormModelBase::compileEditorWidgetCode( const QString &code, bool isText ) const
+{
+  EditorWidgetCode editorWidgetCode;
+  editorWidgetCode.code = code;
+  editorWidgetCode.isText = isText;
+
+  if ( isText )
   {
-    QStandardItem *item = fieldIterator.key();
-    const int fidx = fieldIterator.value();
-    if ( fidx == fieldIndex || !fields.at( fidx ).defaultValueDefinition().isValid() || !fields.at( fidx ).defaultValueDefinition().applyOnUpdate() )
-      continue;
+    // text codes are evaluated through QgsExpression::replaceExpressionText, only their dependencies are needed
+    const thread_local QRegularExpression sRegEx( QStringLiteral( "\\[%(.*?)%\\]" ), QRegularExpression::MultilineOption | QRegularExpression::DotMatchesEverythingOption );
+    QRegularExpressionMatchIterator matchIt = sRegEx.globalMatch( code );
+    while ( matchIt.hasNext() )
+    {
+      editorWidgetCode.dependencies.unite( expressionDependencies( QgsExpression( matchIt.next().captured( 1 ) ) ) );
+    }
+    return editorWidgetCode;
+  }
+
+  const thread_local QRegularExpression sRegEx( QStringLiteral( R"re(expression\.evaluate\s*\(\s*"(.*?[^\\])"\s*\))re" ), QRegularExpression::MultilineOption | QRegularExpression::DotMatchesEverythingOption );
+  qsizetype position = 0;
+  QRegularExpressionMatchIterator matchIt = sRegEx.globalMatch( code );
+  while ( matchIt.hasNext() )
+  {
+    const QRegularExpressionMatch match = matchIt.next();
+    QString expression = match.captured( 1 );
+    expression = expression.replace( QStringLiteral( "\\\"" ), QStringLiteral( "\"" ) );
+
+    editorWidgetCode.parts << code.mid( position, match.capturedStart( 0 ) - position );
+    editorWidgetCode.expressions << QgsExpression( expression );
+    editorWidgetCode.dependencies.unite( expressionDependencies( editorWidgetCode.expressions.last() ) );
+    position = match.capturedEnd( 0 );
+  }
+  editorWidgetCode.parts << code.mid( position );
 
-    QgsExpression exp( fields.at( fidx ).defaultValueDefinition().expression() );
-    exp.prepare( &mExpressionContext );
+  return editorWidgetCode;
+}
+
+QString AttributeFormModelBase::evaluateEditorWidgetCode( EditorWidgetCode &editorWidgetCode )
+{
+  if ( editorWidgetCode.isText )
+  {
+    return QgsExpression::replaceExpressionText( editorWidgetCode.code, &mExpressionContext );
+  }
 
-    // avoid cost of value update if expression doesn't contain the field which triggered the default values update
-    if ( !exp.referencedColumns().contains( fieldName ) && !exp.referencedColumns().contains( QgsFeatureRequest::ALL_ATTRIBUTES ) )
+  QString code = editorWidgetCode.parts.value( 0 );
+  for ( int i = 0; i < editorWidgetCode.expressions.size(); i++ )
+  {
+    QVariant result = editorWidgetCode.expressions[i].evaluate( &mExpressionContext );
+
+    QString resultString;
+    switch ( static_cast<QMetaType::Type>( result.typeId() ) )
     {
-      continue;
+      case QMetaType::Int:
+      case QMetaType::UInt:
+      case QMetaType::Double:
+      case QMetaType::LongLong:
+      case QMetaType::ULongLong:
+        resultString = result.toString();
+        break;
+      case QMetaType::Bool:
+        resultString = result.toBool() ? QStringLiteral( "true" ) : QStringLiteral( "false" );
+        break;
+      default:
+        resultString = QStringLiteral( "'%1'" ).arg( result.toString() );
+        break;
     }
+    code += resultString + editorWidgetCode.parts.value( i + 1 );
+  }
 
-    const QVariant defaultValue = exp.evaluate( &mExpressionContext );
-    const QVariant previousValue = mFeatureModel->data( mFeatureModel->index( fidx ), FeatureModel::AttributeValue );
-    const bool success = mFeatureModel->setData( mFeatureModel->index( fidx ), defaultValue, FeatureModel::AttributeValue );
-    const QVariant updatedValue = mFeatureModel->data( mFeatureModel->index( fidx ), FeatureModel::AttributeValue );
-    if ( success && updatedValue != previousValue )
+  return code;
+}
+
+void AttributeFormModelBase::buildDependencies()
+{
+  const QgsFields fields = mLayer->fields();
+
+  QMap<int, CompiledExpression> defaultValues;
+  for ( const int fieldIndex : std::as_const( mFields ) )
+  {
+    const QgsField field = fields.at( fieldIndex );
+    if ( field.defaultValueDefinition().isValid() && field.defaultValueDefinition().applyOnUpdate() && !defaultValues.contains( fieldIndex ) )
     {
-      synchronizeFieldValue( fidx, updatedValue );
-      if ( !updatedFields.contains( fidx ) )
+      defaultValues.insert( fieldIndex, compileExpression( field.defaultValueDefinition().expression() ) );
+    }
+
+    const QString constraintExpression = field.constraints().constraintExpression();
+    if ( !constraintExpression.isEmpty() && !mConstraintDependencies.contains( fieldIndex ) )
+    {
+      mConstraintDependencies.insert( fieldIndex, compileExpression( constraintExpression ).dependencies );
+    }
+  }
+
+  // sort the default values topologically (Kahn's algorithm), so a single pass over them
+  // evaluates each default value after all the default values it depends on
+  QHash<int, QList<int>> dependents;
+  QMap<int, int> pendingDependenciesCount;
+  for ( auto it = defaultValues.constBegin(); it != defaultValues.constEnd(); ++it )
+  {
+    pendingDependenciesCount[it.key()] = 0;
+
+    const ExpressionDependencies &dependencies = it.value().dependencies;
+    const QList<int> dependencyIndexes = dependencies.allFields ? defaultValues.keys() : QList<int>( dependencies.fieldIndexes.constBegin(), dependencies.fieldIndexes.constEnd() );
+    for ( const int dependencyIndex : dependencyIndexes )
+    {
+      if ( dependencyIndex != it.key() && defaultValues.contains( dependencyIndex ) )
       {
-        updatedFields.append( fidx );
-        updateDefaultValues( fidx, updatedFields );
+        dependents[dependencyIndex] << it.key();
+        pendingDependenciesCount[it.key()]++;
       }
-      updateVisibilityAndConstraints( fidx );
     }
   }
 
-  updateDataDefinedProperties( fieldName );
-  updateEditorWidgetCodes( fieldName );
+  QList<int> readyFieldIndexes;
+  for ( auto it = pendingDependenciesCount.constBegin(); it != pendingDependenciesCount.constEnd(); ++it )
+  {
+    if ( it.value() == 0 )
+      readyFieldIndexes << it.key();
+  }
+
+  while ( !readyFieldIndexes.isEmpty() )
+  {
+    const int fieldIndex = readyFieldIndexes.takeFirst();
+    mDefaultValueExpressions << qMakePair( fieldIndex, defaultValues.take( fieldIndex ) );
+
+    const QList<int> fieldDependents = dependents.value( fieldIndex );
+    for ( const int dependent : fieldDependents )
+    {
+      if ( --pendingDependenciesCount[dependent] == 0 )
+        readyFieldIndexes << dependent;
+    }
+  }
+
+  // default values depending on each other in a cycle are left, evaluate them last in the field order
+  for ( auto it = defaultValues.constBegin(); it != defaultValues.constEnd(); ++it )
+  {
+    mDefaultValueExpressions << qMakePair( it.key(), it.value() );
+  }
 }
 
-bool AttributeFormModelBase::codeRequiresUpdate( const QString &fieldName, const QString &code, const QRegularExpression &regEx )
+void AttributeFormModelBase::prepareExpressions()
 {
-  if ( !mEditorWidgetCodesRequirements.contains( code ) )
+  for ( DefaultValueExpression &defaultValueExpression : mDefaultValueExpressions )
   {
-    CodeRequirements codeRequirements;
-    QRegularExpressionMatchIterator matchIt = regEx.globalMatch( code );
-    while ( matchIt.hasNext() )
+    defaultValueExpression.second.expression.prepare( &mExpressionContext );
+  }
+
+  for ( VisibilityExpression &visibilityExpression : mVisibilityExpressions )
+  {
+    visibilityExpression.first.expression.prepare( &mExpressionContext );
+  }
+
+  for ( CompiledExpression &aliasExpression : mAliasExpressions )
+  {
+    aliasExpression.expression.prepare( &mExpressionContext );
+  }
+
+  for ( CompiledExpression &readOnlyExpression : mReadOnlyExpressions )
+  {
+    readOnlyExpression.expression.prepare( &mExpressionContext );
+  }
+
+  for ( EditorWidgetCode &editorWidgetCode : mEditorWidgetCodes )
+  {
+    for ( QgsExpression &expression : editorWidgetCode.expressions )
     {
-      const QRegularExpressionMatch match = matchIt.next();
-      QString expression = match.captured( 1 );
-      expression = expression.replace( QStringLiteral( "\\\"" ), QStringLiteral( "\"" ) );
+      expression.prepare( &mExpressionContext );
+    }
+  }
+}
 
-      QgsExpression exp( expression );
-      exp.prepare( &mExpressionContext );
-      codeRequirements.referencedColumns.unite( exp.referencedColumns() );
-      codeRequirements.formScope = codeRequirements.formScope || QgsValueRelationFieldFormatter::expressionRequiresFormScope( expression );
+QSet<int> AttributeFormModelBase::updateDefaultValues( int fieldIndex )
+{
+  const QgsFields fields = mFeatureModel->feature().fields();
+  if ( fieldIndex < 0 || fieldIndex >= fields.size() )
+    return QSet<int>();
+
+  mExpressionContext.setFields( fields );
+  mExpressionContext.setFeature( mFeatureModel->feature() );
+
+  // the default values are sorted in dependency order, a single pass reaches all the transitive dependents
+  QSet<int> changedFields { fieldIndex };
+  for ( DefaultValueExpression &defaultValueExpression : mDefaultValueExpressions )
+  {
+    const int fidx = defaultValueExpression.first;
+    if ( fidx == fieldIndex || !defaultValueExpression.second.dependencies.dependsOn( changedFields ) )
+      continue;
+
+    const QVariant defaultValue = defaultValueExpression.second.expression.evaluate( &mExpressionContext );
+    const QVariant previousValue = mFeatureModel->data( mFeatureModel->index( fidx ), FeatureModel::AttributeValue );
+    const bool success = mFeatureModel->setData( mFeatureModel->index( fidx ), defaultValue, FeatureModel::AttributeValue );
+    const QVariant updatedValue = mFeatureModel->data( mFeatureModel->index( fidx ), FeatureModel::AttributeValue );
+    if ( success && updatedValue != previousValue )
+    {
+      synchronizeFieldValue( fidx, updatedValue );
+      mExpressionContext.setFeature( mFeatureModel->feature() );
+      changedFields << fidx;
     }
-    mEditorWidgetCodesRequirements.insert( code, codeRequirements );
   }
 
-  return mEditorWidgetCodesRequirements[code].referencedColumns.contains( fieldName ) || mEditorWidgetCodesRequirements[code].referencedColumns.contains( QgsFeatureRequest::ALL_ATTRIBUTES ) || mEditorWidgetCodesRequirements[code].formScope;
+  return changedFields;
 }
 
-void AttributeFormModelBase::updateDataDefinedProperties( const QString &fieldName )
+void AttributeFormModelBase::updateDataDefinedProperties( const QSet<int> &changedFields )
 {
-  QMap<QStandardItem *, QString>::ConstIterator aliasExpressionsIterator( mAliasExpressions.constBegin() );
-  for ( ; aliasExpressionsIterator != mAliasExpressions.constEnd(); aliasExpressionsIterator++ )
+  for ( auto it = mAliasExpressions.begin(); it != mAliasExpressions.end(); ++it )
   {
-    QStandardItem *item = aliasExpressionsIterator.key();
-    if ( !item )
+    QStandardItem *item = it.key();
+    if ( !item || !it->dependencies.dependsOn( changedFields ) )
     {
       continue;
     }
 
-    QgsExpression exp( aliasExpressionsIterator.value() );
-    exp.referencedColumns().contains( fieldName );
+    QVariant result = it->expression.evaluate( &mExpressionContext );
+    if ( result.isValid() )
     {
-      exp.prepare( &mExpressionContext );
-      QVariant result = exp.evaluate( &mExpressionContext );
-      if ( result.isValid() )
-      {
-        item->setData( result, AttributeFormModel::Name );
-      }
+      item->setData( result, AttributeFormModel::Name );
     }
   }
 
-  QMap<QStandardItem *, QString>::ConstIterator readOnlyExpressionsIterator( mReadOnlyExpressions.constBegin() );
-  for ( ; readOnlyExpressionsIterator != mReadOnlyExpressions.constEnd(); readOnlyExpressionsIterator++ )
+  for ( auto it = mReadOnlyExpressions.begin(); it != mReadOnlyExpressions.end(); ++it )
   {
-    QStandardItem *item = readOnlyExpressionsIterator.key();
-    if ( !item )
+    QStandardItem *item = it.key();
+    if ( !item || !it->dependencies.dependsOn( changedFields ) )
     {
       continue;
     }
@@ -840,74 +958,22 @@ void AttributeFormModelBase::updateDataDefinedProperties( const QString &fieldNa
       continue;
     }
 
-    QgsExpression exp( readOnlyExpressionsIterator.value() );
-    exp.referencedColumns().contains( fieldName );
-    {
-      exp.prepare( &mExpressionContext );
-      QVariant result = exp.evaluate( &mExpressionContext );
-      item->setData( result.isValid() && result.toBool() == true, AttributeFormModel::AttributeEditable );
-    }
+    QVariant result = it->expression.evaluate( &mExpressionContext );
+    item->setData( result.isValid() && result.toBool() == true, AttributeFormModel::AttributeEditable );
   }
 }
 
-void AttributeFormModelBase::updateEditorWidgetCodes( const QString &fieldName )
+void AttributeFormModelBase::updateEditorWidgetCodes( const QSet<int> &changedFields )
 {
-  QMap<QStandardItem *, QString>::ConstIterator editorWidgetCodesIterator( mEditorWidgetCodes.constBegin() );
-  for ( ; editorWidgetCodesIterator != mEditorWidgetCodes.constEnd(); editorWidgetCodesIterator++ )
+  for ( auto it = mEditorWidgetCodes.begin(); it != mEditorWidgetCodes.end(); ++it )
   {
-    QStandardItem *item = editorWidgetCodesIterator.key();
-    if ( !item )
+    QStandardItem *item = it.key();
+    if ( !item || !it->dependencies.dependsOn( changedFields ) )
     {
       continue;
     }
-    QString code = editorWidgetCodesIterator.value();
-    if ( item->data( AttributeFormModel::ElementType ) == QStringLiteral( "qml" ) || item->data( AttributeFormModel::ElementType ) == QStringLiteral( "html" ) )
-    {
-      const thread_local QRegularExpression sRegEx( "expression\\.evaluate\\(\\s*\\\"(.*?[^\\\\])\\\"\\s*\\)", QRegularExpression::MultilineOption | QRegularExpression::DotMatchesEverythingOption );
-      if ( codeRequiresUpdate( fieldName, code, sRegEx ) )
-      {
-        QRegularExpressionMatch match = sRegEx.match( code );
-        while ( match.hasMatch() )
-        {
-          QString expression = match.captured( 1 );
-          expression = expression.replace( QStringLiteral( "\\\"" ), QStringLiteral( "\"" ) );
-
-          QgsExpression exp = QgsExpression( expression );
-          exp.prepare( &mExpressionContext );
-          QVariant result = exp.evaluate( &mExpressionContext );
 
-          QString resultString;
-          switch ( static_cast<QMetaType::Type>( result.typeId() ) )
-          {
-            case QMetaType::Int:
-            case QMetaType::UInt:
-            case QMetaType::Double:
-            case QMetaType::LongLong:
-            case QMetaType::ULongLong:
-              resultString = result.toString();
-              break;
-            case QMetaType::Bool:
-              resultString = result.toBool() ? QStringLiteral( "true" ) : QStringLiteral( "false" );
-              break;
-            default:
-              resultString = QStringLiteral( "'%1'" ).arg( result.toString() );
-              break;
-          }
-          code = code.mid( 0, match.capturedStart( 0 ) ) + resultString + code.mid( match.capturedEnd( 0 ) );
-          match = sRegEx.match( code );
-        }
-        item->setData( code, AttributeFormModel::EditorWidgetCode );
-      }
-    }
-    else if ( item->data( AttributeFormModel::ElementType ) == QStringLiteral( "text" ) )
-    {
-      const thread_local QRegularExpression sRegEx( QStringLiteral( "\\[%(.*?)%\\]" ), QRegularExpression::MultilineOption | QRegularExpression::DotMatchesEverythingOption );
-      if ( codeRequiresUpdate( fieldName, code, sRegEx ) )
-      {
-        code = QgsExpression::replaceExpressionText( code, &mExpressionContext );
-        item->setData( code, AttributeFormModel::EditorWidgetCode );
-      }
-    }
+    item->setData( evaluateEditorWidgetCode( *it ), AttributeFormModel::EditorWidgetCode );
   }
 }
 
@@ -938,24 +1004,19 @@ void _checkChildrenValidity( QStandardItem *parent, bool &hardValidity, bool &so
   }
 };
 
-void AttributeFormModelBase::updateVisibilityAndConstraints( int fieldIndex )
+void AttributeFormModelBase::updateVisibilityAndConstraints( const QSet<int> &changedFields )
 {
-  const QString fieldName = fieldIndex > -1 && fieldIndex < mLayer->fields().size() ? mLayer->fields().at( fieldIndex ).name() : QString();
   QgsFields fields = mFeatureModel->feature().fields();
   mExpressionContext.setFields( fields );
   mExpressionContext.setFeature( mFeatureModel->feature() );
 
   bool visibilityChanged = false;
-  for ( const VisibilityExpression &it : std::as_const( mVisibilityExpressions ) )
+  for ( VisibilityExpression &it : mVisibilityExpressions )
   {
-    // If triggered by an updated field index (fieldIndex), check if the visibility
-    // expression refers to that field
-    if ( fieldIndex == -1 || it.first.referencedColumns().contains( fieldName ) || it.first.referencedColumns().contains( QgsFeatureRequest::ALL_ATTRIBUTES ) )
+    // If triggered by updated fields, check if the visibility expression depends on them
+    if ( changedFields.isEmpty() || it.first.dependencies.dependsOn( changedFields ) )
     {
-      QgsExpression exp = it.first;
-      exp.prepare( &mExpressionContext );
-
-      bool visible = exp.evaluate( &mExpressionContext ).toInt();
+      bool visible = it.first.expression.evaluate( &mExpressionContext ).toInt();
       QStandardItem *item = it.second;
       if ( item->data( AttributeFormModel::CurrentlyVisible ).toBool() != visible )
       {
@@ -973,12 +1034,11 @@ void AttributeFormModelBase::updateVisibilityAndConstraints( int fieldIndex )
   {
     QStandardItem *item = fieldIterator.key();
     int fidx = fieldIterator.value();
-    if ( fieldIndex != -1 && fidx != fieldIndex )
+    if ( !changedFields.isEmpty() && !changedFields.contains( fidx ) )
     {
-      // Check whether the current field iterator index (fidx) has an expression constraints referencing the
-      // updated field index (fieldIndex) which triggered a constraints update
-      const QgsExpression expression = mLayer->fields().at( fidx ).constraints().constraintExpression();
-      if ( !expression.referencedColumns().contains( fieldName ) && !expression.referencedColumns().contains( QgsFeatureRequest::ALL_ATTRIBUTES ) )
+      // Check whether the current field iterator index (fidx) has an expression constraints depending on
+      // the updated fields which triggered a constraints update
+      if ( !mConstraintDependencies.value( fidx ).dependsOn( changedFields ) )
       {
         continue;
       }
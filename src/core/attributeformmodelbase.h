@@ -22,6 +22,7 @@
 #include <QStandardItemModel>
 #include <qgsattributeeditorcontainer.h>
 #include <qgseditformconfig.h>
+#include <qgsexpression.h>
 #include <qgsexpressioncontext.h>
 
 /**
@@ -87,10 +88,39 @@ class AttributeFormModelBase : public QStandardItemModel
     void constraintsSoftValidChanged();
 
   private:
-    struct CodeRequirements
+    //! The fields an expression depends on
+    struct ExpressionDependencies
     {
-        QSet<QString> referencedColumns;
-        bool formScope = false;
+        QSet<int> fieldIndexes;
+        //! TRUE if the expression depends on all attributes or on the form scope
+        bool allFields = false;
+
+        //! Returns TRUE if the expression has to be re-evaluated when any of the \a changedFieldIndexes changed
+        bool dependsOn( const QSet<int> &changedFieldIndexes ) const { return allFields || fieldIndexes.intersects( changedFieldIndexes ); }
+
+        void unite( const ExpressionDependencies &other )
+        {
+          fieldIndexes.unite( other.fieldIndexes );
+          allFields = allFields || other.allFields;
+        }
+    };
+
+    //! An expression parsed once per form, along with the fields it depends on
+    struct CompiledExpression
+    {
+        QgsExpression expression;
+        ExpressionDependencies dependencies;
+    };
+
+    //! A QML, HTML or text widget code along with its parsed expressions
+    struct EditorWidgetCode
+    {
+        QString code;
+        bool isText = false;
+        //! The QML or HTML code split around its expression.evaluate() calls, there is one more part than expressions
+        QStringList parts;
+        QList<QgsExpression> expressions;
+        ExpressionDependencies dependencies;
     };
 
     /**
@@ -111,23 +141,44 @@ class AttributeFormModelBase : public QStandardItemModel
                     int columnCount = 1 );
 
 
+    //! Returns the fields of the layer the \a expression depends on.
+    ExpressionDependencies expressionDependencies( const QgsExpression &expression ) const;
+
+    //! Parses the \a expression and resolves the fields it depends on.
+    CompiledExpression compileExpression( const QString &expression ) const;
+
+    //! Parses the expressions of a QML or HTML widget \a code, or of a text widget code if \a isText is TRUE.
+    EditorWidgetCode compileEditorWidgetCode( const QString &code, bool isText ) const;
+
+    //! Returns the widget code with its expressions evaluated against the current feature.
+    QString evaluateEditorWidgetCode( EditorWidgetCode &editorWidgetCode );
+
+    /**
+     * Builds the graph of the default value and constraint expressions depending on each field,
+     * with the default values sorted so that each one comes after the default values it depends on.
+     */
+    void buildDependencies();
+
+    //! Prepares the compiled expressions against the current expression context.
+    void prepareExpressions();
+
     //! Synchronize all items linked to the \a fieldIndex to have the same \a value.
     void synchronizeFieldValue( int fieldIndex, QVariant value );
 
-    //! Update default values refering to the \a fieldIndex.
-    void updateDefaultValues( int fieldIndex = -1, QVector<int> updatedFields = QVector<int>() );
-
-    //! Update QML, HTML, and text widget code.
-    void updateEditorWidgetCodes( const QString &fieldName );
+    /**
+     * Updates the default values depending, directly or transitively, on the \a fieldIndex in dependency order.
+     * \returns the indexes of the changed fields, including \a fieldIndex
+     */
+    QSet<int> updateDefaultValues( int fieldIndex );
 
-    //! Update expression-driven alias and read-only values.
-    void updateDataDefinedProperties( const QString &fieldName );
+    //! Update QML, HTML, and text widget code depending on the \a changedFields.
+    void updateEditorWidgetCodes( const QSet<int> &changedFields );
 
-    //! Check if the given \a code requires update.
-    bool codeRequiresUpdate( const QString &fieldName, const QString &code, const QRegularExpression &regEx );
+    //! Update expression-driven alias and read-only values depending on the \a changedFields.
+    void updateDataDefinedProperties( const QSet<int> &changedFields );
 
-    //! Udate the visibility state of groups as well as constraints of field items
-    void updateVisibilityAndConstraints( int fieldIndex = -1 );
+    //! Udate the visibility state of groups as well as constraints of field items depending on the \a changedFields, or all of them if empty
+    void updateVisibilityAndConstraints( const QSet<int> &changedFields = QSet<int>() );
 
     void setConstraintsHardValid( bool constraintsHardValid );
 
@@ -153,13 +204,17 @@ class AttributeFormModelBase : public QStandardItemModel
     bool mHasTabs = false;
     bool mHasRemembrance = false;
 
-    typedef QPair<QgsExpression, QStandardItem *> VisibilityExpression;
+    typedef QPair<CompiledExpression, QStandardItem *> VisibilityExpression;
     QList<VisibilityExpression> mVisibilityExpressions;
     QMap<QStandardItem *, int> mFields;
-    QMap<QStandardItem *, QString> mAliasExpressions;
-    QMap<QStandardItem *, QString> mReadOnlyExpressions;
-    QMap<QStandardItem *, QString> mEditorWidgetCodes;
-    QMap<QString, CodeRequirements> mEditorWidgetCodesRequirements;
+    QMap<QStandardItem *, CompiledExpression> mAliasExpressions;
+    QMap<QStandardItem *, CompiledExpression> mReadOnlyExpressions;
+    QMap<QStandardItem *, EditorWidgetCode> mEditorWidgetCodes;
+
+    //! The default values applied on update, sorted in dependency order
+    typedef QPair<int, CompiledExpression> DefaultValueExpression;
+    QList<DefaultValueExpression> mDefaultValueExpressions;
+    QMap<int, ExpressionDependencies> mConstraintDependencies;
 
     QgsExpressionContext mExpressionContext;
     bool mConstraintsHardValid = true;
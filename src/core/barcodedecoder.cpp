@@ -16,38 +16,144 @@
 
 #include "barcodedecoder.h"
 
+#include <QMutex>
+#include <QThread>
 #include <QVideoFrame>
+#include <QWaitCondition>
 
 #include <ZXing/ReadBarcode.h>
 
+#include <cstring>
+#include <utility>
+
+/**
+ * A persistent thread decoding the images handed over by a barcode decoder. A single image waits to be
+ * decoded, an image posted while another one is waiting replaces it.
+ */
 class BarcodeDecoderThread : public QThread
 {
   public:
-    explicit BarcodeDecoderThread( BarcodeDecoder *decoder, const QImage &image )
+    explicit BarcodeDecoderThread( BarcodeDecoder *decoder )
       : QThread()
       , mDecoder( decoder )
-      , mImage( image )
     {
     }
 
+    /**
+     * Returns TRUE if no image is being decoded or waiting to be decoded.
+     */
+    bool isIdle()
+    {
+      QMutexLocker locker( &mMutex );
+      return mImage.isNull() && !mDecoding;
+    }
+
+    /**
+     * Posts an \a image to be decoded.
+     * \returns FALSE if an image waiting to be decoded was dropped.
+     */
+    bool post( const QImage &image )
+    {
+      QMutexLocker locker( &mMutex );
+      const bool dropped = !mImage.isNull();
+      mImage = image;
+      mCondition.wakeOne();
+      return !dropped;
+    }
+
+    //! Stops the thread once the image being decoded is done
+    void stop()
+    {
+      QMutexLocker locker( &mMutex );
+      mStopped = true;
+      mCondition.wakeOne();
+    }
+
   private:
     void run() override
     {
-      if ( mDecoder )
+      for ( ;; )
       {
-        mDecoder->decodeImage( mImage );
+        QImage image;
+        {
+          QMutexLocker locker( &mMutex );
+          while ( mImage.isNull() && !mStopped )
+          {
+            mCondition.wait( &mMutex );
+          }
+
+          if ( mStopped )
+          {
+            return;
+          }
+
+          image = std::exchange( mImage, QImage() );
+          mDecoding = true;
+        }
+
+        const QString decodedString = BarcodeDecoder::decodeString( image );
+        if ( !decodedString.isEmpty() )
+        {
+          QMetaObject::invokeMethod( mDecoder, "setDecodedString", Qt::QueuedConnection, Q_ARG( QString, decodedString ) );
+        }
+
+        QMutexLocker locker( &mMutex );
+        mDecoding = false;
       }
     }
 
     BarcodeDecoder *mDecoder = nullptr;
+    QMutex mMutex;
+    QWaitCondition mCondition;
     QImage mImage;
+    bool mDecoding = false;
+    bool mStopped = false;
 };
 
+//! Returns the pixels covered by a normalized \a region of an image of a given \a size
+static QRect regionRect( const QRectF &region, const QSize &size )
+{
+  return QRectF( region.x() * size.width(), region.y() * size.height(), region.width() * size.width(), region.height() * size.height() )
+    .toAlignedRect()
+    .intersected( QRect( QPoint( 0, 0 ), size ) );
+}
+
+//! Maps a normalized \a region of a \a frame as displayed onto the frame data, which is stored unrotated
+static QRectF unrotatedRegion( const QRectF &region, const QVideoFrame &frame )
+{
+#if QT_VERSION >= QT_VERSION_CHECK( 6, 7, 0 )
+  const int rotation = static_cast<int>( frame.rotation() );
+#else
+  const int rotation = static_cast<int>( frame.rotationAngle() );
+#endif
+
+  switch ( rotation )
+  {
+    case 90:
+      return QRectF( region.y(), 1 - region.x() - region.width(), region.height(), region.width() );
+    case 180:
+      return QRectF( 1 - region.x() - region.width(), 1 - region.y() - region.height(), region.width(), region.height() );
+    case 270:
+      return QRectF( 1 - region.y() - region.height(), region.x(), region.height(), region.width() );
+    default:
+      return region;
+  }
+}
+
 BarcodeDecoder::BarcodeDecoder( QObject *parent )
   : QObject( parent )
 {
 }
 
+BarcodeDecoder::~BarcodeDecoder()
+{
+  if ( mDecodingThread )
+  {
+    mDecodingThread->stop();
+    mDecodingThread->wait();
+  }
+}
+
 void BarcodeDecoder::clearDecodedString()
 {
   if ( mDecodedString.isEmpty() )
@@ -60,7 +166,36 @@ void BarcodeDecoder::clearDecodedString()
   emit decodedStringChanged();
 }
 
+void BarcodeDecoder::setDecodedString( const QString &decodedString )
+{
+  if ( decodedString.isEmpty() || mDecodedString == decodedString )
+  {
+    return;
+  }
+
+  mDecodedString = decodedString;
+
+  emit decodedStringChanged();
+}
+
+void BarcodeDecoder::setRegionOfInterest( const QRectF &regionOfInterest )
+{
+  if ( mRegionOfInterest == regionOfInterest )
+  {
+    return;
+  }
+
+  mRegionOfInterest = regionOfInterest;
+
+  emit regionOfInterestChanged();
+}
+
 void BarcodeDecoder::decodeImage( const QImage &image )
+{
+  setDecodedString( decodeString( image ) );
+}
+
+QString BarcodeDecoder::decodeString( const QImage &image )
 {
   auto imageFormatFromQImage = []( const QImage &img ) {
     switch ( img.format() )
@@ -85,35 +220,113 @@ void BarcodeDecoder::decodeImage( const QImage &image )
   };
 
   ZXing::ImageFormat imageFormat = imageFormatFromQImage( image );
-  if ( imageFormat != ZXing::ImageFormat::None )
+  if ( imageFormat == ZXing::ImageFormat::None )
   {
-    ZXing::ImageView imageView( image.bits(), image.width(), image.height(), imageFormat, static_cast<int>( image.bytesPerLine() ) );
+    return QString();
+  }
+
+  ZXing::ImageView imageView( image.constBits(), image.width(), image.height(), imageFormat, static_cast<int>( image.bytesPerLine() ) );
 
 #if ZXing_VERSION_MAJOR >= 2
-    ZXing::ReaderOptions options;
-    options.setFormats( ZXing::BarcodeFormat::Any );
-    options.setTryRotate( true );
+  ZXing::ReaderOptions options;
+  options.setFormats( ZXing::BarcodeFormat::Any );
+  options.setTryRotate( true );
 
-    ZXing::Result result = ZXing::ReadBarcode( imageView, options );
-    const std::string text = result.text();
-    QString resultText = QString::fromStdString( text.c_str() );
+  ZXing::Result result = ZXing::ReadBarcode( imageView, options );
+  const std::string text = result.text();
+  return QString::fromStdString( text.c_str() );
 #else
-    ZXing::DecodeHints hints;
-    hints.setFormats( ZXing::BarcodeFormat::Any );
-    hints.setTryRotate( true );
+  ZXing::DecodeHints hints;
+  hints.setFormats( ZXing::BarcodeFormat::Any );
+  hints.setTryRotate( true );
 
-    ZXing::Result result = ZXing::ReadBarcode( imageView, hints );
-    const std::wstring text = result.text();
-    QString resultText = QString::fromWCharArray( text.c_str() );
+  ZXing::Result result = ZXing::ReadBarcode( imageView, hints );
+  const std::wstring text = result.text();
+  return QString::fromWCharArray( text.c_str() );
 #endif
-    if ( !resultText.isEmpty() && mDecodedString != resultText )
+}
+
+QImage BarcodeDecoder::luminanceImage( const QVideoFrame &frame, const QRectF &regionOfInterest )
+{
+  if ( regionOfInterest.intersected( QRectF( 0, 0, 1, 1 ) ).isEmpty() )
+  {
+    return QImage();
+  }
+
+  // the distance between two luminance values and the position of the first one in the first plane
+  int pixelStride = 0;
+  int pixelOffset = 0;
+  switch ( frame.pixelFormat() )
+  {
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YUV422P:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_Y8:
+      pixelStride = 1;
+      break;
+    case QVideoFrameFormat::Format_YUYV:
+      pixelStride = 2;
+      break;
+    case QVideoFrameFormat::Format_UYVY:
+      pixelStride = 2;
+      pixelOffset = 1;
+      break;
+    case QVideoFrameFormat::Format_AYUV:
+    case QVideoFrameFormat::Format_AYUV_Premultiplied:
+      pixelStride = 4;
+      pixelOffset = 1;
+      break;
+    default:
+      break;
+  }
+
+  const QRect rect = regionRect( unrotatedRegion( regionOfInterest, frame ), frame.size() );
+  if ( pixelStride > 0 && !rect.isEmpty() )
+  {
+    QVideoFrame mappedFrame( frame );
+    if ( mappedFrame.map( QVideoFrame::ReadOnly ) )
     {
-      mDecodedString = resultText;
-      emit decodedStringChanged();
+      QImage image( rect.size(), QImage::Format_Grayscale8 );
+      const uchar *bits = mappedFrame.bits( 0 );
+      const qsizetype bytesPerLine = mappedFrame.bytesPerLine( 0 );
+
+      for ( int y = 0; y < rect.height(); y++ )
+      {
+        const uchar *source = bits + ( rect.y() + y ) * bytesPerLine + rect.x() * pixelStride + pixelOffset;
+        uchar *destination = image.scanLine( y );
+        if ( pixelStride == 1 )
+        {
+          std::memcpy( destination, source, rect.width() );
+        }
+        else
+        {
+          for ( int x = 0; x < rect.width(); x++ )
+          {
+            destination[x] = source[x * pixelStride];
+          }
+        }
+      }
+
+      mappedFrame.unmap();
+      return image;
     }
   }
 
-  return;
+  // other formats, as well as frames which cannot be mapped into memory, are converted, with their rotation applied
+  const QImage image = frame.toImage();
+  if ( image.isNull() )
+  {
+    return image;
+  }
+
+  const QRect imageRect = regionRect( regionOfInterest, image.size() );
+  return imageRect.isEmpty() ? QImage() : image.copy( imageRect ).convertToFormat( QImage::Format_Grayscale8 );
 }
 
 QVideoSink *BarcodeDecoder::videoSink() const
@@ -137,19 +350,28 @@ void BarcodeDecoder::setVideoSink( QVideoSink *sink )
 
 void BarcodeDecoder::decodeVideoFrame( const QVideoFrame &frame )
 {
-  if ( mDecodingThread || !frame.isValid() )
+  if ( !frame.isValid() )
     return;
 
-  QImage image = frame.toImage();
-  if ( !image.isNull() && image.format() != QImage::Format_ARGB32 )
+  // mapping a frame can be a costly GPU readback, frames arriving while the decoding thread is busy are not read at all
+  if ( mDecodingThread && !mDecodingThread->isIdle() )
   {
-    image = image.convertToFormat( QImage::Format_ARGB32 );
+    mDroppedFramesCount++;
+    return;
   }
 
-  mDecodingThread = new BarcodeDecoderThread( this, image );
-  connect( mDecodingThread, &QThread::finished, this, [this] {
-    mDecodingThread->deleteLater();
-    mDecodingThread = nullptr;
-  } );
-  mDecodingThread->start();
+  const QImage image = luminanceImage( frame, mRegionOfInterest );
+  if ( image.isNull() )
+    return;
+
+  if ( !mDecodingThread )
+  {
+    mDecodingThread = std::make_unique<BarcodeDecoderThread>( this );
+    mDecodingThread->start( QThread::LowPriority );
+  }
+
+  if ( !mDecodingThread->post( image ) )
+  {
+    mDroppedFramesCount++;
+  }
 }
@@ -17,24 +17,32 @@
 #ifndef BARCODEDECODER_H
 #define BARCODEDECODER_H
 
+#include "qfield_core_export.h"
+
 #include <QImage>
 #include <QObject>
 #include <QPointer>
-#include <QThread>
+#include <QRectF>
 #include <QVideoSink>
 
+#include <memory>
+
+class BarcodeDecoderThread;
+
 /**
  * \ingroup core
  */
-class BarcodeDecoder : public QObject
+class QFIELD_CORE_EXPORT BarcodeDecoder : public QObject
 {
     Q_OBJECT
 
     Q_PROPERTY( QVideoSink *videoSink READ videoSink WRITE setVideoSink NOTIFY videoSinkChanged )
     Q_PROPERTY( QString decodedString READ decodedString NOTIFY decodedStringChanged )
+    Q_PROPERTY( QRectF regionOfInterest READ regionOfInterest WRITE setRegionOfInterest NOTIFY regionOfInterestChanged )
 
   public:
     explicit BarcodeDecoder( QObject *parent = nullptr );
+    ~BarcodeDecoder() override;
 
     /**
      * Returns the last barcode decoded string.
@@ -54,17 +62,53 @@ class BarcodeDecoder : public QObject
     QVideoSink *videoSink() const;
     void setVideoSink( QVideoSink *sink );
 
+    /**
+     * Returns the region of the video frames scanned for barcodes, normalized to the frame size as displayed,
+     * i.e. with the frame rotation applied. Defaults to the whole frame.
+     */
+    QRectF regionOfInterest() const { return mRegionOfInterest; }
+
+    /**
+     * Sets the region of the video frames scanned for barcodes, normalized to the frame size as displayed.
+     */
+    void setRegionOfInterest( const QRectF &regionOfInterest );
+
+    /**
+     * Returns the number of video frames which were dropped because the decoding thread was busy.
+     */
+    qint64 droppedFramesCount() const { return mDroppedFramesCount; }
+
+    /**
+     * Returns the luminance of the \a regionOfInterest of a video \a frame as a grayscale image. The luminance is
+     * copied from the Y plane of YUV frames without any color conversion nor rotation, other frames are converted.
+     */
+    static QImage luminanceImage( const QVideoFrame &frame, const QRectF &regionOfInterest = QRectF( 0, 0, 1, 1 ) );
+
+    /**
+     * Scans a provided \a image for barcodes and returns the decoded string, or an empty string if none is found.
+     */
+    static QString decodeString( const QImage &image );
+
   public slots:
+    /**
+     * Hands the region of interest of a video \a frame over to the decoding thread. Frames arriving while the
+     * decoding thread is busy are dropped without being read.
+     */
     void decodeVideoFrame( const QVideoFrame &frame );
 
   signals:
     void decodedStringChanged();
     void videoSinkChanged();
+    void regionOfInterestChanged();
+
+  private slots:
+    void setDecodedString( const QString &decodedString );
 
   private:
-    QImage mImage;
     QString mDecodedString;
-    QThread *mDecodingThread = nullptr;
+    QRectF mRegionOfInterest = QRectF( 0, 0, 1, 1 );
+    std::unique_ptr<BarcodeDecoderThread> mDecodingThread;
+    qint64 mDroppedFramesCount = 0;
     QPointer<QVideoSink> mVideoSink;
 };
 
@@ -0,0 +1,170 @@
+/***************************************************************************
+                        commitsnapshotservice.cpp
+                        -------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "commitsnapshotservice.h"
+
+#include <qgsfeatureiterator.h>
+#include <qgsfeaturerequest.h>
+#include <qgslogger.h>
+#include <qgsvectordataprovider.h>
+#include <qgsvectorlayer.h>
+#include <qgsvectorlayereditbuffer.h>
+
+#include <algorithm>
+
+
+CommitSnapshotService::CommitSnapshotService( QObject *parent )
+  : QObject( parent )
+{
+}
+
+
+void CommitSnapshotService::watchLayer( QgsVectorLayer *vl, const QObject *consumer, SnapshotContent content )
+{
+  mConsumers[vl->id()].insert( consumer, content );
+
+  // NOTE unique connections keep their position, so the snapshot of the previous commit is dropped before the observers connected later are called
+  connect( vl, &QgsVectorLayer::beforeCommitChanges, this, &CommitSnapshotService::releaseSnapshot, Qt::UniqueConnection );
+  connect( vl, &QgsVectorLayer::afterCommitChanges, this, &CommitSnapshotService::releaseSnapshot, Qt::UniqueConnection );
+  connect( vl, &QgsVectorLayer::afterRollBack, this, &CommitSnapshotService::releaseSnapshot, Qt::UniqueConnection );
+}
+
+
+void CommitSnapshotService::unwatchLayer( QgsVectorLayer *vl, const QObject *consumer )
+{
+  auto it = mConsumers.find( vl->id() );
+  if ( it == mConsumers.end() )
+  {
+    return;
+  }
+
+  it->remove( consumer );
+  if ( it->isEmpty() )
+  {
+    mConsumers.erase( it );
+    mSnapshots.remove( vl->id() );
+    disconnect( vl, nullptr, this, nullptr );
+  }
+}
+
+
+int CommitSnapshotService::consumersCount( QgsVectorLayer *vl ) const
+{
+  return mConsumers.value( vl->id() ).size();
+}
+
+
+bool CommitSnapshotService::requiresCompleteFeatures( QgsVectorLayer *vl ) const
+{
+  const QHash<const QObject *, SnapshotContent> consumers = mConsumers.value( vl->id() );
+  return std::any_of( consumers.constBegin(), consumers.constEnd(), []( SnapshotContent content ) { return content == SnapshotContent::CompleteFeatures; } );
+}
+
+
+QgsFeatureMap CommitSnapshotService::snapshot( QgsVectorLayer *vl )
+{
+  mStatistics.snapshotsCount++;
+
+  auto it = mSnapshots.constFind( vl->id() );
+  if ( it != mSnapshots.constEnd() )
+  {
+    mStatistics.featuresSavedCount += it->size();
+
+    QgsLogger::debug( QStringLiteral( "CommitSnapshotService::snapshot: layer \"%1\" shared snapshot of %2 features, %3 features not read again in total" )
+                        .arg( vl->id() )
+                        .arg( it->size() )
+                        .arg( mStatistics.featuresSavedCount ) );
+    return *it;
+  }
+
+  const QgsFeatureMap features = readSnapshot( vl );
+  mSnapshots.insert( vl->id(), features );
+  return features;
+}
+
+
+void CommitSnapshotService::resetStatistics()
+{
+  mStatistics = Statistics();
+}
+
+
+void CommitSnapshotService::releaseSnapshot()
+{
+  QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( sender() );
+  if ( !vl )
+  {
+    return;
+  }
+
+  mSnapshots.remove( vl->id() );
+}
+
+
+QgsFeatureMap CommitSnapshotService::readSnapshot( QgsVectorLayer *vl )
+{
+  QgsFeatureMap features;
+
+  QgsVectorLayerEditBuffer *eb = vl->editBuffer();
+  if ( !eb )
+  {
+    return features;
+  }
+
+  const QgsGeometryMap changedGeometries = eb->changedGeometries();
+  const QgsChangedAttributesMap changedAttributesValues = eb->changedAttributeValues();
+
+  // NOTE QgsFeatureIds underlying implementation is QSet, so no need to check if the QgsFeatureId already exists
+  QgsFeatureIds changedFids = eb->deletedFeatureIds();
+
+  for ( auto it = changedGeometries.constBegin(); it != changedGeometries.constEnd(); ++it )
+    changedFids.insert( it.key() );
+
+  for ( auto it = changedAttributesValues.constBegin(); it != changedAttributesValues.constEnd(); ++it )
+    changedFids.insert( it.key() );
+
+  if ( changedFids.isEmpty() )
+  {
+    return features;
+  }
+
+  mStatistics.providerReadsCount++;
+
+  // NOTE we read the features from the dataProvider directly as we want to access the old values.
+  // If we use the layer, we get the values from the edit buffer.
+  const QgsFields providerFields = vl->dataProvider()->fields();
+  const QList<QgsFeatureId> fidsList( changedFids.constBegin(), changedFids.constEnd() );
+
+  for ( qsizetype chunkStart = 0; chunkStart < fidsList.size(); chunkStart += CHUNK_SIZE )
+  {
+    const QList<QgsFeatureId> chunkFids = fidsList.mid( chunkStart, CHUNK_SIZE );
+    mStatistics.requestsCount++;
+
+    QgsFeatureIterator featuresIt = vl->dataProvider()->getFeatures( QgsFeatureRequest( QgsFeatureIds( chunkFids.constBegin(), chunkFids.constEnd() ) ) );
+    QgsFeature f;
+
+    while ( featuresIt.nextFeature( f ) )
+    {
+      f.setFields( providerFields, false );
+      features.insert( f.id(), f );
+    }
+  }
+
+  mStatistics.featuresReadCount += features.size();
+
+  return features;
+}
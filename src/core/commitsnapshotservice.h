@@ -0,0 +1,118 @@
+/***************************************************************************
+                        commitsnapshotservice.h
+                        -----------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef COMMITSNAPSHOTSERVICE_H
+#define COMMITSNAPSHOTSERVICE_H
+
+#include "qfield_core_export.h"
+
+#include <QHash>
+#include <QObject>
+#include <qgsfeature.h>
+
+class QgsVectorLayer;
+
+/**
+ * Reads the old version of the features changed or deleted by a commit from the data provider
+ * once, and shares it with all the observers of the commit.
+ *
+ * Observers register the layers they observe with watchLayer() before connecting to
+ * QgsVectorLayer::beforeCommitChanges, and call snapshot() from their slot. The first call
+ * reads the features, the following calls for the same commit get the same implicitly shared
+ * feature map, which is only copied if an observer modifies it. Observers which can do with the
+ * changed values only tell so when registering, and read the complete features only when another
+ * observer of the layer requires them, see requiresCompleteFeatures().
+ * \ingroup core
+ */
+class QFIELD_CORE_EXPORT CommitSnapshotService : public QObject
+{
+    Q_OBJECT
+
+  public:
+    //! Maximum number of features read from the data provider with a single request
+    static constexpr int CHUNK_SIZE = 1000;
+
+    /**
+     * What an observer needs from the old version of the features changed by a commit
+     */
+    enum class SnapshotContent
+    {
+      ChangedValues,    //!< The old values of the changed attributes and geometries only
+      CompleteFeatures, //!< All the attributes and the geometry of the changed features
+    };
+
+    /**
+     * Cumulative counters of the snapshots handed out
+     */
+    struct Statistics
+    {
+        //! Number of snapshots handed out to observers
+        qsizetype snapshotsCount = 0;
+        //! Number of snapshots read from the data provider
+        qsizetype providerReadsCount = 0;
+        //! Number of data provider requests
+        qsizetype requestsCount = 0;
+        //! Number of features read from the data provider
+        qsizetype featuresReadCount = 0;
+        //! Number of features handed out from an already read snapshot, i.e. not read again
+        qsizetype featuresSavedCount = 0;
+    };
+
+    explicit CommitSnapshotService( QObject *parent = nullptr );
+
+    /**
+     * Registers \a consumer as an observer of the commits of \a vl needing the \a content of the old
+     * features. Must be called before \a consumer connects to QgsVectorLayer::beforeCommitChanges, so
+     * the previous snapshot is dropped first. Calling it again updates the \a content needed.
+     */
+    void watchLayer( QgsVectorLayer *vl, const QObject *consumer, SnapshotContent content = SnapshotContent::CompleteFeatures );
+
+    //! Unregisters \a consumer as an observer of the commits of \a vl
+    void unwatchLayer( QgsVectorLayer *vl, const QObject *consumer );
+
+    //! Returns the number of observers registered for the commits of \a vl
+    int consumersCount( QgsVectorLayer *vl ) const;
+
+    //! Returns TRUE if an observer registered for the commits of \a vl needs the complete old features
+    bool requiresCompleteFeatures( QgsVectorLayer *vl ) const;
+
+    /**
+     * Returns the old version of the features changed or deleted in the edit buffer of \a vl, as
+     * read from the data provider with the provider fields. To be called while the layer emits
+     * QgsVectorLayer::beforeCommitChanges.
+     */
+    QgsFeatureMap snapshot( QgsVectorLayer *vl );
+
+    //! Returns the counters of the snapshots handed out since the creation or the last resetStatistics()
+    Statistics statistics() const { return mStatistics; }
+
+    //! Resets the counters of the snapshots handed out
+    void resetStatistics();
+
+  private slots:
+    //! Drops the snapshot of the previous commit of the sender layer
+    void releaseSnapshot();
+
+  private:
+    QgsFeatureMap readSnapshot( QgsVectorLayer *vl );
+
+    QHash<QString, QgsFeatureMap> mSnapshots;
+    QHash<QString, QHash<const QObject *, SnapshotContent>> mConsumers;
+    Statistics mStatistics;
+};
+
+#endif // COMMITSNAPSHOTSERVICE_H
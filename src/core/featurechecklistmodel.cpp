@@ -282,6 +282,7 @@ FeatureCheckListModel::FeatureCheckListModel( QObject *parent )
   connect( mSourceModel, &FeatureCheckListModelBase::attributeValueChanged, this, &FeatureCheckListModel::attributeValueChanged );
   connect( mSourceModel, &FeatureCheckListModelBase::attributeFieldChanged, this, &FeatureCheckListModel::attributeFieldChanged );
   connect( mSourceModel, &FeatureCheckListModelBase::allowMultiChanged, this, &FeatureCheckListModel::allowMultiChanged );
+  connect( mSourceModel, &FeatureCheckListModelBase::allowMultiChanged, this, &FeatureCheckListModel::updateSourcePageSize );
   connect( mSourceModel, &FeatureCheckListModelBase::listUpdated, this, &FeatureCheckListModel::listUpdated );
 
   setSourceModel( mSourceModel );
@@ -465,6 +466,7 @@ void FeatureCheckListModel::setSearchTerm( const QString &searchTerm )
   mSearchTerm = searchTerm;
   emit searchTermChanged();
 
+  updateSourcePageSize();
   invalidate();
   sort( 0 );
 }
@@ -484,9 +486,36 @@ void FeatureCheckListModel::setSortCheckedFirst( bool enabled )
   mSortCheckedFirst = enabled;
   emit sortCheckedFirstChanged();
 
+  updateSourcePageSize();
   sort( 0 );
 }
 
+int FeatureCheckListModel::pageSize() const
+{
+  return mPageSize;
+}
+
+void FeatureCheckListModel::setPageSize( int pageSize )
+{
+  pageSize = std::max( 0, pageSize );
+  if ( mPageSize == pageSize )
+  {
+    return;
+  }
+
+  mPageSize = pageSize;
+  emit pageSizeChanged();
+
+  updateSourcePageSize();
+}
+
+void FeatureCheckListModel::updateSourcePageSize()
+{
+  // searching and sorting only see the fetched rows, and the multiple values list is not a view fetching more rows
+  const bool suspendPaging = !mSearchTerm.isEmpty() || mSortCheckedFirst || mSourceModel->allowMulti();
+  mSourceModel->setPageSize( suspendPaging ? 0 : mPageSize );
+}
+
 bool FeatureCheckListModel::filterAcceptsRow( int sourceRow, const QModelIndex &sourceParent ) const
 {
   const QStringList searchFragments = mSearchTerm.trimmed().toLower().split( " ", Qt::SkipEmptyParts );
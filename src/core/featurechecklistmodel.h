@@ -155,6 +155,9 @@ class FeatureCheckListModel : public QSortFilterProxyModel
     //! The sorting method.
     Q_PROPERTY( bool sortCheckedFirst READ sortCheckedFirst WRITE setSortCheckedFirst NOTIFY sortCheckedFirstChanged )
 
+    //! The number of rows exposed at once, 0 exposes all rows at once (the default). Paging is suspended while searching, sorting checked items first or allowing multiple values.
+    Q_PROPERTY( int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged )
+
   public:
     explicit FeatureCheckListModel( QObject *parent = nullptr );
 
@@ -300,6 +303,17 @@ class FeatureCheckListModel : public QSortFilterProxyModel
      */
     void setSortCheckedFirst( bool enabled );
 
+    /**
+     * Returns the number of rows exposed at once, 0 if all rows are exposed at once.
+     */
+    int pageSize() const;
+
+    /**
+     * Sets the number of rows exposed at once, 0 to expose all rows at once.
+     * Paging is suspended while searching, sorting checked items first or allowing multiple values.
+     */
+    void setPageSize( int pageSize );
+
   protected:
     /**
      * Determines whether a row should be accepted based on the current filter settings.
@@ -347,6 +361,7 @@ class FeatureCheckListModel : public QSortFilterProxyModel
     // Proxy-specific signals
     void searchTermChanged();
     void sortCheckedFirstChanged();
+    void pageSizeChanged();
 
   private:
     /**
@@ -354,8 +369,12 @@ class FeatureCheckListModel : public QSortFilterProxyModel
      */
     double calcFuzzyScore( const QString &displayString, const QString &searchTerm ) const;
 
+    //! Pages the source model rows unless paging is suspended
+    void updateSourcePageSize();
+
     FeatureCheckListModelBase *mSourceModel = nullptr;
     QString mSearchTerm;
     bool mSortCheckedFirst;
+    int mPageSize = 0;
 };
 #endif // FEATURECHECKLISTMODEL_H
@@ -107,7 +107,18 @@ class FeatureExpressionValuesGatherer : public QThread
 
         const QString expressionValue = mDisplayExpression.evaluate( &mExpressionContext ).toString();
 
-        mEntries.append( Entry( attributes, expressionValue, feature ) );
+        if ( mKeepFeatures )
+        {
+          mEntries.append( Entry( attributes, expressionValue, feature ) );
+        }
+        else
+        {
+          Entry entry;
+          entry.identifierFields = attributes;
+          entry.featureId = feature.id();
+          entry.value = expressionValue;
+          mEntries.append( entry );
+        }
 
         QMutexLocker locker( &mCancelMutex );
         //cppcheck-suppress knownConditionTrueFalse
@@ -135,6 +146,16 @@ class FeatureExpressionValuesGatherer : public QThread
       return mEntries;
     }
 
+    /**
+     * Sets whether the gathered entries hold a copy of their feature, defaults to TRUE.
+     * When FALSE, only the feature ids are kept, which saves memory on large layers.
+     * \note must be called before the gatherer is started
+     */
+    void setKeepFeatures( bool keepFeatures )
+    {
+      mKeepFeatures = keepFeatures;
+    }
+
     QgsFeatureRequest request() const
     {
       return mRequest;
@@ -168,6 +189,7 @@ class FeatureExpressionValuesGatherer : public QThread
     mutable QMutex mCancelMutex;
     QStringList mIdentifierFields;
     QVariant mData;
+    bool mKeepFeatures = true;
 };
 
 #endif // FEATUREEXPRESSIONVALUESGATHERER_H
@@ -15,17 +15,33 @@
  *                                                                         *
  ***************************************************************************/
 
+#include "commitsnapshotservice.h"
 #include "featurehistory.h"
 #include "trackingmodel.h"
 
+#include <QDataStream>
 #include <qgsmessagelog.h>
 #include <qgsvectorlayer.h>
 #include <qgsvectorlayereditbuffer.h>
 #include <qgsvectorlayerutils.h>
 
-FeatureHistory::FeatureHistory( const QgsProject *project, TrackingModel *trackingModel )
+#include <algorithm>
+
+/**
+ * The changed attributes and geometry of an updated feature, as stored in a history step
+ */
+struct FeatureDiff
+{
+    QgsFeatureId fid = FID_NULL;
+    QMap<int, QVariant> attributes;
+    bool hasGeometryChanged = false;
+    QByteArray wkb;
+};
+
+FeatureHistory::FeatureHistory( const QgsProject *project, TrackingModel *trackingModel, CommitSnapshotService *snapshotService )
   : mProject( project )
   , mTrackingModel( trackingModel )
+  , mSnapshotService( snapshotService ? snapshotService : new CommitSnapshotService( this ) )
 {
   connect( mProject, &QgsProject::homePathChanged, this, &FeatureHistory::onHomePathChanged );
   connect( mProject, &QgsProject::layersAdded, this, &FeatureHistory::onLayersAdded );
@@ -70,6 +86,8 @@ void FeatureHistory::addLayerListeners()
     disconnect( vl, &QgsVectorLayer::committedFeaturesAdded, this, &FeatureHistory::onCommittedFeaturesAdded );
     disconnect( vl, &QgsVectorLayer::committedFeaturesRemoved, this, &FeatureHistory::onCommittedFeaturesRemoved );
 
+    mSnapshotService->watchLayer( vl, this );
+
     connect( vl, &QgsVectorLayer::beforeCommitChanges, this, &FeatureHistory::onBeforeCommitChanges );
     connect( vl, &QgsVectorLayer::afterCommitChanges, this, &FeatureHistory::onAfterCommitChanges );
     connect( vl, &QgsVectorLayer::committedFeaturesAdded, this, &FeatureHistory::onCommittedFeaturesAdded );
@@ -113,21 +131,18 @@ void FeatureHistory::onBeforeCommitChanges()
   for ( const QgsFeatureId fid : changedAttributesFids )
     changedFids.insert( fid );
 
-  // NOTE we read the features from the dataProvider directly as we want to access the old values.
-  // If we use the layer, we get the values from the edit buffer.
-  QgsFeatureIterator featuresIt = vl->dataProvider()->getFeatures( QgsFeatureRequest( changedFids ) );
-  QMap<QgsFeatureId, QgsFeature> modifiedFeatures;
-  QgsFeature f;
+  // NOTE the old features are read once from the data provider and shared with the other observers of the commit,
+  // the map is only copied when modified below
+  QMap<QgsFeatureId, QgsFeature> modifiedFeatures = mSnapshotService->snapshot( vl );
 
-  while ( featuresIt.nextFeature( f ) )
+  for ( const QgsFeatureId fid : deletedFids )
   {
-    if ( deletedFids.contains( f.id() ) )
+    if ( modifiedFeatures.contains( fid ) )
     {
       // Insure that join-provided fields are added to avoid error restoring deleted feature
       // on vector layers containing joins
-      QgsVectorLayerUtils::matchAttributesToFields( f, vl->fields() );
+      QgsVectorLayerUtils::matchAttributesToFields( modifiedFeatures[fid], vl->fields() );
     }
-    modifiedFeatures.insert( f.id(), f );
   }
 
   // The feature FIDs will not be valid, we'll nevertheless use a basic layer ID check
@@ -242,6 +257,7 @@ void FeatureHistory::onLayerInTrackingChanged( QgsVectorLayer *vl, bool isTracki
 {
   if ( isTracking )
   {
+    mSnapshotService->unwatchLayer( vl, this );
     disconnect( vl, &QgsVectorLayer::beforeCommitChanges, this, &FeatureHistory::onBeforeCommitChanges );
     disconnect( vl, &QgsVectorLayer::afterCommitChanges, this, &FeatureHistory::onAfterCommitChanges );
     disconnect( vl, &QgsVectorLayer::committedFeaturesAdded, this, &FeatureHistory::onCommittedFeaturesAdded );
@@ -249,6 +265,7 @@ void FeatureHistory::onLayerInTrackingChanged( QgsVectorLayer *vl, bool isTracki
   }
   else
   {
+    mSnapshotService->watchLayer( vl, this );
     connect( vl, &QgsVectorLayer::beforeCommitChanges, this, &FeatureHistory::onBeforeCommitChanges );
     connect( vl, &QgsVectorLayer::afterCommitChanges, this, &FeatureHistory::onAfterCommitChanges );
     connect( vl, &QgsVectorLayer::committedFeaturesAdded, this, &FeatureHistory::onCommittedFeaturesAdded );
@@ -259,10 +276,10 @@ void FeatureHistory::onLayerInTrackingChanged( QgsVectorLayer *vl, bool isTracki
 void FeatureHistory::onTimerTimeout()
 {
   mTimer.stop();
-  mUndoHistory.append( mTempHistoryStep );
+  clearSteps( mRedoHistory );
+  pushStep( mUndoHistory, mTempHistoryStep );
   mTempHistoryStep.clear();
   mTempModifiedFeatureIdsByLayerId.clear();
-  mRedoHistory.clear();
 
   emit isUndoAvailableChanged();
   emit isRedoAvailableChanged();
@@ -306,6 +323,394 @@ QMap<QString, FeatureHistory::FeatureModifications> FeatureHistory::reverseModif
 }
 
 
+FeatureHistory::HistoryStep FeatureHistory::encodeStep( const QMap<QString, FeatureModifications> &modificationsByLayerId ) const
+{
+  HistoryStep step;
+
+  QByteArray data;
+  QDataStream stream( &data, QIODevice::WriteOnly );
+  stream.setVersion( QDataStream::Qt_6_5 );
+  stream << static_cast<quint32>( modificationsByLayerId.size() );
+
+  for ( auto it = modificationsByLayerId.constBegin(); it != modificationsByLayerId.constEnd(); ++it )
+  {
+    const FeatureModifications &modifications = it.value();
+    stream << it.key();
+
+    // created features are read from the layer when applied, only their ids are needed
+    QList<QgsFeatureId> createdFids;
+    for ( const OldNewFeaturePair &pair : modifications.createdFeatures )
+    {
+      createdFids << pair.second.id();
+    }
+    stream << createdFids;
+
+    // deleted features are not in the layer anymore, they are stored entirely
+    stream << static_cast<quint32>( modifications.deletedFeatures.size() );
+    for ( const OldNewFeaturePair &pair : modifications.deletedFeatures )
+    {
+      stream << pair.first.id() << static_cast<const QVariantList &>( pair.first.attributes() ) << ( pair.first.hasGeometry() ? pair.first.geometry().asWkb() : QByteArray() );
+    }
+
+    // updated features are stored as the differences to the current feature in the layer
+    stream << static_cast<quint32>( modifications.updatedFeatures.size() );
+    for ( const OldNewFeaturePair &pair : modifications.updatedFeatures )
+    {
+      FeatureDiff diff;
+      diff.fid = pair.first.id();
+
+      const int attributeCount = std::min( pair.first.attributeCount(), pair.second.attributeCount() );
+      for ( int idx = 0; idx < attributeCount; idx++ )
+      {
+        if ( pair.first.attribute( idx ) != pair.second.attribute( idx ) )
+        {
+          diff.attributes.insert( idx, pair.first.attribute( idx ) );
+        }
+      }
+
+      diff.hasGeometryChanged = pair.first.hasGeometry() != pair.second.hasGeometry() || ( pair.first.hasGeometry() && !pair.first.geometry().equals( pair.second.geometry() ) );
+      stream << diff.fid << diff.attributes << diff.hasGeometryChanged;
+      if ( diff.hasGeometryChanged )
+      {
+        stream << ( pair.first.hasGeometry() ? pair.first.geometry().asWkb() : QByteArray() );
+      }
+    }
+
+    step.layerIds << it.key();
+    step.createdCount += modifications.createdFeatures.size();
+    step.updatedCount += modifications.updatedFeatures.size();
+    step.deletedCount += modifications.deletedFeatures.size();
+  }
+
+  step.data = qCompress( data );
+  return step;
+}
+
+
+QMap<QString, FeatureHistory::FeatureModifications> FeatureHistory::decodeStep( const QByteArray &data ) const
+{
+  QMap<QString, FeatureModifications> modificationsByLayerId;
+
+  QDataStream stream( qUncompress( data ) );
+  stream.setVersion( QDataStream::Qt_6_5 );
+
+  quint32 layersCount = 0;
+  stream >> layersCount;
+
+  for ( quint32 i = 0; i < layersCount && stream.status() == QDataStream::Ok; i++ )
+  {
+    QString layerId;
+    QList<QgsFeatureId> createdFids;
+    stream >> layerId >> createdFids;
+
+    QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( mProject->mapLayer( layerId ) );
+    FeatureModifications modifications;
+
+    quint32 deletedCount = 0;
+    stream >> deletedCount;
+    for ( quint32 j = 0; j < deletedCount && stream.status() == QDataStream::Ok; j++ )
+    {
+      QgsFeatureId fid = FID_NULL;
+      QVariantList attributes;
+      QByteArray wkb;
+      stream >> fid >> attributes >> wkb;
+
+      QgsFeature feature( vl ? vl->fields() : QgsFields(), fid );
+      feature.setAttributes( QgsAttributes( attributes ) );
+      if ( !wkb.isEmpty() )
+      {
+        QgsGeometry geometry;
+        geometry.fromWkb( wkb );
+        feature.setGeometry( geometry );
+      }
+
+      modifications.deletedFeatures.append( OldNewFeaturePair( feature, QgsFeature() ) );
+    }
+
+    quint32 updatedCount = 0;
+    stream >> updatedCount;
+    QList<FeatureDiff> diffs;
+    for ( quint32 j = 0; j < updatedCount && stream.status() == QDataStream::Ok; j++ )
+    {
+      FeatureDiff diff;
+      stream >> diff.fid >> diff.attributes >> diff.hasGeometryChanged;
+      if ( diff.hasGeometryChanged )
+      {
+        stream >> diff.wkb;
+      }
+      diffs << diff;
+    }
+
+    if ( !vl )
+    {
+      continue;
+    }
+
+    // the current features in the layer are the new state of the created and updated features
+    QgsFeatureIds fids( createdFids.constBegin(), createdFids.constEnd() );
+    for ( const FeatureDiff &diff : std::as_const( diffs ) )
+    {
+      fids << diff.fid;
+    }
+
+    QHash<QgsFeatureId, QgsFeature> currentFeatures;
+    if ( !fids.isEmpty() )
+    {
+      QgsFeatureIterator featuresIt = vl->getFeatures( QgsFeatureRequest( fids ) );
+      QgsFeature f;
+      while ( featuresIt.nextFeature( f ) )
+      {
+        currentFeatures.insert( f.id(), f );
+      }
+    }
+
+    for ( const QgsFeatureId fid : std::as_const( createdFids ) )
+    {
+      QgsFeature feature = currentFeatures.value( fid );
+      feature.setId( fid );
+      modifications.createdFeatures.append( OldNewFeaturePair( QgsFeature(), feature ) );
+    }
+
+    for ( const FeatureDiff &diff : std::as_const( diffs ) )
+    {
+      auto it = currentFeatures.constFind( diff.fid );
+      if ( it == currentFeatures.constEnd() )
+      {
+        QgsMessageLog::logMessage( tr( "Failed to find updated feature %1 in layer \"%2\"" ).arg( diff.fid ).arg( vl->name() ) );
+        continue;
+      }
+
+      QgsFeature oldFeature = it.value();
+      for ( auto attrIt = diff.attributes.constBegin(); attrIt != diff.attributes.constEnd(); ++attrIt )
+      {
+        if ( attrIt.key() < oldFeature.attributeCount() )
+        {
+          oldFeature.setAttribute( attrIt.key(), attrIt.value() );
+        }
+      }
+
+      if ( diff.hasGeometryChanged )
+      {
+        QgsGeometry geometry;
+        if ( !diff.wkb.isEmpty() )
+        {
+          geometry.fromWkb( diff.wkb );
+        }
+        oldFeature.setGeometry( geometry );
+      }
+
+      modifications.updatedFeatures.append( OldNewFeaturePair( oldFeature, it.value() ) );
+    }
+
+    modificationsByLayerId.insert( layerId, modifications );
+  }
+
+  return modificationsByLayerId;
+}
+
+
+void FeatureHistory::pushStep( QList<HistoryStep> &history, const QMap<QString, FeatureModifications> &modificationsByLayerId )
+{
+  history.append( encodeStep( modificationsByLayerId ) );
+  mMemoryUsage += history.last().data.size();
+
+  enforceMemoryBudget();
+
+  emit memoryUsageChanged();
+}
+
+
+bool FeatureHistory::takeStep( QList<HistoryStep> &history, QMap<QString, FeatureModifications> &modifications )
+{
+  const HistoryStep &step = history.last();
+  QByteArray data = step.data;
+
+  if ( step.fileOffset >= 0 )
+  {
+    if ( mHistoryFile.seek( step.fileOffset ) )
+    {
+      data = mHistoryFile.read( step.fileSize );
+    }
+
+    if ( data.size() != step.fileSize )
+    {
+      QgsMessageLog::logMessage( tr( "Failed to read the feature history file: %1" ).arg( mHistoryFile.errorString() ) );
+      return false;
+    }
+
+    // the most recent steps are spilled last, the file shrinks as they are taken back
+    if ( step.fileOffset + step.fileSize == mHistoryFile.size() )
+    {
+      mHistoryFile.resize( step.fileOffset );
+    }
+
+    mHistoryFileUsage -= step.fileSize;
+    history.removeLast();
+
+    compactHistoryFile();
+  }
+  else
+  {
+    mMemoryUsage -= data.size();
+    history.removeLast();
+
+    emit memoryUsageChanged();
+  }
+
+  modifications = decodeStep( data );
+  return true;
+}
+
+
+void FeatureHistory::clearSteps( QList<HistoryStep> &history )
+{
+  if ( history.isEmpty() )
+  {
+    return;
+  }
+
+  for ( const HistoryStep &step : std::as_const( history ) )
+  {
+    if ( step.fileOffset >= 0 )
+    {
+      mHistoryFileUsage -= step.fileSize;
+    }
+    else
+    {
+      mMemoryUsage -= step.data.size();
+    }
+  }
+  history.clear();
+
+  compactHistoryFile();
+
+  emit memoryUsageChanged();
+}
+
+
+void FeatureHistory::setMemoryBudget( qint64 memoryBudget )
+{
+  if ( mMemoryBudget == memoryBudget )
+  {
+    return;
+  }
+
+  mMemoryBudget = memoryBudget;
+  emit memoryBudgetChanged();
+
+  enforceMemoryBudget();
+  emit memoryUsageChanged();
+}
+
+
+void FeatureHistory::enforceMemoryBudget()
+{
+  // the oldest undo steps are the least likely to be applied, followed by the redo steps furthest from the current state
+  for ( QList<HistoryStep> *history : { &mUndoHistory, &mRedoHistory } )
+  {
+    for ( HistoryStep &step : *history )
+    {
+      if ( mMemoryUsage <= mMemoryBudget )
+      {
+        return;
+      }
+
+      if ( step.fileOffset < 0 && !spillStep( step ) )
+      {
+        return;
+      }
+    }
+  }
+}
+
+
+bool FeatureHistory::spillStep( HistoryStep &step )
+{
+  if ( !mHistoryFile.isOpen() && !mHistoryFile.open() )
+  {
+    QgsMessageLog::logMessage( tr( "Failed to open the feature history file: %1" ).arg( mHistoryFile.errorString() ) );
+    return false;
+  }
+
+  const qint64 offset = mHistoryFile.size();
+  if ( !mHistoryFile.seek( offset ) || mHistoryFile.write( step.data ) != step.data.size() )
+  {
+    QgsMessageLog::logMessage( tr( "Failed to write the feature history file: %1" ).arg( mHistoryFile.errorString() ) );
+    mHistoryFile.resize( offset );
+    return false;
+  }
+
+  step.fileOffset = offset;
+  step.fileSize = step.data.size();
+  mHistoryFileUsage += step.fileSize;
+  mMemoryUsage -= step.data.size();
+  step.data = QByteArray();
+
+  return true;
+}
+
+
+void FeatureHistory::compactHistoryFile()
+{
+  if ( !mHistoryFile.isOpen() || mHistoryFile.size() - mHistoryFileUsage <= mHistoryFileUsage )
+  {
+    return;
+  }
+
+  QList<HistoryStep *> spilledSteps;
+  for ( QList<HistoryStep> *history : { &mUndoHistory, &mRedoHistory } )
+  {
+    for ( HistoryStep &step : *history )
+    {
+      if ( step.fileOffset >= 0 )
+      {
+        spilledSteps << &step;
+      }
+    }
+  }
+  std::sort( spilledSteps.begin(), spilledSteps.end(), []( const HistoryStep *a, const HistoryStep *b ) { return a->fileOffset < b->fileOffset; } );
+
+  // the steps only move towards the start of the file, over the space of the steps taken back or cleared
+  qint64 offset = 0;
+  for ( HistoryStep *step : std::as_const( spilledSteps ) )
+  {
+    if ( step->fileOffset != offset )
+    {
+      if ( !mHistoryFile.seek( step->fileOffset ) )
+      {
+        QgsMessageLog::logMessage( tr( "Failed to read the feature history file: %1" ).arg( mHistoryFile.errorString() ) );
+        return;
+      }
+
+      const QByteArray data = mHistoryFile.read( step->fileSize );
+      if ( data.size() != step->fileSize )
+      {
+        QgsMessageLog::logMessage( tr( "Failed to read the feature history file: %1" ).arg( mHistoryFile.errorString() ) );
+        return;
+      }
+
+      if ( !mHistoryFile.seek( offset ) || mHistoryFile.write( data ) != data.size() )
+      {
+        // the step may have been partially overwritten, keep it in memory
+        QgsMessageLog::logMessage( tr( "Failed to write the feature history file: %1" ).arg( mHistoryFile.errorString() ) );
+        step->data = data;
+        step->fileOffset = -1;
+        mHistoryFileUsage -= step->fileSize;
+        mMemoryUsage += data.size();
+        emit memoryUsageChanged();
+        continue;
+      }
+
+      step->fileOffset = offset;
+    }
+
+    offset += step->fileSize;
+  }
+
+  mHistoryFile.resize( offset );
+}
+
+
 bool FeatureHistory::applyModifications( QMap<QString, FeatureModifications> &modificationsByLayerId )
 {
   mIsApplyingModifications = true;
@@ -394,7 +799,12 @@ bool FeatureHistory::undo()
     return false;
   }
 
-  QMap<QString, FeatureModifications> modifications = mUndoHistory.takeLast();
+  QMap<QString, FeatureModifications> modifications;
+  if ( !takeStep( mUndoHistory, modifications ) )
+  {
+    return false;
+  }
+
   QMap<QString, FeatureModifications> reversedModifications = reverseModifications( modifications );
 
   if ( !applyModifications( modifications ) )
@@ -402,7 +812,7 @@ bool FeatureHistory::undo()
     return false;
   }
 
-  mRedoHistory.append( reversedModifications );
+  pushStep( mRedoHistory, reversedModifications );
 
   emit isUndoAvailableChanged();
   emit isRedoAvailableChanged();
@@ -418,7 +828,12 @@ bool FeatureHistory::redo()
     return false;
   }
 
-  QMap<QString, FeatureModifications> modifications = mRedoHistory.takeLast();
+  QMap<QString, FeatureModifications> modifications;
+  if ( !takeStep( mRedoHistory, modifications ) )
+  {
+    return false;
+  }
+
   QMap<QString, FeatureModifications> reversedModifications = reverseModifications( modifications );
 
   if ( !applyModifications( modifications ) )
@@ -426,7 +841,7 @@ bool FeatureHistory::redo()
     return false;
   }
 
-  mUndoHistory.append( reversedModifications );
+  pushStep( mUndoHistory, reversedModifications );
 
   emit isUndoAvailableChanged();
   emit isRedoAvailableChanged();
@@ -453,27 +868,12 @@ const QString FeatureHistory::undoMessage()
     return QString();
   }
 
-  int totalChanges = 0;
-  QMap<QString, FeatureModifications> modifiedFeaturesByLayerId = mUndoHistory.last();
-  QStringList layerIds;
-  bool hasCreatedFeatures = false;
-  bool hasUpdatedFeatures = false;
-  bool hasDeletedFeatures = false;
-  for ( const QString &layerId : modifiedFeaturesByLayerId.keys() )
-  {
-    if ( !layerIds.contains( layerId ) )
-    {
-      layerIds << layerId;
-    }
-
-    hasCreatedFeatures |= modifiedFeaturesByLayerId[layerId].createdFeatures.count() > 0;
-    hasUpdatedFeatures |= modifiedFeaturesByLayerId[layerId].updatedFeatures.count() > 0;
-    hasDeletedFeatures |= modifiedFeaturesByLayerId[layerId].deletedFeatures.count() > 0;
-    // cppcheck-suppress useStlAlgorithm
-    totalChanges += modifiedFeaturesByLayerId[layerId].createdFeatures.count()
-                    + modifiedFeaturesByLayerId[layerId].updatedFeatures.count()
-                    + modifiedFeaturesByLayerId[layerId].deletedFeatures.count();
-  }
+  const HistoryStep &step = mUndoHistory.last();
+  const QStringList &layerIds = step.layerIds;
+  const bool hasCreatedFeatures = step.createdCount > 0;
+  const bool hasUpdatedFeatures = step.updatedCount > 0;
+  const bool hasDeletedFeatures = step.deletedCount > 0;
+  const int totalChanges = step.createdCount + step.updatedCount + step.deletedCount;
 
   if ( totalChanges > 0 )
   {
@@ -503,27 +903,13 @@ const QString FeatureHistory::redoMessage()
     return QString();
   }
 
-  int totalChanges = 0;
-  QMap<QString, FeatureModifications> modifiedFeaturesByLayerId = mRedoHistory.last();
-  QStringList layerIds;
-  bool hasCreatedFeatures = false;
-  bool hasUpdatedFeatures = false;
-  bool hasDeletedFeatures = false;
-  for ( const QString &layerId : modifiedFeaturesByLayerId.keys() )
-  {
-    if ( !layerIds.contains( layerId ) )
-    {
-      layerIds << layerId;
-    }
-
-    hasCreatedFeatures |= modifiedFeaturesByLayerId[layerId].deletedFeatures.count() > 0;
-    hasUpdatedFeatures |= modifiedFeaturesByLayerId[layerId].updatedFeatures.count() > 0;
-    hasDeletedFeatures |= modifiedFeaturesByLayerId[layerId].createdFeatures.count() > 0;
-    // cppcheck-suppress useStlAlgorithm
-    totalChanges += modifiedFeaturesByLayerId[layerId].deletedFeatures.count()
-                    + modifiedFeaturesByLayerId[layerId].updatedFeatures.count()
-                    + modifiedFeaturesByLayerId[layerId].createdFeatures.count();
-  }
+  // the redo steps hold the reversed modifications
+  const HistoryStep &step = mRedoHistory.last();
+  const QStringList &layerIds = step.layerIds;
+  const bool hasCreatedFeatures = step.deletedCount > 0;
+  const bool hasUpdatedFeatures = step.updatedCount > 0;
+  const bool hasDeletedFeatures = step.createdCount > 0;
+  const int totalChanges = step.createdCount + step.updatedCount + step.deletedCount;
 
   if ( totalChanges > 0 )
   {
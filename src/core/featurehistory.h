@@ -19,9 +19,11 @@
 #define FEATUREHISTORY_H
 
 #include <QObject>
+#include <QTemporaryFile>
 #include <QTimer>
 #include <qgsproject.h>
 
+class CommitSnapshotService;
 class TrackingModel;
 
 typedef QPair<QgsFeature, QgsFeature> OldNewFeaturePair;
@@ -35,6 +37,8 @@ class FeatureHistory : public QObject
 
     Q_PROPERTY( bool isUndoAvailable READ isUndoAvailable NOTIFY isUndoAvailableChanged )
     Q_PROPERTY( bool isRedoAvailable READ isRedoAvailable NOTIFY isRedoAvailableChanged )
+    Q_PROPERTY( qint64 memoryUsage READ memoryUsage NOTIFY memoryUsageChanged )
+    Q_PROPERTY( qint64 memoryBudget READ memoryBudget WRITE setMemoryBudget NOTIFY memoryBudgetChanged )
 
   public:
     /**
@@ -50,13 +54,38 @@ class FeatureHistory : public QObject
         QList<OldNewFeaturePair> deletedFeatures;
     };
 
+    /**
+     * A compactly encoded undo or redo step, kept in memory or spilled to the temporary history file.
+     * Only the values which cannot be read from the layers when the step is applied are stored, i.e. the
+     * ids of the created features, the deleted features and the changed attributes and geometries of the
+     * updated features.
+     */
+    struct HistoryStep
+    {
+        //! The compressed encoded modifications, empty when spilled to the history file
+        QByteArray data;
+        //! The offset of the encoded modifications in the history file, -1 when kept in memory
+        qint64 fileOffset = -1;
+        //! The size of the encoded modifications in the history file
+        qint64 fileSize = 0;
+        //! The ids of the modified layers
+        QStringList layerIds;
+        //! The number of created features
+        int createdCount = 0;
+        //! The number of updated features
+        int updatedCount = 0;
+        //! The number of deleted features
+        int deletedCount = 0;
+    };
+
     /**
      * Construct a new Feature history object
      *
      * @param project the current project instance
      * @param trackingModel the tracking model
+     * @param snapshotService the service sharing the pre-commit feature snapshots with other observers, an own service is used if not given
      */
-    explicit FeatureHistory( const QgsProject *project, TrackingModel *trackingModel = nullptr );
+    explicit FeatureHistory( const QgsProject *project, TrackingModel *trackingModel = nullptr, CommitSnapshotService *snapshotService = nullptr );
 
     //! Perform undo of the most recent modification step
     Q_INVOKABLE bool undo();
@@ -73,9 +102,23 @@ class FeatureHistory : public QObject
     bool isUndoAvailable();
     bool isRedoAvailable();
 
+    //! Returns the memory used by the undo and redo history steps, in bytes
+    qint64 memoryUsage() const { return mMemoryUsage; }
+
+    //! Returns the memory budget of the undo and redo history steps, in bytes. The oldest steps exceeding it are spilled to a temporary file.
+    qint64 memoryBudget() const { return mMemoryBudget; }
+
+    //! Sets the memory budget of the undo and redo history steps, in bytes
+    void setMemoryBudget( qint64 memoryBudget );
+
+    //! Returns the size of the temporary file holding the spilled history steps, in bytes
+    qint64 historyFileSize() const { return mHistoryFile.size(); }
+
   signals:
     void isUndoAvailableChanged();
     void isRedoAvailableChanged();
+    void memoryUsageChanged();
+    void memoryBudgetChanged();
 
   private slots:
     /**
@@ -108,6 +151,7 @@ class FeatureHistory : public QObject
 
   private:
     static const int sTimeoutMs = 50;
+    static const qint64 sDefaultMemoryBudget = 8 * 1024 * 1024;
 
     //! Add the needed event listeners to monitor for changes.
     void addLayerListeners();
@@ -118,12 +162,45 @@ class FeatureHistory : public QObject
     //! Reverse the modification. Used to make undo modifications into redo modifications.
     QMap<QString, FeatureModifications> reverseModifications( QMap<QString, FeatureModifications> &modificationsByLayerId );
 
+    //! Encodes the modifications into a history step.
+    HistoryStep encodeStep( const QMap<QString, FeatureModifications> &modificationsByLayerId ) const;
+
+    //! Decodes the modifications of a history step, completing them with the current features of the layers.
+    QMap<QString, FeatureModifications> decodeStep( const QByteArray &data ) const;
+
+    //! Encodes the modifications and appends them to the \a history, spilling the oldest steps if the memory budget is exceeded.
+    void pushStep( QList<HistoryStep> &history, const QMap<QString, FeatureModifications> &modificationsByLayerId );
+
+    /**
+     * Takes the most recent step of the \a history and decodes its \a modifications.
+     * Returns FALSE and keeps the step in the \a history if it cannot be read from the history file.
+     */
+    bool takeStep( QList<HistoryStep> &history, QMap<QString, FeatureModifications> &modifications );
+
+    //! Removes all the steps of the \a history.
+    void clearSteps( QList<HistoryStep> &history );
+
+    //! Spills the oldest steps kept in memory to the history file until the memory budget is met.
+    void enforceMemoryBudget();
+
+    //! Writes the data of \a step to the history file.
+    bool spillStep( HistoryStep &step );
+
+    /**
+     * Moves the spilled steps to the start of the history file and truncates it, once the space of the
+     * steps taken back or cleared exceeds the space of the spilled steps left.
+     */
+    void compactHistoryFile();
+
     //! The current project instance.
     const QgsProject *mProject = nullptr;
 
     //! Tracking model. Used to check if the currently modified layer is in tracking, so all changes should be ignored to prevent cluttering the undo history.
     TrackingModel *mTrackingModel = nullptr;
 
+    //! The service providing the old state of the features before commit.
+    CommitSnapshotService *mSnapshotService = nullptr;
+
     //! If currently applying undo or redo feature modifications.
     bool mIsApplyingModifications = false;
 
@@ -143,10 +220,22 @@ class FeatureHistory : public QObject
     QMap<QString, QgsFeatureIds> mTempDeletedFeatureIdsByLayerId;
 
     //! Undo history records
-    QList<QMap<QString, FeatureModifications>> mUndoHistory;
+    QList<HistoryStep> mUndoHistory;
 
     //! Redo history records
-    QList<QMap<QString, FeatureModifications>> mRedoHistory;
+    QList<HistoryStep> mRedoHistory;
+
+    //! Temporary file holding the spilled history steps
+    QTemporaryFile mHistoryFile;
+
+    //! Size of the steps spilled to the history file, in bytes
+    qint64 mHistoryFileUsage = 0;
+
+    //! Memory used by the history steps kept in memory, in bytes
+    qint64 mMemoryUsage = 0;
+
+    //! Memory budget of the history steps, in bytes
+    qint64 mMemoryBudget = sDefaultMemoryBudget;
 
     //! Layer ids being observed for changes. Should reset when the project is changed. Used to prevent double event listeners.
     QSet<QString> mObservedLayerIds;
@@ -19,11 +19,62 @@
 #include "qgsvectorlayer.h"
 #include "stringutils.h"
 
+#include <QCollator>
 #include <QRegularExpression>
 #include <qgsexpressioncontextutils.h>
 #include <qgsproject.h>
 #include <qgsvaluerelationfieldformatter.h>
 
+#include <numeric>
+
+
+void FeatureListModelGatherer::run()
+{
+  FeatureExpressionValuesGatherer::run();
+
+  if ( !mSort || wasCanceled() )
+    return;
+
+  // collation keys are computed once per entry instead of lowering both strings on each comparison
+  QCollator collator;
+  collator.setCaseSensitivity( Qt::CaseInsensitive );
+
+  std::vector<QCollatorSortKey> sortKeys;
+  sortKeys.reserve( mEntries.size() );
+  for ( const Entry &entry : std::as_const( mEntries ) )
+    sortKeys.push_back( collator.sortKey( entry.value ) );
+
+  std::vector<qsizetype> order( mEntries.size() );
+  std::iota( order.begin(), order.end(), 0 );
+
+  std::sort( order.begin(), order.end(), [this, &sortKeys]( qsizetype index1, qsizetype index2 ) {
+    const Entry &entry1 = mEntries.at( index1 );
+    const Entry &entry2 = mEntries.at( index2 );
+
+    const bool key1IsNull = entry1.identifierFields.value( 0 ).isNull();
+    const bool key2IsNull = entry2.identifierFields.value( 0 ).isNull();
+    if ( key1IsNull != key2IsNull )
+      return key1IsNull;
+
+    if ( mSortByGroup )
+    {
+      const QVariant group1 = entry1.identifierFields.value( 1 );
+      const QVariant group2 = entry2.identifierFields.value( 1 );
+      if ( group1 != group2 )
+        return group1 < group2;
+    }
+
+    return sortKeys[index1].compare( sortKeys[index2] ) < 0;
+  } );
+
+  QVector<Entry> sortedEntries;
+  sortedEntries.reserve( mEntries.size() );
+  for ( const qsizetype index : order )
+    sortedEntries << mEntries.at( index );
+
+  mEntries = sortedEntries;
+}
+
 
 FeatureListModel::FeatureListModel( QObject *parent )
   : QAbstractItemModel( parent )
@@ -69,7 +120,7 @@ QModelIndex FeatureListModel::parent( const QModelIndex &child ) const
 int FeatureListModel::rowCount( const QModelIndex &parent ) const
 {
   Q_UNUSED( parent )
-  return static_cast<int>( mEntries.size() );
+  return static_cast<int>( mPageSize > 0 ? std::min( mFetchedCount, mEntries.size() ) : mEntries.size() );
 }
 
 int FeatureListModel::columnCount( const QModelIndex &parent ) const
@@ -80,7 +131,7 @@ int FeatureListModel::columnCount( const QModelIndex &parent ) const
 
 QVariant FeatureListModel::data( const QModelIndex &index, int role ) const
 {
-  if ( index.row() < 0 || index.row() >= mEntries.size() )
+  if ( index.row() < 0 || index.row() >= rowCount() )
     return QVariant();
 
   switch ( role )
@@ -102,6 +153,34 @@ QVariant FeatureListModel::data( const QModelIndex &index, int role ) const
   return QVariant();
 }
 
+bool FeatureListModel::canFetchMore( const QModelIndex &parent ) const
+{
+  if ( parent.isValid() )
+    return false;
+
+  return rowCount() < mEntries.size();
+}
+
+void FeatureListModel::fetchMore( const QModelIndex &parent )
+{
+  if ( parent.isValid() || mPageSize <= 0 )
+    return;
+
+  fetchUpTo( rowCount() + mPageSize - 1 );
+}
+
+void FeatureListModel::fetchUpTo( int row )
+{
+  const int currentCount = rowCount();
+  const int count = static_cast<int>( std::min( static_cast<qsizetype>( row ) + 1, mEntries.size() ) );
+  if ( mPageSize <= 0 || count <= currentCount )
+    return;
+
+  beginInsertRows( QModelIndex(), currentCount, count - 1 );
+  mFetchedCount = count;
+  endInsertRows();
+}
+
 QHash<int, QByteArray> FeatureListModel::roleNames() const
 {
   QHash<int, QByteArray> roles = QAbstractItemModel::roleNames();
@@ -211,13 +290,16 @@ void FeatureListModel::setDisplayGroupName( bool displayGroupName )
   emit displayGroupNameChanged();
 }
 
-int FeatureListModel::findKey( const QVariant &key ) const
+int FeatureListModel::findKey( const QVariant &key )
 {
   int idx = 0;
-  for ( const Entry &entry : mEntries )
+  for ( const Entry &entry : std::as_const( mEntries ) )
   {
     if ( entry.key == key )
+    {
+      fetchUpTo( idx );
       return idx;
+    }
 
     ++idx;
   }
@@ -228,20 +310,27 @@ int FeatureListModel::findKey( const QVariant &key ) const
   return -1;
 }
 
-QList<int> FeatureListModel::findDisplayValueMatches( const QString &filter ) const
+QList<int> FeatureListModel::findDisplayValueMatches( const QString &filter )
 {
   QMap<QString, int> matches;
   const QString preparedFilter = filter.trimmed().toLower();
+  int lastMatch = -1;
   if ( !filter.trimmed().isEmpty() )
   {
     int idx = 0;
-    for ( const Entry &entry : mEntries )
+    for ( const Entry &entry : std::as_const( mEntries ) )
     {
       if ( entry.displayString.trimmed().toLower().startsWith( preparedFilter ) )
+      {
         matches.insert( entry.displayString.trimmed().toLower(), idx );
+        lastMatch = idx;
+      }
       ++idx;
     }
   }
+
+  fetchUpTo( lastMatch );
+
   return matches.values();
 }
 
@@ -321,6 +410,16 @@ void FeatureListModel::gatherFeatureList()
                                  ? QgsExpression::quotedColumnRef( mDisplayValueField )
                                  : QStringLiteral( " ( %1 ) " ).arg( mCurrentLayer->displayExpression() );
 
+  // the list only needs the geometries to evaluate the display value or the filter
+  if ( !QgsExpression( fieldDisplayString ).needsGeometry() && ( mFilterExpression.isEmpty() || !QgsExpression( mFilterExpression ).needsGeometry() ) )
+  {
+#if _QGIS_VERSION_INT >= 33500
+    request.setFlags( Qgis::FeatureRequestFlag::NoGeometry );
+#else
+    request.setFlags( QgsFeatureRequest::NoGeometry );
+#endif
+  }
+
   if ( !mFilterExpression.isEmpty() )
   {
     QgsExpressionContext filterContext = QgsExpressionContext( QgsExpressionContextUtils::globalProjectLayerScopes( mCurrentLayer ) );
@@ -343,7 +442,7 @@ void FeatureListModel::gatherFeatureList()
 
   cleanupGatherer();
 
-  mGatherer = new FeatureExpressionValuesGatherer( mCurrentLayer, fieldDisplayString, request, QStringList() << keyField() << groupField() );
+  mGatherer = new FeatureListModelGatherer( mCurrentLayer, fieldDisplayString, request, QStringList() << keyField() << groupField(), mOrderByValue || !mGroupField.isEmpty(), !mGroupField.isEmpty() );
   connect( mGatherer, &QThread::finished, this, &FeatureListModel::processFeatureList );
   mGatherer->start();
 }
@@ -364,27 +463,19 @@ void FeatureListModel::processFeatureList()
   mGatherer->deleteLater();
   mGatherer = nullptr;
 
+  // the gatherer already sorted the entries
+  entries.reserve( entries.size() + gatheredEntries.size() );
   for ( const FeatureExpressionValuesGatherer::Entry &gatheredEntry : gatheredEntries )
   {
     entries.append( Entry( gatheredEntry.value, gatheredEntry.identifierFields.at( 0 ), gatheredEntry.identifierFields.at( 1 ), gatheredEntry.featureId ) );
   }
-  if ( mOrderByValue || !mGroupField.isEmpty() )
-  {
-    std::sort( entries.begin(), entries.end(), [this]( const Entry &entry1, const Entry &entry2 ) {
-      if ( entry1.key.isNull() && !entry2.key.isNull() )
-        return true;
 
-      if ( !entry1.key.isNull() && entry2.key.isNull() )
-        return false;
-
-      if ( !mGroupField.isEmpty() && entry1.group != entry2.group )
-        return entry1.group < entry2.group;
-      return entry1.displayString.toLower() < entry2.displayString.toLower();
-    } );
-  }
   beginResetModel();
   mEntries = entries;
+  mFetchedCount = std::min( static_cast<qsizetype>( mPageSize ), mEntries.size() );
   endResetModel();
+
+  emit entriesCountChanged();
 }
 
 void FeatureListModel::reloadLayer()
@@ -414,6 +505,20 @@ bool FeatureListModel::orderByValue() const
   return mOrderByValue;
 }
 
+void FeatureListModel::setPageSize( int pageSize )
+{
+  pageSize = std::max( 0, pageSize );
+  if ( mPageSize == pageSize )
+    return;
+
+  beginResetModel();
+  mPageSize = pageSize;
+  mFetchedCount = std::min( static_cast<qsizetype>( mPageSize ), mEntries.size() );
+  endResetModel();
+
+  emit pageSizeChanged();
+}
+
 void FeatureListModel::setOrderByValue( bool orderByValue )
 {
   if ( mOrderByValue == orderByValue )
@@ -29,11 +29,47 @@
 
 class QgsVectorLayer;
 
+/**
+ * Gathers the entries of a FeatureListModel and sorts them off the main thread.
+ *
+ * The identifier fields are expected to be the key field followed by the group field.
+ * Entries are sorted with entries without key first, then by group if \a sortByGroup
+ * is TRUE, then by display value using precomputed case-insensitive collation keys.
+ * \ingroup core
+ */
+class FeatureListModelGatherer : public FeatureExpressionValuesGatherer
+{
+    Q_OBJECT
+
+  public:
+    explicit FeatureListModelGatherer( QgsVectorLayer *layer,
+                                       const QString &displayExpression,
+                                       const QgsFeatureRequest &request,
+                                       const QStringList &identifierFields,
+                                       bool sort,
+                                       bool sortByGroup )
+      : FeatureExpressionValuesGatherer( layer, displayExpression, request, identifierFields )
+      , mSort( sort )
+      , mSortByGroup( sortByGroup )
+    {
+      setKeepFeatures( false );
+    }
+
+    void run() override;
+
+  private:
+    bool mSort = false;
+    bool mSortByGroup = false;
+};
+
 /**
  * Provides access to a list of features from a layer.
  * For each feature, the display expression is exposed as DisplayRole
  * and a keyField as KeyFieldRole for a unique identifier.
  * If a displayValueField is set it replaces the display expression of the layer.
+ *
+ * Features are gathered and sorted on a worker thread. If pageSize is set, the
+ * rows are exposed page by page through fetchMore() as views scroll down.
  * \ingroup core
  */
 class FeatureListModel : public QAbstractItemModel
@@ -90,6 +126,16 @@ class FeatureListModel : public QAbstractItemModel
      */
     Q_PROPERTY( AppExpressionContextScopesGenerator *appExpressionContextScopesGenerator READ appExpressionContextScopesGenerator WRITE setAppExpressionContextScopesGenerator NOTIFY appExpressionContextScopesGeneratorChanged )
 
+    /**
+     * The number of rows exposed at once and added on each fetchMore(), 0 exposes all rows at once (the default).
+     */
+    Q_PROPERTY( int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged )
+
+    /**
+     * The total number of gathered entries, including the ones not fetched yet when paging
+     */
+    Q_PROPERTY( int entriesCount READ entriesCount NOTIFY entriesCountChanged )
+
   public:
     enum FeatureListRoles
     {
@@ -109,6 +155,8 @@ class FeatureListModel : public QAbstractItemModel
     virtual int rowCount( const QModelIndex &parent = QModelIndex() ) const override;
     virtual int columnCount( const QModelIndex &parent ) const override;
     virtual QVariant data( const QModelIndex &index, int role ) const override;
+    virtual bool canFetchMore( const QModelIndex &parent ) const override;
+    virtual void fetchMore( const QModelIndex &parent ) override;
 
     Q_INVOKABLE QVariant dataFromRowIndex( int row, int role ) { return data( index( row, 0, QModelIndex() ), role ); }
 
@@ -141,13 +189,15 @@ class FeatureListModel : public QAbstractItemModel
 
     /**
      * Get the row for a given key value.
+     * When paging, the rows up to the matching one are fetched.
      */
-    Q_INVOKABLE int findKey( const QVariant &key ) const;
+    Q_INVOKABLE int findKey( const QVariant &key );
 
     /**
      * Get rows for a given filter string used to match display values.
+     * When paging, the rows up to the last matching one are fetched.
      */
-    Q_INVOKABLE QList<int> findDisplayValueMatches( const QString &filter ) const;
+    Q_INVOKABLE QList<int> findDisplayValueMatches( const QString &filter );
 
     /**
      * Orders all the values alphabethically by their displayString.
@@ -199,6 +249,21 @@ class FeatureListModel : public QAbstractItemModel
      */
     void setAppExpressionContextScopesGenerator( AppExpressionContextScopesGenerator *generator );
 
+    /**
+     * Returns the number of rows exposed at once and added on each fetchMore(), 0 if all rows are exposed at once.
+     */
+    int pageSize() const { return mPageSize; }
+
+    /**
+     * Sets the number of rows exposed at once and added on each fetchMore(), 0 to expose all rows at once.
+     */
+    void setPageSize( int pageSize );
+
+    /**
+     * Returns the total number of gathered entries, including the ones not fetched yet when paging.
+     */
+    int entriesCount() const { return static_cast<int>( mEntries.size() ); }
+
   signals:
     void currentLayerChanged();
     void keyFieldChanged();
@@ -210,6 +275,8 @@ class FeatureListModel : public QAbstractItemModel
     void filterExpressionChanged();
     void currentFormFeatureChanged();
     void appExpressionContextScopesGeneratorChanged();
+    void pageSizeChanged();
+    void entriesCountChanged();
 
   private slots:
     void onFeatureAdded();
@@ -255,9 +322,12 @@ class FeatureListModel : public QAbstractItemModel
 
     void cleanupGatherer();
 
+    //! Makes sure the rows up to \a row are fetched when paging
+    void fetchUpTo( int row );
+
     QPointer<QgsVectorLayer> mCurrentLayer;
 
-    FeatureExpressionValuesGatherer *mGatherer = nullptr;
+    FeatureListModelGatherer *mGatherer = nullptr;
 
     QList<Entry> mEntries;
     QString mKeyField;
@@ -270,6 +340,9 @@ class FeatureListModel : public QAbstractItemModel
     QgsFeature mCurrentFormFeature;
     QPointer<AppExpressionContextScopesGenerator> mAppExpressionContextScopesGenerator;
 
+    int mPageSize = 0;
+    qsizetype mFetchedCount = 0;
+
     QTimer mReloadTimer;
 };
 
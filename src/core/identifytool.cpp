@@ -17,24 +17,63 @@
 #include "multifeaturelistmodel.h"
 #include "qgsquickmapsettings.h"
 
+#include <QThread>
+#include <QtConcurrentRun>
 #include <qgsexpressioncontextutils.h>
 #include <qgsfeaturestore.h>
+#include <qgsfeedback.h>
 #include <qgsproject.h>
 #include <qgsrasteridentifyresult.h>
 #include <qgsrasterlayer.h>
 #include <qgsrenderer.h>
 #include <qgsvectorlayer.h>
+#include <qgsvectorlayerfeatureiterator.h>
 #include <qgsvectorlayertemporalproperties.h>
+#include <qgsvectortiledataprovider.h>
 #include <qgsvectortilelayer.h>
 #include <qgsvectortileloader.h>
 #include <qgsvectortilemvtdecoder.h>
 #include <qgsvectortileutils.h>
 
+/**
+ * Returns a shared pointer to the data provider \a clone, deleted on the thread it was created on
+ * whichever worker thread drops the last reference.
+ */
+template<class T>
+static std::shared_ptr<T> sharedDataProvider( T *clone )
+{
+  return std::shared_ptr<T>( clone, []( T *provider ) {
+    if ( !provider )
+      return;
+
+    if ( provider->thread() == QThread::currentThread() )
+      delete provider;
+    else
+      provider->deleteLater();
+  } );
+}
+
+//! Attaches the identified \a layer to the \a results, the jobs never hold a pointer to the layer itself
+static QList<IdentifyTool::IdentifyResult> resultsForLayer( QList<IdentifyTool::IdentifyResult> results, QgsMapLayer *layer )
+{
+  for ( IdentifyTool::IdentifyResult &result : results )
+    result.layer = layer;
+
+  return results;
+}
+
 IdentifyTool::IdentifyTool( QObject *parent )
   : QObject( parent )
   , mMapSettings( nullptr )
   , mSearchRadiusMm( 5 )
 {
+  mThreadPool.setMaxThreadCount( std::max( 2, QThread::idealThreadCount() ) );
+}
+
+IdentifyTool::~IdentifyTool()
+{
+  cancel();
+  mThreadPool.waitForDone();
 }
 
 QgsQuickMapSettings *IdentifyTool::mapSettings() const
@@ -51,7 +90,7 @@ void IdentifyTool::setMapSettings( QgsQuickMapSettings *mapSettings )
   emit mapSettingsChanged();
 }
 
-void IdentifyTool::identify( const QPointF &point ) const
+void IdentifyTool::identify( const QPointF &point )
 {
   if ( mDeactivated )
     return;
@@ -62,58 +101,145 @@ void IdentifyTool::identify( const QPointF &point ) const
     return;
   }
 
+  cancel();
+
   mModel->clear( true );
 
   QgsPointXY mapPoint = mMapSettings->screenToCoordinate( point );
 
+  mFeedback = std::make_shared<QgsFeedback>();
+
   const QList<QgsMapLayer *> layers = mModel->selectedLayer() ? QList<QgsMapLayer *>() << mModel->selectedLayer() : mMapSettings->mapSettings().layers();
   for ( QgsMapLayer *layer : layers )
   {
     if ( !layer->flags().testFlag( QgsMapLayer::Identifiable ) )
       continue;
 
-    if ( QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( layer ) )
-    {
-      QList<IdentifyResult> results = identifyVectorLayer( vl, mapPoint );
-      mModel->appendFeatures( results );
-    }
-    else if ( QgsRasterLayer *rl = qobject_cast<QgsRasterLayer *>( layer ) )
-    {
-      QList<IdentifyResult> results = identifyRasterLayer( rl, mapPoint );
-      mModel->appendFeatures( results );
-    }
-    else if ( QgsVectorTileLayer *vtl = qobject_cast<QgsVectorTileLayer *>( layer ) )
-    {
-      QList<IdentifyResult> results = identifyVectorTileLayer( vtl, mapPoint );
-      mModel->appendFeatures( results );
-    }
+    const IdentifyJob job = prepareIdentify( layer, mapPoint );
+    if ( !job )
+      continue;
+
+    const qsizetype index = mPendingLayers.size();
+
+    PendingLayer pendingLayer;
+    pendingLayer.layer = layer;
+    pendingLayer.watcher = new QFutureWatcher<QList<IdentifyResult>>( this );
+    mPendingLayers << pendingLayer;
+
+    connect( pendingLayer.watcher, &QFutureWatcherBase::finished, this, [this, index]() { layerIdentified( index ); } );
+    pendingLayer.watcher->setFuture( QtConcurrent::run( &mThreadPool, [job, feedback = mFeedback]() {
+      return feedback->isCanceled() ? QList<IdentifyResult>() : job( feedback.get() );
+    } ) );
   }
 
+  appendFinishedResults();
+}
+
+void IdentifyTool::cancel()
+{
+  if ( mFeedback )
+  {
+    // the running tasks only hold their own copies of the layers data, they can safely finish in the background
+    mFeedback->cancel();
+    mFeedback.reset();
+  }
+
+  for ( const PendingLayer &pendingLayer : std::as_const( mPendingLayers ) )
+  {
+    disconnect( pendingLayer.watcher, nullptr, this, nullptr );
+    pendingLayer.watcher->deleteLater();
+  }
+
+  mPendingLayers.clear();
+  mNextPendingLayer = 0;
+}
+
+void IdentifyTool::layerIdentified( qsizetype index )
+{
+  if ( index >= mPendingLayers.size() )
+    return;
+
+  PendingLayer &pendingLayer = mPendingLayers[index];
+  pendingLayer.isFinished = true;
+
+  // the layer might have been deleted while being identified, e.g. by a project reload
+  if ( pendingLayer.layer )
+    pendingLayer.results = resultsForLayer( pendingLayer.watcher->result(), pendingLayer.layer );
+
+  appendFinishedResults();
+}
+
+void IdentifyTool::appendFinishedResults()
+{
+  // the results are appended in the layers order, a layer waits for the ones above it
+  while ( mNextPendingLayer < mPendingLayers.size() && mPendingLayers.at( mNextPendingLayer ).isFinished )
+  {
+    const PendingLayer &pendingLayer = mPendingLayers.at( mNextPendingLayer );
+
+    // the layer might have been deleted while waiting for the layers above it
+    if ( pendingLayer.layer && !pendingLayer.results.isEmpty() && mModel )
+      mModel->appendFeatures( pendingLayer.results );
+
+    mNextPendingLayer++;
+  }
+
+  if ( mNextPendingLayer < mPendingLayers.size() )
+    return;
+
+  for ( const PendingLayer &pendingLayer : std::as_const( mPendingLayers ) )
+    pendingLayer.watcher->deleteLater();
+
+  mPendingLayers.clear();
+  mNextPendingLayer = 0;
+  mFeedback.reset();
+
   emit identifyFinished();
 }
 
+IdentifyTool::IdentifyJob IdentifyTool::prepareIdentify( QgsMapLayer *layer, const QgsPointXY &point ) const
+{
+  if ( QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( layer ) )
+  {
+    return prepareVectorLayerIdentify( vl, point );
+  }
+  else if ( QgsRasterLayer *rl = qobject_cast<QgsRasterLayer *>( layer ) )
+  {
+    return prepareRasterLayerIdentify( rl, point );
+  }
+  else if ( QgsVectorTileLayer *vtl = qobject_cast<QgsVectorTileLayer *>( layer ) )
+  {
+    return prepareVectorTileLayerIdentify( vtl, point );
+  }
+
+  return IdentifyJob();
+}
+
 QList<IdentifyTool::IdentifyResult> IdentifyTool::identifyVectorLayer( QgsVectorLayer *layer, const QgsPointXY &point ) const
 {
-  QList<IdentifyResult> results;
+  const IdentifyJob job = prepareVectorLayerIdentify( layer, point );
+  return job ? resultsForLayer( job( nullptr ), layer ) : QList<IdentifyResult>();
+}
 
+IdentifyTool::IdentifyJob IdentifyTool::prepareVectorLayerIdentify( QgsVectorLayer *layer, const QgsPointXY &point ) const
+{
   if ( !layer || !layer->isSpatial() )
-    return results;
+    return IdentifyJob();
 
   if ( !layer->isInScaleRange( mMapSettings->mapSettings().scale() ) )
-    return results;
+    return IdentifyJob();
 
   QString temporalFilter;
   if ( mMapSettings->isTemporal() )
   {
     if ( !layer->temporalProperties()->isVisibleInTemporalRange( mMapSettings->mapSettings().temporalRange() ) )
-      return results;
+      return IdentifyJob();
 
     QgsVectorLayerTemporalContext temporalContext;
     temporalContext.setLayer( layer );
     temporalFilter = qobject_cast<const QgsVectorLayerTemporalProperties *>( layer->temporalProperties() )->createFilterString( temporalContext, mMapSettings->mapSettings().temporalRange() );
   }
 
-  QgsFeatureList featureList;
+  QgsFeatureRequest req;
 
   // toLayerCoordinates will throw an exception for an 'invalid' point.
   // For example, if you project a world map onto a globe using EPSG 2163
@@ -131,83 +257,116 @@ QList<IdentifyTool::IdentifyResult> IdentifyTool::identifyVectorLayer( QgsVector
 
     r = toLayerCoordinates( layer, r );
 
-    QgsFeatureRequest req;
     req.setFilterRect( r );
-    if ( !temporalFilter.isEmpty() )
-      req.setFilterExpression( temporalFilter );
-    req.setLimit( QSettings().value( "/QField/identify/limit", 200 ).toInt() );
+  }
+  catch ( QgsCsException &cse )
+  {
+    Q_UNUSED( cse );
+    // catch exception for 'invalid' point and proceed with no features found
+    return IdentifyJob();
+  }
+
+  if ( !temporalFilter.isEmpty() )
+    req.setFilterExpression( temporalFilter );
+  req.setLimit( QSettings().value( "/QField/identify/limit", 200 ).toInt() );
 #if _QGIS_VERSION_INT >= 33500
-    req.setFlags( Qgis::FeatureRequestFlag::ExactIntersect );
+  req.setFlags( Qgis::FeatureRequestFlag::ExactIntersect );
 #else
-    req.setFlags( QgsFeatureRequest::ExactIntersect );
+  req.setFlags( QgsFeatureRequest::ExactIntersect );
 #endif
 
-    QgsAttributeTableConfig config = layer->attributeTableConfig();
-    if ( !config.sortExpression().isEmpty() )
-    {
-      req.addOrderBy( config.sortExpression(), config.sortOrder() == Qt::AscendingOrder );
-    }
-    else if ( !layer->displayExpression().isEmpty() )
-    {
-      req.addOrderBy( layer->displayExpression() );
-    }
-
-    QgsFeatureIterator fit = layer->getFeatures( req );
-    QgsFeature f;
-    while ( fit.nextFeature( f ) )
-      featureList << QgsFeature( f );
+  QgsAttributeTableConfig config = layer->attributeTableConfig();
+  if ( !config.sortExpression().isEmpty() )
+  {
+    req.addOrderBy( config.sortExpression(), config.sortOrder() == Qt::AscendingOrder );
   }
-  catch ( QgsCsException &cse )
+  else if ( !layer->displayExpression().isEmpty() )
   {
-    Q_UNUSED( cse );
-    // catch exception for 'invalid' point and proceed with no features found
+    req.addOrderBy( layer->displayExpression() );
   }
 
   QgsRenderContext context( QgsRenderContext::fromMapSettings( mMapSettings->mapSettings() ) );
   context.setExpressionContext( QgsExpressionContext( QgsExpressionContextUtils::globalProjectLayerScopes( layer ) ) );
   context.expressionContext() << QgsExpressionContextUtils::mapSettingsScope( mMapSettings->mapSettings() );
-  QgsFeatureRenderer *renderer = layer->renderer();
 
-  if ( renderer )
-  {
-    renderer->startRender( context, layer->fields() );
-  }
+  // the worker thread only uses copies of the layer source and renderer
+  std::shared_ptr<QgsVectorLayerFeatureSource> source = std::make_shared<QgsVectorLayerFeatureSource>( layer );
+  std::shared_ptr<QgsFeatureRenderer> renderer( layer->renderer() ? layer->renderer()->clone() : nullptr );
+  const QgsFields fields = layer->fields();
 
-  for ( const QgsFeature &feature : std::as_const( featureList ) )
-  {
-    context.expressionContext().setFeature( feature );
-    if ( renderer && !renderer->willRenderFeature( const_cast<QgsFeature &>( feature ), context ) )
-      continue;
+  return [source, renderer, req, context, fields]( QgsFeedback *feedback ) mutable {
+    QList<IdentifyResult> results;
 
-    results.append( IdentifyResult( layer, feature ) );
-  }
+    QgsFeatureList featureList;
 
-  if ( renderer )
-  {
-    renderer->stopRender( context );
-  }
+    try
+    {
+      QgsFeatureRequest request( req );
+      request.setFeedback( feedback );
 
-  return results;
+      QgsFeatureIterator fit = source->getFeatures( request );
+      QgsFeature f;
+      while ( fit.nextFeature( f ) )
+        featureList << QgsFeature( f );
+    }
+    catch ( QgsCsException &cse )
+    {
+      Q_UNUSED( cse );
+      // catch exception for 'invalid' point and proceed with no features found
+    }
+
+    if ( feedback && feedback->isCanceled() )
+      return results;
+
+    if ( renderer )
+    {
+      renderer->startRender( context, fields );
+    }
+
+    for ( const QgsFeature &feature : std::as_const( featureList ) )
+    {
+      context.expressionContext().setFeature( feature );
+      if ( renderer && !renderer->willRenderFeature( const_cast<QgsFeature &>( feature ), context ) )
+        continue;
+
+      results.append( IdentifyResult( nullptr, feature ) );
+    }
+
+    if ( renderer )
+    {
+      renderer->stopRender( context );
+    }
+
+    return results;
+  };
 }
 
 QList<IdentifyTool::IdentifyResult> IdentifyTool::identifyRasterLayer( QgsRasterLayer *layer, const QgsPointXY &point ) const
 {
-  QList<IdentifyTool::IdentifyResult> results;
+  const IdentifyJob job = prepareRasterLayerIdentify( layer, point );
+  return job ? resultsForLayer( job( nullptr ), layer ) : QList<IdentifyResult>();
+}
+
+IdentifyTool::IdentifyJob IdentifyTool::prepareRasterLayerIdentify( QgsRasterLayer *layer, const QgsPointXY &point ) const
+{
   if ( !layer->dataProvider() || !layer->isValid() )
-    return results;
+    return IdentifyJob();
 
-  std::unique_ptr<QgsRasterDataProvider> dataProvider( layer->dataProvider()->clone() );
+  std::shared_ptr<QgsRasterDataProvider> dataProvider = sharedDataProvider( layer->dataProvider()->clone() );
   const Qgis::RasterInterfaceCapabilities capabilities = dataProvider->capabilities();
 
   if ( !( capabilities & Qgis::RasterInterfaceCapability::Identify ) )
-    return results;
+    return IdentifyJob();
 
   if ( !( capabilities & Qgis::RasterInterfaceCapability::IdentifyFeature ) )
-    return results;
+    return IdentifyJob();
 
   const QgsPointXY pointInLayerCoordinates = toLayerCoordinates( layer, point );
   const double mapUnitsPerPixel = mMapSettings->mapSettings().mapUnitsPerPixel();
-  QgsRasterIdentifyResult identifyResult;
+  QgsPointXY identifyPoint;
+  QgsRectangle identifyExtent;
+  int identifyWidth = 0;
+  int identifyHeight = 0;
   // We can only use current map canvas context (extent, width, height) if layer is not reprojected,
   if ( dataProvider->crs() != mMapSettings->mapSettings().destinationCrs() )
   {
@@ -225,7 +384,10 @@ QList<IdentifyTool::IdentifyResult> IdentifyTool::identifyRasterLayer( QgsRaster
     // Mapserver (6.0.3, for example) does not work with 1x1 pixel box
     // but that is fixed (the rect is enlarged) in the WMS provider
 
-    identifyResult = dataProvider->identify( pointInLayerCoordinates, Qgis::RasterIdentifyFormat::Feature, r, 1, 1 );
+    identifyPoint = pointInLayerCoordinates;
+    identifyExtent = r;
+    identifyWidth = 1;
+    identifyHeight = 1;
   }
   else
   {
@@ -245,82 +407,105 @@ QList<IdentifyTool::IdentifyResult> IdentifyTool::identifyRasterLayer( QgsRaster
     const int width = static_cast<int>( std::round( extent.width() / mapUnitsPerPixel ) );
     const int height = static_cast<int>( std::round( extent.height() / mapUnitsPerPixel ) );
 
-    identifyResult = dataProvider->identify( point, Qgis::RasterIdentifyFormat::Feature, extent, width, height );
+    identifyPoint = point;
+    identifyExtent = extent;
+    identifyWidth = width;
+    identifyHeight = height;
   }
 
-  QMap<int, QVariant> identifyResults = identifyResult.results();
-  for ( auto it = identifyResults.constBegin(); it != identifyResults.constEnd(); ++it )
-  {
-    const QVariant &result = it.value();
-    if ( result.userType() == QMetaType::Type::Bool && !result.toBool() )
-    {
-      // sublayer not visible or not queryable
-      continue;
-    }
+  const QString layerName = layer->name();
+  const QStringList subLayers = layer->subLayers();
 
-    if ( result.userType() == QMetaType::Type::QString )
-    {
-      // error
-      // TODO: better error reporting
-      QString label = layer->subLayers().value( it.key() );
-      continue;
-    }
+  return [dataProvider, identifyPoint, identifyExtent, identifyWidth, identifyHeight, layerName, subLayers]( QgsFeedback *feedback ) {
+    QList<IdentifyTool::IdentifyResult> results;
+
+    if ( feedback && feedback->isCanceled() )
+      return results;
 
-    // list of feature stores for a single sublayer
-    const QgsFeatureStoreList featureStoreList = result.value<QgsFeatureStoreList>();
+    // NOTE the data provider identify() does not take a feedback, a canceled request is dropped once answered
+    const QgsRasterIdentifyResult identifyResult = dataProvider->identify( identifyPoint, Qgis::RasterIdentifyFormat::Feature, identifyExtent, identifyWidth, identifyHeight );
 
-    for ( const QgsFeatureStore &featureStore : featureStoreList )
+    if ( feedback && feedback->isCanceled() )
+      return results;
+
+    QMap<int, QVariant> identifyResults = identifyResult.results();
+    for ( auto it = identifyResults.constBegin(); it != identifyResults.constEnd(); ++it )
     {
-      const QgsFeatureList storeFeatures = featureStore.features();
-      for ( const QgsFeature &feature : storeFeatures )
+      const QVariant &result = it.value();
+      if ( result.userType() == QMetaType::Type::Bool && !result.toBool() )
       {
-        // WMS sublayer and feature type, a sublayer may contain multiple feature types.
-        // Sublayer name may be the same as layer name and feature type name
-        // may be the same as sublayer. We try to avoid duplicities in label.
-        QString sublayer = featureStore.params().value( QStringLiteral( "sublayer" ) ).toString();
-        QString featureType = featureStore.params().value( QStringLiteral( "featureType" ) ).toString();
-        // Strip UMN MapServer '_feature'
-        featureType.remove( QStringLiteral( "_feature" ) );
-
-        QStringList labels;
-        if ( sublayer.compare( layer->name(), Qt::CaseInsensitive ) != 0 && sublayer.compare( QStringLiteral( "Null" ), Qt::CaseInsensitive ) != 0 )
-        {
-          labels << sublayer;
-        }
-        if ( ( featureType.compare( sublayer, Qt::CaseInsensitive ) != 0 || labels.isEmpty() ) && featureType.compare( QStringLiteral( "Null" ), Qt::CaseInsensitive ) != 0 )
+        // sublayer not visible or not queryable
+        continue;
+      }
+
+      if ( result.userType() == QMetaType::Type::QString )
+      {
+        // error
+        // TODO: better error reporting
+        QString label = subLayers.value( it.key() );
+        continue;
+      }
+
+      // list of feature stores for a single sublayer
+      const QgsFeatureStoreList featureStoreList = result.value<QgsFeatureStoreList>();
+
+      for ( const QgsFeatureStore &featureStore : featureStoreList )
+      {
+        const QgsFeatureList storeFeatures = featureStore.features();
+        for ( const QgsFeature &feature : storeFeatures )
         {
-          labels << featureType;
-        }
+          // WMS sublayer and feature type, a sublayer may contain multiple feature types.
+          // Sublayer name may be the same as layer name and feature type name
+          // may be the same as sublayer. We try to avoid duplicities in label.
+          QString sublayer = featureStore.params().value( QStringLiteral( "sublayer" ) ).toString();
+          QString featureType = featureStore.params().value( QStringLiteral( "featureType" ) ).toString();
+          // Strip UMN MapServer '_feature'
+          featureType.remove( QStringLiteral( "_feature" ) );
+
+          QStringList labels;
+          if ( sublayer.compare( layerName, Qt::CaseInsensitive ) != 0 && sublayer.compare( QStringLiteral( "Null" ), Qt::CaseInsensitive ) != 0 )
+          {
+            labels << sublayer;
+          }
+          if ( ( featureType.compare( sublayer, Qt::CaseInsensitive ) != 0 || labels.isEmpty() ) && featureType.compare( QStringLiteral( "Null" ), Qt::CaseInsensitive ) != 0 )
+          {
+            labels << featureType;
+          }
 
 
-        results.append( IdentifyResult( layer, feature, !labels.isEmpty() ? QStringLiteral( "%1 - %2" ).arg( labels.join( QStringLiteral( " - " ) ) ) : layer->name() ) );
+          results.append( IdentifyResult( nullptr, feature, !labels.isEmpty() ? QStringLiteral( "%1 - %2" ).arg( labels.join( QStringLiteral( " - " ) ) ) : layerName ) );
+        }
       }
     }
-  }
 
-  return results;
+    return results;
+  };
 }
 
 QList<IdentifyTool::IdentifyResult> IdentifyTool::identifyVectorTileLayer( QgsVectorTileLayer *layer, const QgsPointXY &point ) const
 {
-  QList<IdentifyTool::IdentifyResult> results;
-  if ( !layer || !layer->isSpatial() )
-    return results;
+  const IdentifyJob job = prepareVectorTileLayerIdentify( layer, point );
+  return job ? resultsForLayer( job( nullptr ), layer ) : QList<IdentifyResult>();
+}
+
+IdentifyTool::IdentifyJob IdentifyTool::prepareVectorTileLayerIdentify( QgsVectorTileLayer *layer, const QgsPointXY &point ) const
+{
+  if ( !layer || !layer->isSpatial() || !layer->dataProvider() )
+    return IdentifyJob();
 
   if ( !layer->isInScaleRange( mMapSettings->mapSettings().scale() ) )
   {
-    return results;
+    return IdentifyJob();
   }
 
-  QMap<QString, QString> commonDerivedAttributes;
-  int featureCount = 0;
+  QgsRectangle r;
+  QVector<QgsTileXYZ> tiles;
 
   try
   {
     // create the search rectangle
     double searchRadius = searchRadiusMU();
 
-    QgsRectangle r;
     r.setXMinimum( point.x() - searchRadius );
     r.setXMaximum( point.x() + searchRadius );
     r.setYMinimum( point.y() - searchRadius );
@@ -338,31 +523,53 @@ QList<IdentifyTool::IdentifyResult> IdentifyTool::identifyVectorTileLayer( QgsVe
     const QgsTileMatrix tileMatrix = layer->tileMatrixSet().tileMatrix( tileZoom );
     const QgsTileRange tileRange = tileMatrix.tileRangeFromExtent( r );
 
-    const QVector<QgsTileXYZ> tiles = layer->tileMatrixSet().tilesInRange( tileRange, tileZoom );
+    tiles = layer->tileMatrixSet().tilesInRange( tileRange, tileZoom );
+  }
+  catch ( QgsCsException &cse )
+  {
+    Q_UNUSED( cse )
+    // catch exception for 'invalid' point and proceed with no features found
+    QgsDebugError( QStringLiteral( "Caught CRS exception %1" ).arg( cse.what() ) );
+    return IdentifyJob();
+  }
+
+  // the worker thread fetches the tiles through its own copy of the data provider
+  std::shared_ptr<QgsVectorTileDataProvider> dataProvider = sharedDataProvider( qobject_cast<QgsVectorTileDataProvider *>( layer->dataProvider()->clone() ) );
+  if ( !dataProvider )
+    return IdentifyJob();
+
+  const QgsVectorTileMatrixSet tileMatrixSet = layer->tileMatrixSet();
+  const QString layerName = layer->name();
+
+  return [dataProvider, tileMatrixSet, tiles, r, layerName]( QgsFeedback *feedback ) {
+    QList<IdentifyTool::IdentifyResult> results;
+
     for ( const QgsTileXYZ &tileID : tiles )
     {
-      const QgsVectorTileRawData data = layer->getRawTile( tileID );
+      if ( feedback && feedback->isCanceled() )
+        break;
+
+      const QgsVectorTileRawData data = dataProvider->readTile( tileMatrixSet, tileID, feedback );
       if ( data.data.isEmpty() )
         continue; // failed to get data
 
-      QgsVectorTileMVTDecoder decoder( layer->tileMatrixSet() );
+      QgsVectorTileMVTDecoder decoder( tileMatrixSet );
       if ( !decoder.decode( data ) )
         continue; // failed to decode
 
       QMap<QString, QgsFields> perLayerFields;
       const QStringList layerNames = decoder.layers();
-      for ( const QString &layerName : layerNames )
+      for ( const QString &decodedLayerName : layerNames )
       {
-        QSet<QString> fieldNames = qgis::listToSet( decoder.layerFieldNames( layerName ) );
-        perLayerFields[layerName] = QgsVectorTileUtils::makeQgisFields( fieldNames );
+        QSet<QString> fieldNames = qgis::listToSet( decoder.layerFieldNames( decodedLayerName ) );
+        perLayerFields[decodedLayerName] = QgsVectorTileUtils::makeQgisFields( fieldNames );
       }
 
       const QgsVectorTileFeatures features = decoder.layerFeatures( perLayerFields, QgsCoordinateTransform() );
       const QStringList featuresLayerNames = features.keys();
-      for ( const QString &layerName : featuresLayerNames )
+      for ( const QString &featuresLayerName : featuresLayerNames )
       {
-        const QgsFields fFields = perLayerFields[layerName];
-        const QVector<QgsFeature> &layerFeatures = features[layerName];
+        const QVector<QgsFeature> &layerFeatures = features[featuresLayerName];
         for ( const QgsFeature &f : layerFeatures )
         {
           if ( f.fields().isEmpty() )
@@ -370,20 +577,14 @@ QList<IdentifyTool::IdentifyResult> IdentifyTool::identifyVectorTileLayer( QgsVe
 
           if ( f.geometry().intersects( r ) )
           {
-            results.append( IdentifyResult( layer, f, QStringLiteral( "%1 - %2" ).arg( layer->name(), layerName ) ) );
+            results.append( IdentifyResult( nullptr, f, QStringLiteral( "%1 - %2" ).arg( layerName, featuresLayerName ) ) );
           }
         }
       }
     }
-  }
-  catch ( QgsCsException &cse )
-  {
-    Q_UNUSED( cse )
-    // catch exception for 'invalid' point and proceed with no features found
-    QgsDebugError( QStringLiteral( "Caught CRS exception %1" ).arg( cse.what() ) );
-  }
 
-  return results;
+    return results;
+  };
 }
 
 MultiFeatureListModel *IdentifyTool::model() const
@@ -396,6 +597,8 @@ void IdentifyTool::setModel( MultiFeatureListModel *model )
   if ( model == mModel )
     return;
 
+  cancel();
+
   mModel = model;
   emit modelChanged();
 }
@@ -403,7 +606,10 @@ void IdentifyTool::setModel( MultiFeatureListModel *model )
 void IdentifyTool::setDeactivated( bool deactivated )
 {
   if ( deactivated )
+  {
+    cancel();
     mModel->clear();
+  }
   mDeactivated = deactivated;
 }
 
@@ -16,12 +16,17 @@
 #ifndef IDENTIFYTOOL_H
 #define IDENTIFYTOOL_H
 
+#include <QFutureWatcher>
 #include <QObject>
+#include <QPointer>
+#include <QThreadPool>
+#include <functional>
 #include <qgsfeature.h>
 #include <qgsmapsettings.h>
 #include <qgspoint.h>
 #include <qgsrendercontext.h>
 
+class QgsFeedback;
 class QgsMapLayer;
 class QgsQuickMapSettings;
 class QgsRasterLayer;
@@ -30,6 +35,11 @@ class QgsVectorTileLayer;
 class MultiFeatureListModel;
 
 /**
+ * Identifies the features of the map layers at a given point.
+ *
+ * Each layer is identified by a task running on a worker thread pool, the results are appended
+ * to the model in the layers order as soon as they are available. A new identification cancels
+ * the ongoing one.
  * \ingroup core
  */
 class IdentifyTool : public QObject
@@ -57,6 +67,7 @@ class IdentifyTool : public QObject
 
   public:
     explicit IdentifyTool( QObject *parent = nullptr );
+    ~IdentifyTool() override;
 
     QgsQuickMapSettings *mapSettings() const;
     void setMapSettings( QgsQuickMapSettings *mapSettings );
@@ -75,19 +86,53 @@ class IdentifyTool : public QObject
     void searchRadiusMmChanged();
     void modelChanged();
     void deactivatedChanged();
+    //! Emitted when all the layers have been identified and their results appended to the model
     void identifyFinished() const;
 
   public slots:
-    void identify( const QPointF &point ) const;
+    /**
+     * Identifies the features at the screen \a point, the results are appended to the model asynchronously.
+     */
+    void identify( const QPointF &point );
+
+    //! Cancels the ongoing identification, the results appended to the model so far are kept
+    void cancel();
 
     QList<IdentifyResult> identifyVectorLayer( QgsVectorLayer *layer, const QgsPointXY &point ) const;
     QList<IdentifyResult> identifyRasterLayer( QgsRasterLayer *layer, const QgsPointXY &point ) const;
     QList<IdentifyResult> identifyVectorTileLayer( QgsVectorTileLayer *layer, const QgsPointXY &point ) const;
 
   private:
+    /**
+     * An identification of a single layer, prepared on the main thread and safe to run on a worker thread.
+     * The job never touches the layer, its results have no layer set. The feedback might be null.
+     */
+    using IdentifyJob = std::function<QList<IdentifyResult>( QgsFeedback *feedback )>;
+
+    struct PendingLayer
+    {
+        QPointer<QgsMapLayer> layer;
+        QFutureWatcher<QList<IdentifyResult>> *watcher = nullptr;
+        QList<IdentifyResult> results;
+        bool isFinished = false;
+    };
+
+    IdentifyJob prepareIdentify( QgsMapLayer *layer, const QgsPointXY &point ) const;
+    IdentifyJob prepareVectorLayerIdentify( QgsVectorLayer *layer, const QgsPointXY &point ) const;
+    IdentifyJob prepareRasterLayerIdentify( QgsRasterLayer *layer, const QgsPointXY &point ) const;
+    IdentifyJob prepareVectorTileLayerIdentify( QgsVectorTileLayer *layer, const QgsPointXY &point ) const;
+
+    void layerIdentified( qsizetype index );
+    void appendFinishedResults();
+
     QgsQuickMapSettings *mMapSettings = nullptr;
     MultiFeatureListModel *mModel = nullptr;
 
+    QThreadPool mThreadPool;
+    std::shared_ptr<QgsFeedback> mFeedback;
+    QList<PendingLayer> mPendingLayers;
+    qsizetype mNextPendingLayer = 0;
+
     double searchRadiusMU( const QgsRenderContext &context ) const;
     double searchRadiusMU() const;
 
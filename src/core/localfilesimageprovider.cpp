@@ -16,56 +16,186 @@
 
 #include "localfilesimageprovider.h"
 
-#include <QIcon>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QStandardPaths>
+#include <QThread>
+#include <QUuid>
+#include <QtConcurrentRun>
 #include <qgsgdalutils.h>
 
+#include <algorithm>
 #include <gdal.h>
 
-LocalFilesImageProvider::LocalFilesImageProvider()
-  : QQuickImageProvider( Pixmap )
+LocalFilesImageResponse::LocalFilesImageResponse( const QString &path, const QSize &requestedSize, const QString &cacheDirectory, QThreadPool *threadPool )
 {
+  connect( &mWatcher, &QFutureWatcher<QImage>::finished, this, [this] {
+    if ( !mWatcher.isCanceled() )
+      mImage = mWatcher.result();
+    emit finished();
+  } );
+  mWatcher.setFuture( QtConcurrent::run( threadPool, &LocalFilesImageProvider::thumbnail, path, requestedSize, cacheDirectory ) );
 }
 
-QImage LocalFilesImageProvider::requestImage( const QString &id, QSize *size, const QSize &requestedSize )
+QQuickTextureFactory *LocalFilesImageResponse::textureFactory() const
 {
-  static const QIcon defaultIcon( QStringLiteral( ":/themes/qfield/nodpi/ic_file_green_48dp.svg" ) );
+  return QQuickTextureFactory::textureFactoryForImage( mImage );
+}
+
+void LocalFilesImageResponse::cancel()
+{
+  // thumbnails of items scrolled out of view before a worker picked them up are never generated
+  mWatcher.cancel();
+}
+
+
+LocalFilesImageProvider::LocalFilesImageProvider( const QString &cacheDirectory )
+  : mCacheDirectory( cacheDirectory.isEmpty() ? QStringLiteral( "%1/thumbnails" ).arg( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) ) : cacheDirectory )
+{
+  // decoding large rasters is memory hungry, keep the number of concurrent decodings low
+  mThreadPool.setMaxThreadCount( std::clamp( QThread::idealThreadCount() / 2, 1, 2 ) );
+
+  // thumbnails of moved, modified or deleted datasets are never read again, prune them once per session
+  ( void ) QtConcurrent::run( &mThreadPool, &LocalFilesImageProvider::pruneCache, mCacheDirectory, CACHE_MAX_AGE_DAYS );
+}
+
+LocalFilesImageProvider::~LocalFilesImageProvider()
+{
+  mThreadPool.clear();
+  mThreadPool.waitForDone();
+}
 
+QQuickImageResponse *LocalFilesImageProvider::requestImageResponse( const QString &id, const QSize &requestedSize )
+{
   // the id is passed on as an encoded URL string which needs decoding
-  QString path = QUrl::fromPercentEncoding( id.toUtf8() );
-  if ( path.toLower().endsWith( QStringLiteral( ".zip" ) ) )
-    path = QStringLiteral( "/vsizip/%1" ).arg( path );
+  const QString path = QUrl::fromPercentEncoding( id.toUtf8() );
+  return new LocalFilesImageResponse( path, requestedSize, mCacheDirectory, &mThreadPool );
+}
+
+QImage LocalFilesImageProvider::thumbnail( const QString &path, const QSize &requestedSize, const QString &cacheDirectory )
+{
+  const QSize size = requestedSize.width() > 0 ? requestedSize : QSize( 256, 256 );
+
+  const QFileInfo fileInfo( path );
+  if ( !fileInfo.exists() )
+    return defaultThumbnail( size );
+
+  const QByteArray key = QStringLiteral( "%1|%2|%3|%4" ).arg( fileInfo.absoluteFilePath() ).arg( fileInfo.size() ).arg( fileInfo.lastModified().toMSecsSinceEpoch() ).arg( size.width() ).toUtf8();
+  const QString cachedFileName = QStringLiteral( "%1/%2.png" ).arg( cacheDirectory, QString::fromLatin1( QCryptographicHash::hash( key, QCryptographicHash::Sha1 ).toHex() ) );
+
+  if ( QFile::exists( cachedFileName ) )
+  {
+    QImageReader reader( cachedFileName );
+    const QImage image = reader.read();
+    if ( !image.isNull() )
+    {
+      // thumbnails are pruned by age, keep the ones still in use
+      QFile cachedFile( cachedFileName );
+      if ( cachedFile.open( QIODevice::ReadWrite ) )
+        cachedFile.setFileTime( QDateTime::currentDateTime(), QFileDevice::FileModificationTime );
+      return image;
+    }
+  }
+
+  const QImage image = renderThumbnail( path, size );
+  if ( image.isNull() )
+    return defaultThumbnail( size );
+
+  // write through a temporary file, concurrent readers never see a partial thumbnail
+  if ( QDir().mkpath( cacheDirectory ) )
+  {
+    const QString tmpFileName = QStringLiteral( "%1.%2.tmp" ).arg( cachedFileName, QUuid::createUuid().toString( QUuid::WithoutBraces ) );
+    if ( !image.save( tmpFileName, "PNG" ) || !QFile::rename( tmpFileName, cachedFileName ) )
+      QFile::remove( tmpFileName );
+  }
+
+  return image;
+}
+
+void LocalFilesImageProvider::pruneCache( const QString &cacheDirectory, int maxAgeDays )
+{
+  const QDateTime oldest = QDateTime::currentDateTime().addDays( -maxAgeDays );
+  QDirIterator it( cacheDirectory, { QStringLiteral( "*.png" ), QStringLiteral( "*.tmp" ) }, QDir::Files );
+  while ( it.hasNext() )
+  {
+    it.next();
+    if ( it.fileInfo().lastModified() < oldest )
+      QFile::remove( it.filePath() );
+  }
+}
 
-  const gdal::dataset_unique_ptr dataset( GDALOpen( path.toLocal8Bit().data(), GA_ReadOnly ) );
+QImage LocalFilesImageProvider::renderThumbnail( const QString &path, const QSize &requestedSize )
+{
+  QString datasetPath = path;
+  if ( datasetPath.toLower().endsWith( QStringLiteral( ".zip" ) ) )
+    datasetPath = QStringLiteral( "/vsizip/%1" ).arg( datasetPath );
+
+  const gdal::dataset_unique_ptr dataset( GDALOpen( datasetPath.toLocal8Bit().data(), GA_ReadOnly ) );
   if ( !dataset )
-    return defaultIcon.pixmap( QSize( requestedSize ) ).toImage();
+    return QImage();
 
   const int cols = GDALGetRasterXSize( dataset.get() );
   const int rows = GDALGetRasterYSize( dataset.get() );
   int bands = std::min( 4, GDALGetRasterCount( dataset.get() ) );
+  if ( cols <= 0 || rows <= 0 || bands <= 0 )
+    return QImage();
+
   if ( bands == 2 )
   {
     // For 2-band raster, go for a 1-band grayscale representation
     bands = 1;
   }
 
-  const QSize outputSize( requestedSize.width(), rows * requestedSize.width() / cols );
+  const QSize outputSize( requestedSize.width(), std::max( 1, static_cast<int>( static_cast<qint64>( rows ) * requestedSize.width() / cols ) ) );
   QImage image( outputSize, bands == 4 ? QImage::Format_RGBA8888 : bands == 3 ? QImage::Format_RGB888
                                                                               : QImage::Format_Grayscale8 );
   if ( image.isNull() )
-    return defaultIcon.pixmap( QSize( requestedSize ) ).toImage();
+    return QImage();
+
+  // decode from the smallest overview still larger than the thumbnail, if any
+  int overviewIndex = -1;
+  int overviewCols = cols;
+  GDALRasterBandH firstBand = GDALGetRasterBand( dataset.get(), 1 );
+  for ( int i = 0; i < GDALGetOverviewCount( firstBand ); i++ )
+  {
+    GDALRasterBandH overview = GDALGetOverview( firstBand, i );
+    const int columns = overview ? GDALGetRasterBandXSize( overview ) : 0;
+    if ( columns >= outputSize.width() && columns < overviewCols )
+    {
+      overviewIndex = i;
+      overviewCols = columns;
+    }
+  }
 
   GByte *firstPixel = reinterpret_cast<GByte *>( image.bits() );
   for ( int i = 0; i < bands; i++ )
   {
-    CPLErr err = GDALRasterIOEx( GDALGetRasterBand( dataset.get(), i + 1 ),
-                                 GF_Read, 0, 0, cols, rows,
+    GDALRasterBandH band = GDALGetRasterBand( dataset.get(), i + 1 );
+    if ( overviewIndex > -1 && GDALGetOverviewCount( band ) > overviewIndex )
+      band = GDALGetOverview( band, overviewIndex );
+
+    CPLErr err = GDALRasterIOEx( band,
+                                 GF_Read, 0, 0, GDALGetRasterBandXSize( band ), GDALGetRasterBandYSize( band ),
                                  firstPixel + ( i ),
                                  outputSize.width(), outputSize.height(),
                                  GDT_Byte, bands, image.bytesPerLine(), nullptr );
     if ( err != CE_None )
     {
-      return defaultIcon.pixmap( QSize( requestedSize ) ).toImage();
+      return QImage();
     }
   }
   return image;
 }
+
+QImage LocalFilesImageProvider::defaultThumbnail( const QSize &requestedSize )
+{
+  // QIcon and QPixmap are bound to the GUI thread, render the icon through an image reader instead
+  QImageReader reader( QStringLiteral( ":/themes/qfield/nodpi/ic_file_green_48dp.svg" ) );
+  reader.setScaledSize( QSize( requestedSize.width(), requestedSize.width() ) );
+  return reader.read();
+}
@@ -16,18 +16,71 @@
 #ifndef LOCALFILESIMAGEPROVIDER_H
 #define LOCALFILESIMAGEPROVIDER_H
 
-#include <QQuickImageProvider>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QQuickAsyncImageProvider>
+#include <QQuickImageResponse>
+#include <QThreadPool>
 
 /**
+ * \brief This class provides responses of thumbnails generated on a worker thread.
  * \ingroup core
  */
-class LocalFilesImageProvider : public QQuickImageProvider
+class LocalFilesImageResponse : public QQuickImageResponse
 {
   public:
-    explicit LocalFilesImageProvider();
+    LocalFilesImageResponse( const QString &path, const QSize &requestedSize, const QString &cacheDirectory, QThreadPool *threadPool );
 
-    QQmlImageProviderBase::ImageType imageType() const override { return QQmlImageProviderBase::Image; }
-    QImage requestImage( const QString &id, QSize *size, const QSize &requestedSize ) override;
+    QQuickTextureFactory *textureFactory() const override;
+
+    void cancel() override;
+
+  private:
+    QFutureWatcher<QImage> mWatcher;
+    QImage mImage;
+};
+
+
+/**
+ * \brief This class provides thumbnails of local raster datasets and images.
+ *
+ * Thumbnails are decoded from the smallest overview large enough when the dataset has overviews,
+ * on a bounded pool of worker threads, and cached on disk keyed by the dataset path, size and
+ * modification time so browsing the same folder again does not decode the datasets again.
+ * Cached thumbnails left unused for a month are removed when the provider is created.
+ * \ingroup core
+ */
+class LocalFilesImageProvider : public QQuickAsyncImageProvider
+{
+  public:
+    /**
+     * Creates a local files image provider caching thumbnails into \a cacheDirectory.
+     * If empty, the thumbnails are cached in the application cache location.
+     */
+    explicit LocalFilesImageProvider( const QString &cacheDirectory = QString() );
+    ~LocalFilesImageProvider() override;
+
+    QQuickImageResponse *requestImageResponse( const QString &id, const QSize &requestedSize ) override;
+
+    /**
+     * Returns the thumbnail of the file at \a path fitting the \a requestedSize width, reading it from
+     * the thumbnails cached in \a cacheDirectory when available. This method is thread safe.
+     */
+    static QImage thumbnail( const QString &path, const QSize &requestedSize, const QString &cacheDirectory );
+
+    /**
+     * Removes the thumbnails cached in \a cacheDirectory which have not been used for \a maxAgeDays days.
+     */
+    static void pruneCache( const QString &cacheDirectory, int maxAgeDays );
+
+  private:
+    static constexpr int CACHE_MAX_AGE_DAYS = 30;
+
+    static QImage renderThumbnail( const QString &path, const QSize &requestedSize );
+    static QImage defaultThumbnail( const QSize &requestedSize );
+
+    QString mCacheDirectory;
+    QThreadPool mThreadPool;
 };
 
 #endif // LOCALFILESIMAGEPROVIDER_H
@@ -23,10 +23,18 @@
 #include <QDir>
 #include <QFile>
 #include <QImageReader>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+#define LISTING_CACHE_SIZE 16
+#define APPEND_CHUNK_SIZE 500
 
 LocalFilesModel::LocalFilesModel( QObject *parent )
   : QAbstractListModel( parent )
 {
+  connect( &mScanWatcher, &QFutureWatcher<QList<Item>>::finished, this, &LocalFilesModel::scanFinished );
+  connect( &mFileSystemWatcher, &QFileSystemWatcher::directoryChanged, this, &LocalFilesModel::directoryChanged );
+
   QSettings settings;
   mFavorites = settings.value( QStringLiteral( "qfieldFavorites" ), QStringList() ).toStringList();
 
@@ -97,6 +105,8 @@ void LocalFilesModel::resetToRoot()
 
 void LocalFilesModel::resetToPath( const QString &path )
 {
+  clearListingCache();
+
   mHistory.clear();
   setCurrentPath( path );
 
@@ -231,6 +241,10 @@ void LocalFilesModel::moveUp()
 
 void LocalFilesModel::reloadModel()
 {
+  // the results of a scan still running are stale
+  mScanPath.clear();
+  mPendingItems.clear();
+
   beginResetModel();
   mItems.clear();
 
@@ -275,86 +289,204 @@ void LocalFilesModel::reloadModel()
         mItems << Item( ItemMetaType::Folder, ItemType::SimpleFolder, fi.absoluteFilePath(), QString(), fi.absoluteFilePath() );
       }
     }
+
+    endResetModel();
+    setIsLoading( false );
+    return;
   }
-  else
+
+  endResetModel();
+
+  auto cachedListing = mListingCache.constFind( path );
+  if ( cachedListing != mListingCache.constEnd() )
   {
-    QDir dir( path );
-    if ( dir.exists() )
+    mListingCacheOrder.removeAll( path );
+    mListingCacheOrder << path;
+
+    appendItems( *cachedListing );
+    setIsLoading( false );
+    return;
+  }
+
+  mScanPath = path;
+  setIsLoading( true );
+  mScanWatcher.setFuture( QtConcurrent::run( &LocalFilesModel::scanDirectory, path ) );
+}
+
+QList<LocalFilesModel::Item> LocalFilesModel::scanDirectory( const QString &path )
+{
+  QList<Item> folders;
+  QList<Item> files;
+  QList<Item> projects;
+  QList<Item> datasets;
+
+  QDir dir( path );
+  if ( !dir.exists() )
+    return QList<Item>();
+
+  const QFileInfoList entries = dir.entryInfoList( QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot, QDir::DirsFirst | QDir::IgnoreCase );
+
+  // index the entry names once, sibling lookups would otherwise scan the whole listing for each entry
+  QSet<QString> names;
+  QSet<QString> lowerCaseNames;
+  names.reserve( entries.size() );
+  lowerCaseNames.reserve( entries.size() );
+  for ( const QFileInfo &fi : entries )
+  {
+    names << fi.fileName();
+    lowerCaseNames << fi.fileName().toLower();
+  }
+
+  const QRegularExpression translatedProjectRe( QStringLiteral( "(.*)_[A-Za-z]{2}" ) );
+  for ( const QFileInfo &fi : entries )
+  {
+    const QString item = fi.fileName();
+    if ( fi.isDir() )
+    {
+      folders << Item( ItemMetaType::Folder, ItemType::SimpleFolder, fi.fileName(), QString(), fi.absoluteFilePath() );
+    }
+    else
     {
-      const QStringList items = dir.entryList( QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot, QDir::DirsFirst | QDir::IgnoreCase );
-      QList<Item> folders;
-      QList<Item> files;
-      QList<Item> projects;
-      QList<Item> datasets;
-      for ( const QString &item : items )
+      const QString suffix = fi.suffix().toLower();
+      if ( ( suffix == QStringLiteral( "png" ) || suffix == QStringLiteral( "jpg" ) ) && names.contains( fi.completeBaseName() ) )
       {
-        QFileInfo fi( path + QDir::separator() + item );
-        if ( fi.isDir() )
-        {
-          folders << Item( ItemMetaType::Folder, ItemType::SimpleFolder, fi.fileName(), QString(), fi.absoluteFilePath() );
-        }
-        else
+        // Skip project preview images
+        continue;
+      }
+      else if ( suffix == QStringLiteral( "qgs" ) || suffix == QStringLiteral( "qgz" ) )
+      {
+        QRegularExpressionMatch match = translatedProjectRe.match( fi.completeBaseName() );
+        if ( match.hasMatch() )
         {
-          const QString suffix = fi.suffix().toLower();
-          if ( ( suffix == QStringLiteral( "png" ) || suffix == QStringLiteral( "jpg" ) ) && items.contains( fi.completeBaseName() ) )
+          const QString projectName = match.captured( 1 ).toLower();
+          if ( lowerCaseNames.contains( QStringLiteral( "%1.qgs" ).arg( projectName ) ) || lowerCaseNames.contains( QStringLiteral( "%1.qgz" ).arg( projectName ) ) )
           {
-            // Skip project preview images
+            // Skip translated project, users should always use the original project
             continue;
           }
-          else if ( suffix == QStringLiteral( "qgs" ) || suffix == QStringLiteral( "qgz" ) )
-          {
-            QRegularExpression re( QStringLiteral( "(.*)_[A-Za-z]{2}" ) );
-            QRegularExpressionMatch match = re.match( fi.completeBaseName() );
-            if ( match.hasMatch() )
-            {
-              if ( items.contains( QStringLiteral( "%1.qgs" ).arg( match.captured( 1 ) ), Qt::CaseInsensitive ) || items.contains( QStringLiteral( "%1.qgz" ).arg( match.captured( 1 ) ), Qt::CaseInsensitive ) )
-              {
-                // Skip translated project, users should always use the original project
-                continue;
-              }
-            }
-          }
-          else if ( suffix == QStringLiteral( "zip" ) )
-          {
-            if ( item.endsWith( QStringLiteral( "_attachments.zip" ), Qt::CaseInsensitive ) )
-            {
-              const QString reducedItemName = item.mid( 0, item.size() - 16 );
-              if ( items.contains( QStringLiteral( "%1.qgs" ).arg( reducedItemName ), Qt::CaseInsensitive ) || items.contains( QStringLiteral( "%1.qgz" ).arg( reducedItemName ), Qt::CaseInsensitive ) )
-              {
-                // Skip project attachments sidecar file
-                continue;
-              }
-            }
-          }
-          else if ( item == QStringLiteral( "qfield_webdav_configuration.json" ) )
+        }
+      }
+      else if ( suffix == QStringLiteral( "zip" ) )
+      {
+        if ( item.endsWith( QStringLiteral( "_attachments.zip" ), Qt::CaseInsensitive ) )
+        {
+          const QString reducedItemName = item.mid( 0, item.size() - 16 ).toLower();
+          if ( lowerCaseNames.contains( QStringLiteral( "%1.qgs" ).arg( reducedItemName ) ) || lowerCaseNames.contains( QStringLiteral( "%1.qgz" ).arg( reducedItemName ) ) )
           {
-            // Skip QField WebDAV configuration file
+            // Skip project attachments sidecar file
             continue;
           }
-
-          if ( SUPPORTED_PROJECT_EXTENSIONS.contains( suffix ) )
-          {
-            projects << Item( ItemMetaType::Project, ItemType::ProjectFile, fi.completeBaseName(), suffix, fi.absoluteFilePath(), fi.size() );
-          }
-          else if ( SUPPORTED_VECTOR_EXTENSIONS.contains( suffix ) && suffix != QStringLiteral( "pdf" ) )
-          {
-            datasets << Item( ItemMetaType::Dataset, ItemType::VectorDataset, fi.completeBaseName(), suffix, fi.absoluteFilePath(), fi.size() );
-          }
-          else if ( SUPPORTED_RASTER_EXTENSIONS.contains( suffix ) )
-          {
-            datasets << Item( ItemMetaType::Dataset, ItemType::RasterDataset, fi.completeBaseName(), suffix, fi.absoluteFilePath(), fi.size() );
-          }
-          else if ( SUPPORTED_FILE_EXTENSIONS.contains( suffix ) )
-          {
-            files << Item( ItemMetaType::File, ItemType::OtherFile, fi.completeBaseName(), suffix, fi.absoluteFilePath(), fi.size() );
-          }
         }
       }
-      mItems << folders << projects << datasets << files;
+      else if ( item == QStringLiteral( "qfield_webdav_configuration.json" ) )
+      {
+        // Skip QField WebDAV configuration file
+        continue;
+      }
+
+      if ( SUPPORTED_PROJECT_EXTENSIONS.contains( suffix ) )
+      {
+        projects << Item( ItemMetaType::Project, ItemType::ProjectFile, fi.completeBaseName(), suffix, fi.absoluteFilePath(), fi.size() );
+      }
+      else if ( SUPPORTED_VECTOR_EXTENSIONS.contains( suffix ) && suffix != QStringLiteral( "pdf" ) )
+      {
+        datasets << Item( ItemMetaType::Dataset, ItemType::VectorDataset, fi.completeBaseName(), suffix, fi.absoluteFilePath(), fi.size() );
+      }
+      else if ( SUPPORTED_RASTER_EXTENSIONS.contains( suffix ) )
+      {
+        datasets << Item( ItemMetaType::Dataset, ItemType::RasterDataset, fi.completeBaseName(), suffix, fi.absoluteFilePath(), fi.size() );
+      }
+      else if ( SUPPORTED_FILE_EXTENSIONS.contains( suffix ) )
+      {
+        files << Item( ItemMetaType::File, ItemType::OtherFile, fi.completeBaseName(), suffix, fi.absoluteFilePath(), fi.size() );
+      }
     }
   }
 
-  endResetModel();
+  return QList<Item>() << folders << projects << datasets << files;
+}
+
+void LocalFilesModel::scanFinished()
+{
+  if ( mScanPath.isEmpty() || mScanPath != currentPath() )
+    return;
+
+  const QList<Item> items = mScanWatcher.result();
+  cacheListing( mScanPath, items );
+  mScanPath.clear();
+
+  appendItems( items );
+  setIsLoading( false );
+}
+
+void LocalFilesModel::appendItems( const QList<Item> &items )
+{
+  const bool appendScheduled = !mPendingItems.isEmpty();
+  mPendingItems << items;
+  if ( !appendScheduled )
+  {
+    appendPendingItems();
+  }
+}
+
+void LocalFilesModel::appendPendingItems()
+{
+  if ( mPendingItems.isEmpty() )
+    return;
+
+  const qsizetype count = std::min<qsizetype>( mPendingItems.size(), APPEND_CHUNK_SIZE );
+  beginInsertRows( QModelIndex(), static_cast<int>( mItems.size() ), static_cast<int>( mItems.size() + count - 1 ) );
+  mItems << mPendingItems.mid( 0, count );
+  mPendingItems.remove( 0, count );
+  endInsertRows();
+
+  if ( !mPendingItems.isEmpty() )
+  {
+    // let the user interface render the first chunks before appending the next one
+    QTimer::singleShot( 0, this, &LocalFilesModel::appendPendingItems );
+  }
+}
+
+void LocalFilesModel::cacheListing( const QString &path, const QList<Item> &items )
+{
+  mListingCache.insert( path, items );
+  mListingCacheOrder.removeAll( path );
+  mListingCacheOrder << path;
+  mFileSystemWatcher.addPath( path );
+
+  while ( mListingCacheOrder.size() > LISTING_CACHE_SIZE )
+  {
+    const QString evictedPath = mListingCacheOrder.takeFirst();
+    mListingCache.remove( evictedPath );
+    mFileSystemWatcher.removePath( evictedPath );
+  }
+}
+
+void LocalFilesModel::clearListingCache()
+{
+  if ( !mListingCacheOrder.isEmpty() )
+  {
+    mFileSystemWatcher.removePaths( mListingCacheOrder );
+  }
+  mListingCache.clear();
+  mListingCacheOrder.clear();
+}
+
+void LocalFilesModel::directoryChanged( const QString &path )
+{
+  // the next visit of the directory will scan it again
+  mListingCache.remove( path );
+  mListingCacheOrder.removeAll( path );
+  mFileSystemWatcher.removePath( path );
+}
+
+void LocalFilesModel::setIsLoading( bool isLoading )
+{
+  if ( mIsLoading == isLoading )
+    return;
+
+  mIsLoading = isLoading;
+  emit isLoadingChanged();
 }
 
 int LocalFilesModel::rowCount( const QModelIndex &parent ) const
@@ -17,6 +17,8 @@
 #define LOCALFILESMODEL_H
 
 #include <QAbstractListModel>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
 
 /**
  * \ingroup core
@@ -30,6 +32,7 @@ class LocalFilesModel : public QAbstractListModel
     Q_PROPERTY( int currentDepth READ currentDepth NOTIFY currentPathChanged )
     Q_PROPERTY( bool isDeletedAllowedInCurrentPath READ isDeletedAllowedInCurrentPath NOTIFY currentPathChanged )
     Q_PROPERTY( bool inSelectionMode READ inSelectionMode NOTIFY inSelectionModeChanged )
+    Q_PROPERTY( bool isLoading READ isLoading NOTIFY isLoadingChanged )
 
   public:
     enum ItemMetaType
@@ -145,21 +148,51 @@ class LocalFilesModel : public QAbstractListModel
     //! Set checked state of all items to false
     Q_INVOKABLE void clearSelection();
 
+    //! Returns TRUE while the content of the current path is being scanned
+    bool isLoading() const { return mIsLoading; }
+
   signals:
 
     void currentPathChanged();
 
     void inSelectionModeChanged();
 
+    void isLoadingChanged();
+
   private:
     void reloadModel();
     const QString getCurrentTitleFromPath( const QString &path ) const;
 
+    //! Lists and classifies the content of the directory at \a path. This method is thread safe.
+    static QList<Item> scanDirectory( const QString &path );
+
+    void scanFinished();
+
+    //! Appends the \a items to the model, in chunks to keep the user interface responsive for large directories
+    void appendItems( const QList<Item> &items );
+    void appendPendingItems();
+
+    void cacheListing( const QString &path, const QList<Item> &items );
+    void clearListingCache();
+    void directoryChanged( const QString &path );
+
+    void setIsLoading( bool isLoading );
+
     QStringList mHistory;
     QList<Item> mItems;
 
     QStringList mFavorites;
 
+    bool mIsLoading = false;
+    QFutureWatcher<QList<Item>> mScanWatcher;
+    QString mScanPath;
+    QList<Item> mPendingItems;
+
+    //! Listings of the recently visited directories, invalidated by the file system watcher
+    QHash<QString, QList<Item>> mListingCache;
+    QStringList mListingCacheOrder;
+    QFileSystemWatcher mFileSystemWatcher;
+
     QString mCreatedProjectsPath;
     QString mImportedProjectsPath;
     QString mImportedDatasetsPath;
@@ -16,6 +16,7 @@
 
 #include "activelayerfeatureslocatorfilter.h"
 #include "featurelistextentcontroller.h"
+#include "featuresearchindex.h"
 #include "locatormodelsuperbridge.h"
 #include "qgsquickmapsettings.h"
 
@@ -79,6 +80,13 @@ QStringList ActiveLayerFeaturesLocatorFilter::prepare( const QString &string, co
   bool allowNumeric = false;
   double numericalValue = searchString.toDouble( &allowNumeric );
 
+  // on large layers, only fetch the candidates of the search index and filter them while fetching the results
+  QgsFeatureIds candidates;
+  FeatureSearchIndex *searchIndex = FeatureSearchIndex::indexForLayer( layer );
+  const bool useCandidates = !allowNumeric && searchIndex && searchIndex->candidates( searchString, candidates );
+  mDisplayTitleFilterExpression = QgsExpression();
+  mFieldFilterExpression = QgsExpression();
+
   // search in display expression if no field restriction
   if ( !isRestricting )
   {
@@ -94,9 +102,18 @@ QStringList ActiveLayerFeaturesLocatorFilter::prepare( const QString &string, co
     }
     QString enhancedSearch = searchString;
     enhancedSearch.replace( ' ', '%' );
-    req.setFilterExpression( QStringLiteral( "%1 ILIKE '%%2%'" )
-                               .arg( layer->displayExpression(), enhancedSearch ) );
-    req.setLimit( mMaxTotalResults );
+    const QString filterString = QStringLiteral( "%1 ILIKE '%%2%'" ).arg( layer->displayExpression(), enhancedSearch );
+    if ( useCandidates )
+    {
+      req.setFilterFids( candidates );
+      mDisplayTitleFilterExpression = QgsExpression( filterString );
+      mDisplayTitleFilterExpression.prepare( &mContext );
+    }
+    else
+    {
+      req.setFilterExpression( filterString );
+      req.setLimit( mMaxTotalResults );
+    }
     mDisplayTitleIterator = layer->getFeatures( req );
   }
   else
@@ -169,13 +186,22 @@ QStringList ActiveLayerFeaturesLocatorFilter::prepare( const QString &string, co
     req.setFlags( QgsFeatureRequest::NoGeometry );
 #endif
   }
-  req.setFilterExpression( expression );
+  if ( useCandidates )
+  {
+    req.setFilterFids( candidates );
+    mFieldFilterExpression = QgsExpression( expression );
+    mFieldFilterExpression.prepare( &mContext );
+  }
+  else
+  {
+    req.setFilterExpression( expression );
+    req.setLimit( mMaxTotalResults );
+  }
   if ( isRestricting )
   {
     req.setSubsetOfAttributes( subsetOfAttributes );
   }
 
-  req.setLimit( mMaxTotalResults );
   mFieldIterator = layer->getFeatures( req );
 
   mLayerId = layer->id();
@@ -228,6 +254,9 @@ void ActiveLayerFeaturesLocatorFilter::fetchResults( const QString &string, cons
 
       mContext.setFeature( f );
 
+      if ( !mDisplayTitleFilterExpression.expression().isEmpty() && !mDisplayTitleFilterExpression.evaluate( &mContext ).toBool() )
+        continue;
+
       QgsLocatorResult result;
       result.displayString = mDispExpression.evaluate( &mContext ).toString();
       result.group = mLayerName;
@@ -266,6 +295,9 @@ void ActiveLayerFeaturesLocatorFilter::fetchResults( const QString &string, cons
 
     mContext.setFeature( f );
 
+    if ( !mFieldFilterExpression.expression().isEmpty() && !mFieldFilterExpression.evaluate( &mContext ).toBool() )
+      continue;
+
     // find matching field content
     int idx = 0;
     const QgsAttributes attributes = f.attributes();
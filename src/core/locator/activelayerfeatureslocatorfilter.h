@@ -72,6 +72,9 @@ class ActiveLayerFeaturesLocatorFilter : public QgsLocatorFilter
     QgsExpressionContext mContext;
     QgsFeatureIterator mDisplayTitleIterator;
     QgsFeatureIterator mFieldIterator;
+    //! Set when the iterators only fetch the search index candidates, which must still match these filters
+    QgsExpression mDisplayTitleFilterExpression;
+    QgsExpression mFieldFilterExpression;
     QString mLayerId;
     QString mLayerName;
     bool mLayerIsSpatial = false;
@@ -0,0 +1,235 @@
+/***************************************************************************
+  featuresearchindex.cpp
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "featuresearchindex.h"
+
+#include <QRegularExpression>
+#include <QtConcurrent>
+#include <qgsexpressioncontextutils.h>
+#include <qgsfeedback.h>
+#include <qgsvectorlayer.h>
+#include <qgsvectorlayerfeatureiterator.h>
+
+#include <algorithm>
+
+#define SEARCH_INDEX_MINIMUM_FEATURE_COUNT 20000
+#define SEARCH_INDEX_MAXIMUM_CHANGED_FEATURES 1000
+
+
+FeatureSearchIndex *FeatureSearchIndex::indexForLayer( QgsVectorLayer *layer )
+{
+  if ( !layer )
+    return nullptr;
+
+  FeatureSearchIndex *index = layer->findChild<FeatureSearchIndex *>( QString(), Qt::FindDirectChildrenOnly );
+  if ( !index && isIndexable( layer ) )
+  {
+    index = new FeatureSearchIndex( layer );
+  }
+
+  return index;
+}
+
+bool FeatureSearchIndex::isIndexable( QgsVectorLayer *layer )
+{
+  if ( !layer || !layer->isValid() || !layer->dataProvider() )
+    return false;
+
+  const QVariant searchIndex = layer->customProperty( QStringLiteral( "QFieldSync/search_index" ) );
+  if ( searchIndex.isValid() )
+    return searchIndex.toBool();
+
+  return layer->featureCount() >= SEARCH_INDEX_MINIMUM_FEATURE_COUNT;
+}
+
+FeatureSearchIndex::FeatureSearchIndex( QgsVectorLayer *layer )
+  : QObject( layer )
+  , mLayer( layer )
+{
+  connect( &mBuildWatcher, &QFutureWatcher<std::shared_ptr<Data>>::finished, this, [this] {
+    mData = mBuildWatcher.result();
+    mBuildFeedback.reset();
+    if ( mData )
+      emit readyChanged();
+  } );
+
+  // edited features are candidates of every search until the index is rebuilt
+  connect( layer, &QgsVectorLayer::featureAdded, this, &FeatureSearchIndex::featureChanged );
+  connect( layer, &QgsVectorLayer::attributeValueChanged, this, [this]( QgsFeatureId fid, int, const QVariant & ) { featureChanged( fid ); } );
+  connect( layer, &QgsVectorLayer::committedFeaturesAdded, this, [this]( const QString &, const QgsFeatureList &features ) {
+    for ( const QgsFeature &feature : features )
+      featureChanged( feature.id() );
+  } );
+
+  connect( layer, &QgsVectorLayer::displayExpressionChanged, this, &FeatureSearchIndex::rebuild );
+  connect( layer, &QgsVectorLayer::subsetStringChanged, this, &FeatureSearchIndex::rebuild );
+  connect( layer, &QgsMapLayer::dataSourceChanged, this, &FeatureSearchIndex::rebuild );
+
+  rebuild();
+}
+
+FeatureSearchIndex::~FeatureSearchIndex()
+{
+  if ( mBuildFeedback )
+    mBuildFeedback->cancel();
+  mBuildWatcher.waitForFinished();
+}
+
+void FeatureSearchIndex::appendTrigrams( const QString &text, QSet<quint64> &trigrams )
+{
+  const QString lowerText = text.toLower();
+  const QChar *chars = lowerText.constData();
+  for ( qsizetype i = 0; i + 2 < lowerText.size(); i++ )
+  {
+    trigrams.insert( static_cast<quint64>( chars[i].unicode() ) << 32 | static_cast<quint64>( chars[i + 1].unicode() ) << 16 | chars[i + 2].unicode() );
+  }
+}
+
+void FeatureSearchIndex::rebuild()
+{
+  if ( mBuildFeedback )
+    mBuildFeedback->cancel();
+
+  const bool wasReady = isReady();
+  mData.reset();
+  mChangedFeatureIds.clear();
+  if ( wasReady )
+    emit readyChanged();
+
+  if ( !mLayer || !mLayer->isValid() )
+    return;
+
+  QgsExpressionContext context;
+  context.appendScopes( QgsExpressionContextUtils::globalProjectLayerScopes( mLayer ) );
+  QgsExpression expression( mLayer->displayExpression() );
+  expression.prepare( &context );
+
+  // the display expression and the text attributes are searched by the locator filters
+  QgsAttributeList attributes = expression.referencedAttributeIndexes( mLayer->fields() ).values();
+  QgsAttributeList textAttributes;
+  const QgsFields fields = mLayer->fields();
+  for ( int i = 0; i < fields.count(); i++ )
+  {
+    if ( fields.at( i ).type() == QMetaType::QString )
+    {
+      textAttributes << i;
+      if ( !attributes.contains( i ) )
+        attributes << i;
+    }
+  }
+
+  QgsFeatureRequest request;
+  request.setSubsetOfAttributes( attributes );
+  if ( !expression.needsGeometry() )
+#if _QGIS_VERSION_INT >= 33500
+    request.setFlags( Qgis::FeatureRequestFlag::NoGeometry );
+#else
+    request.setFlags( QgsFeatureRequest::NoGeometry );
+#endif
+
+  std::shared_ptr<QgsVectorLayerFeatureSource> source = std::make_shared<QgsVectorLayerFeatureSource>( mLayer );
+  std::shared_ptr<QgsFeedback> feedback = std::make_shared<QgsFeedback>();
+  mBuildFeedback = feedback;
+
+  mBuildWatcher.setFuture( QtConcurrent::run( [source, request, expression, context, textAttributes, feedback]() mutable -> std::shared_ptr<Data> {
+    std::shared_ptr<Data> data = std::make_shared<Data>();
+    QSet<quint64> trigrams;
+    QgsFeature feature;
+    QgsFeatureIterator it = source->getFeatures( request );
+    while ( it.nextFeature( feature ) )
+    {
+      if ( feedback->isCanceled() )
+        return nullptr;
+
+      trigrams.clear();
+      context.setFeature( feature );
+      appendTrigrams( expression.evaluate( &context ).toString(), trigrams );
+      for ( int attribute : std::as_const( textAttributes ) )
+        appendTrigrams( feature.attribute( attribute ).toString(), trigrams );
+
+      // features are numbered in iteration order, the postings are therefore sorted
+      const int position = static_cast<int>( data->featureIds.size() );
+      data->featureIds << feature.id();
+      for ( quint64 trigram : std::as_const( trigrams ) )
+        data->postings[trigram] << position;
+    }
+
+    for ( QVector<int> &positions : data->postings )
+      positions.squeeze();
+
+    return data;
+  } ) );
+}
+
+void FeatureSearchIndex::featureChanged( QgsFeatureId fid )
+{
+  mChangedFeatureIds << fid;
+
+  // past this point, the candidates are not selective enough anymore
+  if ( mChangedFeatureIds.size() > SEARCH_INDEX_MAXIMUM_CHANGED_FEATURES && isReady() )
+    rebuild();
+}
+
+bool FeatureSearchIndex::candidates( const QString &searchString, QgsFeatureIds &candidates ) const
+{
+  candidates.clear();
+  if ( !mData )
+    return false;
+
+  // every part of the pattern between wildcards appears in the matching values
+  static const QRegularExpression sWildcards( QStringLiteral( "[\\s%_]+" ) );
+  const QStringList parts = searchString.split( sWildcards, Qt::SkipEmptyParts );
+  QSet<quint64> trigrams;
+  for ( const QString &part : parts )
+    appendTrigrams( part, trigrams );
+
+  if ( trigrams.isEmpty() )
+    return false;
+
+  QVector<const QVector<int> *> postings;
+  postings.reserve( trigrams.size() );
+  for ( quint64 trigram : std::as_const( trigrams ) )
+  {
+    auto it = mData->postings.constFind( trigram );
+    if ( it == mData->postings.constEnd() )
+    {
+      postings.clear();
+      break;
+    }
+    postings << &it.value();
+  }
+
+  if ( !postings.isEmpty() )
+  {
+    // intersect the shortest lists first
+    std::sort( postings.begin(), postings.end(), []( const QVector<int> *a, const QVector<int> *b ) { return a->size() < b->size(); } );
+    QVector<int> positions = *postings.at( 0 );
+    QVector<int> intersection;
+    for ( int i = 1; i < postings.size() && !positions.isEmpty(); i++ )
+    {
+      intersection.clear();
+      std::set_intersection( positions.constBegin(), positions.constEnd(), postings.at( i )->constBegin(), postings.at( i )->constEnd(), std::back_inserter( intersection ) );
+      positions.swap( intersection );
+    }
+
+    candidates.reserve( positions.size() + mChangedFeatureIds.size() );
+    for ( int position : std::as_const( positions ) )
+      candidates << mData->featureIds.at( position );
+  }
+
+  candidates.unite( mChangedFeatureIds );
+  return true;
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+  featuresearchindex.h
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef FEATURESEARCHINDEX_H
+#define FEATURESEARCHINDEX_H
+
+#include "qfield_core_export.h"
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <qgsfeatureid.h>
+
+#include <memory>
+
+class QgsFeedback;
+class QgsVectorLayer;
+
+/**
+ * \brief An in-memory trigram index of the display expression and text attributes of a vector layer's features.
+ *
+ * The locator filters use it to narrow down their `ILIKE '%term%'` searches to a few candidate features
+ * instead of scanning the whole layer on every keystroke. The index is built on a worker thread
+ * the first time a layer is searched, the searches scan the layer until it is ready.
+ *
+ * The features added or modified after the index was built are always returned as candidates,
+ * so the candidates are a superset of the matching features which still need to be filtered.
+ * \ingroup core
+ */
+class QFIELD_CORE_EXPORT FeatureSearchIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * Returns the search index of the \a layer, created on first use, or nullptr if the layer is not indexed.
+     * \see isIndexable()
+     */
+    static FeatureSearchIndex *indexForLayer( QgsVectorLayer *layer );
+
+    /**
+     * Returns TRUE if the \a layer is indexed. Large layers are indexed unless their `QFieldSync/search_index`
+     * custom property is FALSE, smaller ones only if it is TRUE.
+     */
+    static bool isIndexable( QgsVectorLayer *layer );
+
+    //! Creates a search index of \a layer, owned by the layer
+    explicit FeatureSearchIndex( QgsVectorLayer *layer );
+    ~FeatureSearchIndex() override;
+
+    //! Returns TRUE once the index is built
+    bool isReady() const { return static_cast<bool>( mData ); }
+
+    /**
+     * Returns in \a candidates the features whose display expression or text attributes may match the
+     * case insensitive LIKE pattern `%searchString%`, where spaces, `%` and `_` are wildcards.
+     * \returns FALSE if the index cannot narrow down the search, when it is not ready or the search string
+     * has no part of at least three characters.
+     */
+    bool candidates( const QString &searchString, QgsFeatureIds &candidates ) const;
+
+  signals:
+    //! Emitted when the index is built or invalidated
+    void readyChanged();
+
+  private:
+    struct Data
+    {
+        //! The indexed features, the postings refer to their position in this list
+        QVector<QgsFeatureId> featureIds;
+        //! The sorted positions of the features for each trigram
+        QHash<quint64, QVector<int>> postings;
+    };
+
+    static void appendTrigrams( const QString &text, QSet<quint64> &trigrams );
+
+    void rebuild();
+    void featureChanged( QgsFeatureId fid );
+
+    QPointer<QgsVectorLayer> mLayer;
+    std::shared_ptr<Data> mData;
+    QgsFeatureIds mChangedFeatureIds;
+    QFutureWatcher<std::shared_ptr<Data>> mBuildWatcher;
+    std::shared_ptr<QgsFeedback> mBuildFeedback;
+};
+
+#endif // FEATURESEARCHINDEX_H
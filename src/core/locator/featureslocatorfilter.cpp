@@ -15,6 +15,7 @@
  ***************************************************************************/
 
 #include "featurelistextentcontroller.h"
+#include "featuresearchindex.h"
 #include "featureslocatorfilter.h"
 #include "locatormodelsuperbridge.h"
 #include "qgsquickmapsettings.h"
@@ -71,10 +72,26 @@ QStringList FeaturesLocatorFilter::prepare( const QString &string, const QgsLoca
 #endif
     QString enhancedSearch = string;
     enhancedSearch.replace( " ", "%" );
-    req.setFilterExpression( QStringLiteral( "%1 ILIKE '%%2%'" ).arg( layer->displayExpression(), enhancedSearch ) );
-    req.setLimit( 30 );
+    const QString filterString = QStringLiteral( "%1 ILIKE '%%2%'" ).arg( layer->displayExpression(), enhancedSearch );
 
     std::shared_ptr<PreparedLayer> preparedLayer( new PreparedLayer() );
+
+    // on large layers, only fetch the candidates of the search index and filter them while fetching the results
+    QgsFeatureIds candidates;
+    FeatureSearchIndex *searchIndex = FeatureSearchIndex::indexForLayer( layer );
+    if ( searchIndex && searchIndex->candidates( string, candidates ) )
+    {
+      req.setFilterFids( candidates );
+      preparedLayer->filterExpression = QgsExpression( filterString );
+      preparedLayer->filterExpression.prepare( &expressionContext );
+      preparedLayer->filterCandidates = true;
+    }
+    else
+    {
+      req.setFilterExpression( filterString );
+      req.setLimit( 30 );
+    }
+
     preparedLayer->expression = expression;
     preparedLayer->context = expressionContext;
     preparedLayer->layerId = layer->id();
@@ -110,6 +127,9 @@ void FeaturesLocatorFilter::fetchResults( const QString &string, const QgsLocato
 
       preparedLayer->context.setFeature( f );
 
+      if ( preparedLayer->filterCandidates && !preparedLayer->filterExpression.evaluate( &( preparedLayer->context ) ).toBool() )
+        continue;
+
       result.displayString = preparedLayer->expression.evaluate( &( preparedLayer->context ) ).toString();
 
 #if _QGIS_VERSION_INT >= 33300
@@ -51,6 +51,9 @@ class FeaturesLocatorFilter : public QgsLocatorFilter
         QgsExpressionContext context;
         std::unique_ptr<QgsVectorLayerFeatureSource> featureSource;
         QgsFeatureRequest request;
+        //! Set when the request only fetches the search index candidates, which must still match this filter
+        QgsExpression filterExpression;
+        bool filterCandidates = false;
         QString layerName;
         QString layerId;
         QIcon layerIcon;
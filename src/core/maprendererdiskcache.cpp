@@ -0,0 +1,311 @@
+/***************************************************************************
+  maprendererdiskcache.cpp - MapRendererDiskCache
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "fileutils.h"
+#include "maprendererdiskcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QStandardPaths>
+#include <QUuid>
+#include <QtConcurrentRun>
+#include <qgsmaplayer.h>
+#include <qgsmaplayertemporalproperties.h>
+#include <qgsmapsettings.h>
+#include <qgsproviderregistry.h>
+#include <qgsvectorlayer.h>
+
+#include <algorithm>
+
+
+MapRendererDiskCache::MapRendererDiskCache( const QString &directory, qint64 maximumSize )
+  : mDirectory( directory.isEmpty() ? QStringLiteral( "%1/map_renders" ).arg( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) ) : directory )
+  , mMaximumSize( maximumSize )
+{
+  // writes and removals are serialized, a removal never races with a pending write
+  mThreadPool.setMaxThreadCount( 1 );
+}
+
+MapRendererDiskCache::~MapRendererDiskCache()
+{
+  mThreadPool.waitForDone();
+}
+
+bool MapRendererDiskCache::isCacheable( const QgsMapLayer *layer )
+{
+  if ( !layer || !layer->isValid() )
+    return false;
+
+  switch ( layer->type() )
+  {
+    case Qgis::LayerType::Raster:
+    case Qgis::LayerType::VectorTile:
+      break;
+
+    case Qgis::LayerType::Vector:
+      // the rendering of editable layers changes with every edit
+      if ( qobject_cast<const QgsVectorLayer *>( layer )->supportsEditing() )
+        return false;
+      break;
+
+    default:
+      return false;
+  }
+
+  if ( layer->temporalProperties() && layer->temporalProperties()->isActive() )
+    return false;
+
+  return true;
+}
+
+QByteArray MapRendererDiskCache::styleHash( const QgsMapLayer *layer )
+{
+  QDomDocument style;
+  QString errorMessage;
+  layer->exportNamedStyle( style, errorMessage );
+  return QCryptographicHash::hash( style.toByteArray(), QCryptographicHash::Sha1 );
+}
+
+QString MapRendererDiskCache::key( const QgsMapLayer *layer, const QgsMapSettings &mapSettings )
+{
+  return key( layer, styleHash( layer ), mapSettings );
+}
+
+QString MapRendererDiskCache::key( const QgsMapLayer *layer, const QByteArray &styleHash, const QgsMapSettings &mapSettings )
+{
+  QCryptographicHash hash( QCryptographicHash::Sha1 );
+  hash.addData( layer->providerType().toUtf8() );
+  hash.addData( layer->source().toUtf8() );
+
+  // local datasets replaced by a synchronization render differently
+  const QString path = QgsProviderRegistry::instance()->decodeUri( layer->providerType(), layer->source() ).value( QStringLiteral( "path" ) ).toString();
+  if ( !path.isEmpty() )
+  {
+    const QFileInfo fileInfo( path );
+    hash.addData( QStringLiteral( "|%1|%2" ).arg( fileInfo.size() ).arg( fileInfo.lastModified().toMSecsSinceEpoch() ).toUtf8() );
+  }
+
+  hash.addData( styleHash );
+
+  // the extent is rounded to a tenth of a pixel, restored extents are not always bit identical
+  const double mapUnitsPerPixel = mapSettings.mapUnitsPerPixel();
+  const QgsPointXY center = mapSettings.visibleExtent().center();
+  hash.addData( QStringLiteral( "|%1|%2|%3|%4|%5x%6|%7|%8|%9" )
+                  .arg( mapSettings.destinationCrs().authid() )
+                  .arg( qRound64( center.x() * 10 / mapUnitsPerPixel ) )
+                  .arg( qRound64( center.y() * 10 / mapUnitsPerPixel ) )
+                  .arg( mapUnitsPerPixel, 0, 'g', 10 )
+                  .arg( mapSettings.outputSize().width() )
+                  .arg( mapSettings.outputSize().height() )
+                  .arg( mapSettings.outputDpi(), 0, 'g', 6 )
+                  .arg( mapSettings.devicePixelRatio(), 0, 'g', 6 )
+                  .arg( mapSettings.rotation(), 0, 'g', 6 )
+                  .toUtf8() );
+
+  return QString::fromLatin1( hash.result().toHex() );
+}
+
+QString MapRendererDiskCache::layerDirectory( const QString &layerId ) const
+{
+  return QStringLiteral( "%1/%2" ).arg( mDirectory, FileUtils::sanitizeFilePathPart( layerId ) );
+}
+
+QString MapRendererDiskCache::imagePath( const QString &layerId, const QString &key ) const
+{
+  return QStringLiteral( "%1/%2.png" ).arg( layerDirectory( layerId ), key );
+}
+
+bool MapRendererDiskCache::contains( const QString &layerId, const QString &key ) const
+{
+  return QFile::exists( imagePath( layerId, key ) );
+}
+
+QImage MapRendererDiskCache::image( const QString &layerId, const QString &key )
+{
+  const QString path = imagePath( layerId, key );
+  QFile file( path );
+  if ( !file.open( QIODevice::ReadOnly ) )
+    return QImage();
+
+  QImage image;
+  if ( !image.loadFromData( file.readAll(), "PNG" ) )
+    return QImage();
+
+  // the modification time orders the images for eviction, it is persisted for the next sessions
+  const QDateTime now = QDateTime::currentDateTime();
+  file.setFileTime( now, QFileDevice::FileModificationTime );
+  QtConcurrent::run( &mThreadPool, [this, path, lastUsed = now.toMSecsSinceEpoch()] {
+    touch( path, lastUsed );
+  } );
+
+  return image;
+}
+
+void MapRendererDiskCache::insert( const QString &layerId, const QString &key, const QImage &image )
+{
+  if ( image.isNull() )
+    return;
+
+  QtConcurrent::run( &mThreadPool, [this, path = imagePath( layerId, key ), image] {
+    write( path, image );
+    evict();
+  } );
+}
+
+void MapRendererDiskCache::invalidate( const QString &layerId )
+{
+  const QString path = layerDirectory( layerId );
+  if ( !QFileInfo::exists( path ) )
+    return;
+
+  // move the images out of sight right away, they are deleted in the background
+  const QString removedPath = QStringLiteral( "%1/.removed-%2" ).arg( mDirectory, QUuid::createUuid().toString( QUuid::WithoutBraces ) );
+  if ( !QDir().rename( path, removedPath ) )
+  {
+    QDir( path ).removeRecursively();
+    return;
+  }
+
+  QtConcurrent::run( &mThreadPool, [this, path, removedPath] {
+    remove( path, removedPath );
+  } );
+}
+
+void MapRendererDiskCache::loadIndex()
+{
+  if ( mIndexLoaded )
+    return;
+
+  mIndexLoaded = true;
+  QDirIterator it( mDirectory, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories );
+  while ( it.hasNext() )
+  {
+    it.next();
+    const QFileInfo fileInfo = it.fileInfo();
+
+    IndexEntry entry;
+    entry.size = fileInfo.size();
+    entry.lastUsed = fileInfo.lastModified().toMSecsSinceEpoch();
+    mIndex.insert( fileInfo.absoluteFilePath(), entry );
+    mIndexSize += entry.size;
+  }
+}
+
+void MapRendererDiskCache::touch( const QString &path, qint64 lastUsed )
+{
+  loadIndex();
+
+  auto it = mIndex.find( QFileInfo( path ).absoluteFilePath() );
+  if ( it != mIndex.end() )
+    it->lastUsed = lastUsed;
+}
+
+void MapRendererDiskCache::remove( const QString &layerPath, const QString &removedPath )
+{
+  loadIndex();
+
+  QDir( removedPath ).removeRecursively();
+
+  // the images written after the layer directory was moved away are kept
+  const QString layerPrefix = QFileInfo( layerPath ).absoluteFilePath() + QLatin1Char( '/' );
+  const QString removedPrefix = QFileInfo( removedPath ).absoluteFilePath() + QLatin1Char( '/' );
+  for ( auto it = mIndex.begin(); it != mIndex.end(); )
+  {
+    if ( it.key().startsWith( removedPrefix ) || ( it.key().startsWith( layerPrefix ) && !QFile::exists( it.key() ) ) )
+    {
+      mIndexSize -= it->size;
+      it = mIndex.erase( it );
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void MapRendererDiskCache::write( const QString &path, const QImage &image )
+{
+  loadIndex();
+
+  if ( !QDir().mkpath( QFileInfo( path ).absolutePath() ) )
+    return;
+
+  // write through a temporary file, an interrupted write never leaves a truncated image behind
+  const QString tmpPath = QStringLiteral( "%1.%2.tmp" ).arg( path, QUuid::createUuid().toString( QUuid::WithoutBraces ) );
+  QImageWriter writer( tmpPath, "PNG" );
+  // Qt maps the PNG quality to a zlib compression level, 80 is level 1: the fastest to write, with
+  // reasonably small files, while the decoding speed hardly depends on the level
+  writer.setQuality( 80 );
+  if ( !writer.write( image ) )
+  {
+    QFile::remove( tmpPath );
+    return;
+  }
+
+  QFile::remove( path );
+  if ( !QFile::rename( tmpPath, path ) )
+    QFile::remove( tmpPath );
+
+  const QFileInfo fileInfo( path );
+  const QString absolutePath = fileInfo.absoluteFilePath();
+  auto it = mIndex.find( absolutePath );
+  if ( it != mIndex.end() )
+  {
+    mIndexSize -= it->size;
+    mIndex.erase( it );
+  }
+
+  if ( fileInfo.exists() )
+  {
+    IndexEntry entry;
+    entry.size = fileInfo.size();
+    entry.lastUsed = QDateTime::currentMSecsSinceEpoch();
+    mIndex.insert( absolutePath, entry );
+    mIndexSize += entry.size;
+  }
+}
+
+void MapRendererDiskCache::evict()
+{
+  if ( mIndexSize <= mMaximumSize )
+    return;
+
+  QList<QPair<qint64, QString>> images;
+  images.reserve( mIndex.size() );
+  for ( auto it = mIndex.constBegin(); it != mIndex.constEnd(); ++it )
+    images << qMakePair( it->lastUsed, it.key() );
+  std::sort( images.begin(), images.end() );
+
+  // leave some room, so the next insertions do not have to evict right away
+  const qint64 targetSize = mMaximumSize * 9 / 10;
+  for ( const QPair<qint64, QString> &image : std::as_const( images ) )
+  {
+    if ( mIndexSize <= targetSize )
+      break;
+
+    if ( QFile::remove( image.second ) || !QFile::exists( image.second ) )
+    {
+      mIndexSize -= mIndex.value( image.second ).size;
+      mIndex.remove( image.second );
+    }
+  }
+}
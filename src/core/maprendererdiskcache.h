@@ -0,0 +1,113 @@
+/***************************************************************************
+  maprendererdiskcache.h - MapRendererDiskCache
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MAPRENDERERDISKCACHE_H
+#define MAPRENDERERDISKCACHE_H
+
+#include "qfield_core_export.h"
+
+#include <QHash>
+#include <QImage>
+#include <QString>
+#include <QThreadPool>
+
+class QgsMapLayer;
+class QgsMapSettings;
+
+/**
+ * \brief A size-bounded disk cache of rendered layer images, which survives application restarts.
+ *
+ * The images are keyed by the layer id, its data source and style, and the rendered extent, scale,
+ * output size and DPI, so a cached image is only reused for an identical rendering. Only layers
+ * which cannot be edited are cached, the images of a layer are discarded when it requests a repaint.
+ *
+ * Images are written on a worker thread, the least recently used ones are evicted once the cache
+ * exceeds its maximum size. The worker thread keeps an index of the images and their size, the
+ * cache directory is only scanned once.
+ * \ingroup core
+ */
+class QFIELD_CORE_EXPORT MapRendererDiskCache
+{
+  public:
+    /**
+     * Creates a disk cache in \a directory, by default in the application cache location, holding up
+     * to \a maximumSize bytes of images.
+     */
+    explicit MapRendererDiskCache( const QString &directory = QString(), qint64 maximumSize = 200 * 1024 * 1024 );
+    ~MapRendererDiskCache();
+
+    //! Returns the directory of the cache
+    QString directory() const { return mDirectory; }
+
+    //! Returns TRUE if the rendered images of \a layer can be persisted
+    static bool isCacheable( const QgsMapLayer *layer );
+
+    //! Returns the key of the image of \a layer rendered with \a mapSettings
+    static QString key( const QgsMapLayer *layer, const QgsMapSettings &mapSettings );
+
+    /**
+     * Returns the key of the image of \a layer rendered with \a mapSettings, for a layer
+     * whose style hashes to \a styleHash.
+     * \see styleHash()
+     */
+    static QString key( const QgsMapLayer *layer, const QByteArray &styleHash, const QgsMapSettings &mapSettings );
+
+    //! Returns a hash of the style of \a layer, which only changes along with the layer style
+    static QByteArray styleHash( const QgsMapLayer *layer );
+
+    //! Returns TRUE if the cache holds an image of the layer with \a layerId for \a key
+    bool contains( const QString &layerId, const QString &key ) const;
+
+    /**
+     * Returns the image of the layer with \a layerId for \a key, or a null image if it is not cached.
+     * The image is marked as recently used. Can be called from any thread.
+     */
+    QImage image( const QString &layerId, const QString &key );
+
+    //! Writes the \a image of the layer with \a layerId for \a key in the background
+    void insert( const QString &layerId, const QString &key, const QImage &image );
+
+    //! Discards all images of the layer with \a layerId
+    void invalidate( const QString &layerId );
+
+  private:
+    struct IndexEntry
+    {
+        qint64 size = 0;
+        qint64 lastUsed = 0;
+    };
+
+    QString layerDirectory( const QString &layerId ) const;
+    QString imagePath( const QString &layerId, const QString &key ) const;
+
+    // the following are only called from the worker thread
+    void loadIndex();
+    void write( const QString &path, const QImage &image );
+    void touch( const QString &path, qint64 lastUsed );
+    void remove( const QString &layerPath, const QString &removedPath );
+    void evict();
+
+    QString mDirectory;
+    qint64 mMaximumSize = 0;
+    QThreadPool mThreadPool;
+
+    // the images on disk and their total size, only accessed from the worker thread
+    bool mIndexLoaded = false;
+    QHash<QString, IndexEntry> mIndex;
+    qint64 mIndexSize = 0;
+};
+
+#endif // MAPRENDERERDISKCACHE_H
@@ -73,6 +73,8 @@ void Geofencer::processAreas()
   mGatherer->deleteLater();
   mGatherer = nullptr;
 
+  indexAreas();
+
   if ( mActive )
   {
     checkWithin();
@@ -80,19 +82,64 @@ void Geofencer::processAreas()
   }
 }
 
+void Geofencer::indexAreas()
+{
+  mAreasIndex = QgsSpatialIndex();
+  mAreasBoundingBoxes.clear();
+  mPreparedAreas.clear();
+
+  mAreasBoundingBoxes.reserve( mAreas.size() );
+  for ( int i = 0; i < mAreas.size(); i++ )
+  {
+    const QgsGeometry &geometry = mAreas.at( i ).feature.geometry();
+    const QgsRectangle boundingBox = geometry.isEmpty() ? QgsRectangle() : geometry.boundingBox();
+
+    mAreasBoundingBoxes << boundingBox;
+    if ( !boundingBox.isNull() )
+    {
+      mAreasIndex.addFeature( i, boundingBox );
+    }
+  }
+}
+
+bool Geofencer::isPositionWithinArea( int index )
+{
+  auto it = mPreparedAreas.find( index );
+  if ( it == mPreparedAreas.end() )
+  {
+    std::unique_ptr<QgsGeometryEngine> geometryEngine( QgsGeometry::createGeometryEngine( mAreas.at( index ).feature.geometry().constGet() ) );
+    geometryEngine->prepareGeometry();
+    it = mPreparedAreas.emplace( index, std::move( geometryEngine ) ).first;
+  }
+
+  // an area contains the position exactly when the position is within the area
+  return it->second->contains( &mPosition );
+}
+
 void Geofencer::checkWithin()
 {
   int isWithinIndex = -1;
   if ( mActive && !mAreas.isEmpty() && !mPosition.isEmpty() )
   {
-    std::unique_ptr<QgsGeometryEngine> geometryEngine;
-    geometryEngine.reset( QgsGeometry::createGeometryEngine( &mPosition ) );
-    for ( int i = 0; i < mAreas.size(); i++ )
+    const QgsPointXY point( mPosition.x(), mPosition.y() );
+
+    // consecutive positions are most often within the same area, check it first
+    if ( mIsWithinIndex >= 0 && mIsWithinIndex < mAreasBoundingBoxes.size() && mAreasBoundingBoxes.at( mIsWithinIndex ).contains( point ) && isPositionWithinArea( mIsWithinIndex ) )
     {
-      if ( geometryEngine->within( mAreas.at( i ).feature.geometry().get() ) )
+      isWithinIndex = mIsWithinIndex;
+    }
+    else
+    {
+      QList<QgsFeatureId> candidates = mAreasIndex.intersects( QgsRectangle( point, point ) );
+      // keep the areas order, the first area containing the position wins
+      std::sort( candidates.begin(), candidates.end() );
+      for ( const QgsFeatureId candidate : std::as_const( candidates ) )
       {
-        isWithinIndex = i;
-        break;
+        if ( isPositionWithinArea( static_cast<int>( candidate ) ) )
+        {
+          isWithinIndex = static_cast<int>( candidate );
+          break;
+        }
       }
     }
   }
@@ -22,13 +22,21 @@
 #include <QObject>
 #include <QTimer>
 #include <qgscoordinatereferencesystem.h>
+#include <qgsgeometryengine.h>
 #include <qgspoint.h>
+#include <qgsspatialindex.h>
 #include <qgsvectorlayer.h>
 
+#include <unordered_map>
+
 /**
  * This class provides an interface to manage geofencing of areas as well as
  * providing feedback whenever the position trespasses into or out of those
  * areas.
+ *
+ * The areas are spatially indexed by bounding box, and only the candidate areas
+ * of a position are tested using prepared geometries, so that frequent position
+ * updates remain cheap with many complex areas.
  * \ingroup core
  */
 class Geofencer : public QObject
@@ -156,6 +164,10 @@ class Geofencer : public QObject
     void cleanupGatherer();
     void gatherAreas();
     void processAreas();
+    void indexAreas();
+
+    //! Returns TRUE if the current position is within the area at \a index, preparing its geometry on first use
+    bool isPositionWithinArea( int index );
 
     void checkWithin();
     void checkAlert();
@@ -168,6 +180,9 @@ class Geofencer : public QObject
 
     QPointer<QgsVectorLayer> mAreasLayer;
     QList<FeatureExpressionValuesGatherer::Entry> mAreas;
+    QList<QgsRectangle> mAreasBoundingBoxes;
+    QgsSpatialIndex mAreasIndex;
+    std::unordered_map<int, std::unique_ptr<QgsGeometryEngine>> mPreparedAreas;
 
     bool mIsAlerting = false;
 
@@ -20,6 +20,8 @@
 #include <QFileInfo>
 #include <QSettings>
 
+#include <cmath>
+
 NmeaGnssReceiver::NmeaGnssReceiver( QObject *parent )
   : AbstractGnssReceiver( parent )
   , mImuPosition()
@@ -28,11 +30,16 @@ NmeaGnssReceiver::NmeaGnssReceiver( QObject *parent )
 
 void NmeaGnssReceiver::initNmeaConnection( QIODevice *ioDevice )
 {
+  // Connected ahead of the QgsNmeaConnection, to peek at the received data before it gets consumed
+  connect( ioDevice, &QIODevice::readyRead, this, [this, ioDevice] { processReceivedData( ioDevice ); } );
+
   mNmeaConnection = std::make_unique<QgsNmeaConnection>( ioDevice );
 
+  // QgsNmeaConnection leaves chunks shorter than a sentence address in the device, they are peeked again with the next chunk
+  connect( ioDevice, &QIODevice::readyRead, this, [this, ioDevice] { mNmeaTokenizer.skipUnreadData( ioDevice ); } );
+
   //QgsGpsConnection state changed (received location string)
   connect( mNmeaConnection.get(), &QgsGpsConnection::stateChanged, this, &NmeaGnssReceiver::stateChanged );
-  connect( mNmeaConnection.get(), &QgsGpsConnection::nmeaSentenceReceived, this, &NmeaGnssReceiver::nmeaSentenceReceived );
 }
 
 void NmeaGnssReceiver::stateChanged( const QgsGpsInformation &info )
@@ -43,19 +50,19 @@ void NmeaGnssReceiver::stateChanged( const QgsGpsInformation &info )
   }
   mLastGnssPositionValid = !std::isnan( info.latitude );
 
-  bool ellipsoidalElevation = false;
-  double antennaHeight = 0.0;
-  if ( PositioningSource *positioningSource = qobject_cast<PositioningSource *>( parent() ) )
-  {
-    ellipsoidalElevation = positioningSource->elevationCorrectionMode() != PositioningSource::ElevationCorrectionMode::OrthometricFromDevice;
-    antennaHeight = positioningSource->antennaHeight();
-  }
-
+  // The state changes with every parsed sentence, the position information is only built once the first
+  // sentence of the next epoch is received and the previous epoch is complete
   if ( info.utcTime != mLastGnssPositionUtcTime )
   {
     mLastGnssPositionUtcTime = info.utcTime;
     if ( mImuPosition.valid )
     {
+      bool ellipsoidalElevation = false;
+      if ( PositioningSource *positioningSource = qobject_cast<PositioningSource *>( parent() ) )
+      {
+        ellipsoidalElevation = positioningSource->elevationCorrectionMode() != PositioningSource::ElevationCorrectionMode::OrthometricFromDevice;
+      }
+
       mLastGnssPositionInformation = GnssPositionInformation( mImuPosition.latitude, mImuPosition.longitude,
                                                               ellipsoidalElevation ? mImuPosition.altitude : mImuPosition.altitude - info.elevation_diff,
                                                               mImuPosition.speed * 1000 / 60 / 60, // QgsGpsInformation's speed is served in km/h, translate to m/s
@@ -70,32 +77,58 @@ void NmeaGnssReceiver::stateChanged( const QgsGpsInformation &info )
     }
     else
     {
-      mLastGnssPositionInformation = mCurrentNmeaGnssPositionInformation;
+      mLastGnssPositionInformation = positionInformation( mCurrentNmeaInformation );
     }
 
     emit lastGnssPositionInformationChanged( mLastGnssPositionInformation );
   }
 
-  mCurrentNmeaGnssPositionInformation = GnssPositionInformation( info.latitude, info.longitude,
-                                                                 info.elevation - antennaHeight + ( ellipsoidalElevation ? info.elevation_diff : 0 ),
-                                                                 info.speed * 1000 / 60 / 60, // QgsGpsInformation's speed is served in km/h, translate to m/s
-                                                                 info.direction,
-                                                                 info.satellitesInView, info.pdop, info.hdop, info.vdop,
-                                                                 info.hacc, info.vacc, info.utcDateTime, info.fixMode, info.fixType, info.quality, info.satellitesUsed, info.status,
-                                                                 info.satPrn, info.satInfoComplete, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(),
-                                                                 0, QStringLiteral( "nmea" ) );
+  mCurrentNmeaInformation = info;
 }
 
-void NmeaGnssReceiver::nmeaSentenceReceived( const QString &substring )
+GnssPositionInformation NmeaGnssReceiver::positionInformation( const QgsGpsInformation &info ) const
 {
-  if ( mLogFile.isOpen() )
+  bool ellipsoidalElevation = false;
+  double antennaHeight = 0.0;
+  if ( PositioningSource *positioningSource = qobject_cast<PositioningSource *>( parent() ) )
   {
-    mLogStream << substring << Qt::endl;
+    ellipsoidalElevation = positioningSource->elevationCorrectionMode() != PositioningSource::ElevationCorrectionMode::OrthometricFromDevice;
+    antennaHeight = positioningSource->antennaHeight();
   }
 
-  if ( substring.startsWith( "$INS.NAVI" ) )
+  return GnssPositionInformation( info.latitude, info.longitude,
+                                  info.elevation - antennaHeight + ( ellipsoidalElevation ? info.elevation_diff : 0 ),
+                                  info.speed * 1000 / 60 / 60, // QgsGpsInformation's speed is served in km/h, translate to m/s
+                                  info.direction,
+                                  info.satellitesInView, info.pdop, info.hdop, info.vdop,
+                                  info.hacc, info.vacc, info.utcDateTime, info.fixMode, info.fixType, info.quality, info.satellitesUsed, info.status,
+                                  info.satPrn, info.satInfoComplete, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(),
+                                  0, QStringLiteral( "nmea" ) );
+}
+
+void NmeaGnssReceiver::processReceivedData( QIODevice *ioDevice )
+{
+  const bool logging = mLogFile.isOpen();
+  mNmeaTokenizer.feed( ioDevice );
+
+  QByteArrayView sentence;
+  while ( mNmeaTokenizer.nextSentence( sentence ) )
   {
-    processImuSentence( substring );
+    if ( logging )
+    {
+      mLogFile.write( sentence.data(), sentence.size() );
+      mLogFile.write( "\n", 1 );
+    }
+
+    if ( sentence.startsWith( "$INS.NAVI" ) )
+    {
+      processImuSentence( sentence );
+    }
+  }
+
+  if ( logging )
+  {
+    mLogFile.flush();
   }
 }
 
@@ -108,7 +141,6 @@ void NmeaGnssReceiver::handleStartLogging( const QString &path )
 
     mLogFile.setFileName( QStringLiteral( "%1/nmea-%2.log" ).arg( path, QDateTime::currentDateTime().toString( QStringLiteral( "yyyy-MM-ddThh:mm:ss" ) ) ) );
     mLogFile.open( QIODevice::WriteOnly );
-    mLogStream.setDevice( &mLogFile );
   }
 }
 
@@ -129,22 +161,20 @@ GnssPositionDetails NmeaGnssReceiver::details() const
   return dataList;
 }
 
-void NmeaGnssReceiver::processImuSentence( const QString &sentence )
+void NmeaGnssReceiver::processImuSentence( QByteArrayView sentence )
 {
   static const int PARAMETER_STATUS_INDEX = 19;
 
   static const int IMU_KQGEO_STATUS_OK = 1026;
   static const int IMU_KQGEO_STATUS_OK_NEW = 1967106;
 
-  // Remove checksum
-  const QString sentenceWithoutChecksum = sentence.split( '*' ).first();
-  QStringList parameters = sentenceWithoutChecksum.split( ',' );
-  if ( parameters.size() <= PARAMETER_STATUS_INDEX )
+  NmeaTokenizer::splitFields( sentence, mImuFields );
+  if ( mImuFields.size() <= PARAMETER_STATUS_INDEX )
     return;
 
   // Parse Status
   bool ok = false;
-  const int status = parameters[PARAMETER_STATUS_INDEX].toInt( &ok );
+  const int status = mImuFields[PARAMETER_STATUS_INDEX].toInt( &ok );
   if ( ok == false )
   {
     mImuPosition.valid = false;
@@ -159,18 +189,26 @@ void NmeaGnssReceiver::processImuSentence( const QString &sentence )
 
   // Parse other parameters
   mImuPosition.utcDateTime = QDateTime::currentDateTime();
-  QTime time = QTime::fromString( parameters[1], "hhmmss.zzz" );
-  if ( time.isValid() )
-    mImuPosition.utcDateTime.setTime( time );
+  const QByteArrayView time = mImuFields[1];
+  if ( time.size() >= 6 )
+  {
+    // hhmmss followed by optional decimal seconds
+    const int hours = time.first( 2 ).toInt();
+    const int minutes = time.sliced( 2, 2 ).toInt();
+    const double seconds = time.sliced( 4 ).toDouble();
+    const QTime utcTime( hours, minutes, static_cast<int>( seconds ), static_cast<int>( std::round( ( seconds - std::floor( seconds ) ) * 1000 ) ) % 1000 );
+    if ( utcTime.isValid() )
+      mImuPosition.utcDateTime.setTime( utcTime );
+  }
 
   bool latitudeOk;
-  mImuPosition.latitude = parameters[2].toDouble( &latitudeOk );
+  mImuPosition.latitude = mImuFields[2].toDouble( &latitudeOk );
 
   bool longitudeOk;
-  mImuPosition.longitude = parameters[3].toDouble( &longitudeOk );
+  mImuPosition.longitude = mImuFields[3].toDouble( &longitudeOk );
 
   bool altitudeOk;
-  mImuPosition.altitude = parameters[4].toDouble( &altitudeOk );
+  mImuPosition.altitude = mImuFields[4].toDouble( &altitudeOk );
 
   if ( !latitudeOk || !longitudeOk || !altitudeOk )
   {
@@ -178,10 +216,10 @@ void NmeaGnssReceiver::processImuSentence( const QString &sentence )
     return;
   }
 
-  double speedNorth = parameters[5].toDouble();
-  double speedEast = parameters[6].toDouble();
+  double speedNorth = mImuFields[5].toDouble();
+  double speedEast = mImuFields[6].toDouble();
   mImuPosition.speed = sqrt( speedNorth * speedNorth + speedEast * speedEast );
-  mImuPosition.speedDown = parameters[7].toDouble();
+  mImuPosition.speedDown = mImuFields[7].toDouble();
   mImuPosition.direction = 0.0;
   if ( speedEast != 0.0 )
     mImuPosition.direction = atan( speedNorth / speedEast );
@@ -190,17 +228,17 @@ void NmeaGnssReceiver::processImuSentence( const QString &sentence )
   else if ( speedNorth < 0.0 )
     mImuPosition.direction = -M_PI_2;
 
-  mImuPosition.roll = parameters[8].toDouble();
-  mImuPosition.pitch = parameters[9].toDouble();
-  mImuPosition.heading = parameters[10].toDouble();
-  mImuPosition.steering = parameters[11].toDouble();
-  mImuPosition.accelerometerX = parameters[12].toDouble();
-  mImuPosition.accelerometerY = parameters[13].toDouble();
-  mImuPosition.accelerometerZ = parameters[14].toDouble();
-  mImuPosition.gyroX = parameters[15].toDouble();
-  mImuPosition.gyroY = parameters[16].toDouble();
-  mImuPosition.gyroZ = parameters[17].toDouble();
-  mImuPosition.steeringZ = parameters[18].toDouble();
+  mImuPosition.roll = mImuFields[8].toDouble();
+  mImuPosition.pitch = mImuFields[9].toDouble();
+  mImuPosition.heading = mImuFields[10].toDouble();
+  mImuPosition.steering = mImuFields[11].toDouble();
+  mImuPosition.accelerometerX = mImuFields[12].toDouble();
+  mImuPosition.accelerometerY = mImuFields[13].toDouble();
+  mImuPosition.accelerometerZ = mImuFields[14].toDouble();
+  mImuPosition.gyroX = mImuFields[15].toDouble();
+  mImuPosition.gyroY = mImuFields[16].toDouble();
+  mImuPosition.gyroZ = mImuFields[17].toDouble();
+  mImuPosition.steeringZ = mImuFields[18].toDouble();
 
   mImuPosition.valid = true;
 }
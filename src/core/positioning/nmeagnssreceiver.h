@@ -17,6 +17,7 @@
 #define NMEAGNSSRECEIVER_H
 
 #include "abstractgnssreceiver.h"
+#include "nmeatokenizer.h"
 #include "qgsnmeaconnection.h"
 
 #include <QFile>
@@ -25,6 +26,10 @@
 /**
  * The nmeareceiver connects to a device and feeds the QgsNmeaConnection.
  * It receives QgsGpsInformation and converts it to GnssPositionInformation
+ * once per epoch.
+ *
+ * The received data is also peeked by a NmeaTokenizer, which handles logging
+ * and the IMU sentences unknown to QgsNmeaConnection without allocating strings.
  * \ingroup coure
  */
 class NmeaGnssReceiver : public AbstractGnssReceiver
@@ -44,21 +49,25 @@ class NmeaGnssReceiver : public AbstractGnssReceiver
 
   private slots:
     void stateChanged( const QgsGpsInformation &info );
-    void nmeaSentenceReceived( const QString &substring );
 
   private:
     void handleStartLogging( const QString &path ) override;
     void handleStopLogging() override;
     GnssPositionDetails details() const override;
 
-    void processImuSentence( const QString &sentence );
+    void processReceivedData( QIODevice *ioDevice );
+    void processImuSentence( QByteArrayView sentence );
+
+    GnssPositionInformation positionInformation( const QgsGpsInformation &info ) const;
 
     QTime mLastGnssPositionUtcTime;
 
     QFile mLogFile;
-    QTextStream mLogStream;
 
-    GnssPositionInformation mCurrentNmeaGnssPositionInformation;
+    NmeaTokenizer mNmeaTokenizer;
+    NmeaTokenizer::Fields mImuFields;
+
+    QgsGpsInformation mCurrentNmeaInformation;
 
     struct ImuPosition
     {
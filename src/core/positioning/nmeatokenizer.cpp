@@ -0,0 +1,120 @@
+/***************************************************************************
+  nmeatokenizer.cpp - NmeaTokenizer
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "nmeatokenizer.h"
+
+#include <QIODevice>
+
+#include <algorithm>
+#include <cstring>
+
+
+void NmeaTokenizer::feed( QIODevice *device )
+{
+  const qint64 available = device->bytesAvailable();
+  const qint64 unreadPeekedSize = std::min( mUnreadPeekedSize, available );
+  mUnreadPeekedSize = 0;
+  if ( available <= unreadPeekedSize )
+    return;
+
+  // move the incomplete sentence left from the previous data to the front, the buffer capacity is reused
+  mBuffer.remove( 0, mPosition );
+  mPosition = 0;
+
+  const qsizetype size = mBuffer.size();
+  mBuffer.resize( size + available );
+  const qint64 peeked = device->peek( mBuffer.data() + size, available );
+  mBuffer.resize( size + std::max<qint64>( 0, peeked ) );
+
+  // the data left unread since the previous call is already in the buffer
+  mBuffer.remove( size, std::min( unreadPeekedSize, std::max<qint64>( 0, peeked ) ) );
+}
+
+void NmeaTokenizer::skipUnreadData( const QIODevice *device )
+{
+  mUnreadPeekedSize = std::max<qint64>( 0, device->bytesAvailable() );
+}
+
+void NmeaTokenizer::feed( QByteArrayView data )
+{
+  mBuffer.remove( 0, mPosition );
+  mPosition = 0;
+
+  mBuffer.append( data );
+}
+
+bool NmeaTokenizer::nextSentence( QByteArrayView &sentence )
+{
+  while ( mPosition < mBuffer.size() )
+  {
+    const char *begin = mBuffer.constData() + mPosition;
+    const char *lineBreak = static_cast<const char *>( std::memchr( begin, '\n', mBuffer.size() - mPosition ) );
+    if ( !lineBreak )
+    {
+      if ( mBuffer.size() - mPosition > MAX_SENTENCE_LENGTH )
+      {
+        // not NMEA data, or a line break got lost
+        mPosition = mBuffer.size();
+      }
+      return false;
+    }
+
+    mPosition = lineBreak - mBuffer.constData() + 1;
+
+    const char *end = lineBreak;
+    while ( end > begin && ( end[-1] == '\r' || end[-1] == ' ' ) )
+    {
+      end--;
+    }
+
+    if ( end > begin )
+    {
+      sentence = QByteArrayView( begin, end );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void NmeaTokenizer::clear()
+{
+  mBuffer.clear();
+  mPosition = 0;
+  mUnreadPeekedSize = 0;
+}
+
+void NmeaTokenizer::splitFields( QByteArrayView sentence, Fields &fields )
+{
+  fields.clear();
+
+  const qsizetype checksumIndex = sentence.indexOf( '*' );
+  if ( checksumIndex >= 0 )
+  {
+    sentence = sentence.first( checksumIndex );
+  }
+
+  qsizetype start = 0;
+  for ( qsizetype i = 0; i < sentence.size(); i++ )
+  {
+    if ( sentence.at( i ) == ',' )
+    {
+      fields.append( sentence.sliced( start, i - start ) );
+      start = i + 1;
+    }
+  }
+  fields.append( sentence.sliced( start ) );
+}
@@ -0,0 +1,82 @@
+/***************************************************************************
+  nmeatokenizer.h - NmeaTokenizer
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NMEATOKENIZER_H
+#define NMEATOKENIZER_H
+
+#include "qfield_core_export.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVarLengthArray>
+
+class QIODevice;
+
+/**
+ * A streaming tokenizer splitting the data received from a GNSS device into NMEA sentences
+ * and fields, without allocating strings.
+ *
+ * Received data is accumulated in a reusable buffer and sentences as well as their fields are
+ * returned as views into that buffer, which stay valid until the next call to feed().
+ * \ingroup core
+ */
+class QFIELD_CORE_EXPORT NmeaTokenizer
+{
+  public:
+    //! Data that is not terminated by a line break within this length is dropped
+    static constexpr qsizetype MAX_SENTENCE_LENGTH = 4096;
+
+    //! The fields of a sentence
+    using Fields = QVarLengthArray<QByteArrayView, 32>;
+
+    /**
+     * Appends the data available from \a device to the buffer. The data is peeked, the device
+     * can still be read by others afterwards. The data peeked by the previous call and left unread
+     * in the \a device, as recorded by skipUnreadData(), is not appended again.
+     */
+    void feed( QIODevice *device );
+
+    /**
+     * Records the data peeked from \a device which its other readers left unread, e.g. a partial
+     * sentence too short to be parsed yet. To be called once they are done with the received data.
+     */
+    void skipUnreadData( const QIODevice *device );
+
+    //! Appends \a data to the buffer
+    void feed( QByteArrayView data );
+
+    /**
+     * Returns the next complete sentence of the buffer into \a sentence, stripped from its line break.
+     * \returns FALSE if no complete sentence is left.
+     */
+    bool nextSentence( QByteArrayView &sentence );
+
+    //! Clears the buffer, including any incomplete sentence
+    void clear();
+
+    /**
+     * Splits \a sentence into its comma separated \a fields, excluding the checksum.
+     * The first field is the sentence address, e.g. `$GNGGA`.
+     */
+    static void splitFields( QByteArrayView sentence, Fields &fields );
+
+  private:
+    QByteArray mBuffer;
+    qsizetype mPosition = 0;
+    qint64 mUnreadPeekedSize = 0;
+};
+
+#endif // NMEATOKENIZER_H
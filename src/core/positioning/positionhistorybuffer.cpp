@@ -0,0 +1,221 @@
+/***************************************************************************
+  positionhistorybuffer.cpp - PositionHistoryBuffer
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "positionhistorybuffer.h"
+
+#include <QTimeZone>
+
+#include <algorithm>
+#include <cstring>
+
+#define HISTORY_MAGIC 0x51465048 // QFPH
+#define HISTORY_VERSION 1
+
+#define RECORD_FLAG_UTC_DATETIME_VALID 0x01
+#define RECORD_FLAG_SAT_INFO_COMPLETE 0x02
+#define RECORD_FLAG_IMU_CORRECTION 0x04
+
+
+PositionHistoryBuffer::PositionHistoryBuffer( const QString &filePath, int capacity )
+  : mFile( filePath )
+  , mCapacity( std::max( 1, capacity ) )
+{
+  static_assert( sizeof( Header ) == 88, "The history header size is part of the file format" );
+  static_assert( sizeof( Record ) == 112, "The history record size is part of the file format" );
+}
+
+PositionHistoryBuffer::~PositionHistoryBuffer()
+{
+  close();
+}
+
+int PositionHistoryBuffer::capacity() const
+{
+  return mHeader ? static_cast<int>( mHeader->capacity ) : mCapacity;
+}
+
+bool PositionHistoryBuffer::create()
+{
+  close();
+
+  if ( !mFile.open( QIODevice::ReadWrite | QIODevice::Truncate ) )
+    return false;
+
+  // resizing fills the file with zeros, the records are written as positions get appended
+  if ( !mFile.resize( static_cast<qint64>( sizeof( Header ) ) + static_cast<qint64>( sizeof( Record ) ) * mCapacity ) || !map() )
+  {
+    close();
+    return false;
+  }
+
+  mHeader->magic = HISTORY_MAGIC;
+  mHeader->version = HISTORY_VERSION;
+  mHeader->capacity = static_cast<quint32>( mCapacity );
+  mHeader->recordSize = sizeof( Record );
+  mHeader->head = 0;
+
+  return true;
+}
+
+bool PositionHistoryBuffer::open()
+{
+  close();
+
+  if ( !mFile.exists() || !mFile.open( QIODevice::ReadOnly ) )
+    return false;
+
+  if ( mFile.size() < static_cast<qint64>( sizeof( Header ) ) || !map() )
+  {
+    close();
+    return false;
+  }
+
+  if ( mHeader->magic != HISTORY_MAGIC || mHeader->version != HISTORY_VERSION || mHeader->recordSize != sizeof( Record ) || mHeader->capacity == 0
+       || mFile.size() != static_cast<qint64>( sizeof( Header ) ) + static_cast<qint64>( sizeof( Record ) ) * mHeader->capacity )
+  {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void PositionHistoryBuffer::close()
+{
+  if ( mHeader )
+  {
+    mFile.unmap( reinterpret_cast<uchar *>( mHeader ) );
+    mHeader = nullptr;
+    mRecords = nullptr;
+  }
+
+  if ( mFile.isOpen() )
+  {
+    mFile.close();
+  }
+}
+
+bool PositionHistoryBuffer::map()
+{
+  uchar *data = mFile.map( 0, mFile.size() );
+  if ( !data )
+    return false;
+
+  mHeader = reinterpret_cast<Header *>( data );
+  mRecords = reinterpret_cast<Record *>( data + sizeof( Header ) );
+  return true;
+}
+
+PositionHistoryBuffer::Record *PositionHistoryBuffer::record( quint64 index ) const
+{
+  return mRecords + index % mHeader->capacity;
+}
+
+bool PositionHistoryBuffer::append( const GnssPositionInformation &positionInformation )
+{
+  if ( !mHeader || !mFile.isWritable() )
+    return false;
+
+  Record *record = PositionHistoryBuffer::record( mHeader->head );
+  record->latitude = positionInformation.latitude();
+  record->longitude = positionInformation.longitude();
+  record->elevation = positionInformation.elevation();
+  record->utcDateTime = positionInformation.utcDateTime().isValid() ? positionInformation.utcDateTime().toMSecsSinceEpoch() : 0;
+  record->speed = static_cast<float>( positionInformation.speed() );
+  record->direction = static_cast<float>( positionInformation.direction() );
+  record->pdop = static_cast<float>( positionInformation.pdop() );
+  record->hdop = static_cast<float>( positionInformation.hdop() );
+  record->vdop = static_cast<float>( positionInformation.vdop() );
+  record->hacc = static_cast<float>( positionInformation.hacc() );
+  record->vacc = static_cast<float>( positionInformation.vacc() );
+  record->verticalSpeed = static_cast<float>( positionInformation.verticalSpeed() );
+  record->magneticVariation = static_cast<float>( positionInformation.magneticVariation() );
+  record->imuRoll = static_cast<float>( positionInformation.imuRoll() );
+  record->imuPitch = static_cast<float>( positionInformation.imuPitch() );
+  record->imuHeading = static_cast<float>( positionInformation.imuHeading() );
+  record->imuSteering = static_cast<float>( positionInformation.imuSteering() );
+  record->orientation = static_cast<float>( positionInformation.orientation() );
+  record->fixType = positionInformation.fixType();
+  record->quality = positionInformation.quality();
+  record->satellitesUsed = positionInformation.satellitesUsed();
+  record->averagedCount = positionInformation.averagedCount();
+  record->fixMode = positionInformation.fixMode().unicode();
+  record->status = positionInformation.status().unicode();
+  record->flags = ( positionInformation.utcDateTime().isValid() ? RECORD_FLAG_UTC_DATETIME_VALID : 0 )
+                  | ( positionInformation.satInfoComplete() ? RECORD_FLAG_SAT_INFO_COMPLETE : 0 )
+                  | ( positionInformation.imuCorrection() ? RECORD_FLAG_IMU_CORRECTION : 0 );
+
+  // the source name rarely changes, it is stored once for all the records
+  const QByteArray sourceName = positionInformation.sourceName().toUtf8().left( sizeof( Header::sourceName ) - 1 );
+  if ( std::strncmp( mHeader->sourceName, sourceName.constData(), sizeof( Header::sourceName ) ) != 0 )
+  {
+    std::memset( mHeader->sourceName, 0, sizeof( Header::sourceName ) );
+    std::memcpy( mHeader->sourceName, sourceName.constData(), sourceName.size() );
+  }
+
+  // the head is moved once the record is complete, readers never see a partially written record
+  mHeader->head++;
+
+  return true;
+}
+
+int PositionHistoryBuffer::count() const
+{
+  if ( !mHeader )
+    return 0;
+
+  return static_cast<int>( std::min<quint64>( mHeader->head, mHeader->capacity ) );
+}
+
+qint64 PositionHistoryBuffer::droppedCount() const
+{
+  if ( !mHeader || mHeader->head <= mHeader->capacity )
+    return 0;
+
+  return static_cast<qint64>( mHeader->head - mHeader->capacity );
+}
+
+QList<GnssPositionInformation> PositionHistoryBuffer::read( int offset, int count ) const
+{
+  QList<GnssPositionInformation> positionInformationList;
+
+  const int available = PositionHistoryBuffer::count();
+  if ( offset < 0 || offset >= available )
+    return positionInformationList;
+
+  if ( count < 0 || count > available - offset )
+    count = available - offset;
+
+  const QString sourceName = QString::fromUtf8( mHeader->sourceName, static_cast<int>( qstrnlen( mHeader->sourceName, sizeof( Header::sourceName ) ) ) );
+  const quint64 first = mHeader->head - static_cast<quint64>( available ) + static_cast<quint64>( offset );
+
+  positionInformationList.reserve( count );
+  for ( int i = 0; i < count; i++ )
+  {
+    const Record *record = PositionHistoryBuffer::record( first + i );
+    positionInformationList << GnssPositionInformation( record->latitude, record->longitude, record->elevation,
+                                                        record->speed, record->direction, QList<QgsSatelliteInfo>(),
+                                                        record->pdop, record->hdop, record->vdop,
+                                                        record->hacc, record->vacc,
+                                                        record->flags & RECORD_FLAG_UTC_DATETIME_VALID ? QDateTime::fromMSecsSinceEpoch( record->utcDateTime, QTimeZone( QTimeZone::Initialization::UTC ) ) : QDateTime(),
+                                                        QChar( record->fixMode ), record->fixType, record->quality, record->satellitesUsed, QChar( record->status ), QList<int>(),
+                                                        record->flags & RECORD_FLAG_SAT_INFO_COMPLETE, record->verticalSpeed, record->magneticVariation, record->averagedCount, sourceName,
+                                                        record->flags & RECORD_FLAG_IMU_CORRECTION, record->imuRoll, record->imuPitch, record->imuHeading, record->imuSteering,
+                                                        record->orientation );
+  }
+
+  return positionInformationList;
+}
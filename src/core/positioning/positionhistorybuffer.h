@@ -0,0 +1,143 @@
+/***************************************************************************
+  positionhistorybuffer.h - PositionHistoryBuffer
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef POSITIONHISTORYBUFFER_H
+#define POSITIONHISTORYBUFFER_H
+
+#include "gnsspositioninformation.h"
+#include "qfield_core_export.h"
+
+#include <QFile>
+#include <QList>
+#include <QString>
+
+/**
+ * A file backed ring buffer of position information, used to keep the positions collected
+ * while the positioning source is in background mode.
+ *
+ * Positions are stored as fixed-size binary records in a memory mapped file, so appending a position
+ * costs a copy into the mapping and the file never grows beyond its capacity. Once full, the oldest
+ * positions are overwritten. The list of satellites in view and their PRNs are not stored, they are
+ * not needed to replay a track.
+ *
+ * The file is written by the positioning source and read in chunks by the application, which can
+ * live in different processes.
+ * \ingroup core
+ */
+class QFIELD_CORE_EXPORT PositionHistoryBuffer
+{
+  public:
+    //! The default capacity, a day of positions received once per second
+    static constexpr int DEFAULT_CAPACITY = 86400;
+
+    /**
+     * Creates a position history buffer stored in \a filePath, holding up to \a capacity positions.
+     * The capacity is only used when creating the file, an existing file keeps its own capacity.
+     */
+    explicit PositionHistoryBuffer( const QString &filePath, int capacity = DEFAULT_CAPACITY );
+    ~PositionHistoryBuffer();
+
+    //! Returns the path of the file backing the buffer
+    QString filePath() const { return mFile.fileName(); }
+
+    //! Returns the maximum number of positions held by the buffer
+    int capacity() const;
+
+    /**
+     * Creates an empty buffer file, replacing any existing one, and maps it for writing.
+     * \returns FALSE if the file cannot be created or mapped.
+     */
+    bool create();
+
+    /**
+     * Maps an existing buffer file for reading.
+     * \returns FALSE if the file does not exist or is not a valid buffer file.
+     */
+    bool open();
+
+    //! Unmaps and closes the buffer file, which is kept on disk
+    void close();
+
+    //! Returns TRUE if the buffer file is mapped
+    bool isOpen() const { return mHeader != nullptr; }
+
+    //! Appends \a positionInformation, overwriting the oldest position when the buffer is full
+    bool append( const GnssPositionInformation &positionInformation );
+
+    //! Returns the number of positions held by the buffer
+    int count() const;
+
+    //! Returns the number of positions that were overwritten since the buffer was created
+    qint64 droppedCount() const;
+
+    /**
+     * Returns up to \a count positions starting at \a offset, the oldest held position having offset 0.
+     * A negative \a count returns all the positions from \a offset.
+     */
+    QList<GnssPositionInformation> read( int offset, int count = -1 ) const;
+
+  private:
+    struct Header
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 capacity;
+        quint32 recordSize;
+        quint64 head;
+        char sourceName[64];
+    };
+
+    struct Record
+    {
+        double latitude;
+        double longitude;
+        double elevation;
+        qint64 utcDateTime;
+        float speed;
+        float direction;
+        float pdop;
+        float hdop;
+        float vdop;
+        float hacc;
+        float vacc;
+        float verticalSpeed;
+        float magneticVariation;
+        float imuRoll;
+        float imuPitch;
+        float imuHeading;
+        float imuSteering;
+        float orientation;
+        qint32 fixType;
+        qint32 quality;
+        qint32 satellitesUsed;
+        qint32 averagedCount;
+        quint16 fixMode;
+        quint16 status;
+        quint8 flags;
+        quint8 reserved[3];
+    };
+
+    bool map();
+    Record *record( quint64 index ) const;
+
+    QFile mFile;
+    int mCapacity = DEFAULT_CAPACITY;
+
+    Header *mHeader = nullptr;
+    Record *mRecords = nullptr;
+};
+
+#endif // POSITIONHISTORYBUFFER_H
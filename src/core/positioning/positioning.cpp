@@ -26,7 +26,6 @@
 #include <QFile>
 #include <QGuiApplication>
 #include <QPermissions>
-#include <QRemoteObjectPendingCall>
 #include <QScreen>
 #include <qgsapplication.h>
 #include <qgsunittypes.h>
@@ -497,19 +496,22 @@ void Positioning::setBackgroundMode( bool enabled )
   emit backgroundModeChanged();
 }
 
-QList<GnssPositionInformation> Positioning::getBackgroundPositionInformation() const
+int Positioning::backgroundPositionInformationCount() const
 {
-  QList<GnssPositionInformation> positionInformationList;
+  PositionHistoryBuffer history( PositioningSource::backgroundHistoryFilePath );
+  return history.open() ? history.count() : 0;
+}
 
-  if ( isSourceAvailable() )
+QList<GnssPositionInformation> Positioning::getBackgroundPositionInformation( int offset, int count ) const
+{
+  // The source writes into a shared history file, reading it here avoids moving the whole history through the replica
+  PositionHistoryBuffer history( PositioningSource::backgroundHistoryFilePath );
+  if ( !history.open() )
   {
-    QRemoteObjectPendingCall call;
-    QMetaObject::invokeMethod( mPositioningSourceReplica.data(), "getBackgroundPositionInformation", Qt::DirectConnection, Q_RETURN_ARG( QRemoteObjectPendingCall, call ) );
-    call.waitForFinished();
-    positionInformationList = call.returnValue().value<QList<GnssPositionInformation>>();
+    return QList<GnssPositionInformation>();
   }
 
-  return positionInformationList;
+  return history.read( offset, count );
 }
 
 void Positioning::onElevationCorrectionModeChanged()
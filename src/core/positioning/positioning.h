@@ -276,11 +276,19 @@ class Positioning : public QObject
     void setBackgroundMode( bool enabled );
 
     /**
-     * Returns a list of position information collected while background mode is active.
+     * Returns the number of position information collected while background mode was active.
+     * \see getBackgroundPositionInformation()
+     */
+    Q_INVOKABLE int backgroundPositionInformationCount() const;
+
+    /**
+     * Returns up to \a count position information collected while background mode was active, starting
+     * at \a offset. A negative \a count returns all the collected position information from \a offset.
+     * \note The collected position information is read from disk, reading it in chunks keeps memory usage bounded
      * \see backgroundMode()
      * \see setBackgroundMode()
      */
-    Q_INVOKABLE QList<GnssPositionInformation> getBackgroundPositionInformation() const;
+    Q_INVOKABLE QList<GnssPositionInformation> getBackgroundPositionInformation( int offset = 0, int count = -1 ) const;
 
     /**
      * Returns the threshold above which accuracy is considered bad.
@@ -23,17 +23,21 @@
 #include "egenioussreceiver.h"
 #include "filereceiver.h"
 #include "internalgnssreceiver.h"
+#include "positionhistorybuffer.h"
 #include "positioningsource.h"
 #include "positioningutils.h"
 #include "tcpreceiver.h"
 #include "udpreceiver.h"
 
 #include <QStandardPaths>
+#include <qgsmessagelog.h>
 
 QString PositioningSource::backgroundFilePath = QStringLiteral( "%1/positioning.background" ).arg( QStandardPaths::writableLocation( QStandardPaths::AppDataLocation ) );
+QString PositioningSource::backgroundHistoryFilePath = QStringLiteral( "%1/positioning.background.history" ).arg( QStandardPaths::writableLocation( QStandardPaths::AppDataLocation ) );
 
 PositioningSource::PositioningSource( QObject *parent )
   : QObject( parent )
+  , mBackgroundHistory( std::make_unique<PositionHistoryBuffer>( backgroundHistoryFilePath ) )
 {
   // Setup internal gnss receiver by default
   setupDevice();
@@ -149,35 +153,19 @@ void PositioningSource::setBackgroundMode( bool backgroundMode )
 
   if ( mBackgroundMode )
   {
-    if ( QFile::exists( QStringLiteral( "%1.information" ).arg( backgroundFilePath ) ) )
+    // Replaces previously collected position information
+    if ( !mBackgroundHistory->create() )
     {
-      // Remove previously collected position information
-      QFile::remove( QStringLiteral( "%1.information" ).arg( backgroundFilePath ) );
+      QgsMessageLog::logMessage( tr( "Failed to create the background position history %1" ).arg( backgroundHistoryFilePath ), QStringLiteral( "QField" ), Qgis::Warning );
     }
   }
-
-  emit backgroundModeChanged();
-}
-
-QList<GnssPositionInformation> PositioningSource::getBackgroundPositionInformation() const
-{
-  QList<GnssPositionInformation> positionInformationList;
-
-  QFile file( QStringLiteral( "%1.information" ).arg( backgroundFilePath ) );
-  if ( file.exists() )
+  else
   {
-    file.open( QFile::ReadOnly );
-    QDataStream stream( &file );
-    while ( !stream.atEnd() )
-    {
-      GnssPositionInformation positionInformation;
-      stream >> positionInformation;
-      positionInformationList << positionInformation;
-    }
-    file.close();
+    // The history is kept on disk for the application to replay it
+    mBackgroundHistory->close();
   }
 
-  return positionInformationList;
+  emit backgroundModeChanged();
 }
 
 void PositioningSource::setElevationCorrectionMode( ElevationCorrectionMode elevationCorrectionMode )
@@ -333,11 +321,7 @@ void PositioningSource::lastGnssPositionInformationChanged( const GnssPositionIn
   }
   else
   {
-    QFile file( QStringLiteral( "%1.information" ).arg( backgroundFilePath ) );
-    file.open( QFile::Append );
-    QDataStream stream( &file );
-    stream << mPositionInformation;
-    file.close();
+    mBackgroundHistory->append( mPositionInformation );
   }
 }
 
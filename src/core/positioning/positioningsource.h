@@ -19,6 +19,7 @@
 
 #include "abstractgnssreceiver.h"
 #include "gnsspositioninformation.h"
+#include "positionhistorybuffer.h"
 
 #include <QCompass>
 #include <QObject>
@@ -193,25 +194,25 @@ class PositioningSource : public QObject
     /**
      * Returns TRUE if the background mode is active. When activated, position information details
      * will not be signaled but instead saved to disk until deactivated.
-     * \see getBackgroundPositionInformation()
+     * \see backgroundHistoryFilePath
      */
     bool backgroundMode() const { return mBackgroundMode; }
 
     /**
      * Sets whether the background mode is active. When activated, position information details
      * will not be signaled but instead saved to disk until deactivated.
-     * \see getBackgroundPositionInformation()
+     * \see backgroundHistoryFilePath
      */
     void setBackgroundMode( bool backgroundMode );
 
+    static QString backgroundFilePath;
+
     /**
-     * Returns a list of position information collected while background mode is active.
-     * \see backgroundMode()
-     * \see setBackgroundMode()
+     * The path of the position history buffer collected while background mode is active. It is read
+     * directly by the application, without going through the remote object replica.
+     * \see PositionHistoryBuffer
      */
-    Q_INVOKABLE QList<GnssPositionInformation> getBackgroundPositionInformation() const;
-
-    static QString backgroundFilePath;
+    static QString backgroundHistoryFilePath;
 
   signals:
     void activeChanged();
@@ -256,6 +257,7 @@ class PositioningSource : public QObject
     QString mLoggingPath;
 
     bool mBackgroundMode = false;
+    std::unique_ptr<PositionHistoryBuffer> mBackgroundHistory;
 
     std::unique_ptr<AbstractGnssReceiver> mReceiver;
 
@@ -0,0 +1,220 @@
+/***************************************************************************
+    contentstore.cpp
+    ---------------------
+    begin                : October 2026
+    copyright            : (C) 2026 by OPENGIS.ch
+    email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "contentstore.h"
+#include "fileutils.h"
+#include "qfieldcloudutils.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QUuid>
+#include <qgslogger.h>
+
+
+ContentStore::ContentStore( const QString &rootPath )
+  : mRootPath( rootPath.isEmpty() ? QStringLiteral( "%1/.store" ).arg( QFieldCloudUtils::localCloudDirectory() ) : rootPath )
+{
+}
+
+
+QString ContentStore::etagKey( const QString &etag )
+{
+  return etag.isEmpty() ? QString() : QStringLiteral( "etag/%1" ).arg( FileUtils::sanitizeFilePathPart( etag ) );
+}
+
+
+QString ContentStore::sha256Key( const QString &fileName )
+{
+  const QByteArray checksum = FileUtils::fileChecksum( fileName, QCryptographicHash::Sha256 );
+  return checksum.isEmpty() ? QString() : QStringLiteral( "sha256/%1" ).arg( QString::fromLatin1( checksum.toHex() ) );
+}
+
+
+bool ContentStore::canShareContent( const QString &fileName )
+{
+  static const QStringList sReadOnlySuffixes = {
+    QStringLiteral( "tif" ),
+    QStringLiteral( "tiff" ),
+    QStringLiteral( "jp2" ),
+    QStringLiteral( "ecw" ),
+    QStringLiteral( "mbtiles" ),
+    QStringLiteral( "pmtiles" ),
+    QStringLiteral( "vtpk" ),
+    QStringLiteral( "pdf" ),
+    QStringLiteral( "mp3" ),
+    QStringLiteral( "mp4" ),
+    QStringLiteral( "wav" ),
+  };
+
+  return sReadOnlySuffixes.contains( QFileInfo( fileName ).suffix().toLower() );
+}
+
+
+QString ContentStore::objectPath( const QString &key ) const
+{
+  return QStringLiteral( "%1/%2" ).arg( mRootPath, key );
+}
+
+
+QString ContentStore::metadataPath( const QString &key ) const
+{
+  return QStringLiteral( "%1.meta" ).arg( objectPath( key ) );
+}
+
+
+bool ContentStore::contains( const QString &key ) const
+{
+  if ( key.isEmpty() )
+    return false;
+
+  const QFileInfo objectInfo( objectPath( key ) );
+
+  if ( !objectInfo.exists() )
+    return false;
+
+  QFile metadataFile( metadataPath( key ) );
+
+  if ( !metadataFile.open( QIODevice::ReadOnly ) )
+    return false;
+
+  // the metadata holds the size and the modification time in milliseconds at insertion time
+  const QList<QByteArray> metadata = metadataFile.readAll().trimmed().split( ' ' );
+
+  return metadata.size() == 2 && metadata.at( 0 ).toLongLong() == objectInfo.size() && metadata.at( 1 ).toLongLong() == objectInfo.lastModified().toMSecsSinceEpoch();
+}
+
+
+bool ContentStore::validate( const QString &key )
+{
+  if ( contains( key ) )
+    return true;
+
+  if ( !key.isEmpty() && QFile::exists( objectPath( key ) ) )
+  {
+    QgsLogger::debug( QStringLiteral( "Content store object `%1` has been modified, removing it" ).arg( key ) );
+    remove( key );
+  }
+
+  return false;
+}
+
+
+bool ContentStore::insert( const QString &fileName, const QString &key )
+{
+  // files written in place would spread their changes to the other projects through the hard links
+  if ( key.isEmpty() || !canShareContent( fileName ) )
+    return false;
+
+  if ( validate( key ) )
+    return true;
+
+  const QFileInfo fileInfo( fileName );
+
+  if ( !fileInfo.exists() || !QDir().mkpath( QFileInfo( objectPath( key ) ).absolutePath() ) )
+    return false;
+
+  remove( key );
+
+  if ( !FileUtils::createHardLink( fileName, objectPath( key ) ) )
+    return false;
+
+  QFile metadataFile( metadataPath( key ) );
+
+  if ( !metadataFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+  {
+    remove( key );
+    return false;
+  }
+
+  metadataFile.write( QStringLiteral( "%1 %2" ).arg( fileInfo.size() ).arg( fileInfo.lastModified().toMSecsSinceEpoch() ).toLatin1() );
+
+  return true;
+}
+
+
+bool ContentStore::materialize( const QString &key, const QString &fileName, bool shareContent )
+{
+  if ( !validate( key ) )
+    return false;
+
+  if ( shareContent && FileUtils::isSameFile( objectPath( key ), fileName ) )
+    return true;
+
+  if ( !QDir().mkpath( QFileInfo( fileName ).absolutePath() ) )
+    return false;
+
+  if ( QFile::exists( fileName ) && !QFile::remove( fileName ) )
+    return false;
+
+  if ( shareContent && FileUtils::createHardLink( objectPath( key ), fileName ) )
+    return true;
+
+  // copy through a temporary file so no partial file is left behind
+  const QString tmpFileName = QStringLiteral( "%1.%2.tmp" ).arg( fileName, QUuid::createUuid().toString( QUuid::WithoutBraces ) );
+
+  if ( !QFile::copy( objectPath( key ), tmpFileName ) )
+    return false;
+
+  if ( !QFile::rename( tmpFileName, fileName ) )
+  {
+    QFile::remove( tmpFileName );
+    return false;
+  }
+
+  return true;
+}
+
+
+bool ContentStore::isMaterialized( const QString &key, const QString &fileName ) const
+{
+  return contains( key ) && FileUtils::isSameFile( objectPath( key ), fileName );
+}
+
+
+int ContentStore::removeUnreferenced()
+{
+  int removedCount = 0;
+  QDirIterator it( mRootPath, QDir::Files, QDirIterator::Subdirectories );
+
+  while ( it.hasNext() )
+  {
+    const QString filePath = it.next();
+
+    if ( filePath.endsWith( QLatin1String( ".meta" ) ) )
+      continue;
+
+    const QString key = QDir( mRootPath ).relativeFilePath( filePath );
+
+    // the store itself holds one of the links
+    if ( FileUtils::hardLinkCount( filePath ) == 1 || !contains( key ) )
+    {
+      remove( key );
+      removedCount++;
+    }
+  }
+
+  return removedCount;
+}
+
+
+void ContentStore::remove( const QString &key )
+{
+  QFile::remove( metadataPath( key ) );
+  QFile::remove( objectPath( key ) );
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+    contentstore.h
+    ---------------------
+    begin                : October 2026
+    copyright            : (C) 2026 by OPENGIS.ch
+    email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef CONTENTSTORE_H
+#define CONTENTSTORE_H
+
+#include "qfield_core_export.h"
+
+#include <QString>
+
+
+/**
+ * A content addressed store of the files downloaded from QFieldCloud, shared by all the local projects.
+ *
+ * The objects are hard links to the downloaded files, keyed by their content checksum, so storing them costs no extra disk space
+ * as long as a project references them. Materializing an object into a project directory creates another hard link
+ * for read-only content, or a copy otherwise or when the file system does not support hard links.
+ *
+ * Only files which are never written in place by QField are stored, see canShareContent(). As a safety net, an object is only
+ * valid as long as its size and modification time are the ones recorded when it was inserted.
+ * \ingroup core
+ */
+class QFIELD_CORE_EXPORT ContentStore
+{
+  public:
+    /**
+     * Creates a content store in \a rootPath. If empty, the store is in the `.store` directory of the local cloud directory.
+     */
+    explicit ContentStore( const QString &rootPath = QString() );
+
+    //! Returns the directory of the store
+    QString rootPath() const { return mRootPath; }
+
+    //! Returns the store key of a file with the Object Storage (S3) \a etag, as computed by FileUtils::fileEtag()
+    static QString etagKey( const QString &etag );
+
+    //! Returns the store key of the content of \a fileName, based on its SHA-256 checksum
+    static QString sha256Key( const QString &fileName );
+
+    /**
+     * Returns TRUE if files like \a fileName are never written in place by QField, so several projects can share their content.
+     * Datasets and images can be edited, sharing them would spread the edits of one project to the others.
+     */
+    static bool canShareContent( const QString &fileName );
+
+    //! Returns the path of the object with \a key, which might not exist
+    QString objectPath( const QString &key ) const;
+
+    //! Returns TRUE if the store has a valid object with \a key
+    bool contains( const QString &key ) const;
+
+    /**
+     * Adds the content of \a fileName to the store as \a key, as a hard link to \a fileName.
+     * \returns FALSE if the content of \a fileName cannot be shared or the file cannot be hard linked, the store never holds a copy of the content.
+     * \see canShareContent()
+     */
+    bool insert( const QString &fileName, const QString &key );
+
+    /**
+     * Writes the object with \a key to \a fileName, replacing any existing file.
+     * If \a shareContent is TRUE, \a fileName is a hard link to the object when possible, otherwise it is a copy.
+     * \returns FALSE if the store has no valid object with \a key or the file cannot be written.
+     * \see canShareContent()
+     */
+    bool materialize( const QString &key, const QString &fileName, bool shareContent );
+
+    //! Returns TRUE if \a fileName is a hard link to the valid object with \a key, so its content is known without reading it
+    bool isMaterialized( const QString &key, const QString &fileName ) const;
+
+    //! Removes the objects that are not referenced by any project file anymore or have been modified, returns the number of removed objects
+    int removeUnreferenced();
+
+  private:
+    QString metadataPath( const QString &key ) const;
+
+    //! Returns TRUE if the store has a valid object with \a key, an object which has been modified is removed
+    bool validate( const QString &key );
+
+    void remove( const QString &key );
+
+    QString mRootPath;
+};
+
+#endif // CONTENTSTORE_H
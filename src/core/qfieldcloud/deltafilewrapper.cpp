@@ -23,6 +23,8 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
+#include <QTimer>
 #include <QUuid>
 #include <qgsmessagelog.h>
 #include <qgsproject.h>
@@ -40,6 +42,35 @@ Q_GLOBAL_STATIC( CacheAttachmentFieldNamesMap, sCacheAttachmentFieldNames );
  */
 Q_GLOBAL_STATIC( QSet<QString>, sFileLocks );
 
+/**
+ * The string keys of a delta, the index matches the bit in `Delta::missingKeys`.
+ */
+static const QStringList sDeltaStringKeys = {
+  QStringLiteral( "uuid" ),
+  QStringLiteral( "localPk" ),
+  QStringLiteral( "sourcePk" ),
+  QStringLiteral( "localLayerId" ),
+  QStringLiteral( "localLayerCrs" ),
+  QStringLiteral( "localLayerName" ),
+  QStringLiteral( "sourceLayerId" ),
+  QStringLiteral( "exportId" ),
+  QStringLiteral( "clientId" ),
+};
+
+/**
+ * Returns whether any of the \a attributes values is the \a fileName string.
+ */
+static bool attributesContainFileName( const QHash<QString, QJsonValue> &attributes, const QString &fileName )
+{
+  for ( const QJsonValue &value : attributes )
+  {
+    if ( value.isString() && value.toString() == fileName )
+      return true;
+  }
+
+  return false;
+}
+
 
 DeltaFileWrapper::DeltaFileWrapper( const QString &projectId, const QString &fileName )
 {
@@ -114,16 +145,24 @@ DeltaFileWrapper::DeltaFileWrapper( const QString &projectId, const QString &fil
         }
         // TODO validate delta item properties
 
-        QVariantMap delta = v.toObject().toVariantMap();
-        const QString method = delta.value( QStringLiteral( "method" ) ).toString();
-        const QString localLayerId = delta.value( QStringLiteral( "localLayerId" ) ).toString();
-        const QString localPk = delta.value( QStringLiteral( "localPk" ) ).toString();
-        if ( method == QStringLiteral( "create" ) )
+        const qint64 sequence = mNextDeltaSequence++;
+        mDeltas.insert( sequence, deltaFromJson( v.toObject() ) );
+        indexDelta( sequence );
+      }
+
+      // the deltas are kept typed in memory, no need to hold their JSON representation too
+      mJsonRoot.remove( QStringLiteral( "deltas" ) );
+
+      // a journal left behind means the last session did not get to compact its changes into the delta file
+      if ( QFileInfo::exists( journalFileName() ) )
+        replayJournal();
+
+      for ( const Delta &delta : std::as_const( mDeltas ) )
+      {
+        if ( delta.method == DeltaMethod::Create )
         {
-          mLocalPkToDeltaUuid[localLayerId][localPk] = delta.value( QStringLiteral( "uuid" ) ).toString();
+          mLocalPkToDeltaUuid[delta.localLayerId][delta.localPk] = delta.uuid;
         }
-
-        mDeltas.append( v );
       }
     }
   }
@@ -131,8 +170,7 @@ DeltaFileWrapper::DeltaFileWrapper( const QString &projectId, const QString &fil
   {
     mJsonRoot = QJsonObject( { { "version", DeltaFormatVersion },
                                { "id", QUuid::createUuid().toString( QUuid::WithoutBraces ) },
-                               { "project", mCloudProjectId },
-                               { "deltas", mDeltas } } );
+                               { "project", mCloudProjectId } } );
 
     if ( !deltaFile.open( QIODevice::ReadWrite ) )
     {
@@ -153,6 +191,14 @@ DeltaFileWrapper::DeltaFileWrapper( const QString &projectId, const QString &fil
 
 DeltaFileWrapper::~DeltaFileWrapper()
 {
+  // an unfinished asynchronous application leaves no layer in edit mode
+  if ( mAsyncApplyJob )
+  {
+    finishApply( *mAsyncApplyJob, false );
+    mAsyncApplyJob.reset();
+    emit applyFinished( false );
+  }
+
   sFileLocks()->remove( mFileName );
 }
 
@@ -181,16 +227,23 @@ void DeltaFileWrapper::reset()
     return;
 
   mIsDirty = true;
-  mDeltas = QJsonArray();
+  mDeltas.clear();
+  mDeltaSequenceByUuid.clear();
+  mDeltaUuidsByLocalPk.clear();
   mLocalPkToDeltaUuid.clear();
 
+  addJournalRecord( { QStringLiteral( "reset" ), QString(), Delta() } );
+
   emit countChanged();
 }
 
 
 void DeltaFileWrapper::resetId()
 {
-  mJsonRoot.insert( QStringLiteral( "id" ), QUuid::createUuid().toString( QUuid::WithoutBraces ) );
+  const QString id = QUuid::createUuid().toString( QUuid::WithoutBraces );
+  mJsonRoot.insert( QStringLiteral( "id" ), id );
+
+  addJournalRecord( { QStringLiteral( "id" ), id, Delta() } );
 }
 
 
@@ -214,7 +267,12 @@ int DeltaFileWrapper::count() const
 
 QJsonArray DeltaFileWrapper::deltas() const
 {
-  return mDeltas;
+  QJsonArray deltas;
+
+  for ( const Delta &delta : std::as_const( mDeltas ) )
+    deltas.append( deltaToJson( delta ) );
+
+  return deltas;
 }
 
 
@@ -259,7 +317,7 @@ QByteArray DeltaFileWrapper::toJson( QJsonDocument::JsonFormat jsonFormat ) cons
   jsonRoot.insert( QStringLiteral( "version" ), DeltaFormatVersion );
   jsonRoot.insert( QStringLiteral( "id" ), id() );
   jsonRoot.insert( QStringLiteral( "project" ), mCloudProjectId );
-  jsonRoot.insert( QStringLiteral( "deltas" ), mDeltas );
+  jsonRoot.insert( QStringLiteral( "deltas" ), deltas() );
   jsonRoot.insert( QStringLiteral( "files" ), QJsonArray() );
 
   return QJsonDocument( jsonRoot ).toJson( jsonFormat );
@@ -274,29 +332,245 @@ QString DeltaFileWrapper::toString() const
 
 bool DeltaFileWrapper::toFile()
 {
-  QFile deltaFile( mFileName );
+  if ( !mIsJournalingEnabled || mJournalRecordsCount + mJournalPendingRecords.size() > DeltaJournalCompactionThreshold )
+    return compact();
 
-  if ( !deltaFile.open( QIODevice::WriteOnly | QIODevice::Unbuffered ) )
+  if ( !mJournalPendingRecords.isEmpty() )
+  {
+    QFile journalFile( journalFileName() );
+
+    if ( !journalFile.open( QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered ) )
+    {
+      setError( DeltaFileWrapper::ErrorType::IOError, journalFile.errorString() );
+      QgsMessageLog::logMessage( QStringLiteral( "File %1 cannot be open for writing. Reason: %2" ).arg( journalFileName() ).arg( mErrorDetails ) );
+      return false;
+    }
+
+    QByteArray records;
+    for ( const JournalRecord &record : std::as_const( mJournalPendingRecords ) )
+    {
+      QJsonObject recordJson( { { "op", record.op } } );
+
+      if ( record.op == QStringLiteral( "append" ) || record.op == QStringLiteral( "replace" ) )
+        recordJson.insert( QStringLiteral( "delta" ), deltaToJson( record.delta ) );
+      else if ( record.op == QStringLiteral( "remove" ) )
+        recordJson.insert( QStringLiteral( "uuid" ), record.value );
+      else if ( record.op == QStringLiteral( "id" ) )
+        recordJson.insert( QStringLiteral( "id" ), record.value );
+
+      records += QJsonDocument( recordJson ).toJson( QJsonDocument::Compact );
+      records += '\n';
+    }
+
+    if ( journalFile.write( records ) == -1 )
+    {
+      setError( DeltaFileWrapper::ErrorType::IOError, journalFile.errorString() );
+      QgsMessageLog::logMessage( QStringLiteral( "Contents of the file %1 has not been written. Reason %2" ).arg( journalFileName() ).arg( mErrorDetails ) );
+      return false;
+    }
+
+    journalFile.close();
+    mJournalRecordsCount += static_cast<int>( mJournalPendingRecords.size() );
+    mJournalPendingRecords.clear();
+  }
+
+  mIsDirty = false;
+
+  emit savedToFile();
+
+  return true;
+}
+
+
+bool DeltaFileWrapper::compact()
+{
+  if ( !writeDeltaFile() )
+    return false;
+
+  // the delta file now holds all the changes, the journal is obsolete
+  if ( QFileInfo::exists( journalFileName() ) && !QFile::remove( journalFileName() ) )
+  {
+    QgsMessageLog::logMessage( QStringLiteral( "Failed to remove the delta journal file %1" ).arg( journalFileName() ) );
+  }
+
+  mJournalPendingRecords.clear();
+  mJournalRecordsCount = 0;
+  mIsDirty = false;
+  // QgsLogger::debug( "Finished writing deltas JSON" );
+
+  emit savedToFile();
+
+  return true;
+}
+
+
+bool DeltaFileWrapper::writeDeltaFile()
+{
+  // write through a temporary file, so an interrupted write never leaves a truncated delta file behind
+  QSaveFile deltaFile( mFileName );
+
+  if ( !deltaFile.open( QIODevice::WriteOnly ) )
   {
     setError( DeltaFileWrapper::ErrorType::IOError, deltaFile.errorString() );
     QgsMessageLog::logMessage( QStringLiteral( "File %1 cannot be open for writing. Reason: %2" ).arg( mFileName ).arg( mErrorDetails ) );
     return false;
   }
 
-  if ( deltaFile.write( toJson() ) == -1 )
+  if ( deltaFile.write( toJson() ) == -1 || !deltaFile.commit() )
   {
     setError( DeltaFileWrapper::ErrorType::IOError, deltaFile.errorString() );
     QgsMessageLog::logMessage( QStringLiteral( "Contents of the file %1 has not been written. Reason %2" ).arg( mFileName ).arg( mErrorDetails ) );
     return false;
   }
 
-  deltaFile.close();
-  mIsDirty = false;
-  // QgsLogger::debug( "Finished writing deltas JSON" );
+  return true;
+}
 
-  emit savedToFile();
 
-  return true;
+bool DeltaFileWrapper::isJournalingEnabled() const
+{
+  return mIsJournalingEnabled;
+}
+
+
+void DeltaFileWrapper::setJournalingEnabled( bool enabled )
+{
+  if ( mIsJournalingEnabled == enabled )
+    return;
+
+  // changes made before enabling the journal were never recorded, so they have to land in the delta file first
+  if ( enabled && mIsDirty )
+    compact();
+
+  mIsJournalingEnabled = enabled;
+  mJournalPendingRecords.clear();
+}
+
+
+QString DeltaFileWrapper::journalFileName() const
+{
+  return QStringLiteral( "%1.journal" ).arg( mFileName );
+}
+
+
+void DeltaFileWrapper::addJournalRecord( const JournalRecord &record )
+{
+  if ( !mIsJournalingEnabled )
+    return;
+
+  mJournalPendingRecords << record;
+}
+
+
+void DeltaFileWrapper::replayJournal()
+{
+  QFile journalFile( journalFileName() );
+
+  if ( !journalFile.open( QIODevice::ReadOnly ) )
+  {
+    QgsMessageLog::logMessage( QStringLiteral( "Failed to open the delta journal file %1 for reading. Reason: %2" ).arg( journalFileName(), journalFile.errorString() ) );
+    return;
+  }
+
+  QgsLogger::debug( QStringLiteral( "Replaying delta journal from %1" ).arg( journalFileName() ) );
+
+  while ( !journalFile.atEnd() )
+  {
+    const QByteArray line = journalFile.readLine().trimmed();
+
+    if ( line.isEmpty() )
+      continue;
+
+    QJsonParseError jsonError;
+    const QJsonDocument record = QJsonDocument::fromJson( line, &jsonError );
+
+    // a record can only be malformed if the last write got interrupted, nothing after it can be trusted
+    if ( jsonError.error != QJsonParseError::NoError || !record.isObject() )
+    {
+      QgsMessageLog::logMessage( QStringLiteral( "Discarding the remaining records of the delta journal file %1. Reason: %2" ).arg( journalFileName(), jsonError.errorString() ) );
+      break;
+    }
+
+    applyJournalRecord( record.object() );
+    mJournalRecordsCount++;
+  }
+
+  mIsDirty = mJournalRecordsCount > 0;
+}
+
+
+void DeltaFileWrapper::applyJournalRecord( const QJsonObject &record )
+{
+  const QString op = record.value( QStringLiteral( "op" ) ).toString();
+
+  if ( op == QStringLiteral( "append" ) )
+  {
+    const Delta delta = deltaFromJson( record.value( QStringLiteral( "delta" ) ).toObject() );
+
+    if ( getDeltaSequenceByUuid( delta.uuid ) == -1 )
+      appendDeltaItem( delta );
+  }
+  else if ( op == QStringLiteral( "remove" ) )
+  {
+    const qint64 sequence = getDeltaSequenceByUuid( record.value( QStringLiteral( "uuid" ) ).toString() );
+
+    if ( sequence >= 0 )
+      removeDeltaItem( sequence );
+  }
+  else if ( op == QStringLiteral( "replace" ) )
+  {
+    const Delta delta = deltaFromJson( record.value( QStringLiteral( "delta" ) ).toObject() );
+    const qint64 sequence = getDeltaSequenceByUuid( delta.uuid );
+
+    if ( sequence >= 0 )
+      replaceDeltaItem( sequence, delta );
+  }
+  else if ( op == QStringLiteral( "reset" ) )
+  {
+    mDeltas.clear();
+    mDeltaSequenceByUuid.clear();
+    mDeltaUuidsByLocalPk.clear();
+  }
+  else if ( op == QStringLiteral( "id" ) )
+  {
+    mJsonRoot.insert( QStringLiteral( "id" ), record.value( QStringLiteral( "id" ) ).toString() );
+  }
+  else
+  {
+    QgsLogger::debug( QStringLiteral( "File `%1` contains unknown journal operation `%2`" ).arg( journalFileName(), op ) );
+  }
+}
+
+
+void DeltaFileWrapper::appendDeltaItem( const Delta &delta )
+{
+  const qint64 sequence = mNextDeltaSequence++;
+  mDeltas.insert( sequence, delta );
+  indexDelta( sequence );
+
+  addJournalRecord( { QStringLiteral( "append" ), QString(), delta } );
+}
+
+
+void DeltaFileWrapper::removeDeltaItem( qint64 sequence )
+{
+  const QString uuid = mDeltas.constFind( sequence )->uuid;
+
+  // the other deltas keep their sequence numbers, so there is nothing to reindex
+  unindexDelta( sequence );
+  mDeltas.remove( sequence );
+
+  addJournalRecord( { QStringLiteral( "remove" ), uuid, Delta() } );
+}
+
+
+void DeltaFileWrapper::replaceDeltaItem( qint64 sequence, const Delta &delta )
+{
+  unindexDelta( sequence );
+  mDeltas.insert( sequence, delta );
+  indexDelta( sequence );
+
+  addJournalRecord( { QStringLiteral( "replace" ), QString(), delta } );
 }
 
 
@@ -314,7 +588,6 @@ QString DeltaFileWrapper::toFileForPush( const QString &outFileName ) const
     fileName = tempFile.fileName();
   }
 
-  QJsonArray resultDeltas;
   QJsonObject jsonRoot( mJsonRoot );
 
   jsonRoot.insert( QStringLiteral( "deltas" ), deltas() );
@@ -340,10 +613,8 @@ bool DeltaFileWrapper::append( const DeltaFileWrapper *deltaFileWrapper )
   if ( deltaFileWrapper->hasError() )
     return false;
 
-  const QJsonArray constDeltas = deltaFileWrapper->deltas();
-
-  for ( const QJsonValue &delta : constDeltas )
-    mDeltas.append( delta );
+  for ( const Delta &delta : std::as_const( deltaFileWrapper->mDeltas ) )
+    appendDeltaItem( delta );
 
   emit countChanged();
 
@@ -420,45 +691,35 @@ QMap<QString, QString> DeltaFileWrapper::attachmentFileNames() const
   QMap<QString, QString> fileNames;
   QMap<QString, QString> fileChecksums;
 
-  for ( const QJsonValue &deltaJson : std::as_const( mDeltas ) )
+  for ( const Delta &delta : std::as_const( mDeltas ) )
   {
-    QVariantMap delta = deltaJson.toObject().toVariantMap();
-    const QString localLayerId = delta.value( QStringLiteral( "localLayerId" ) ).toString();
-    const QString method = delta.value( QStringLiteral( "method" ) ).toString();
-    const QString localPk = delta.value( QStringLiteral( "localPk" ) ).toString();
-
-    if ( method == QStringLiteral( "delete" ) || method == QStringLiteral( "patch" ) )
+    if ( delta.method == DeltaMethod::Delete || delta.method == DeltaMethod::Patch )
     {
-      const QVariantMap oldData = delta.value( QStringLiteral( "old" ) ).toMap();
-
-      Q_ASSERT( !oldData.isEmpty() );
+      Q_ASSERT( delta.oldData && !delta.oldData->isEmpty() );
     }
 
-    if ( method == QStringLiteral( "create" ) || method == QStringLiteral( "patch" ) )
+    if ( delta.method == DeltaMethod::Create || delta.method == DeltaMethod::Patch )
     {
-      const QVariantMap newData = delta.value( QStringLiteral( "new" ) ).toMap();
+      Q_ASSERT( delta.newData && !delta.newData->isEmpty() );
 
-      Q_ASSERT( !newData.isEmpty() );
-
-      if ( newData.contains( QStringLiteral( "files_sha256" ) ) )
+      if ( delta.newData && delta.newData->filesSha256 )
       {
-        const QVariantMap filesChecksum = newData.value( QStringLiteral( "files_sha256" ) ).toMap();
+        const QJsonObject filesChecksum = *delta.newData->filesSha256;
 
         Q_ASSERT( !filesChecksum.isEmpty() );
 
-        const QVariantMap attributes = newData.value( QStringLiteral( "attributes" ) ).toMap();
-        const QStringList attributeNames = attributes.keys();
+        const QHash<QString, QJsonValue> attributes = delta.newData->attributes.value_or( QHash<QString, QJsonValue>() );
 
-        for ( const QString &fieldName : attributeNames )
+        for ( auto [fieldName, value] : qfield::asKeyValueRange( attributes ) )
         {
-          const QString fileName = attributes.value( fieldName ).toString();
+          const QString fileName = value.toString();
           if ( !filesChecksum.contains( fileName ) )
           {
             // Not a file attachment, skip ahead
             continue;
           }
 
-          const QString key = QStringLiteral( "%1//%2//%3" ).arg( localLayerId, localPk, fieldName );
+          const QString key = QStringLiteral( "%1//%2//%3" ).arg( delta.localLayerId, delta.localPk, fieldName );
           const QString fileChecksum = filesChecksum.value( fileName ).toString();
 
           fileNames.insert( key, fileName );
@@ -467,9 +728,9 @@ QMap<QString, QString> DeltaFileWrapper::attachmentFileNames() const
       }
     }
 
-    if ( method != QStringLiteral( "create" ) && method != QStringLiteral( "delete" ) && method != QStringLiteral( "patch" ) )
+    if ( delta.method == DeltaMethod::Unknown )
     {
-      QgsLogger::debug( QStringLiteral( "File `%1` contains unknown method `%2`" ).arg( mFileName, method ) );
+      QgsLogger::debug( QStringLiteral( "File `%1` contains unknown method `%2`" ).arg( mFileName, delta.other.value( QStringLiteral( "method" ) ).toString() ) );
       Q_ASSERT( 0 );
     }
   }
@@ -485,41 +746,214 @@ QMap<QString, QString> DeltaFileWrapper::attachmentFileNames() const
   return fileNameChecksum;
 }
 
-void DeltaFileWrapper::addPatch( const QgsProject *project, const QString &localLayerId, const QString &sourceLayerId, const QString &localPkAttrName, const QString &sourcePkAttrName, const QgsFeature &oldFeature, const QgsFeature &newFeature, bool storeSnapshot )
+QString DeltaFileWrapper::intern( const QString &string )
+{
+  if ( string.isEmpty() )
+    return string;
+
+  const auto it = mInternedStrings.constFind( string );
+  if ( it != mInternedStrings.constEnd() )
+    return *it;
+
+  mInternedStrings.insert( string );
+  return string;
+}
+
+DeltaFileWrapper::Delta DeltaFileWrapper::createDelta( const QgsProject *project, DeltaMethod method, const QString &localLayerId, const QString &sourceLayerId, const QVariant &localPk, const QVariant &sourcePk )
+{
+  Delta delta;
+  delta.method = method;
+  delta.uuid = QUuid::createUuid().toString( QUuid::WithoutBraces );
+  delta.localPk = QgsVariantUtils::isNull( localPk ) ? QString() : localPk.toString();
+  delta.sourcePk = QgsVariantUtils::isNull( sourcePk ) ? QString() : sourcePk.toString();
+  delta.localLayerId = intern( localLayerId );
+  delta.localLayerCrs = intern( crsByLayerId( project, localLayerId ) );
+  delta.localLayerName = intern( nameByLayerId( project, localLayerId ) );
+  delta.sourceLayerId = intern( sourceLayerId );
+  delta.exportId = intern( QFieldCloudUtils::projectSetting( mCloudProjectId, QStringLiteral( "lastExportId" ) ).toString() );
+  delta.clientId = intern( QFieldCloudUtils::projectSetting( mCloudProjectId, QStringLiteral( "lastLocalExportId" ) ).toString() );
+
+  return delta;
+}
+
+DeltaFileWrapper::Delta DeltaFileWrapper::deltaFromJson( const QJsonObject &object )
 {
-  QVariant localPk = oldFeature.attribute( localPkAttrName );
-  QVariant sourcePk = oldFeature.attribute( sourcePkAttrName );
-  QJsonObject delta(
+  Delta delta;
+  QString *stringValues[] = { &delta.uuid, &delta.localPk, &delta.sourcePk, &delta.localLayerId, &delta.localLayerCrs, &delta.localLayerName, &delta.sourceLayerId, &delta.exportId, &delta.clientId };
+
+  static_assert( sizeof( stringValues ) / sizeof( stringValues[0] ) <= sizeof( Delta::missingKeys ) * 8 );
+  Q_ASSERT( sDeltaStringKeys.size() == sizeof( stringValues ) / sizeof( stringValues[0] ) );
+
+  for ( auto it = object.constBegin(); it != object.constEnd(); ++it )
+  {
+    const QString key = it.key();
+    const QJsonValue value = it.value();
+    const qsizetype stringKeyIdx = sDeltaStringKeys.indexOf( key );
+
+    if ( stringKeyIdx != -1 && value.isString() )
+    {
+      // the uuid and primary keys are unique per delta, no point in interning them
+      *stringValues[stringKeyIdx] = stringKeyIdx <= 2 ? value.toString() : intern( value.toString() );
+    }
+    else if ( key == QLatin1String( "method" ) && value.toString() == QLatin1String( "create" ) )
+    {
+      delta.method = DeltaMethod::Create;
+    }
+    else if ( key == QLatin1String( "method" ) && value.toString() == QLatin1String( "delete" ) )
+    {
+      delta.method = DeltaMethod::Delete;
+    }
+    else if ( key == QLatin1String( "method" ) && value.toString() == QLatin1String( "patch" ) )
+    {
+      delta.method = DeltaMethod::Patch;
+    }
+    else if ( key == QLatin1String( "old" ) && value.isObject() )
+    {
+      delta.oldData = deltaDataFromJson( value.toObject() );
+    }
+    else if ( key == QLatin1String( "new" ) && value.isObject() )
+    {
+      delta.newData = deltaDataFromJson( value.toObject() );
+    }
+    else
+    {
+      delta.other.insert( key, value );
+    }
+  }
+
+  for ( qsizetype i = 0; i < sDeltaStringKeys.size(); i++ )
+  {
+    if ( !object.value( sDeltaStringKeys.at( i ) ).isString() )
+      delta.missingKeys |= 1 << i;
+  }
+
+  return delta;
+}
+
+QJsonObject DeltaFileWrapper::deltaToJson( const Delta &delta )
+{
+  QJsonObject object( delta.other );
+  const QString *stringValues[] = { &delta.uuid, &delta.localPk, &delta.sourcePk, &delta.localLayerId, &delta.localLayerCrs, &delta.localLayerName, &delta.sourceLayerId, &delta.exportId, &delta.clientId };
+
+  for ( qsizetype i = 0; i < sDeltaStringKeys.size(); i++ )
+  {
+    if ( !( delta.missingKeys & ( 1 << i ) ) )
+      object.insert( sDeltaStringKeys.at( i ), *stringValues[i] );
+  }
+
+  switch ( delta.method )
+  {
+    case DeltaMethod::Create:
+      object.insert( QStringLiteral( "method" ), QStringLiteral( "create" ) );
+      break;
+    case DeltaMethod::Delete:
+      object.insert( QStringLiteral( "method" ), QStringLiteral( "delete" ) );
+      break;
+    case DeltaMethod::Patch:
+      object.insert( QStringLiteral( "method" ), QStringLiteral( "patch" ) );
+      break;
+    case DeltaMethod::Unknown:
+      // the original value, if any, is kept in `other`
+      break;
+  }
+
+  if ( delta.oldData )
+    object.insert( QStringLiteral( "old" ), deltaDataToJson( *delta.oldData ) );
+
+  if ( delta.newData )
+    object.insert( QStringLiteral( "new" ), deltaDataToJson( *delta.newData ) );
+
+  return object;
+}
+
+DeltaFileWrapper::DeltaData DeltaFileWrapper::deltaDataFromJson( const QJsonObject &object )
+{
+  DeltaData data;
+
+  for ( auto it = object.constBegin(); it != object.constEnd(); ++it )
+  {
+    const QString key = it.key();
+    const QJsonValue value = it.value();
+
+    if ( key == QLatin1String( "geometry" ) )
     {
-      { "localPk", QgsVariantUtils::isNull( localPk ) ? QString() : localPk.toString() },
-      { "localLayerId", localLayerId },
-      { "localLayerCrs", crsByLayerId( project, localLayerId ) },
-      { "localLayerName", nameByLayerId( project, localLayerId ) },
-      { "method", "patch" },
-      { "sourcePk", QgsVariantUtils::isNull( sourcePk ) ? QString() : sourcePk.toString() },
-      { "sourceLayerId", sourceLayerId },
-      { "uuid", QUuid::createUuid().toString( QUuid::WithoutBraces ) },
-      { "exportId", QFieldCloudUtils::projectSetting( mCloudProjectId, QStringLiteral( "lastExportId" ) ).toString() },
-      { "clientId", QFieldCloudUtils::projectSetting( mCloudProjectId, QStringLiteral( "lastLocalExportId" ) ).toString() },
-    } );
+      data.geometry = value;
+    }
+    else if ( key == QLatin1String( "attributes" ) && value.isObject() )
+    {
+      const QJsonObject attributesObject = value.toObject();
+      QHash<QString, QJsonValue> attributes;
+      attributes.reserve( attributesObject.size() );
+
+      for ( auto attrIt = attributesObject.constBegin(); attrIt != attributesObject.constEnd(); ++attrIt )
+        attributes.insert( intern( attrIt.key() ), attrIt.value() );
+
+      data.attributes = attributes;
+    }
+    else if ( key == QLatin1String( "files_sha256" ) && value.isObject() )
+    {
+      data.filesSha256 = value.toObject();
+    }
+    else if ( key == QLatin1String( "is_snapshot" ) && value.isBool() )
+    {
+      data.isSnapshot = value.toBool();
+    }
+    else
+    {
+      data.other.insert( key, value );
+    }
+  }
+
+  return data;
+}
+
+QJsonObject DeltaFileWrapper::deltaDataToJson( const DeltaData &data )
+{
+  QJsonObject object( data.other );
+
+  if ( !data.geometry.isUndefined() )
+    object.insert( QStringLiteral( "geometry" ), data.geometry );
+
+  if ( data.attributes )
+  {
+    QJsonObject attributes;
+
+    for ( auto [name, value] : qfield::asKeyValueRange( *data.attributes ) )
+      attributes.insert( name, value );
+
+    object.insert( QStringLiteral( "attributes" ), attributes );
+  }
+
+  if ( data.filesSha256 )
+    object.insert( QStringLiteral( "files_sha256" ), *data.filesSha256 );
+
+  if ( data.isSnapshot )
+    object.insert( QStringLiteral( "is_snapshot" ), *data.isSnapshot );
+
+  return object;
+}
+
+void DeltaFileWrapper::addPatch( const QgsProject *project, const QString &localLayerId, const QString &sourceLayerId, const QString &localPkAttrName, const QString &sourcePkAttrName, const QgsFeature &oldFeature, const QgsFeature &newFeature, bool storeSnapshot )
+{
+  Delta delta = createDelta( project, DeltaMethod::Patch, localLayerId, sourceLayerId, oldFeature.attribute( localPkAttrName ), oldFeature.attribute( sourcePkAttrName ) );
 
   const QgsGeometry oldGeom = oldFeature.geometry();
   const QgsGeometry newGeom = newFeature.geometry();
   const QgsAttributes oldAttrs = oldFeature.attributes();
   const QgsAttributes newAttrs = newFeature.attributes();
-  QJsonObject oldData;
-  QJsonObject newData;
+  DeltaData oldData;
+  DeltaData newData;
   bool hasFeatureChanged = false;
 
   if ( !oldGeom.equals( newGeom ) )
   {
-    oldData.insert( QStringLiteral( "geometry" ), geometryToJsonValue( oldGeom ) );
-    newData.insert( QStringLiteral( "geometry" ), geometryToJsonValue( newGeom ) );
+    oldData.geometry = geometryToJsonValue( oldGeom );
+    newData.geometry = geometryToJsonValue( newGeom );
     hasFeatureChanged = true;
   }
   else if ( storeSnapshot )
   {
-    oldData.insert( QStringLiteral( "geometry" ), geometryToJsonValue( oldGeom ) );
+    oldData.geometry = geometryToJsonValue( oldGeom );
   }
 
   QgsFields fields;
@@ -583,11 +1017,11 @@ void DeltaFileWrapper::addPatch( const QgsProject *project, const QString &local
 
   Q_ASSERT( fields.count() == newFields.count() - ignoredFields );
 
-  QJsonObject tmpOldAttrs;
-  QJsonObject tmpNewAttrs;
+  QHash<QString, QJsonValue> tmpOldAttrs;
+  QHash<QString, QJsonValue> tmpNewAttrs;
   for ( const QgsField &field : fields )
   {
-    const QString name = field.name();
+    const QString name = intern( field.name() );
     const int oldFieldIdx = oldFields.indexFromName( name );
     const int newFieldIdx = newFields.indexFromName( name );
 
@@ -617,32 +1051,32 @@ void DeltaFileWrapper::addPatch( const QgsProject *project, const QString &local
 
   if ( !tmpOldAttrs.isEmpty() || !tmpNewAttrs.isEmpty() )
   {
-    oldData.insert( QStringLiteral( "attributes" ), tmpOldAttrs );
-    newData.insert( QStringLiteral( "attributes" ), tmpNewAttrs );
+    oldData.attributes = tmpOldAttrs;
+    newData.attributes = tmpNewAttrs;
 
     QJsonObject oldFileChecksums;
     QJsonObject newFileChecksums;
     std::tie( newFileChecksums, oldFileChecksums ) = addAttachments( project, localLayerId, tmpNewAttrs, tmpOldAttrs );
     if ( !oldFileChecksums.isEmpty() )
     {
-      oldData.insert( QStringLiteral( "files_sha256" ), oldFileChecksums );
+      oldData.filesSha256 = oldFileChecksums;
     }
 
     if ( !newFileChecksums.isEmpty() )
     {
-      newData.insert( QStringLiteral( "files_sha256" ), newFileChecksums );
+      newData.filesSha256 = newFileChecksums;
     }
   }
 
-  newData.insert( QStringLiteral( "is_snapshot" ), false );
-  oldData.insert( QStringLiteral( "is_snapshot" ), storeSnapshot );
+  newData.isSnapshot = false;
+  oldData.isSnapshot = storeSnapshot;
 
-  delta.insert( QStringLiteral( "old" ), oldData );
-  delta.insert( QStringLiteral( "new" ), newData );
+  delta.oldData = oldData;
+  delta.newData = newData;
   appendDelta( delta );
 }
 
-std::tuple<QJsonObject, QJsonObject> DeltaFileWrapper::addAttachments( const QgsProject *project, const QString &localLayerId, const QJsonObject &newAttrs, const QJsonObject &oldAttrs )
+std::tuple<QJsonObject, QJsonObject> DeltaFileWrapper::addAttachments( const QgsProject *project, const QString &localLayerId, const QHash<QString, QJsonValue> &newAttrs, const QHash<QString, QJsonValue> &oldAttrs )
 {
   QJsonObject newFileChecksums;
   QJsonObject oldFileChecksums;
@@ -681,32 +1115,20 @@ std::tuple<QJsonObject, QJsonObject> DeltaFileWrapper::addAttachments( const Qgs
 
 void DeltaFileWrapper::addDelete( const QgsProject *project, const QString &localLayerId, const QString &sourceLayerId, const QString &localPkAttrName, const QString &sourcePkAttrName, const QgsFeature &oldFeature )
 {
-  QVariant localPk = oldFeature.attribute( localPkAttrName );
-  QVariant sourcePk = oldFeature.attribute( sourcePkAttrName );
-  QJsonObject delta(
-    {
-      { "localPk", QgsVariantUtils::isNull( localPk ) ? QString() : localPk.toString() },
-      { "localLayerId", localLayerId },
-      { "localLayerCrs", crsByLayerId( project, localLayerId ) },
-      { "localLayerName", nameByLayerId( project, localLayerId ) },
-      { "method", "delete" },
-      { "sourcePk", QgsVariantUtils::isNull( sourcePk ) ? QString() : sourcePk.toString() },
-      { "sourceLayerId", sourceLayerId },
-      { "uuid", QUuid::createUuid().toString( QUuid::WithoutBraces ) },
-      { "exportId", QFieldCloudUtils::projectSetting( mCloudProjectId, QStringLiteral( "lastExportId" ) ).toString() },
-      { "clientId", QFieldCloudUtils::projectSetting( mCloudProjectId, QStringLiteral( "lastLocalExportId" ) ).toString() },
-    } );
+  Delta delta = createDelta( project, DeltaMethod::Delete, localLayerId, sourceLayerId, oldFeature.attribute( localPkAttrName ), oldFeature.attribute( sourcePkAttrName ) );
 
   const QStringList attachmentFieldsList = attachmentFieldNames( project, localLayerId );
   const QgsAttributes oldAttrs = oldFeature.attributes();
-  QJsonObject oldData( { { "geometry", geometryToJsonValue( oldFeature.geometry() ) } } );
-  QJsonObject tmpOldAttrs;
+  DeltaData oldData;
+  QHash<QString, QJsonValue> tmpOldAttrs;
   QJsonObject tmpOldFileChecksums;
 
+  oldData.geometry = geometryToJsonValue( oldFeature.geometry() );
+
   for ( int idx = 0; idx < oldAttrs.count(); ++idx )
   {
     const QVariant oldVal = oldAttrs.at( idx );
-    const QString name = oldFeature.fields().at( idx ).name();
+    const QString name = intern( oldFeature.fields().at( idx ).name() );
     tmpOldAttrs.insert( name, attributeToJsonValue( oldVal ) );
 
     if ( attachmentFieldsList.contains( name ) && !oldVal.toString().isNull() )
@@ -722,11 +1144,11 @@ void DeltaFileWrapper::addDelete( const QgsProject *project, const QString &loca
 
   if ( !tmpOldAttrs.isEmpty() )
   {
-    oldData.insert( QStringLiteral( "attributes" ), tmpOldAttrs );
+    oldData.attributes = tmpOldAttrs;
 
     if ( !tmpOldFileChecksums.isEmpty() )
     {
-      oldData.insert( QStringLiteral( "files_sha256" ), tmpOldFileChecksums );
+      oldData.filesSha256 = tmpOldFileChecksums;
     }
   }
   else
@@ -734,38 +1156,26 @@ void DeltaFileWrapper::addDelete( const QgsProject *project, const QString &loca
     Q_ASSERT( tmpOldFileChecksums.isEmpty() );
   }
 
-  delta.insert( QStringLiteral( "old" ), oldData );
+  delta.oldData = oldData;
   appendDelta( delta );
 }
 
 
 void DeltaFileWrapper::addCreate( const QgsProject *project, const QString &localLayerId, const QString &sourceLayerId, const QString &localPkAttrName, const QString &sourcePkAttrName, const QgsFeature &newFeature )
 {
-  QVariant localPk = newFeature.attribute( localPkAttrName );
-  QVariant sourcePk = newFeature.attribute( sourcePkAttrName );
-  QJsonObject delta(
-    {
-      { "localPk", QgsVariantUtils::isNull( localPk ) ? QString() : localPk.toString() },
-      { "localLayerId", localLayerId },
-      { "localLayerCrs", crsByLayerId( project, localLayerId ) },
-      { "localLayerName", nameByLayerId( project, localLayerId ) },
-      { "method", "create" },
-      { "sourcePk", QgsVariantUtils::isNull( sourcePk ) ? QString() : sourcePk.toString() },
-      { "sourceLayerId", sourceLayerId },
-      { "uuid", QUuid::createUuid().toString( QUuid::WithoutBraces ) },
-      { "exportId", QFieldCloudUtils::projectSetting( mCloudProjectId, QStringLiteral( "lastExportId" ) ).toString() },
-      { "clientId", QFieldCloudUtils::projectSetting( mCloudProjectId, QStringLiteral( "lastLocalExportId" ) ).toString() },
-    } );
+  Delta delta = createDelta( project, DeltaMethod::Create, localLayerId, sourceLayerId, newFeature.attribute( localPkAttrName ), newFeature.attribute( sourcePkAttrName ) );
   const QgsAttributes newAttrs = newFeature.attributes();
   const QgsFields newFields = newFeature.fields();
-  QJsonObject newData( { { "geometry", geometryToJsonValue( newFeature.geometry() ) } } );
-  QJsonObject tmpNewAttrs;
+  DeltaData newData;
+  QHash<QString, QJsonValue> tmpNewAttrs;
+
+  newData.geometry = geometryToJsonValue( newFeature.geometry() );
 
   for ( int idx = 0; idx < newAttrs.count(); ++idx )
   {
     const QVariant newVal = newAttrs.at( idx );
     const QgsField newField = newFields.at( idx );
-    const QString name = newField.name();
+    const QString name = intern( newField.name() );
 
     switch ( newFields.fieldOrigin( idx ) )
     {
@@ -796,23 +1206,23 @@ void DeltaFileWrapper::addCreate( const QgsProject *project, const QString &loca
 
   if ( !tmpNewAttrs.isEmpty() )
   {
-    newData.insert( QStringLiteral( "attributes" ), tmpNewAttrs );
+    newData.attributes = tmpNewAttrs;
 
     QJsonObject dummyOldFileChecksums;
     QJsonObject newFileChecksums;
     std::tie( newFileChecksums, dummyOldFileChecksums ) = addAttachments( project, localLayerId, tmpNewAttrs );
     if ( !newFileChecksums.isEmpty() )
     {
-      newData.insert( QStringLiteral( "files_sha256" ), newFileChecksums );
+      newData.filesSha256 = newFileChecksums;
     }
   }
 
-  delta.insert( QStringLiteral( "new" ), newData );
+  delta.newData = newData;
 
   appendDelta( delta );
 }
 
-void DeltaFileWrapper::appendDelta( const QJsonObject &delta )
+void DeltaFileWrapper::appendDelta( const Delta &delta )
 {
   if ( mIsPushing )
   {
@@ -824,87 +1234,78 @@ void DeltaFileWrapper::appendDelta( const QJsonObject &delta )
   }
 }
 
-void DeltaFileWrapper::mergeCreateDelta( const QJsonObject &delta )
+void DeltaFileWrapper::mergeCreateDelta( const Delta &delta )
 {
-  Q_ASSERT( delta.value( QStringLiteral( "method" ) ) == "create" );
-
-  QJsonObject newData = delta.value( QStringLiteral( "new" ) ).toObject();
+  Q_ASSERT( delta.method == DeltaMethod::Create );
 
-  const QString localPk = delta.value( QStringLiteral( "localPk" ) ).toString();
-  const QString localLayerId = delta.value( QStringLiteral( "localLayerId" ) ).toString();
-  const QString existingDeltaUuid = mLocalPkToDeltaUuid[localLayerId].take( localPk );
+  const QString existingDeltaUuid = mLocalPkToDeltaUuid[delta.localLayerId].take( delta.localPk );
 
   if ( !existingDeltaUuid.isEmpty() )
   {
-    const int existingDeltaIdx = getDeltaIndexByUuid( existingDeltaUuid );
+    const qint64 existingDeltaSequence = getDeltaSequenceByUuid( existingDeltaUuid );
 
-    Q_ASSERT( existingDeltaIdx >= 0 );
+    Q_ASSERT( existingDeltaSequence >= 0 );
 
-    const QJsonObject existingDelta = mDeltas.at( existingDeltaIdx ).toObject();
-    const QString existingDeltaMethod = existingDelta.value( QStringLiteral( "method" ) ).toString();
+    const Delta &existingDelta = *mDeltas.constFind( existingDeltaSequence );
 
     // There is a change that the current "create" delta is actually the "undo" of a "delete" delta from earlier.
     // In those cases we just discard both deltas like nothing happened
-    if ( existingDeltaMethod == QStringLiteral( "delete" ) )
+    if ( existingDelta.method == DeltaMethod::Delete )
     {
-      const QJsonObject existingDeltaOldData = existingDelta.value( QStringLiteral( "old" ) ).toObject();
-
       // the newly added "create" delta matches 1:1 with previously existing "delete" delta
-      if ( existingDeltaOldData == newData )
+      if ( existingDelta.oldData.value_or( DeltaData() ) == delta.newData.value_or( DeltaData() ) )
       {
-        Q_ASSERT( existingDelta.value( QStringLiteral( "localLayerId" ) ).toString() == localLayerId );
-        Q_ASSERT( existingDelta.value( QStringLiteral( "localPk" ) ).toString() == localPk );
+        Q_ASSERT( existingDelta.localLayerId == delta.localLayerId );
+        Q_ASSERT( existingDelta.localPk == delta.localPk );
 
-        mDeltas.removeAt( existingDeltaIdx );
+        removeDeltaItem( existingDeltaSequence );
         mIsDirty = true;
 
         emit countChanged();
 
-        qDebug() << "DeltaFileWrapper::mergeCreateDelta: removed delete delta instead of adding a create delta: " << existingDeltaIdx;
+        qDebug() << "DeltaFileWrapper::mergeCreateDelta: removed delete delta instead of adding a create delta: " << existingDeltaUuid;
 
         return;
       }
     }
   }
 
-  mDeltas.append( delta );
+  appendDeltaItem( delta );
   mIsDirty = true;
 
-  qDebug() << "DeltaFileWrapper::mergeCreateDelta: Added a new create delta: " << delta;
+  qDebug() << "DeltaFileWrapper::mergeCreateDelta: Added a new create delta: " << delta.uuid;
 
-  mLocalPkToDeltaUuid[localLayerId][localPk] = delta.value( QStringLiteral( "uuid" ) ).toString();
+  mLocalPkToDeltaUuid[delta.localLayerId][delta.localPk] = delta.uuid;
 
   emit countChanged();
 }
 
-void DeltaFileWrapper::mergeDeleteDelta( const QJsonObject &delta )
+void DeltaFileWrapper::mergeDeleteDelta( const Delta &delta )
 {
-  Q_ASSERT( delta.value( QStringLiteral( "method" ) ) == "delete" );
+  Q_ASSERT( delta.method == DeltaMethod::Delete );
 
-  const QString localLayerId = delta.value( QStringLiteral( "localLayerId" ) ).toString();
-  QMap<QString, QString> layerPkDeltaIdx = mLocalPkToDeltaUuid.value( localLayerId );
-  QString localPk = delta.value( QStringLiteral( "localPk" ) ).toString();
+  const QString &localLayerId = delta.localLayerId;
+  const QString &localPk = delta.localPk;
+  const QString existingDeltaUuid = mLocalPkToDeltaUuid.value( localLayerId ).value( localPk );
 
-  if ( layerPkDeltaIdx.contains( localPk ) )
+  if ( !existingDeltaUuid.isEmpty() )
   {
-    const QString existingDeltaUuid = layerPkDeltaIdx.take( localPk );
-    const int existingDeltaIdx = getDeltaIndexByUuid( existingDeltaUuid );
+    const qint64 existingDeltaSequence = getDeltaSequenceByUuid( existingDeltaUuid );
 
-    Q_ASSERT( existingDeltaIdx >= 0 );
+    Q_ASSERT( existingDeltaSequence >= 0 );
 
     // Feature creation/deletion occured in the same delta session, just remove as if nothing had ever occured
-    const QJsonObject existingDelta = mDeltas.at( existingDeltaIdx ).toObject();
-    const QString existingDeltaMethod = existingDelta.value( QStringLiteral( "method" ) ).toString();
+    const DeltaMethod existingDeltaMethod = mDeltas.constFind( existingDeltaSequence )->method;
 
-    Q_ASSERT( existingDeltaMethod == QStringLiteral( "create" ) || existingDeltaMethod == QStringLiteral( "patch" ) );
+    Q_ASSERT( existingDeltaMethod == DeltaMethod::Create || existingDeltaMethod == DeltaMethod::Patch );
 
     // we should remove the "create" delta if it is for the same feature, but must keep the "patch" delta, because othrewise it will not work with the undo/redo feature.
-    if ( existingDeltaMethod == QStringLiteral( "create" ) )
+    if ( existingDeltaMethod == DeltaMethod::Create )
     {
-      mDeltas.removeAt( existingDeltaIdx );
+      removeDeltaItem( existingDeltaSequence );
       mIsDirty = true;
 
-      qDebug() << "DeltaFileWrapper::mergeDeleteDelta: removed the create delta: " << delta;
+      qDebug() << "DeltaFileWrapper::mergeDeleteDelta: removed the create delta: " << delta.uuid;
 
       mLocalPkToDeltaUuid[localLayerId].remove( localPk );
 
@@ -914,132 +1315,94 @@ void DeltaFileWrapper::mergeDeleteDelta( const QJsonObject &delta )
     }
   }
 
-  mDeltas.append( delta );
+  appendDeltaItem( delta );
   mIsDirty = true;
 
-  qDebug() << "DeltaFileWrapper::mergeDeleteDelta: Added a new delete delta: " << delta;
+  qDebug() << "DeltaFileWrapper::mergeDeleteDelta: Added a new delete delta: " << delta.uuid;
 
-  mLocalPkToDeltaUuid[localLayerId][localPk] = delta.value( QStringLiteral( "uuid" ) ).toString();
+  mLocalPkToDeltaUuid[localLayerId][localPk] = delta.uuid;
 
   emit countChanged();
 }
 
-void DeltaFileWrapper::mergePatchDelta( const QJsonObject &delta )
+void DeltaFileWrapper::mergePatchDelta( const Delta &delta )
 {
-  Q_ASSERT( delta.value( QStringLiteral( "method" ) ) == "patch" );
-
-  QJsonObject oldData = delta.value( QStringLiteral( "old" ) ).toObject();
-  QJsonObject newData = delta.value( QStringLiteral( "new" ) ).toObject();
+  Q_ASSERT( delta.method == DeltaMethod::Patch );
 
-  QJsonObject tmpOldAttrs;
-  QJsonObject tmpOldFileChecksum;
-  if ( oldData.contains( QStringLiteral( "attributes" ) ) )
-  {
-    tmpOldAttrs = oldData.value( QStringLiteral( "attributes" ) ).toObject();
-  }
-  if ( oldData.contains( QStringLiteral( "files_sha256" ) ) )
-  {
-    tmpOldFileChecksum = oldData.value( QStringLiteral( "files_sha256" ) ).toObject();
-  }
+  const DeltaData oldData = delta.oldData.value_or( DeltaData() );
+  const DeltaData newData = delta.newData.value_or( DeltaData() );
 
-  QString newGeomString;
-  QJsonObject tmpNewAttrs;
-  QJsonObject tmpNewFileChecksum;
-  if ( newData.contains( QStringLiteral( "geometry" ) ) )
-  {
-    newGeomString = newData.value( QStringLiteral( "geometry" ) ).toString();
-  }
-  if ( newData.contains( QStringLiteral( "attributes" ) ) )
-  {
-    tmpNewAttrs = newData.value( QStringLiteral( "attributes" ) ).toObject();
-  }
-  if ( newData.contains( QStringLiteral( "attributes" ) ) )
-  {
-    tmpNewAttrs = newData.value( QStringLiteral( "attributes" ) ).toObject();
-  }
-  if ( newData.contains( QStringLiteral( "files_sha256" ) ) )
-  {
-    tmpNewFileChecksum = newData.value( QStringLiteral( "files_sha256" ) ).toObject();
-  }
+  const QHash<QString, QJsonValue> tmpOldAttrs = oldData.attributes.value_or( QHash<QString, QJsonValue>() );
+  const QJsonObject tmpOldFileChecksum = oldData.filesSha256.value_or( QJsonObject() );
+  const QString newGeomString = newData.geometry.toString();
+  const QHash<QString, QJsonValue> tmpNewAttrs = newData.attributes.value_or( QHash<QString, QJsonValue>() );
+  const QJsonObject tmpNewFileChecksum = newData.filesSha256.value_or( QJsonObject() );
 
   mIsDirty = true;
 
-  const QString localPk = delta.value( QStringLiteral( "localPk" ) ).toString();
-  const QString localLayerId = delta.value( QStringLiteral( "localLayerId" ) ).toString();
-  QMap<QString, QString> layerPkDeltaIdx = mLocalPkToDeltaUuid.value( localLayerId );
+  const QString &localPk = delta.localPk;
+  const QString &localLayerId = delta.localLayerId;
+  QString existingDeltaUuid = mLocalPkToDeltaUuid.value( localLayerId ).value( localPk );
 
-  qDebug() << "DeltaFileWrapper::mergePatchDelta: localPk=" << localPk << " layerPkDeltaIdx=" << layerPkDeltaIdx;
+  qDebug() << "DeltaFileWrapper::mergePatchDelta: localPk=" << localPk << " existingDeltaUuid=" << existingDeltaUuid;
 
   // check if there is a patch delta that refers to the same `localLayerId` and `localPk`
   // we might get here if we did 0) existing f1 1) modify f1 2) delete f1 3) undo 4) undo
-  if ( !layerPkDeltaIdx.contains( localPk ) )
+  if ( existingDeltaUuid.isEmpty() )
   {
     qDebug() << "DeltaFileWrapper::mergePatchDelta: does not contain PK, trying to find a patch delta...";
 
-    for ( qsizetype i = mDeltas.size() - 1; i >= 0; i-- )
-    {
-      const QJsonObject existingDelta = mDeltas[i].toObject();
-
-      const QString existingLayerId = existingDelta.value( QStringLiteral( "localLayerId" ) ).toString();
-      const QString existingLocalPk = existingDelta.value( QStringLiteral( "localPk" ) ).toString();
-      const QString existingMethod = existingDelta.value( QStringLiteral( "method" ) ).toString();
+    existingDeltaUuid = lastPatchDeltaUuid( localLayerId, localPk );
 
-      if ( existingLayerId == localLayerId && existingLocalPk == localPk && existingMethod == "patch" )
-      {
-        qDebug() << "DeltaFileWrapper::mergePatchDelta: patch delta found!";
-
-        layerPkDeltaIdx[localPk] = existingDelta.value( "uuid" ).toString();
-        break;
-      }
+    if ( !existingDeltaUuid.isEmpty() )
+    {
+      qDebug() << "DeltaFileWrapper::mergePatchDelta: patch delta found!";
     }
   }
 
-  qDebug() << "DeltaFileWrapper::mergePatchDelta: localPk=" << localPk << " layerPkDeltaIdx=" << layerPkDeltaIdx;
+  qDebug() << "DeltaFileWrapper::mergePatchDelta: localPk=" << localPk << " existingDeltaUuid=" << existingDeltaUuid;
 
-  if ( layerPkDeltaIdx.contains( localPk ) )
+  if ( !existingDeltaUuid.isEmpty() )
   {
-    const QString existingDeltaUuid = layerPkDeltaIdx.take( localPk );
-    const int existingDeltaIdx = getDeltaIndexByUuid( existingDeltaUuid );
+    const qint64 existingDeltaSequence = getDeltaSequenceByUuid( existingDeltaUuid );
 
-    Q_ASSERT( existingDeltaIdx >= 0 );
+    Q_ASSERT( existingDeltaSequence >= 0 );
 
-    QJsonObject existingDelta = mDeltas.at( existingDeltaIdx ).toObject();
-    const QString existingDeltaMethod = existingDelta.value( QStringLiteral( "method" ) ).toString();
-    QJsonObject existingDeltaNewData = existingDelta.value( QStringLiteral( "new" ) ).toObject();
-    QJsonObject existingDeltaOldData = existingDelta.value( QStringLiteral( "old" ) ).toObject();
-    QJsonObject existingDeltaNewAttrs = existingDeltaNewData.value( QStringLiteral( "attributes" ) ).toObject();
-    QJsonObject existingDeltaOldAttrs = existingDeltaOldData.value( QStringLiteral( "attributes" ) ).toObject();
+    Delta existingDelta = mDeltas.value( existingDeltaSequence );
+    DeltaData existingDeltaNewData = existingDelta.newData.value_or( DeltaData() );
+    DeltaData existingDeltaOldData = existingDelta.oldData.value_or( DeltaData() );
+    QHash<QString, QJsonValue> existingDeltaNewAttrs = existingDeltaNewData.attributes.value_or( QHash<QString, QJsonValue>() );
+    QHash<QString, QJsonValue> existingDeltaOldAttrs = existingDeltaOldData.attributes.value_or( QHash<QString, QJsonValue>() );
 
     // add the attributes of the current delta in the old delta
-    const QStringList attributeNames = tmpNewAttrs.keys();
-    for ( const QString &attributeName : attributeNames )
+    for ( auto [attributeName, attributeValue] : qfield::asKeyValueRange( tmpNewAttrs ) )
     {
-      existingDeltaNewAttrs.insert( attributeName, tmpNewAttrs.value( attributeName ) );
+      existingDeltaNewAttrs.insert( attributeName, attributeValue );
 
       // previous patch did not contain this attribute change, add old attribute value
-      if ( !existingDeltaOldAttrs.contains( attributeName ) )
+      if ( !existingDeltaOldAttrs.contains( attributeName ) && tmpOldAttrs.contains( attributeName ) )
       {
         existingDeltaOldAttrs.insert( attributeName, tmpOldAttrs.value( attributeName ) );
       }
     }
-    existingDeltaOldData.insert( QStringLiteral( "attributes" ), existingDeltaOldAttrs );
-    existingDeltaNewData.insert( QStringLiteral( "attributes" ), existingDeltaNewAttrs );
+    existingDeltaOldData.attributes = existingDeltaOldAttrs;
+    existingDeltaNewData.attributes = existingDeltaNewAttrs;
 
     // if the current delta has a geometry, replace in the old delta
     if ( !newGeomString.isEmpty() )
     {
-      existingDeltaNewData.insert( QStringLiteral( "geometry" ), newGeomString );
+      existingDeltaNewData.geometry = newGeomString;
 
-      if ( !existingDeltaOldData.contains( "geometry" ) )
+      if ( existingDeltaOldData.geometry.isUndefined() )
       {
         // Previous patch did not contain a geometry change, add old geometry data
-        existingDeltaOldData.insert( "geometry", oldData.value( QStringLiteral( "geometry" ) ) );
+        existingDeltaOldData.geometry = oldData.geometry;
       }
     }
 
 
     // add new file addition / deletion of the current delta in the old delta
-    QJsonObject existingDeltaOldFileChecksums = existingDeltaOldData.value( QStringLiteral( "files_sha256" ) ).toObject();
+    QJsonObject existingDeltaOldFileChecksums = existingDeltaOldData.filesSha256.value_or( QJsonObject() );
     const QStringList oldFileChecksums = tmpOldFileChecksum.keys();
     for ( const QString &oldFileChecksum : oldFileChecksums )
     {
@@ -1049,7 +1412,7 @@ void DeltaFileWrapper::mergePatchDelta( const QJsonObject &delta )
       }
     }
 
-    QJsonObject existingDeltaNewFileChecksums = existingDeltaNewData.value( QStringLiteral( "files_sha256" ) ).toObject();
+    QJsonObject existingDeltaNewFileChecksums = existingDeltaNewData.filesSha256.value_or( QJsonObject() );
     const QStringList newFileChecksums = tmpNewFileChecksum.keys();
     for ( const QString &newFileChecksum : newFileChecksums )
     {
@@ -1065,12 +1428,11 @@ void DeltaFileWrapper::mergePatchDelta( const QJsonObject &delta )
 
     if ( !existingDeltaOldFileChecksums.isEmpty() )
     {
-      const QVariantList oldAttributes = existingDeltaOldAttrs.toVariantMap().values();
       QJsonObject refreshedDeltaOldFileChecksums;
       QJsonObject::const_iterator it = existingDeltaOldFileChecksums.constBegin();
       while ( it != existingDeltaOldFileChecksums.constEnd() )
       {
-        if ( oldAttributes.contains( it.key() ) )
+        if ( attributesContainFileName( existingDeltaOldAttrs, it.key() ) )
         {
           refreshedDeltaOldFileChecksums.insert( it.key(), it.value() );
         }
@@ -1079,18 +1441,17 @@ void DeltaFileWrapper::mergePatchDelta( const QJsonObject &delta )
 
       if ( !refreshedDeltaOldFileChecksums.isEmpty() )
       {
-        existingDeltaOldData.insert( "files_sha256", refreshedDeltaOldFileChecksums );
+        existingDeltaOldData.filesSha256 = refreshedDeltaOldFileChecksums;
       }
     }
 
     if ( !existingDeltaNewFileChecksums.isEmpty() )
     {
-      const QVariantList newAttributes = existingDeltaNewAttrs.toVariantMap().values();
       QJsonObject refreshedDeltaNewFileChecksums;
       QJsonObject::const_iterator it = existingDeltaNewFileChecksums.constBegin();
       while ( it != existingDeltaNewFileChecksums.constEnd() )
       {
-        if ( newAttributes.contains( it.key() ) )
+        if ( attributesContainFileName( existingDeltaNewAttrs, it.key() ) )
         {
           refreshedDeltaNewFileChecksums.insert( it.key(), it.value() );
         }
@@ -1099,47 +1460,49 @@ void DeltaFileWrapper::mergePatchDelta( const QJsonObject &delta )
 
       if ( !refreshedDeltaNewFileChecksums.isEmpty() )
       {
-        existingDeltaNewData.insert( "files_sha256", refreshedDeltaNewFileChecksums );
+        existingDeltaNewData.filesSha256 = refreshedDeltaNewFileChecksums;
       }
     }
 
     // now patch `existingDelta` with the changes from above
-    existingDelta.insert( QStringLiteral( "new" ), existingDeltaNewData );
-    existingDelta.insert( QStringLiteral( "sourcePk" ), delta.value( QStringLiteral( "sourcePk" ) ) );
+    existingDelta.newData = existingDeltaNewData;
+    existingDelta.sourcePk = delta.sourcePk;
+    existingDelta.missingKeys &= ~( 1 << sDeltaStringKeys.indexOf( QStringLiteral( "sourcePk" ) ) );
+    existingDelta.other.remove( QStringLiteral( "sourcePk" ) );
 
-    if ( existingDeltaMethod == QStringLiteral( "create" ) )
+    if ( existingDelta.method == DeltaMethod::Create )
     {
-      mDeltas.replace( existingDeltaIdx, existingDelta );
+      replaceDeltaItem( existingDeltaSequence, existingDelta );
       mIsDirty = true;
 
-      qDebug() << "DeltaFileWrapper::mergePatchDelta: replaced an existing create delta: " << existingDelta;
+      qDebug() << "DeltaFileWrapper::mergePatchDelta: replaced an existing create delta: " << existingDelta.uuid;
 
-      mLocalPkToDeltaUuid[localLayerId][localPk] = existingDelta.value( QStringLiteral( "uuid" ) ).toString();
+      mLocalPkToDeltaUuid[localLayerId][localPk] = existingDelta.uuid;
 
       return;
     }
-    else if ( existingDeltaMethod == QStringLiteral( "patch" ) )
+    else if ( existingDelta.method == DeltaMethod::Patch )
     {
       // only "patch" deltas have "old" value
-      existingDelta.insert( QStringLiteral( "old" ), existingDeltaOldData );
+      existingDelta.oldData = existingDeltaOldData;
 
-      // remove the existing delta
-      mDeltas.removeAt( existingDeltaIdx );
+      // remove the existing delta, the merged one goes to the end
+      removeDeltaItem( existingDeltaSequence );
 
       // and only re-add it if there is actual change between the `old` and `new` data in the delta
       if ( deltaContainsActualChange( existingDelta ) )
       {
-        mDeltas.append( existingDelta );
+        appendDeltaItem( existingDelta );
 
-        mLocalPkToDeltaUuid[localLayerId][localPk] = existingDelta.value( QStringLiteral( "uuid" ) ).toString();
+        mLocalPkToDeltaUuid[localLayerId][localPk] = existingDelta.uuid;
 
-        qDebug() << "DeltaFileWrapper::mergePatchDelta: re-added a patch delta: " << existingDelta;
+        qDebug() << "DeltaFileWrapper::mergePatchDelta: re-added a patch delta: " << existingDelta.uuid;
       }
       else
       {
         mLocalPkToDeltaUuid[localLayerId].remove( localPk );
 
-        qDebug() << "DeltaFileWrapper::mergePatchDelta: removed a patch delta: " << existingDelta;
+        qDebug() << "DeltaFileWrapper::mergePatchDelta: removed a patch delta: " << existingDelta.uuid;
       }
 
       mIsDirty = true;
@@ -1156,36 +1519,34 @@ void DeltaFileWrapper::mergePatchDelta( const QJsonObject &delta )
   }
   else
   {
-    mDeltas.append( delta );
+    appendDeltaItem( delta );
     mIsDirty = true;
 
-    qDebug() << "DeltaFileWrapper::mergePatchDelta: added a new patch delta: " << delta;
+    qDebug() << "DeltaFileWrapper::mergePatchDelta: added a new patch delta: " << delta.uuid;
 
-    mLocalPkToDeltaUuid[localLayerId][localPk] = delta.value( QStringLiteral( "uuid" ) ).toString();
+    mLocalPkToDeltaUuid[localLayerId][localPk] = delta.uuid;
 
     emit countChanged();
   }
 }
 
-void DeltaFileWrapper::mergeDelta( const QJsonObject &delta )
+void DeltaFileWrapper::mergeDelta( const Delta &delta )
 {
-  const QString deltaMethod = delta.value( "method" ).toString();
-  if ( deltaMethod == "create" )
-  {
-    mergeCreateDelta( delta );
-  }
-  else if ( deltaMethod == "delete" )
-  {
-    mergeDeleteDelta( delta );
-  }
-  else if ( deltaMethod == "patch" )
+  switch ( delta.method )
   {
-    mergePatchDelta( delta );
-  }
-  else
-  {
-    qWarning() << QStringLiteral( "Unknown delta method: %s" ).arg( deltaMethod );
-    Q_ASSERT( 0 );
+    case DeltaMethod::Create:
+      mergeCreateDelta( delta );
+      break;
+    case DeltaMethod::Delete:
+      mergeDeleteDelta( delta );
+      break;
+    case DeltaMethod::Patch:
+      mergePatchDelta( delta );
+      break;
+    case DeltaMethod::Unknown:
+      qWarning() << QStringLiteral( "Unknown delta method: %1" ).arg( delta.other.value( QStringLiteral( "method" ) ).toString() );
+      Q_ASSERT( 0 );
+      break;
   }
 }
 
@@ -1199,7 +1560,7 @@ void DeltaFileWrapper::setIsPushing( bool isPushing )
 
   if ( !mIsPushing && !mPendingDeltas.isEmpty() )
   {
-    for ( const QJsonObject delta : std::as_const( mPendingDeltas ) )
+    for ( const Delta &delta : std::as_const( mPendingDeltas ) )
     {
       mergeDelta( delta );
     }
@@ -1229,10 +1590,10 @@ QStringList DeltaFileWrapper::deltaLayerIds() const
 {
   QStringList layerIds;
 
-  for ( const QJsonValue &v : std::as_const( mDeltas ) )
+  for ( const Delta &delta : std::as_const( mDeltas ) )
   {
-    QJsonObject deltaItem = v.toObject();
-    const QString layerId = deltaItem.value( QStringLiteral( "layerId" ) ).toString();
+    // "layerId" is not a known delta key, so it is kept among the other keys
+    const QString layerId = delta.other.value( QStringLiteral( "layerId" ) ).toString();
 
     if ( !layerIds.contains( layerId ) )
       layerIds.append( layerId );
@@ -1248,57 +1609,178 @@ bool DeltaFileWrapper::isDeltaBeingApplied() const
 }
 
 
-bool DeltaFileWrapper::apply( const QgsProject *project )
+bool DeltaFileWrapper::apply( const QgsProject *project, QgsFeedback *feedback )
 {
-  return applyInternal( project, false );
+  return applyInternal( project, false, feedback );
 }
 
 
-bool DeltaFileWrapper::applyReversed( const QgsProject *project )
+bool DeltaFileWrapper::applyReversed( const QgsProject *project, QgsFeedback *feedback )
 {
-  return applyInternal( project, true );
+  return applyInternal( project, true, feedback );
 }
 
 
-bool DeltaFileWrapper::applyInternal( const QgsProject *project, bool shouldApplyInReverse )
+bool DeltaFileWrapper::applyReversedAsync( const QgsProject *project, QgsFeedback *feedback )
 {
-  if ( !toFile() )
+  if ( mAsyncApplyJob )
     return false;
 
-  mIsDeltaFileBeingApplied = true;
+  mAsyncApplyJob = startApply( project, true, feedback );
+
+  if ( !mAsyncApplyJob )
+    return false;
+
+  QTimer::singleShot( 0, this, &DeltaFileWrapper::applyNextBatchAsync );
+
+  return true;
+}
+
+
+bool DeltaFileWrapper::applyInternal( const QgsProject *project, bool shouldApplyInReverse, QgsFeedback *feedback )
+{
+  std::unique_ptr<ApplyJob> job = startApply( project, shouldApplyInReverse, feedback );
+
+  if ( !job )
+    return false;
 
   bool isSuccess = true;
+  while ( isSuccess && !job->isDone() )
+    isSuccess = applyNextBatch( *job );
+
+  return finishApply( *job, isSuccess );
+}
+
+
+void DeltaFileWrapper::applyNextBatchAsync()
+{
+  if ( !mAsyncApplyJob )
+    return;
+
+  const bool isSuccess = applyNextBatch( *mAsyncApplyJob );
+
+  // the event loop runs between batches, the progress gets shown and a cancel request can come in
+  if ( isSuccess && !mAsyncApplyJob->isDone() )
+  {
+    QTimer::singleShot( 0, this, &DeltaFileWrapper::applyNextBatchAsync );
+    return;
+  }
+
+  std::unique_ptr<ApplyJob> job = std::move( mAsyncApplyJob );
+  emit applyFinished( finishApply( *job, isSuccess ) );
+}
+
+
+std::unique_ptr<DeltaFileWrapper::ApplyJob> DeltaFileWrapper::startApply( const QgsProject *project, bool shouldApplyInReverse, QgsFeedback *feedback )
+{
+  if ( mIsDeltaFileBeingApplied || !toFile() )
+    return nullptr;
+
+  mIsDeltaFileBeingApplied = true;
+
+  std::unique_ptr<ApplyJob> job = std::make_unique<ApplyJob>();
+  job->shouldApplyInReverse = shouldApplyInReverse;
+  job->feedback = feedback;
+  job->deltas = mDeltas.values();
 
-  // 1) get all vector layers referenced in the delta file and make them editable
-  QHash<QString, QgsVectorLayer *> vectorLayers;
-  for ( const QJsonValue &deltaJson : std::as_const( mDeltas ) )
+  if ( shouldApplyInReverse )
+    std::reverse( job->deltas.begin(), job->deltas.end() );
+
+  // group the deltas per layer, keeping the order of application within each layer
+  for ( const Delta &delta : std::as_const( job->deltas ) )
   {
-    const QVariantMap delta = deltaJson.toObject().toVariantMap();
-    const QString layerId = delta.value( QStringLiteral( "localLayerId" ) ).toString();
+    const QString &layerId = delta.localLayerId;
 
-    QgsVectorLayer *vl = static_cast<QgsVectorLayer *>( project->mapLayer( layerId ) );
+    if ( !job->deltasByLayerId.contains( layerId ) )
+      job->layerIds << layerId;
+
+    job->deltasByLayerId[layerId] << &delta;
+  }
+
+  // get all vector layers referenced in the delta file and make them editable
+  for ( const QString &layerId : std::as_const( job->layerIds ) )
+  {
+    QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( project->mapLayer( layerId ) );
 
     if ( !vl || ( !vl->isEditable() && !vl->startEditing() ) )
     {
-      isSuccess = false;
-      break;
+      finishApply( *job, false );
+      return nullptr;
     }
 
-    vectorLayers.insert( vl->id(), vl );
+    job->vectorLayers.insert( layerId, vl );
   }
 
-  // 2) actual application of the delta contents
-  if ( isSuccess )
-    isSuccess = applyDeltasOnLayers( vectorLayers, shouldApplyInReverse );
+  return job;
+}
+
+
+bool DeltaFileWrapper::applyNextBatch( ApplyJob &job )
+{
+  const QString &layerId = job.layerIds.at( job.layerIndex );
+  QgsVectorLayer *vl = job.vectorLayers.value( layerId );
+
+  // the layer might have been removed from the project while the deltas were applied asynchronously
+  if ( !vl )
+  {
+    QgsMessageLog::logMessage( QStringLiteral( "Layer with id \"%1\" has been removed while applying deltas" ).arg( layerId ) );
+    return false;
+  }
+
+  // all the deltas of a layer go into a single edit command, instead of one undo command per change
+  if ( job.batchStart == 0 )
+    vl->beginEditCommand( tr( "Apply deltas" ) );
 
-  // 3) commit the changes, if fails, revert the rest of the layers
+  if ( job.feedback && job.feedback->isCanceled() )
+  {
+    QgsMessageLog::logMessage( QStringLiteral( "Applying deltas has been canceled" ) );
+    vl->destroyEditCommand();
+    return false;
+  }
+
+  // a batch is a run of consecutive deltas with the same method, capped to `DeltaApplyBatchSize`
+  const QList<const Delta *> &layerDeltas = job.deltasByLayerId[layerId];
+  const DeltaMethod batchMethod = layerDeltas.at( job.batchStart )->method;
+  qsizetype batchEnd = job.batchStart + 1;
+  while ( batchEnd < layerDeltas.size()
+          && batchEnd - job.batchStart < DeltaApplyBatchSize
+          && layerDeltas.at( batchEnd )->method == batchMethod )
+    batchEnd++;
+
+  if ( !applyDeltaBatchOnLayer( vl, layerDeltas.mid( job.batchStart, batchEnd - job.batchStart ), job.shouldApplyInReverse ) )
+  {
+    vl->destroyEditCommand();
+    return false;
+  }
+
+  job.appliedDeltasCount += batchEnd - job.batchStart;
+  job.batchStart = batchEnd;
+
+  if ( job.batchStart == layerDeltas.size() )
+  {
+    vl->endEditCommand();
+    job.layerIndex++;
+    job.batchStart = 0;
+  }
+
+  if ( job.feedback )
+    job.feedback->setProgress( 100.0 * static_cast<double>( job.appliedDeltasCount ) / static_cast<double>( job.deltas.size() ) );
+
+  return true;
+}
+
+
+bool DeltaFileWrapper::finishApply( ApplyJob &job, bool isSuccess )
+{
+  // commit the changes, if fails, revert the rest of the layers
   if ( isSuccess )
   {
-    for ( auto [layerId, vl] : qfield::asKeyValueRange( vectorLayers ) )
+    for ( const QString &layerId : std::as_const( job.layerIds ) )
     {
-      // despite the error, try to rollback all the changes so far
-      if ( vl->commitChanges() )
-        vectorLayers[layerId] = nullptr;
+      QgsVectorLayer *vl = job.vectorLayers.value( layerId );
+
+      if ( vl && vl->commitChanges() )
+        job.vectorLayers.remove( layerId );
       else
       {
         QgsMessageLog::logMessage( QStringLiteral( "Failed to commit layer with id \"%1\", all the rest layers will be rolled back" ).arg( layerId ) );
@@ -1308,12 +1790,12 @@ bool DeltaFileWrapper::applyInternal( const QgsProject *project, bool shouldAppl
     }
   }
 
-  // 4) revert the changes that didn't manage to be applied
+  // revert the changes that didn't manage to be applied
   if ( !isSuccess )
   {
-    for ( auto [layerId, vl] : qfield::asKeyValueRange( vectorLayers ) )
+    for ( auto [layerId, vl] : qfield::asKeyValueRange( job.vectorLayers ) )
     {
-      // the layer has already been committed
+      // the layer has been removed from the project
       if ( !vl )
         continue;
 
@@ -1329,68 +1811,37 @@ bool DeltaFileWrapper::applyInternal( const QgsProject *project, bool shouldAppl
 }
 
 
-bool DeltaFileWrapper::applyDeltasOnLayers( QHash<QString, QgsVectorLayer *> &vectorLayers, bool shouldApplyInReverse )
+bool DeltaFileWrapper::applyDeltaBatchOnLayer( QgsVectorLayer *vl, const QList<const Delta *> &deltas, bool shouldApplyInReverse )
 {
-  QJsonArray deltas;
-
-  if ( shouldApplyInReverse )
-    // not the most optimal solution, but at least the QJsonValues are not copied
-    for ( qsizetype i = mDeltas.size(); i > 0; )
-      deltas.append( mDeltas[--i] );
-  else
-    deltas = QJsonArray( mDeltas );
-
-  for ( const QJsonValue &deltaJson : std::as_const( deltas ) )
-  {
-    const QVariantMap delta = deltaJson.toObject().toVariantMap();
-    const QString layerId = delta.value( QStringLiteral( "localLayerId" ) ).toString();
-    const QString localPk = delta.value( QStringLiteral( "localPk" ) ).toString();
-    const QgsFields fields = vectorLayers[layerId]->fields();
-    const QPair<int, QString> pkAttrPair = getLocalPkAttribute( vectorLayers[layerId] );
-
-    QString method = delta.value( QStringLiteral( "method" ) ).toString();
-    QVariantMap oldValues = delta.value( QStringLiteral( "old" ) ).toMap();
-    QVariantMap newValues = delta.value( QStringLiteral( "new" ) ).toMap();
-    QgsFeature f;
+  if ( deltas.isEmpty() )
+    return true;
 
-    if ( shouldApplyInReverse )
-    {
-      if ( method == QStringLiteral( "create" ) )
-        method = QStringLiteral( "delete" );
-      else if ( method == QStringLiteral( "delete" ) )
-        method = QStringLiteral( "create" );
+  const QgsFields fields = vl->fields();
+  const QPair<int, QString> pkAttrPair = getLocalPkAttribute( vl );
 
-      std::swap( oldValues, newValues );
-    }
+  DeltaMethod method = deltas.at( 0 )->method;
 
-    Q_ASSERT( vectorLayers[layerId] );
+  if ( shouldApplyInReverse )
+  {
+    if ( method == DeltaMethod::Create )
+      method = DeltaMethod::Delete;
+    else if ( method == DeltaMethod::Delete )
+      method = DeltaMethod::Create;
+  }
 
-    if ( !vectorLayers[layerId] )
-      return false;
+  if ( method == DeltaMethod::Create )
+  {
+    QgsFeatureList createdFeatures;
+    createdFeatures.reserve( deltas.size() );
 
-    if ( method != QStringLiteral( "create" ) )
+    for ( const Delta *delta : deltas )
     {
-      QgsExpression expr( QStringLiteral( " %1 = %2 " ).arg( QgsExpression::quotedColumnRef( pkAttrPair.second ), QgsExpression::quotedString( localPk ) ) );
-      QgsFeatureIterator it = vectorLayers[layerId]->getFeatures( QgsFeatureRequest( expr ) );
-
-      if ( !it.nextFeature( f ) )
-        return false;
-
-      QgsFeature tempFeature;
-      if ( it.nextFeature( tempFeature ) )
-        return false;
+      const DeltaData newValues = ( shouldApplyInReverse ? delta->oldData : delta->newData ).value_or( DeltaData() );
 
-      if ( !f.isValid() )
-        return false;
-    }
-
-    if ( method == QStringLiteral( "create" ) )
-    {
-      Q_ASSERT( oldValues.isEmpty() );
       Q_ASSERT( !newValues.isEmpty() );
 
-      const QString geomWkt = newValues.value( QStringLiteral( "geometry" ) ).toString();
-      const QVariantMap attributes = newValues.value( QStringLiteral( "attributes" ) ).toMap();
+      const QString geomWkt = newValues.geometry.toString();
+      const QHash<QString, QJsonValue> attributes = newValues.attributes.value_or( QHash<QString, QJsonValue>() );
 
       QgsGeometry geom;
       QgsAttributeMap qgsAttributeMap;
@@ -1399,52 +1850,127 @@ bool DeltaFileWrapper::applyDeltasOnLayers( QHash<QString, QgsVectorLayer *> &ve
         geom = QgsGeometry::fromWkt( geomWkt );
 
       for ( auto [attrName, attrValue] : qfield::asKeyValueRange( attributes ) )
-        qgsAttributeMap.insert( fields.indexFromName( attrName ), attrValue );
+        qgsAttributeMap.insert( fields.indexFromName( attrName ), attrValue.toVariant() );
 
-      QgsFeature createdFeature = QgsVectorLayerUtils::createFeature( vectorLayers[layerId], geom, qgsAttributeMap );
+      QgsFeature createdFeature = QgsVectorLayerUtils::createFeature( vl, geom, qgsAttributeMap );
 
       Q_ASSERT( createdFeature.isValid() );
 
-      if ( !vectorLayers[layerId]->addFeature( createdFeature ) )
-        return false;
+      createdFeatures << createdFeature;
     }
-    else if ( method == QStringLiteral( "delete" ) )
+
+    return vl->addFeatures( createdFeatures );
+  }
+
+  // resolve the local primary keys of the whole batch with a single request
+  if ( pkAttrPair.first == -1 )
+    return false;
+
+  QStringList quotedLocalPks;
+  QSet<QString> localPks;
+  for ( const Delta *delta : deltas )
+  {
+    const QString &localPk = delta->localPk;
+
+    if ( localPks.contains( localPk ) )
+      continue;
+
+    localPks.insert( localPk );
+    quotedLocalPks << QgsExpression::quotedString( localPk );
+  }
+
+  QgsFeatureRequest request( QgsExpression( QStringLiteral( " %1 IN (%2) " ).arg( QgsExpression::quotedColumnRef( pkAttrPair.second ), quotedLocalPks.join( QStringLiteral( ", " ) ) ) ) );
+  request.setSubsetOfAttributes( QgsAttributeList() << pkAttrPair.first );
+#if _QGIS_VERSION_INT >= 33500
+  request.setFlags( Qgis::FeatureRequestFlag::NoGeometry );
+#else
+  request.setFlags( QgsFeatureRequest::NoGeometry );
+#endif
+
+  QHash<QString, QgsFeatureId> featureIdsByLocalPk;
+  QgsFeatureIterator it = vl->getFeatures( request );
+  QgsFeature f;
+  while ( it.nextFeature( f ) )
+  {
+    if ( !f.isValid() )
+      return false;
+
+    const QString localPk = f.attribute( pkAttrPair.first ).toString();
+
+    // the local primary key should be unique
+    if ( featureIdsByLocalPk.contains( localPk ) )
+      return false;
+
+    featureIdsByLocalPk.insert( localPk, f.id() );
+  }
+
+  if ( featureIdsByLocalPk.size() != localPks.size() )
+    return false;
+
+  if ( method == DeltaMethod::Delete )
+  {
+    QgsFeatureIds deletedFeatureIds;
+    for ( const Delta *delta : deltas )
     {
-      Q_ASSERT( newValues.isEmpty() );
-      Q_ASSERT( !oldValues.isEmpty() );
-      Q_ASSERT( f.isValid() );
+      Q_ASSERT( !( shouldApplyInReverse ? delta->newData : delta->oldData ).value_or( DeltaData() ).isEmpty() );
 
-      if ( !vectorLayers[layerId]->deleteFeature( f.id() ) )
-        return false;
+      deletedFeatureIds << featureIdsByLocalPk.value( delta->localPk );
     }
-    else if ( method == QStringLiteral( "patch" ) )
+
+    return vl->deleteFeatures( deletedFeatureIds );
+  }
+  else if ( method == DeltaMethod::Patch )
+  {
+    // consecutive patches of the same feature are collapsed, the last value wins
+    QList<QgsFeatureId> changedFeatureIds;
+    QHash<QgsFeatureId, QgsAttributeMap> changedAttributeValues;
+    QHash<QgsFeatureId, QgsGeometry> changedGeometries;
+    for ( const Delta *delta : deltas )
     {
-      Q_ASSERT( !newValues.isEmpty() );
-      Q_ASSERT( !oldValues.isEmpty() );
-      Q_ASSERT( f.isValid() );
+      const DeltaData newValues = ( shouldApplyInReverse ? delta->oldData : delta->newData ).value_or( DeltaData() );
+      const QgsFeatureId fid = featureIdsByLocalPk.value( delta->localPk );
 
-      const QString geomWkt = newValues.value( QStringLiteral( "geometry" ) ).toString();
-      const QVariantMap attributes = newValues.value( QStringLiteral( "attributes" ) ).toMap();
+      Q_ASSERT( !newValues.isEmpty() );
 
-      if ( !geomWkt.isEmpty() )
+      if ( !changedAttributeValues.contains( fid ) )
       {
-        QgsGeometry geom = QgsGeometry::fromWkt( geomWkt );
-        vectorLayers[layerId]->changeGeometry( f.id(), geom );
+        changedFeatureIds << fid;
+        changedAttributeValues.insert( fid, QgsAttributeMap() );
       }
 
+      const QString geomWkt = newValues.geometry.toString();
+      if ( !geomWkt.isEmpty() )
+        changedGeometries.insert( fid, QgsGeometry::fromWkt( geomWkt ) );
+
+      QgsAttributeMap &attributeMap = changedAttributeValues[fid];
+      const QHash<QString, QJsonValue> attributes = newValues.attributes.value_or( QHash<QString, QJsonValue>() );
       for ( auto [attrName, attrValue] : qfield::asKeyValueRange( attributes ) )
       {
-        if ( !vectorLayers[layerId]->changeAttributeValue( f.id(), fields.indexOf( attrName ), attrValue ) )
+        const int attrIdx = fields.indexOf( attrName );
+
+        if ( attrIdx == -1 )
           return false;
+
+        attributeMap.insert( attrIdx, attrValue.toVariant() );
       }
     }
-    else
+
+    for ( const QgsFeatureId fid : std::as_const( changedFeatureIds ) )
     {
-      Q_ASSERT( 0 );
+      if ( changedGeometries.contains( fid ) )
+        vl->changeGeometry( fid, changedGeometries[fid] );
+
+      const QgsAttributeMap &attributeMap = changedAttributeValues[fid];
+      if ( !attributeMap.isEmpty() && !vl->changeAttributeValues( fid, attributeMap ) )
+        return false;
     }
+
+    return true;
   }
 
-  return true;
+  Q_ASSERT( 0 );
+
+  return false;
 }
 
 QJsonValue DeltaFileWrapper::attributeToJsonValue( const QVariant &value )
@@ -1467,16 +1993,12 @@ bool DeltaFileWrapper::isCreatedFeature( QgsVectorLayer *vl, QgsFeature feature
   const QString pk = feature.attribute( localPkAttrPair.second ).toString();
   const QString layerId = vl->id();
 
-  for ( const QJsonValue &deltaJson : std::as_const( mDeltas ) )
+  for ( const Delta &delta : std::as_const( mDeltas ) )
   {
-    QVariantMap delta = deltaJson.toObject().toVariantMap();
-    const QString method = delta.value( QStringLiteral( "method" ) ).toString();
-    if ( method != QStringLiteral( "create" ) )
+    if ( delta.method != DeltaMethod::Create )
       continue;
 
-    const QString localLayerId = delta.value( QStringLiteral( "localLayerId" ) ).toString();
-    const QString localPk = delta.value( QStringLiteral( "localPk" ) ).toString();
-    if ( localLayerId == layerId && localPk == pk )
+    if ( delta.localLayerId == layerId && delta.localPk == pk )
       return true;
   }
 
@@ -1546,50 +2068,89 @@ QString DeltaFileWrapper::getSourceLayerId( const QgsVectorLayer *vl )
 
 int DeltaFileWrapper::getDeltaIndexByUuid( const QString &uuid ) const
 {
-  int idx = 0;
+  const qint64 sequence = getDeltaSequenceByUuid( uuid );
+
+  if ( sequence == -1 )
+    return -1;
+
+  return static_cast<int>( std::distance( mDeltas.constBegin(), mDeltas.constFind( sequence ) ) );
+}
+
+qint64 DeltaFileWrapper::getDeltaSequenceByUuid( const QString &uuid ) const
+{
+  return mDeltaSequenceByUuid.value( uuid, -1 );
+}
+
+QString DeltaFileWrapper::lastPatchDeltaUuid( const QString &localLayerId, const QString &localPk ) const
+{
+  const QSet<QString> uuids = mDeltaUuidsByLocalPk.value( qMakePair( localLayerId, localPk ) );
+  QString lastPatchUuid;
+  qint64 lastPatchSequence = -1;
 
-  for ( const QJsonValueConstRef &deltaJson : std::as_const( mDeltas ) )
+  for ( const QString &uuid : uuids )
   {
-    Q_ASSERT( deltaJson.isObject() );
+    const qint64 sequence = mDeltaSequenceByUuid.value( uuid, -1 );
 
-    const QVariantMap delta = deltaJson.toObject().toVariantMap();
+    Q_ASSERT( sequence >= 0 );
 
-    if ( delta.value( QStringLiteral( "uuid" ) ) == uuid )
+    if ( sequence > lastPatchSequence && mDeltas.constFind( sequence )->method == DeltaMethod::Patch )
     {
-      return idx;
+      lastPatchSequence = sequence;
+      lastPatchUuid = uuid;
     }
-
-    idx++;
   }
 
-  return -1;
+  return lastPatchUuid;
+}
+
+void DeltaFileWrapper::indexDelta( qint64 sequence )
+{
+  const Delta &delta = *mDeltas.constFind( sequence );
+
+  mDeltaSequenceByUuid.insert( delta.uuid, sequence );
+  mDeltaUuidsByLocalPk[qMakePair( delta.localLayerId, delta.localPk )].insert( delta.uuid );
+}
+
+void DeltaFileWrapper::unindexDelta( qint64 sequence )
+{
+  const Delta &delta = *mDeltas.constFind( sequence );
+
+  mDeltaSequenceByUuid.remove( delta.uuid );
+
+  auto it = mDeltaUuidsByLocalPk.find( qMakePair( delta.localLayerId, delta.localPk ) );
+  if ( it != mDeltaUuidsByLocalPk.end() )
+  {
+    it->remove( delta.uuid );
+
+    if ( it->isEmpty() )
+      mDeltaUuidsByLocalPk.erase( it );
+  }
 }
 
-bool DeltaFileWrapper::deltaContainsActualChange( const QJsonObject &delta ) const
+bool DeltaFileWrapper::deltaContainsActualChange( const Delta &delta ) const
 {
-  const QJsonObject oldData = delta.value( QStringLiteral( "old" ) ).toObject();
-  const QJsonObject newData = delta.value( QStringLiteral( "new" ) ).toObject();
-  const QJsonObject newDataAttrs = newData.value( QStringLiteral( "attributes" ) ).toObject();
-  const QJsonObject oldDataAttrs = oldData.value( QStringLiteral( "attributes" ) ).toObject();
-  const QStringList newDataAttrNames = newData.value( QStringLiteral( "attributes" ) ).toObject().keys();
+  const DeltaData oldData = delta.oldData.value_or( DeltaData() );
+  const DeltaData newData = delta.newData.value_or( DeltaData() );
+  const QHash<QString, QJsonValue> newDataAttrs = newData.attributes.value_or( QHash<QString, QJsonValue>() );
+  const QHash<QString, QJsonValue> oldDataAttrs = oldData.attributes.value_or( QHash<QString, QJsonValue>() );
 
   // the attributes in the `newData` are always going to be a (full) subset of `oldData`
-  for ( const QString &attrName : newDataAttrNames )
+  for ( auto [attrName, attrValue] : qfield::asKeyValueRange( newDataAttrs ) )
   {
-    if ( newDataAttrs.value( attrName ) != oldDataAttrs.value( attrName ) )
+    if ( attrValue != oldDataAttrs.value( attrName, QJsonValue( QJsonValue::Undefined ) ) )
     {
       return true;
     }
   }
 
   // no "geometry" in `newData` indicates there was no change in geometry
-  if ( newData.value( QStringLiteral( "geometry" ) ).isUndefined() )
+  if ( newData.geometry.isUndefined() )
   {
     return false;
   }
 
   // when the "geometry" value differs, then it means the delta makes sense
-  if ( newData.value( QStringLiteral( "geometry" ) ) != oldData.value( QStringLiteral( "geometry" ) ) )
+  if ( newData.geometry != oldData.geometry )
   {
     return true;
   }
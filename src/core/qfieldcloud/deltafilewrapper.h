@@ -18,15 +18,33 @@
 #ifndef FEATUREDELTAS_H
 #define FEATUREDELTAS_H
 
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMap>
+#include <QPointer>
+#include <QSet>
 #include <qgsfeature.h>
+#include <qgsfeedback.h>
 #include <qgslogger.h>
 #include <qgsvectorlayer.h>
 
+#include <memory>
+#include <optional>
+
 const QString DeltaFormatVersion = QStringLiteral( "1.0" );
 
+/**
+ * Number of journal records after which the next `toFile()` call compacts the journal back into the delta file.
+ */
+const int DeltaJournalCompactionThreshold = 500;
+
+/**
+ * Maximum number of deltas applied on a layer at once, the progress is reported and cancelation checked between batches.
+ */
+const int DeltaApplyBatchSize = 1000;
+
 /**
  * A class that wraps the operations with a delta file. All read and write operations to a delta file should go through this class.
  * \ingroup core
@@ -221,6 +239,36 @@ class DeltaFileWrapper : public QObject
     Q_INVOKABLE bool toFile();
 
 
+    /**
+     * Rewrites the complete deltas file to the permanent storage and removes the journal file.
+     *
+     * @return bool whether write has been successful
+     */
+    bool compact();
+
+
+    /**
+     * Returns whether the journaling mode is enabled.
+     */
+    bool isJournalingEnabled() const;
+
+
+    /**
+     * Sets whether the journaling mode is enabled. When enabled, `toFile()` appends the delta changes since the last write
+     * to a journal file next to the deltas file instead of rewriting the deltas file, which gets compacted periodically.
+     * A journal left behind by an interrupted session is always replayed on construction, whether the mode is enabled or not.
+     *
+     * @param enabled set to TRUE to enable the journaling mode
+     */
+    void setJournalingEnabled( bool enabled );
+
+
+    /**
+     * Returns the journal file name, where the delta changes are appended in journaling mode.
+     */
+    QString journalFileName() const;
+
+
     /**
      * Writes deltas file to the permanent storage with replaced layerIds, ready for upload.
      *
@@ -310,23 +358,37 @@ class DeltaFileWrapper : public QObject
     /**
      * Attempts to apply a delta file.
      * The list of deltas is not being reset after successfull application and should be handled by the caller.
+     * The deltas are applied in batches per layer. If a \a feedback is given, it receives the progress and
+     * canceling it stops the application and rolls back the layers.
      *
      * @note it is not guaranteed that the project layers have not changed in case of failure
      * @return whether the attempt was successful
      * @todo TEST
      */
-    Q_INVOKABLE bool apply( const QgsProject *project );
+    Q_INVOKABLE bool apply( const QgsProject *project, QgsFeedback *feedback = nullptr );
 
 
     /**
      * Attempts to apply a delta file in reverse order (resulting in local changes being discarded).
      * The list of deltas is not being reset after successfull application and should be handled by the caller.
+     * The deltas are applied in batches per layer. If a \a feedback is given, it receives the progress and
+     * canceling it stops the application and rolls back the layers.
      *
      * @note it is not guaranteed that the project layers have not changed in case of failure
      * @return whether the attempt was successful.
      * @todo TEST
      */
-    Q_INVOKABLE bool applyReversed( const QgsProject *project );
+    Q_INVOKABLE bool applyReversed( const QgsProject *project, QgsFeedback *feedback = nullptr );
+
+    /**
+     * Starts applying the delta file in reverse order, like applyReversed(), one batch per event loop iteration.
+     * The layers stay in edit mode until `applyFinished` is emitted. If a \a feedback is given, it receives the
+     * progress and canceling it stops the application and rolls back the layers. The layers removed from the
+     * project meanwhile make the application fail.
+     *
+     * @return whether the application has been started
+     */
+    bool applyReversedAsync( const QgsProject *project, QgsFeedback *feedback = nullptr );
 
     /**
      * Returns TRUE if the pushing state is active.
@@ -344,12 +406,19 @@ class DeltaFileWrapper : public QObject
 
     /**
      * Retuns the index position of a delta with given \a uuid in the deltas list or -1 if missing.
+     * The uuid lookup is done in constant time, the index position is then counted in linear time.
      *
      * @param uuid the uuid we are looking for
      */
     int getDeltaIndexByUuid( const QString &uuid ) const;
 
 
+    /**
+     * Returns the uuid of the last patch delta for the feature with \a localPk in \a localLayerId, or an empty string if missing.
+     */
+    QString lastPatchDeltaUuid( const QString &localLayerId, const QString &localPk ) const;
+
+
   signals:
     /**
      * Emitted when the `deltas` list has changed.
@@ -372,7 +441,105 @@ class DeltaFileWrapper : public QObject
      */
     void errorChanged();
 
+    /**
+     * Emitted when the application started with applyReversedAsync() is finished, \a isSuccess is FALSE if it
+     * failed or has been canceled.
+     */
+    void applyFinished( bool isSuccess );
+
   private:
+    /**
+     * The method of a delta.
+     */
+    enum class DeltaMethod
+    {
+      Unknown,
+      Create,
+      Delete,
+      Patch
+    };
+
+    /**
+     * Typed representation of the "old" and "new" data of a delta.
+     */
+    struct DeltaData
+    {
+        //! The "geometry" value, either a WKT string, null, or undefined when missing
+        QJsonValue geometry = QJsonValue( QJsonValue::Undefined );
+        //! The "attributes" values, keyed by interned field names
+        std::optional<QHash<QString, QJsonValue>> attributes;
+        //! The "files_sha256" values, keyed by file names
+        std::optional<QJsonObject> filesSha256;
+        //! The "is_snapshot" value
+        std::optional<bool> isSnapshot;
+        //! Any other key, kept as it is
+        QJsonObject other;
+
+        bool isEmpty() const { return geometry.isUndefined() && !attributes && !filesSha256 && !isSnapshot && other.isEmpty(); }
+
+        bool operator==( const DeltaData &o ) const { return geometry == o.geometry && attributes == o.attributes && filesSha256 == o.filesSha256 && isSnapshot == o.isSnapshot && other == o.other; }
+    };
+
+    /**
+     * Typed in-memory representation of a delta. The layer related strings and field names are interned, so they are shared among all the deltas.
+     */
+    struct Delta
+    {
+        DeltaMethod method = DeltaMethod::Unknown;
+        QString uuid;
+        QString localPk;
+        QString sourcePk;
+        QString localLayerId;
+        QString localLayerCrs;
+        QString localLayerName;
+        QString sourceLayerId;
+        QString exportId;
+        QString clientId;
+        std::optional<DeltaData> oldData;
+        std::optional<DeltaData> newData;
+        //! Bit mask of the string keys missing in the JSON delta, indexed as in `sDeltaStringKeys`
+        quint16 missingKeys = 0;
+        //! Any other key, or known keys with unexpected value type, kept as they are
+        QJsonObject other;
+    };
+
+    /**
+     * The state of a delta file application, advanced one batch at a time.
+     */
+    struct ApplyJob
+    {
+        bool shouldApplyInReverse = false;
+        QPointer<QgsFeedback> feedback;
+        //! The deltas in the order of application, copied as the deltas list can change during an asynchronous application
+        QList<Delta> deltas;
+        //! The ids of the layers, in the order of application
+        QStringList layerIds;
+        //! The deltas of each layer, pointing into `deltas`
+        QHash<QString, QList<const Delta *>> deltasByLayerId;
+        //! The layers in edit mode, the committed ones are removed
+        QHash<QString, QPointer<QgsVectorLayer>> vectorLayers;
+        //! The index in `layerIds` of the layer being applied
+        qsizetype layerIndex = 0;
+        //! The index in the deltas of the layer being applied of the next batch
+        qsizetype batchStart = 0;
+        qsizetype appliedDeltasCount = 0;
+
+        bool isDone() const { return layerIndex >= layerIds.size(); }
+    };
+
+    /**
+     * A change of the deltas list, waiting to be written in the journal file.
+     */
+    struct JournalRecord
+    {
+        //! The journal operation, one of "append", "remove", "replace", "reset" or "id"
+        QString op;
+        //! The uuid of the removed delta or the new delta file id
+        QString value;
+        //! The appended or replaced delta
+        Delta delta;
+    };
+
     /**
      * Set the error type and details string.
      */
@@ -386,23 +553,47 @@ class DeltaFileWrapper : public QObject
     QJsonValue geometryToJsonValue( const QgsGeometry &geom ) const;
 
     /**
-     * Applies the current delta file on the current project. A wrapper method arround \a _applyDeltasOnLayers.
+     * Applies the current delta file on the current project, all the batches at once.
      * If \a shouldApplyInReverse is passed, the deltas are applied in reverse order (e.g. discarding the changes).
      */
-    bool applyInternal( const QgsProject *project, bool shouldApplyInReverse );
+    bool applyInternal( const QgsProject *project, bool shouldApplyInReverse, QgsFeedback *feedback );
 
 
     /**
-     * Applies the current delta file on a list of given layers \a vectorLayers.
-     * If \a shouldApplyInReverse is passed, the deltas are applied in reverse order (e.g. discarding the changes).
+     * Groups the deltas per layer and makes the layers of \a project editable.
+     * Returns NULLPTR if a layer is missing or cannot be edited, or if the delta file is already being applied.
+     */
+    std::unique_ptr<ApplyJob> startApply( const QgsProject *project, bool shouldApplyInReverse, QgsFeedback *feedback );
+
+
+    /**
+     * Applies the next batch of same method deltas of the \a job. The deltas of a layer go into a single edit command.
+     * Returns FALSE if the batch failed, a layer has been removed or the feedback of the \a job has been canceled.
      */
-    bool applyDeltasOnLayers( QHash<QString, QgsVectorLayer *> &vectorLayers, bool shouldApplyInReverse );
+    bool applyNextBatch( ApplyJob &job );
+
+
+    /**
+     * Commits the layers of the \a job if \a isSuccess, or rolls them back. Returns whether all the layers have been committed.
+     */
+    bool finishApply( ApplyJob &job, bool isSuccess );
+
+
+    //! Applies the next batch of the asynchronous application and schedules the following one
+    void applyNextBatchAsync();
+
+
+    /**
+     * Applies a batch of \a deltas with the same method on the vector layer \a vl.
+     * Created features are added with a single call, deleted and patched features are looked up with a single request.
+     */
+    bool applyDeltaBatchOnLayer( QgsVectorLayer *vl, const QList<const Delta *> &deltas, bool shouldApplyInReverse );
 
     /**
      * Add file checksums from relevant changed attributes.
      * \returns A std::tuple<QJsonObject, QJsonObject> where the first object reflects new file checksums and the second reflects old file checkums.
      */
-    std::tuple<QJsonObject, QJsonObject> addAttachments( const QgsProject *project, const QString &localLayerId, const QJsonObject &newAttrs, const QJsonObject &oldAttrs = QJsonObject() );
+    std::tuple<QJsonObject, QJsonObject> addAttachments( const QgsProject *project, const QString &localLayerId, const QHash<QString, QJsonValue> &newAttrs, const QHash<QString, QJsonValue> &oldAttrs = QHash<QString, QJsonValue>() );
 
     /**
      * Converts QVariant value to QJsonValue
@@ -410,59 +601,194 @@ class DeltaFileWrapper : public QObject
     QJsonValue attributeToJsonValue( const QVariant &value );
 
 
+    /**
+     * Returns a new delta with \a method, filled with the values shared by all the delta methods.
+     */
+    Delta createDelta( const QgsProject *project, DeltaMethod method, const QString &localLayerId, const QString &sourceLayerId, const QVariant &localPk, const QVariant &sourcePk );
+
+
+    /**
+     * Returns the shared instance of \a string, so repeated layer ids and field names are stored only once.
+     */
+    QString intern( const QString &string );
+
+
+    /**
+     * Converts the JSON \a object to a typed delta.
+     */
+    Delta deltaFromJson( const QJsonObject &object );
+
+
+    /**
+     * Converts the typed \a delta to a JSON object.
+     */
+    static QJsonObject deltaToJson( const Delta &delta );
+
+
+    /**
+     * Converts the JSON \a object to typed delta data.
+     */
+    DeltaData deltaDataFromJson( const QJsonObject &object );
+
+
+    /**
+     * Converts the typed delta \a data to a JSON object.
+     */
+    static QJsonObject deltaDataToJson( const DeltaData &data );
+
+
+    /**
+     * Appends \a delta at the end of the stored deltas and records the change in the journal.
+     */
+    void appendDeltaItem( const Delta &delta );
+
+
+    /**
+     * Removes the delta with the \a sequence number from the stored deltas and records the change in the journal.
+     */
+    void removeDeltaItem( qint64 sequence );
+
+
+    /**
+     * Replaces the delta with the \a sequence number with \a delta and records the change in the journal.
+     */
+    void replaceDeltaItem( qint64 sequence, const Delta &delta );
+
+
+    /**
+     * Adds the delta with the \a sequence number to the uuid and local primary key indices.
+     */
+    void indexDelta( qint64 sequence );
+
+
+    /**
+     * Removes the delta with the \a sequence number from the uuid and local primary key indices.
+     */
+    void unindexDelta( qint64 sequence );
+
+
+    /**
+     * Returns the sequence number of the delta with given \a uuid or -1 if missing.
+     */
+    qint64 getDeltaSequenceByUuid( const QString &uuid ) const;
+
+
+    /**
+     * Queues the journal \a record to be written on the next `toFile()` call, if the journaling mode is enabled.
+     */
+    void addJournalRecord( const JournalRecord &record );
+
+
+    /**
+     * Replays the journal file records on top of the deltas loaded from the deltas file.
+     */
+    void replayJournal();
+
+
+    /**
+     * Applies a single journal \a record on the stored deltas. Records are idempotent, so replaying a journal that has already been compacted is harmless.
+     */
+    void applyJournalRecord( const QJsonObject &record );
+
+
+    /**
+     * Writes the complete deltas file to the permanent storage.
+     */
+    bool writeDeltaFile();
+
+
     /**
      * Append generated \a delta.
      */
-    void appendDelta( const QJsonObject &delta );
+    void appendDelta( const Delta &delta );
 
 
     /**
      * Merge the generated \a delta into stored deltas.
      */
-    void mergeDelta( const QJsonObject &delta );
+    void mergeDelta( const Delta &delta );
 
 
     /**
      * Merge the generated create \a delta into stored deltas. Should only be called from `mergeDelta` method.
      */
-    void mergeCreateDelta( const QJsonObject &delta );
+    void mergeCreateDelta( const Delta &delta );
 
 
     /**
      * Merge the generated delete \a delta into stored deltas. Should only be called from `mergeDelta` method.
      */
-    void mergeDeleteDelta( const QJsonObject &delta );
+    void mergeDeleteDelta( const Delta &delta );
 
 
     /**
      * Merge the generated patch \a delta into stored deltas. Should only be called from `mergeDelta` method.
      */
-    void mergePatchDelta( const QJsonObject &delta );
+    void mergePatchDelta( const Delta &delta );
 
     /**
      * Checks whether the delta really has a change between the `old` and `new` attributes and geometry.
      *
      * It may not have any change in case undo/redo and delta merging is applied.
      */
-    bool deltaContainsActualChange( const QJsonObject &delta ) const;
+    bool deltaContainsActualChange( const Delta &delta ) const;
 
     /**
      * A mapping between the local primary key and the uuid of the delta.
      */
-    QMap<QString, QMap<QString, QString>> mLocalPkToDeltaUuid;
+    QHash<QString, QHash<QString, QString>> mLocalPkToDeltaUuid;
+
+
+    /**
+     * A mapping between the uuid of the delta and its sequence number in `mDeltas`.
+     */
+    QHash<QString, qint64> mDeltaSequenceByUuid;
+
+
+    /**
+     * A mapping between the local layer id and local primary key pair and the uuids of all the deltas referring to it.
+     */
+    QHash<QPair<QString, QString>, QSet<QString>> mDeltaUuidsByLocalPk;
 
     /**
-     * The list of JSON deltas.
+     * The deltas, keyed by a sequence number increasing with each stored delta, so removing a delta does not shift the others.
      */
-    QJsonArray mDeltas;
+    QMap<qint64, Delta> mDeltas;
 
     /**
-     * The list of pending JSON deltas.
+     * The sequence number of the next stored delta.
      */
-    QList<QJsonObject> mPendingDeltas;
+    qint64 mNextDeltaSequence = 0;
 
     /**
-     * The root deltas JSON object.
+     * The list of pending deltas.
+     */
+    QList<Delta> mPendingDeltas;
+
+    /**
+     * The journal records that have not been written to the journal file yet.
+     */
+    QList<JournalRecord> mJournalPendingRecords;
+
+
+    /**
+     * Number of records stored in the journal file since the last compaction.
+     */
+    int mJournalRecordsCount = 0;
+
+
+    /**
+     * Whether the journaling mode is enabled.
+     */
+    bool mIsJournalingEnabled = false;
+
+    /**
+     * The pool of interned layer related strings and field names.
+     */
+    QSet<QString> mInternedStrings;
+
+    /**
+     * The root deltas JSON object, without the deltas themselves.
      */
     QJsonObject mJsonRoot;
 
@@ -507,6 +833,12 @@ class DeltaFileWrapper : public QObject
      * Whether the delta file is currently being applied.
      */
     bool mIsDeltaFileBeingApplied = false;
+
+
+    /**
+     * The application started with applyReversedAsync(), if not finished yet.
+     */
+    std::unique_ptr<ApplyJob> mAsyncApplyJob;
 };
 
 #endif // FEATUREDELTAS_H
@@ -0,0 +1,288 @@
+/***************************************************************************
+    downloadscheduler.cpp
+    ---------------------
+    begin                : October 2026
+    copyright            : (C) 2026 by OPENGIS.ch
+    email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "downloadscheduler.h"
+
+#include <QFileInfo>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+
+
+DownloadScheduler::DownloadScheduler( QObject *parent )
+  : QObject( parent )
+{
+  mClock.start();
+}
+
+
+DownloadScheduler::Priority DownloadScheduler::priorityForFile( const QString &fileName, bool isAttachment )
+{
+  const QString suffix = QFileInfo( fileName ).suffix().toLower();
+
+  if ( suffix == QLatin1String( "qgs" ) || suffix == QLatin1String( "qgz" ) )
+    return Priority::ProjectFile;
+
+  return isAttachment ? Priority::Attachment : Priority::Layer;
+}
+
+
+bool DownloadScheduler::isRetryableError( QNetworkReply::NetworkError error, int httpStatus )
+{
+  if ( httpStatus == 408 || httpStatus == 429 || ( httpStatus >= 500 && httpStatus < 600 ) )
+    return true;
+
+  switch ( error )
+  {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyConnectionClosedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::ServiceUnavailableError:
+    case QNetworkReply::InternalServerError:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+
+void DownloadScheduler::setMaxParallelDownloads( int maxParallelDownloads )
+{
+  maxParallelDownloads = std::max( 1, maxParallelDownloads );
+
+  if ( mMaxParallelDownloads == maxParallelDownloads )
+    return;
+
+  mMaxParallelDownloads = maxParallelDownloads;
+  emit maxParallelDownloadsChanged();
+
+  dispatch();
+}
+
+
+int DownloadScheduler::retryDelayMs( int retryCount ) const
+{
+  const qint64 delay = static_cast<qint64>( mRetryBaseDelayMs ) << std::clamp( retryCount, 0, 16 );
+  return static_cast<int>( std::min( delay, static_cast<qint64>( sMaxRetryDelayMs ) ) );
+}
+
+
+void DownloadScheduler::enqueue( const QString &fileKey, qint64 bytesTotal, Priority priority )
+{
+  if ( mFiles.contains( fileKey ) )
+    return;
+
+  ScheduledFile file;
+  file.bytesTotal = std::max( bytesTotal, static_cast<qint64>( 0 ) );
+  file.priority = priority;
+  file.order = mEnqueuedCount++;
+
+  mFiles.insert( fileKey, file );
+  mBytesTotal += file.bytesTotal;
+  mIsFinished = false;
+
+  queue( fileKey );
+}
+
+
+void DownloadScheduler::queue( const QString &fileKey )
+{
+  // keep the queue sorted by priority, then by enqueue order
+  const auto it = std::upper_bound( mQueue.begin(), mQueue.end(), fileKey, [this]( const QString &a, const QString &b ) {
+    const ScheduledFile &fileA = mFiles[a];
+    const ScheduledFile &fileB = mFiles[b];
+    return fileA.priority != fileB.priority ? fileA.priority < fileB.priority : fileA.order < fileB.order;
+  } );
+  mQueue.insert( it, fileKey );
+}
+
+
+void DownloadScheduler::start()
+{
+  dispatch();
+}
+
+
+void DownloadScheduler::clear()
+{
+  mFiles.clear();
+  mQueue.clear();
+  mActive.clear();
+  mThroughputSamples.clear();
+
+  mRetryingCount = 0;
+  mFinishedCount = 0;
+  mFailedCount = 0;
+  mRetriesCount = 0;
+  mEnqueuedCount = 0;
+  mBytesTotal = 0;
+  mBytesReceived = 0;
+  mIsFinished = false;
+  mGeneration++;
+}
+
+
+void DownloadScheduler::setBytesReceived( const QString &fileKey, qint64 bytesReceived )
+{
+  if ( !mFiles.contains( fileKey ) )
+    return;
+
+  ScheduledFile &file = mFiles[fileKey];
+
+  if ( file.isFinished )
+    return;
+
+  // a server might send more than announced, never count beyond the expected size
+  bytesReceived = std::clamp( bytesReceived, static_cast<qint64>( 0 ), file.bytesTotal );
+
+  mBytesReceived += bytesReceived - file.bytesReceived;
+  file.bytesReceived = bytesReceived;
+
+  addThroughputSample();
+  emit statisticsChanged();
+}
+
+
+void DownloadScheduler::markFinished( const QString &fileKey )
+{
+  if ( !mFiles.contains( fileKey ) || !mActive.removeOne( fileKey ) )
+    return;
+
+  ScheduledFile &file = mFiles[fileKey];
+  mBytesReceived += file.bytesTotal - file.bytesReceived;
+  file.bytesReceived = file.bytesTotal;
+  file.isFinished = true;
+  mFinishedCount++;
+
+  addThroughputSample();
+  emit statisticsChanged();
+
+  dispatch();
+}
+
+
+bool DownloadScheduler::markFailed( const QString &fileKey, bool isRetryable )
+{
+  if ( !mFiles.contains( fileKey ) || !mActive.removeOne( fileKey ) )
+    return false;
+
+  ScheduledFile &file = mFiles[fileKey];
+
+  // the next attempt reports its own progress, possibly resuming from a partial file
+  mBytesReceived -= file.bytesReceived;
+  file.bytesReceived = 0;
+
+  if ( !isRetryable || file.retryCount >= mMaxRetries )
+  {
+    mFailedCount++;
+    emit statisticsChanged();
+    return false;
+  }
+
+  const int delay = retryDelayMs( file.retryCount );
+  const int generation = mGeneration;
+
+  file.retryCount++;
+  mRetriesCount++;
+  mRetryingCount++;
+
+  QTimer::singleShot( delay, this, [this, fileKey, generation]() {
+    if ( generation != mGeneration )
+      return;
+
+    mRetryingCount--;
+
+    // retried files keep their enqueue order, so they go ahead of the files of the same priority enqueued after them
+    queue( fileKey );
+    dispatch();
+  } );
+
+  emit statisticsChanged();
+
+  // the queued files use the freed slot while the retry waits
+  dispatch();
+
+  return true;
+}
+
+
+double DownloadScheduler::throughput() const
+{
+  if ( mThroughputSamples.size() < 2 )
+    return 0.0;
+
+  const QPair<qint64, qint64> &first = mThroughputSamples.first();
+  const QPair<qint64, qint64> &last = mThroughputSamples.last();
+  const qint64 elapsedMs = last.first - first.first;
+
+  if ( elapsedMs <= 0 )
+    return 0.0;
+
+  return static_cast<double>( std::max( last.second - first.second, static_cast<qint64>( 0 ) ) ) * 1000.0 / static_cast<double>( elapsedMs );
+}
+
+
+qint64 DownloadScheduler::estimatedRemainingSecs() const
+{
+  const double bytesPerSec = throughput();
+
+  if ( bytesPerSec <= 0.0 )
+    return -1;
+
+  return static_cast<qint64>( std::ceil( static_cast<double>( std::max( mBytesTotal - mBytesReceived, static_cast<qint64>( 0 ) ) ) / bytesPerSec ) );
+}
+
+
+void DownloadScheduler::dispatch()
+{
+  // `downloadRequested` handlers might report back synchronously, the outer loop takes care of it
+  if ( mIsDispatching )
+    return;
+
+  mIsDispatching = true;
+
+  while ( mFailedCount == 0 && !mQueue.isEmpty() && mActive.size() < mMaxParallelDownloads )
+  {
+    const QString fileKey = mQueue.takeFirst();
+    mActive.append( fileKey );
+    emit downloadRequested( fileKey );
+  }
+
+  mIsDispatching = false;
+
+  if ( !mIsFinished && !mFiles.isEmpty() && mFailedCount == 0 && mQueue.isEmpty() && mActive.isEmpty() && mRetryingCount == 0 )
+  {
+    mIsFinished = true;
+    emit finished();
+  }
+}
+
+
+void DownloadScheduler::addThroughputSample()
+{
+  const qint64 now = mClock.elapsed();
+
+  mThroughputSamples.append( qMakePair( now, mBytesReceived ) );
+
+  while ( mThroughputSamples.size() > 2 && now - mThroughputSamples.first().first > sThroughputWindowMs )
+    mThroughputSamples.removeFirst();
+}
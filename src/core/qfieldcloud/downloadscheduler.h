@@ -0,0 +1,204 @@
+/***************************************************************************
+    downloadscheduler.h
+    ---------------------
+    begin                : October 2026
+    copyright            : (C) 2026 by OPENGIS.ch
+    email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef DOWNLOADSCHEDULER_H
+#define DOWNLOADSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QNetworkReply>
+#include <QObject>
+#include <QPair>
+
+
+/**
+ * Schedules the download of multiple files, independently of the actual network transfers.
+ *
+ * Files are started by priority and enqueue order, with at most `maxParallelDownloads` files
+ * at the same time. The owner starts the transfer when `downloadRequested` is emitted and reports
+ * back the progress and the outcome. Failed files can be retried with an exponential backoff.
+ * \ingroup core
+ */
+class DownloadScheduler : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY( int maxParallelDownloads READ maxParallelDownloads WRITE setMaxParallelDownloads NOTIFY maxParallelDownloadsChanged )
+    Q_PROPERTY( double throughput READ throughput NOTIFY statisticsChanged )
+    Q_PROPERTY( qint64 estimatedRemainingSecs READ estimatedRemainingSecs NOTIFY statisticsChanged )
+
+  public:
+    //! The download priority of a file, files with lower value are downloaded first.
+    enum class Priority
+    {
+      ProjectFile,
+      Layer,
+      Attachment,
+    };
+    Q_ENUM( Priority )
+
+    explicit DownloadScheduler( QObject *parent = nullptr );
+
+    /**
+     * Returns the priority of the file with \a fileName.
+     * The QGIS project files are first, then the datasets and finally the attachments as marked by \a isAttachment.
+     */
+    static Priority priorityForFile( const QString &fileName, bool isAttachment );
+
+    /**
+     * Returns TRUE if a download failed with the network \a error and \a httpStatus is worth retrying.
+     */
+    static bool isRetryableError( QNetworkReply::NetworkError error, int httpStatus );
+
+    //! Returns the maximum number of files downloaded at the same time
+    int maxParallelDownloads() const { return mMaxParallelDownloads; }
+
+    //! Sets the maximum number of files downloaded at the same time
+    void setMaxParallelDownloads( int maxParallelDownloads );
+
+    //! Returns the maximum number of retries of a single file
+    int maxRetries() const { return mMaxRetries; }
+
+    //! Sets the maximum number of retries of a single file
+    void setMaxRetries( int maxRetries ) { mMaxRetries = maxRetries; }
+
+    //! Returns the delay before the first retry in milliseconds, doubled on each subsequent retry
+    int retryBaseDelayMs() const { return mRetryBaseDelayMs; }
+
+    //! Sets the delay before the first retry in milliseconds, doubled on each subsequent retry
+    void setRetryBaseDelayMs( int retryBaseDelayMs ) { mRetryBaseDelayMs = retryBaseDelayMs; }
+
+    //! Returns the delay in milliseconds before the retry number \a retryCount, starting from 0
+    int retryDelayMs( int retryCount ) const;
+
+    /**
+     * Adds the file with \a fileKey of \a bytesTotal size to the queue with \a priority.
+     * Does nothing if the file is already scheduled.
+     */
+    void enqueue( const QString &fileKey, qint64 bytesTotal, Priority priority );
+
+    /**
+     * Starts the queued files up to the parallel downloads limit.
+     */
+    void start();
+
+    //! Removes all the files and pending retries, without emitting any signal
+    void clear();
+
+    //! Reports that \a bytesReceived bytes of the file with \a fileKey have been downloaded so far in the current attempt
+    void setBytesReceived( const QString &fileKey, qint64 bytesReceived );
+
+    //! Reports that the file with \a fileKey has been successfully downloaded
+    void markFinished( const QString &fileKey );
+
+    /**
+     * Reports that the file with \a fileKey failed to download.
+     * If \a isRetryable and the file has retries left, it is requested again after a backoff delay and TRUE is returned,
+     * the next queued files are started meanwhile.
+     * Otherwise the file is failed, no more queued files are started and FALSE is returned.
+     */
+    bool markFailed( const QString &fileKey, bool isRetryable );
+
+    //! Returns the number of files waiting to be started, including the ones waiting for a retry
+    int queuedCount() const { return static_cast<int>( mQueue.size() ) + mRetryingCount; }
+
+    //! Returns the number of files being downloaded
+    int activeCount() const { return static_cast<int>( mActive.size() ); }
+
+    //! Returns the number of successfully downloaded files
+    int finishedCount() const { return mFinishedCount; }
+
+    //! Returns the number of files that failed to download
+    int failedCount() const { return mFailedCount; }
+
+    //! Returns the number of retries so far
+    int retriesCount() const { return mRetriesCount; }
+
+    //! Returns the number of retries so far of the file with \a fileKey
+    int retryCount( const QString &fileKey ) const { return mFiles.value( fileKey ).retryCount; }
+
+    //! Returns the total number of bytes to download
+    qint64 bytesTotal() const { return mBytesTotal; }
+
+    //! Returns the number of bytes downloaded so far
+    qint64 bytesReceived() const { return mBytesReceived; }
+
+    //! Returns the download throughput over the last few seconds, in bytes per second
+    double throughput() const;
+
+    //! Returns the estimated remaining time in seconds, or -1 if unknown
+    qint64 estimatedRemainingSecs() const;
+
+  signals:
+    //! Emitted when the file with \a fileKey should start downloading
+    void downloadRequested( const QString &fileKey );
+
+    //! Emitted when all the files have been successfully downloaded
+    void finished();
+
+    //! Emitted when the downloaded bytes, throughput or ETA change
+    void statisticsChanged();
+
+    void maxParallelDownloadsChanged();
+
+  private:
+    struct ScheduledFile
+    {
+        qint64 bytesTotal = 0;
+        qint64 bytesReceived = 0;
+        Priority priority = Priority::Attachment;
+        qsizetype order = 0;
+        int retryCount = 0;
+        bool isFinished = false;
+    };
+
+    //! Inserts \a fileKey in the queue, sorted by priority then by enqueue order
+    void queue( const QString &fileKey );
+    void dispatch();
+    void addThroughputSample();
+
+    QHash<QString, ScheduledFile> mFiles;
+    QList<QString> mQueue;
+    QList<QString> mActive;
+
+    int mMaxParallelDownloads = 6;
+    int mMaxRetries = 3;
+    int mRetryBaseDelayMs = 1000;
+
+    int mRetryingCount = 0;
+    int mFinishedCount = 0;
+    int mFailedCount = 0;
+    int mRetriesCount = 0;
+    qsizetype mEnqueuedCount = 0;
+    bool mIsDispatching = false;
+    bool mIsFinished = false;
+
+    //! Incremented by `clear()` so pending retries of a previous run are ignored
+    int mGeneration = 0;
+
+    qint64 mBytesTotal = 0;
+    qint64 mBytesReceived = 0;
+
+    QElapsedTimer mClock;
+    //! Pairs of elapsed milliseconds and received bytes, within the throughput window
+    QList<QPair<qint64, qint64>> mThroughputSamples;
+
+    static const int sThroughputWindowMs = 5000;
+    static const int sMaxRetryDelayMs = 60000;
+};
+
+#endif // DOWNLOADSCHEDULER_H
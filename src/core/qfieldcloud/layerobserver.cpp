@@ -15,22 +15,33 @@
  *                                     *
  ***************************************************************************/
 
+#include "commitsnapshotservice.h"
 #include "layerobserver.h"
 #include "qfieldcloudutils.h"
 
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <qgsfeature.h>
 #include <qgsfeatureiterator.h>
 #include <qgsfeaturerequest.h>
+#include <qgslogger.h>
 #include <qgsmessagelog.h>
 #include <qgsvectorlayereditbuffer.h>
 
 #include <appinterface.h>
 
 
-LayerObserver::LayerObserver( const QgsProject *project )
+//! Returns what the \a snapshotMode needs from the old features of a commit
+static CommitSnapshotService::SnapshotContent snapshotContent( LayerObserver::SnapshotMode snapshotMode )
+{
+  return snapshotMode == LayerObserver::SnapshotMode::FullSnapshot ? CommitSnapshotService::SnapshotContent::CompleteFeatures : CommitSnapshotService::SnapshotContent::ChangedValues;
+}
+
+
+LayerObserver::LayerObserver( const QgsProject *project, CommitSnapshotService *snapshotService )
   : mProject( project )
+  , mSnapshotService( snapshotService ? snapshotService : new CommitSnapshotService( this ) )
 {
   connect( mProject, &QgsProject::homePathChanged, this, &LayerObserver::onHomePathChanged );
   connect( mProject, &QgsProject::layersAdded, this, &LayerObserver::onLayersAdded );
@@ -76,6 +87,25 @@ void LayerObserver::setDeltaFileWrapper( DeltaFileWrapper *wrapper )
 }
 
 
+void LayerObserver::setSnapshotMode( SnapshotMode snapshotMode )
+{
+  if ( mSnapshotMode == snapshotMode )
+  {
+    return;
+  }
+
+  mSnapshotMode = snapshotMode;
+
+  for ( const QString &layerId : std::as_const( mObservedLayerIds ) )
+  {
+    if ( QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( mProject->mapLayer( layerId ) ) )
+      mSnapshotService->watchLayer( vl, this, snapshotContent( mSnapshotMode ) );
+  }
+
+  emit snapshotModeChanged();
+}
+
+
 void LayerObserver::onHomePathChanged()
 {
   if ( mProject->fileName().isEmpty() )
@@ -108,38 +138,103 @@ void LayerObserver::onBeforeCommitChanges()
     return;
   }
 
+  QElapsedTimer timer;
+  timer.start();
+
   const QgsFeatureIds deletedFids = eb->deletedFeatureIds();
-  const QgsFeatureIds changedGeometriesFids = qgis::listToSet( eb->changedGeometries().keys() );
-  const QgsFeatureIds changedAttributesFids = qgis::listToSet( eb->changedAttributeValues().keys() );
-  // NOTE QgsFeatureIds underlying implementation is QSet, so no need to check if the QgsFeatureId already exists
-  QgsFeatureIds changedFids;
+  const QgsGeometryMap changedGeometries = eb->changedGeometries();
+  const QgsChangedAttributesMap changedAttributesValues = eb->changedAttributeValues();
+  SnapshotStatistics statistics;
+  statistics.layerId = vl->id();
 
-  for ( const QgsFeatureId fid : deletedFids )
-  {
-    changedFids.insert( fid );
-  }
+  // NOTE we read the features from the dataProvider directly as we want to access the old values.
+  // If we use the layer, we get the values from the edit buffer.
+  QgsChangedFeatures changedFeatures;
 
-  for ( const QgsFeatureId fid : changedGeometriesFids )
+  if ( mSnapshotService->requiresCompleteFeatures( vl ) )
   {
-    changedFids.insert( fid );
-  }
+    // the complete features are needed, either by this snapshot mode or by another observer of the layer such as the
+    // feature history, they are read once and shared with the other observers of the commit
+    const qsizetype requestsCount = mSnapshotService->statistics().requestsCount;
+    const QgsFeatureMap features = mSnapshotService->snapshot( vl );
+    statistics.requestsCount = mSnapshotService->statistics().requestsCount - requestsCount;
 
-  for ( const QgsFeatureId fid : changedAttributesFids )
-  {
-    changedFids.insert( fid );
+    for ( auto it = features.constBegin(); it != features.constEnd(); ++it )
+    {
+      ChangedFeatureSnapshot snapshot;
+      snapshot.feature = it.value();
+
+      statistics.featuresCount++;
+      statistics.attributeValuesCount += snapshot.feature.attributeCount();
+      statistics.estimatedMemoryBytes += static_cast<qsizetype>( sizeof( QgsFeature ) ) + snapshot.feature.attributeCount() * static_cast<qsizetype>( sizeof( QVariant ) );
+
+      if ( snapshot.feature.hasGeometry() )
+      {
+        statistics.geometriesCount++;
+        statistics.estimatedMemoryBytes += snapshot.feature.geometry().wkbSize();
+      }
+
+      changedFeatures.insert( it.key(), snapshot );
+    }
   }
+  else
+  {
+    // deleted features are stored entirely in the delta file
+    fetchSnapshots( vl, deletedFids, nullptr, true, changedFeatures, statistics );
 
-  // NOTE we read the features from the dataProvider directly as we want to access the old values.
-  // If we use the layer, we get the values from the edit buffer.
-  QgsFeatureIterator featuresIt = vl->dataProvider()->getFeatures( QgsFeatureRequest( changedFids ) );
-  QgsChangedFeatures changedFeatures;
-  QgsFeature f;
+    const QgsFields fields = vl->fields();
+    QHash<QgsFeatureId, QgsAttributeList> attributesByFid;
+    QgsFeatureIds changedGeometryFids;
+    QgsFeatureIds changedAttributesOnlyFids;
+
+    for ( auto it = changedAttributesValues.constBegin(); it != changedAttributesValues.constEnd(); ++it )
+    {
+      if ( deletedFids.contains( it.key() ) )
+        continue;
+
+      QgsAttributeList &attributes = attributesByFid[it.key()];
+      for ( auto attrIt = it.value().constBegin(); attrIt != it.value().constEnd(); ++attrIt )
+      {
+        // only the provider fields have old values to be read
+#if _QGIS_VERSION_INT >= 33800
+        if ( fields.fieldOrigin( attrIt.key() ) != Qgis::FieldOrigin::Provider )
+#else
+        if ( fields.fieldOrigin( attrIt.key() ) != QgsFields::OriginProvider )
+#endif
+          continue;
+
+        attributes << fields.fieldOriginIndex( attrIt.key() );
+      }
+
+      if ( !changedGeometries.contains( it.key() ) )
+        changedAttributesOnlyFids.insert( it.key() );
+    }
+
+    for ( auto it = changedGeometries.constBegin(); it != changedGeometries.constEnd(); ++it )
+    {
+      if ( deletedFids.contains( it.key() ) )
+        continue;
+
+      // make sure geometry only changes have an entry with no attributes
+      attributesByFid[it.key()];
+      changedGeometryFids.insert( it.key() );
+    }
+
+    fetchSnapshots( vl, changedGeometryFids, &attributesByFid, true, changedFeatures, statistics );
+    fetchSnapshots( vl, changedAttributesOnlyFids, &attributesByFid, false, changedFeatures, statistics );
+  }
 
-  // ? is it possible to use the iterator in a less ugly way? something like normal `for ( QgsFeature &f : it ) {}`
-  while ( featuresIt.nextFeature( f ) )
-    changedFeatures.insert( f.id(), f );
+  statistics.elapsedMs = timer.elapsed();
+  mLastSnapshotStatistics = statistics;
 
-  qDebug() << "LayerObserver::onBeforeCommitChanges: vl->id()=" << vl->id() << "sourcePkAttrPair=" << changedFids;
+  QgsLogger::debug( QStringLiteral( "LayerObserver::onBeforeCommitChanges: layer \"%1\" snapshot of %2 features, %3 attribute values and %4 geometries in %5 requests, ~%6 bytes in %7 ms" )
+                      .arg( statistics.layerId )
+                      .arg( statistics.featuresCount )
+                      .arg( statistics.attributeValuesCount )
+                      .arg( statistics.geometriesCount )
+                      .arg( statistics.requestsCount )
+                      .arg( statistics.estimatedMemoryBytes )
+                      .arg( statistics.elapsedMs ) );
 
   // NOTE no need to keep track of added features, as they are always present in the layer after commit
   mChangedFeatures.insert( vl->id(), changedFeatures );
@@ -147,6 +242,114 @@ void LayerObserver::onBeforeCommitChanges()
 }
 
 
+void LayerObserver::fetchSnapshots( QgsVectorLayer *vl, const QgsFeatureIds &fids, const QHash<QgsFeatureId, QgsAttributeList> *attributesByFid, bool fetchGeometry, QgsChangedFeatures &snapshots, SnapshotStatistics &statistics ) const
+{
+  if ( fids.isEmpty() )
+    return;
+
+  const QgsFields providerFields = vl->dataProvider()->fields();
+  const QList<QgsFeatureId> fidsList( fids.constBegin(), fids.constEnd() );
+
+  for ( qsizetype chunkStart = 0; chunkStart < fidsList.size(); chunkStart += LayerObserverSnapshotChunkSize )
+  {
+    const QList<QgsFeatureId> chunkFids = fidsList.mid( chunkStart, LayerObserverSnapshotChunkSize );
+    QgsFeatureRequest request( QgsFeatureIds( chunkFids.constBegin(), chunkFids.constEnd() ) );
+
+    if ( attributesByFid )
+    {
+      QSet<int> chunkAttributes;
+      for ( const QgsFeatureId fid : chunkFids )
+      {
+        for ( const int attrIdx : attributesByFid->value( fid ) )
+          chunkAttributes.insert( attrIdx );
+      }
+
+      request.setSubsetOfAttributes( QgsAttributeList( chunkAttributes.constBegin(), chunkAttributes.constEnd() ) );
+
+      if ( !fetchGeometry )
+      {
+#if _QGIS_VERSION_INT >= 33500
+        request.setFlags( Qgis::FeatureRequestFlag::NoGeometry );
+#else
+        request.setFlags( QgsFeatureRequest::NoGeometry );
+#endif
+      }
+    }
+
+    statistics.requestsCount++;
+
+    QgsFeatureIterator featuresIt = vl->dataProvider()->getFeatures( request );
+    QgsFeature f;
+
+    while ( featuresIt.nextFeature( f ) )
+    {
+      ChangedFeatureSnapshot snapshot;
+      snapshot.isComplete = !attributesByFid;
+
+      f.setFields( providerFields, false );
+
+      // some providers return no attribute values at all with an empty subset of attributes
+      if ( f.attributeCount() != providerFields.count() )
+      {
+        QgsAttributes attributes = f.attributes();
+        attributes.resize( providerFields.count() );
+        f.setAttributes( attributes );
+      }
+
+      if ( attributesByFid )
+      {
+        snapshot.attributes = attributesByFid->value( f.id() );
+        snapshot.hasGeometry = fetchGeometry;
+      }
+
+      const qsizetype attributeValuesCount = snapshot.isComplete ? f.attributeCount() : snapshot.attributes.size();
+      statistics.featuresCount++;
+      statistics.attributeValuesCount += attributeValuesCount;
+      statistics.estimatedMemoryBytes += static_cast<qsizetype>( sizeof( QgsFeature ) ) + attributeValuesCount * static_cast<qsizetype>( sizeof( QVariant ) );
+
+      if ( fetchGeometry && f.hasGeometry() )
+      {
+        statistics.geometriesCount++;
+        statistics.estimatedMemoryBytes += f.geometry().wkbSize();
+      }
+
+      snapshot.feature = f;
+      snapshots.insert( f.id(), snapshot );
+    }
+  }
+}
+
+
+QgsFeature LayerObserver::takeOldFeature( QgsChangedFeatures &changedFeatures, QgsFeatureId fid, const QgsFeature &newFeature ) const
+{
+  const ChangedFeatureSnapshot snapshot = changedFeatures.take( fid );
+
+  if ( snapshot.isComplete )
+    return snapshot.feature;
+
+  // the values that were not read from the data provider did not change, so they are the same as in the new feature
+  QgsFeature oldFeature = snapshot.feature;
+  const QgsFields oldFields = oldFeature.fields();
+  const QgsFields newFields = newFeature.fields();
+
+  for ( int idx = 0; idx < oldFields.count(); idx++ )
+  {
+    if ( snapshot.attributes.contains( idx ) )
+      continue;
+
+    const int newIdx = newFields.indexFromName( oldFields.at( idx ).name() );
+
+    if ( newIdx != -1 )
+      oldFeature.setAttribute( idx, newFeature.attribute( newIdx ) );
+  }
+
+  if ( !snapshot.hasGeometry )
+    oldFeature.setGeometry( newFeature.geometry() );
+
+  return oldFeature;
+}
+
+
 void LayerObserver::onCommittedFeaturesAdded( const QString &localLayerId, const QgsFeatureList &addedFeatures )
 {
   if ( !mDeltaFileWrapper || mDeltaFileWrapper->isDeltaBeingApplied() )
@@ -183,7 +386,7 @@ void LayerObserver::onCommittedFeaturesRemoved( const QString &localLayerId, con
   {
     Q_ASSERT( changedFeatures.contains( fid ) );
 
-    QgsFeature oldFeature = changedFeatures.take( fid );
+    QgsFeature oldFeature = changedFeatures.take( fid ).feature;
 
     mDeltaFileWrapper->addDelete( mProject, localLayerId, sourceLayerId, localPkAttrPair.second, sourcePkAttrPair.second, oldFeature );
   }
@@ -218,8 +421,8 @@ void LayerObserver::onCommittedAttributeValuesChanges( const QString &localLayer
 
     patchedFids.insert( fid );
 
-    QgsFeature oldFeature = changedFeatures.take( fid );
     QgsFeature newFeature = vl->getFeature( fid );
+    QgsFeature oldFeature = takeOldFeature( changedFeatures, fid, newFeature );
 
     if ( vl->fields().indexOf( "fid_1" ) != -1 && localPkAttrPair.second == sourcePkAttrPair.second && newFeature.attribute( "fid" ) != newFeature.attribute( "fid_1" ) )
     {
@@ -259,8 +462,8 @@ void LayerObserver::onCommittedGeometriesChanges( const QString &localLayerId, c
 
     patchedFids.insert( fid );
 
-    QgsFeature oldFeature = changedFeatures.take( fid );
     QgsFeature newFeature = vl->getFeature( fid );
+    QgsFeature oldFeature = takeOldFeature( changedFeatures, fid, newFeature );
 
     if ( vl->fields().indexOf( "fid_1" ) != -1 && localPkAttrPair.second == sourcePkAttrPair.second && newFeature.attribute( "fid" ) != newFeature.attribute( "fid_1" ) )
     {
@@ -347,6 +550,8 @@ void LayerObserver::addLayerListeners()
         // TODO use the future "afterCommitChanges" signal
         disconnect( vl, &QgsVectorLayer::editingStopped, this, &LayerObserver::onEditingStopped );
 
+        mSnapshotService->watchLayer( vl, this, snapshotContent( mSnapshotMode ) );
+
         // for `cloud` projects, we keep track of any change that has occurred
         connect( vl, &QgsVectorLayer::beforeCommitChanges, this, &LayerObserver::onBeforeCommitChanges );
         connect( vl, &QgsVectorLayer::committedFeaturesAdded, this, &LayerObserver::onCommittedFeaturesAdded );
@@ -28,8 +28,29 @@
 #include <qgsproject.h>
 #include <qgsvectorlayer.h>
 
+class CommitSnapshotService;
 
-typedef QMap<QgsFeatureId, QgsFeature> QgsChangedFeatures;
+/**
+ * The old version of a changed feature, as read from the data provider before commit.
+ */
+struct ChangedFeatureSnapshot
+{
+    //! The old feature with the data provider fields
+    QgsFeature feature;
+    //! Whether all the attributes and the geometry have been read, otherwise only `attributes` and the geometry if `hasGeometry`
+    bool isComplete = true;
+    //! Provider attribute indexes read from the data provider, when the snapshot is not complete
+    QgsAttributeList attributes;
+    //! Whether the geometry has been read from the data provider, when the snapshot is not complete
+    bool hasGeometry = false;
+};
+
+typedef QMap<QgsFeatureId, ChangedFeatureSnapshot> QgsChangedFeatures;
+
+/**
+ * Maximum number of features read from the data provider with a single request when taking the pre-commit snapshot.
+ */
+const int LayerObserverSnapshotChunkSize = 1000;
 
 /**
  * Monitors all layers for changes and writes those changes to a delta file
@@ -40,14 +61,47 @@ class LayerObserver : public QObject
     Q_OBJECT
 
     Q_PROPERTY( DeltaFileWrapper *deltaFileWrapper READ deltaFileWrapper WRITE setDeltaFileWrapper NOTIFY deltaFileWrapperChanged )
+    Q_PROPERTY( SnapshotMode snapshotMode READ snapshotMode WRITE setSnapshotMode NOTIFY snapshotModeChanged )
 
   public:
+    /**
+     * Defines what is read from the data provider before a commit
+     */
+    enum class SnapshotMode
+    {
+      FullSnapshot,          //!< All the attributes and the geometry of each changed or deleted feature
+      ChangedValuesSnapshot, //!< Only the changed attributes and the geometry if changed. Deleted features are still read entirely. When another observer of the layer needs the complete features, e.g. the feature history, their shared snapshot is used instead
+    };
+    Q_ENUM( SnapshotMode )
+
+    /**
+     * Counters of the last pre-commit snapshot
+     */
+    struct SnapshotStatistics
+    {
+        //! The layer id
+        QString layerId;
+        //! Number of features read from the data provider
+        qsizetype featuresCount = 0;
+        //! Number of attribute values read from the data provider
+        qsizetype attributeValuesCount = 0;
+        //! Number of geometries read from the data provider
+        qsizetype geometriesCount = 0;
+        //! Number of data provider requests
+        qsizetype requestsCount = 0;
+        //! Estimated memory held by the snapshot, in bytes
+        qsizetype estimatedMemoryBytes = 0;
+        //! Time spent reading the snapshot, in milliseconds
+        qint64 elapsedMs = 0;
+    };
+
     /**
      * Construct a new Layer Observer object
      *
      * @param project
+     * @param snapshotService the service sharing the pre-commit feature snapshots with other observers, an own service is used if not given
      */
-    explicit LayerObserver( const QgsProject *project );
+    explicit LayerObserver( const QgsProject *project, CommitSnapshotService *snapshotService = nullptr );
 
 
     /**
@@ -70,9 +124,25 @@ class LayerObserver : public QObject
      */
     void setDeltaFileWrapper( DeltaFileWrapper *wrapper );
 
+    /**
+     * Returns what is read from the data provider before a commit
+     */
+    SnapshotMode snapshotMode() const { return mSnapshotMode; }
+
+    /**
+     * Sets what is read from the data provider before a commit
+     */
+    void setSnapshotMode( SnapshotMode snapshotMode );
+
+    /**
+     * Returns the counters of the last pre-commit snapshot
+     */
+    SnapshotStatistics lastSnapshotStatistics() const { return mLastSnapshotStatistics; }
+
   signals:
     void layerEdited( const QString &layerId );
     void deltaFileWrapperChanged();
+    void snapshotModeChanged();
 
 
   private slots:
@@ -152,6 +222,12 @@ class LayerObserver : public QObject
     const QgsProject *mProject = nullptr;
 
 
+    /**
+     * The service providing the old version of the features shared with other observers
+     */
+    CommitSnapshotService *mSnapshotService = nullptr;
+
+
     /**
      * The current project delta file name
      */
@@ -186,6 +262,32 @@ class LayerObserver : public QObject
      */
     void addLayerListeners();
 
+
+    /**
+     * Reads the features with \a fids from the data provider of \a vl into \a snapshots in chunks of `LayerObserverSnapshotChunkSize`.
+     * If \a attributesByFid is given, only the listed provider attribute indexes are read, and the geometry only if \a fetchGeometry is set.
+     */
+    void fetchSnapshots( QgsVectorLayer *vl, const QgsFeatureIds &fids, const QHash<QgsFeatureId, QgsAttributeList> *attributesByFid, bool fetchGeometry, QgsChangedFeatures &snapshots, SnapshotStatistics &statistics ) const;
+
+
+    /**
+     * Takes the snapshot of \a fid out of \a changedFeatures and returns the old feature.
+     * Incomplete snapshots are completed with the unchanged values of \a newFeature.
+     */
+    QgsFeature takeOldFeature( QgsChangedFeatures &changedFeatures, QgsFeatureId fid, const QgsFeature &newFeature ) const;
+
+
+    /**
+     * What is read from the data provider before a commit
+     */
+    SnapshotMode mSnapshotMode = SnapshotMode::ChangedValuesSnapshot;
+
+
+    /**
+     * Counters of the last pre-commit snapshot
+     */
+    SnapshotStatistics mLastSnapshotStatistics;
+
     bool mLocalAndSourcePkAttrAreEqual = false;
 };
 
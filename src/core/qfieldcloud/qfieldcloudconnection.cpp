@@ -18,6 +18,7 @@
 #include "qfieldcloudconnection.h"
 #include "qfieldcloudutils.h"
 
+#include <QDateTime>
 #include <QDirIterator>
 #include <QFile>
 #include <QHttpMultiPart>
@@ -36,6 +37,9 @@
 #include <qgsnetworkaccessmanager.h>
 #include <qgssettings.h>
 
+#define MAX_CONCURRENT_ATTACHMENT_UPLOADS 4
+#define MAX_ATTACHMENT_UPLOAD_ATTEMPTS 5
+
 
 QFieldCloudConnection::QFieldCloudConnection()
   : mUrl( QSettings().value( QStringLiteral( "/QFieldCloud/url" ), defaultUrl() ).toString() )
@@ -67,6 +71,14 @@ QFieldCloudConnection::QFieldCloudConnection()
     mTokenConfigId.clear();
     QSettings().remove( "/QFieldCloud/tokenConfigId" );
   }
+
+  connect( this, &QFieldCloudConnection::pendingAttachmentsAdded, this, [this] {
+    if ( mUploadPendingCount > 0 )
+    {
+      enqueuePendingAttachments();
+      processPendingAttachments();
+    }
+  } );
 }
 
 QMap<QString, QString> QFieldCloudConnection::sErrors = QMap<QString, QString>(
@@ -792,107 +804,145 @@ int QFieldCloudConnection::uploadPendingAttachments()
   if ( mUploadPendingCount > 0 )
     return mUploadPendingCount;
 
-  QMultiMap<QString, QString> attachments = QFieldCloudUtils::getPendingAttachments( mUsername );
-  if ( attachments.isEmpty() )
+  mUploadQueue.clear();
+  mUploadQueuedAttachments.clear();
+  enqueuePendingAttachments();
+  if ( mUploadPendingCount == 0 )
   {
     emit pendingAttachmentsUploadFinished();
     return 0;
   }
 
-  mUploadPendingCount = attachments.size();
-  mUploadFailingCount = 0;
   processPendingAttachments();
   return mUploadPendingCount;
 }
 
-void QFieldCloudConnection::processPendingAttachments()
+void QFieldCloudConnection::enqueuePendingAttachments()
 {
-  QMultiMap<QString, QString> attachments = QFieldCloudUtils::getPendingAttachments( mUsername );
-  mUploadPendingCount = attachments.size();
-
-  QMultiMap<QString, QString>::const_iterator it = attachments.constBegin();
-  while ( it != attachments.constEnd() )
+  // The pending attachments list is only read when starting and when attachments are added, not after each upload
+  const QMultiMap<QString, QString> attachments = QFieldCloudUtils::getPendingAttachments( mUsername );
+  for ( auto it = attachments.constBegin(); it != attachments.constEnd(); ++it )
   {
-    if ( !QFileInfo( it.value() ).exists() )
-    {
-      // A pending attachment has been deleted from the local device, remove
-      // This can happen when for e.g. users remove a cloud project from their devices
-      QFieldCloudUtils::removePendingAttachment( mUsername, it.key(), it.value() );
-      ++it;
+    const QPair<QString, QString> attachment( it.key(), it.value() );
+    if ( mUploadQueuedAttachments.contains( attachment ) )
       continue;
-    }
 
-    QFileInfo projectInfo( QFieldCloudUtils::localProjectFilePath( mUsername, it.key() ) );
-    QDir projectDir( projectInfo.absolutePath() );
-    const QString apiPath = projectDir.relativeFilePath( it.value() );
-    NetworkReply *attachmentCloudReply = post( QStringLiteral( "/api/v1/files/%1/%2/" ).arg( it.key(), apiPath ), QVariantMap(), QStringList( { it.value() } ) );
+    mUploadQueuedAttachments.insert( attachment );
+    mUploadQueue << PendingAttachment { it.key(), it.value() };
+    mUploadPendingCount++;
+  }
+}
 
-    QString projectId = it.key();
-    QString fileName = it.value();
-    connect( attachmentCloudReply, &NetworkReply::finished, this, [this, attachmentCloudReply, fileName, projectId]() {
-      QNetworkReply *attachmentReply = attachmentCloudReply->currentRawReply();
-      attachmentCloudReply->deleteLater();
+void QFieldCloudConnection::processPendingAttachments()
+{
+  while ( mUploadActiveCount < MAX_CONCURRENT_ATTACHMENT_UPLOADS && !mUploadQueue.isEmpty() )
+  {
+    uploadPendingAttachment( mUploadQueue.takeFirst() );
+  }
+}
 
-      Q_ASSERT( attachmentCloudReply->isFinished() );
-      Q_ASSERT( attachmentReply );
+void QFieldCloudConnection::uploadPendingAttachment( const PendingAttachment &attachment )
+{
+  if ( !QFileInfo::exists( attachment.fileName ) )
+  {
+    // A pending attachment has been deleted from the local device, remove
+    // This can happen when for e.g. users remove a cloud project from their devices
+    QFieldCloudUtils::removePendingAttachment( mUsername, attachment.projectId, attachment.fileName );
+    finishPendingAttachment();
+    return;
+  }
 
-      // If there is an error, don't panic, we continue uploading. The files may be later manually synced.
-      const int httpCode = attachmentReply->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
-      if ( attachmentReply->error() != QNetworkReply::NoError )
-      {
-        QgsMessageLog::logMessage( tr( "Failed to upload attachment stored at `%1`, reason:\n%2" )
-                                     .arg( fileName )
-                                     .arg( QFieldCloudConnection::errorString( attachmentReply ) ) );
+  QFileInfo projectInfo( QFieldCloudUtils::localProjectFilePath( mUsername, attachment.projectId ) );
+  QDir projectDir( projectInfo.absolutePath() );
+  const QString apiPath = projectDir.relativeFilePath( attachment.fileName );
+  const QDateTime lastModified = QFileInfo( attachment.fileName ).lastModified();
+  NetworkReply *attachmentCloudReply = post( QStringLiteral( "/api/v1/files/%1/%2/" ).arg( attachment.projectId, apiPath ), QVariantMap(), QStringList( { attachment.fileName } ) );
+  if ( !attachmentCloudReply )
+  {
+    // The attachment could not be read, it stays pending
+    finishPendingAttachment();
+    return;
+  }
 
-        // Retry uploading for non-404 errors
-        if ( httpCode != 404 )
-        {
-          mUploadFailingCount++;
+  mUploadActiveCount++;
+  connect( attachmentCloudReply, &NetworkReply::finished, this, [this, attachmentCloudReply, attachment, lastModified]() {
+    QNetworkReply *attachmentReply = attachmentCloudReply->currentRawReply();
+    attachmentCloudReply->deleteLater();
+    mUploadActiveCount--;
 
-          if ( mUploadFailingCount < 5 )
-          {
-            // Retry the last attachment to upload after a brief delay
-            QTimer::singleShot( std::pow( 5, mUploadFailingCount ) * 1000, this, [this] { processPendingAttachments(); } );
-          }
-          else
-          {
-            // Too many fails, bailing out for now
-            emit pendingAttachmentsUploadFinished();
-          }
-          return;
-        }
-      }
+    Q_ASSERT( attachmentCloudReply->isFinished() );
+    Q_ASSERT( attachmentReply );
 
-      if ( httpCode != 201 && httpCode != 404 )
+    // If there is an error, don't panic, we continue uploading. The files may be later manually synced.
+    const int httpCode = attachmentReply->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
+    if ( attachmentReply->error() != QNetworkReply::NoError )
+    {
+      QgsMessageLog::logMessage( tr( "Failed to upload attachment stored at `%1`, reason:\n%2" )
+                                   .arg( attachment.fileName )
+                                   .arg( QFieldCloudConnection::errorString( attachmentReply ) ) );
+
+      // Retry uploading for non-404 errors
+      if ( httpCode != 404 )
       {
-        qDebug() << QStringLiteral( "Attachment project ID: %1 %2 %3" ).arg( projectId ).arg( fileName ).arg( httpCode );
+        PendingAttachment retryAttachment = attachment;
+        retryAttachment.failedAttempts++;
 
-        for ( const QByteArray &header : attachmentReply->rawHeaderList() )
+        if ( retryAttachment.failedAttempts < MAX_ATTACHMENT_UPLOAD_ATTEMPTS )
         {
-          qDebug() << QStringLiteral( "Attachment reply header: %1 => %2" ).arg( header ).arg( attachmentReply->rawHeader( header ) );
+          // Retry the attachment after a delay, the other attachments keep uploading meanwhile
+          QTimer::singleShot( std::pow( 5, retryAttachment.failedAttempts ) * 1000, this, [this, retryAttachment] {
+            mUploadQueue << retryAttachment;
+            processPendingAttachments();
+          } );
+        }
+        else
+        {
+          // Too many fails, the attachment stays pending for a later upload
+          finishPendingAttachment();
         }
 
-        qDebug() << QStringLiteral( "Attachment reply content: %1" ).arg( attachmentReply->readAll() );
-
-        AppInterface::instance()->sendLog( QStringLiteral( "QFieldCloud file upload HTTP code oddity!" ), QString() );
+        processPendingAttachments();
+        return;
       }
+    }
 
-      QFieldCloudUtils::removePendingAttachment( mUsername, projectId, fileName );
-      mUploadPendingCount--;
-      mUploadFailingCount = 0;
+    if ( httpCode != 201 && httpCode != 404 )
+    {
+      qDebug() << QStringLiteral( "Attachment project ID: %1 %2 %3" ).arg( attachment.projectId ).arg( attachment.fileName ).arg( httpCode );
 
-      if ( mUploadPendingCount > 0 )
+      for ( const QByteArray &header : attachmentReply->rawHeaderList() )
       {
-        // Move onto the next attachment to upload
-        processPendingAttachments();
+        qDebug() << QStringLiteral( "Attachment reply header: %1 => %2" ).arg( header ).arg( attachmentReply->rawHeader( header ) );
       }
-      else
-      {
-        emit pendingAttachmentsUploadFinished();
-      }
-    } );
 
-    break;
+      qDebug() << QStringLiteral( "Attachment reply content: %1" ).arg( attachmentReply->readAll() );
+
+      AppInterface::instance()->sendLog( QStringLiteral( "QFieldCloud file upload HTTP code oddity!" ), QString() );
+    }
+
+    if ( httpCode == 201 && QFileInfo( attachment.fileName ).lastModified() != lastModified )
+    {
+      // The attachment was modified during this upload, keep it pending and upload the newer version
+      mUploadQueue << PendingAttachment { attachment.projectId, attachment.fileName };
+      processPendingAttachments();
+      return;
+    }
+
+    QFieldCloudUtils::removePendingAttachment( mUsername, attachment.projectId, attachment.fileName );
+    // The attachment can be queued again if it gets added back later during this upload session
+    mUploadQueuedAttachments.remove( qMakePair( attachment.projectId, attachment.fileName ) );
+
+    finishPendingAttachment();
+    processPendingAttachments();
+  } );
+}
+
+void QFieldCloudConnection::finishPendingAttachment()
+{
+  mUploadPendingCount--;
+
+  if ( mUploadPendingCount == 0 )
+  {
+    emit pendingAttachmentsUploadFinished();
   }
-  return;
 }
@@ -22,6 +22,7 @@
 
 #include <QJsonDocument>
 #include <QObject>
+#include <QSet>
 #include <QVariantMap>
 
 class QNetworkRequest;
@@ -214,6 +215,7 @@ class QFieldCloudConnection : public QObject
 
     /**
      * Uploads any pending attachments linked to the logged in user account.
+     * Up to four attachments are uploaded concurrently, failed uploads are retried with a per attachment backoff.
      * \returns the number of attachments to be uploaded.
      */
     int uploadPendingAttachments();
@@ -240,11 +242,21 @@ class QFieldCloudConnection : public QObject
     void isFetchingAvailableProvidersChanged();
 
   private:
+    struct PendingAttachment
+    {
+        QString projectId;
+        QString fileName;
+        int failedAttempts = 0;
+    };
+
     void setStatus( ConnectionStatus status );
     void setState( ConnectionState state );
     void setToken( const QByteArray &token );
     void invalidateToken();
+    void enqueuePendingAttachments();
     void processPendingAttachments();
+    void uploadPendingAttachment( const PendingAttachment &attachment );
+    void finishPendingAttachment();
 
     QString mUrl;
 
@@ -265,8 +277,10 @@ class QFieldCloudConnection : public QObject
 
     int mPendingRequests = 0;
 
+    QList<PendingAttachment> mUploadQueue;
+    QSet<QPair<QString, QString>> mUploadQueuedAttachments;
     int mUploadPendingCount = 0;
-    int mUploadFailingCount = 0;
+    int mUploadActiveCount = 0;
 
     void setClientHeaders( QNetworkRequest &request );
 };
@@ -14,6 +14,7 @@
  ***************************************************************************/
 
 #include "appinterface.h"
+#include "contentstore.h"
 #include "deltafilewrapper.h"
 #include "deltalistmodel.h"
 #include "fileutils.h"
@@ -24,6 +25,7 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QQmlEngine>
+#include <QSettings>
 #include <qgsmessagelog.h>
 
 #define MAX_REDIRECTS_ALLOWED 10
@@ -40,6 +42,11 @@ QFieldCloudProject::QFieldCloudProject( const QString &id, QFieldCloudConnection
   {
     mUsername = mCloudConnection->username();
   }
+
+  mDownloadScheduler.setMaxParallelDownloads( QSettings().value( QStringLiteral( "/QFieldCloud/maxParallelDownloads" ), MAX_PARALLEL_REQUESTS ).toInt() );
+  connect( &mDownloadScheduler, &DownloadScheduler::downloadRequested, this, &QFieldCloudProject::startFileDownload );
+  connect( &mDownloadScheduler, &DownloadScheduler::finished, this, &QFieldCloudProject::downloadFilesCompleted );
+  connect( &mDownloadScheduler, &DownloadScheduler::statisticsChanged, this, &QFieldCloudProject::downloadStatisticsChanged );
 }
 
 void QFieldCloudProject::setSharedDatasetsProjectId( const QString &id )
@@ -649,6 +656,7 @@ void QFieldCloudProject::packageAndDownload()
   }
 
   mDownloadFileTransfers.clear();
+  mDownloadScheduler.clear();
   mDownloadFilesFinished = 0;
   mDownloadFilesFailed = 0;
   mDownloadBytesTotal = 0;
@@ -781,7 +789,7 @@ void QFieldCloudProject::packageAndDownload()
       }
     }
 
-    mActiveFilesToDownload.clear();
+    mDownloadScheduler.clear();
 
     const bool hasError = !error.isNull();
     if ( hasError )
@@ -836,6 +844,7 @@ void QFieldCloudProject::download()
       return;
     }
 
+    ContentStore contentStore;
     const QJsonArray files = payload.value( QStringLiteral( "files" ) ).toArray();
     for ( const QJsonValue fileValue : files )
     {
@@ -847,6 +856,13 @@ void QFieldCloudProject::download()
       // NOTE the cloud API is giving the false impression that the file keys `md5sum` is having a MD5 or another checksum.
       // This actually is an Object Storage (S3) implementation specific ETag.
       const QString cloudEtag = fileObject.value( QStringLiteral( "md5sum" ) ).toString();
+
+      // files linked to an unmodified store object are known to be up to date without reading them
+      if ( contentStore.isMaterialized( ContentStore::etagKey( cloudEtag ), projectFileName ) )
+      {
+        continue;
+      }
+
       const QString localEtag = FileUtils::fileEtag( projectFileName );
 
       if ( !fileObject.value( QStringLiteral( "size" ) ).isDouble() || fileName.isEmpty() || cloudEtag.isEmpty() )
@@ -869,10 +885,11 @@ void QFieldCloudProject::download()
 
       if ( cloudEtag == localEtag )
       {
+        contentStore.insert( projectFileName, ContentStore::etagKey( cloudEtag ) );
         continue;
       }
 
-      prepareDownloadTransfer( mId, fileName, fileSize, cloudEtag );
+      prepareDownloadTransfer( mId, fileName, fileSize, cloudEtag, DownloadScheduler::priorityForFile( fileName, fileObject.value( QStringLiteral( "is_attachment" ) ).toBool() ) );
     }
 
     emit downloadBytesTotalChanged();
@@ -930,6 +947,7 @@ void QFieldCloudProject::download()
 
         if ( localizedDatasetsRawReply->error() == QNetworkReply::NoError )
         {
+          ContentStore contentStore;
           const QJsonArray files = QJsonDocument::fromJson( localizedDatasetsRawReply->readAll() ).array();
           for ( const QJsonValue fileValue : files )
           {
@@ -942,6 +960,12 @@ void QFieldCloudProject::download()
               // NOTE the cloud API is giving the false impression that the file keys `md5sum` is having a MD5 or another checksum.
               // This actually is an Object Storage (S3) implementation specific ETag.
               const QString cloudEtag = fileObject.value( QStringLiteral( "md5sum" ) ).toString();
+
+              if ( contentStore.isMaterialized( ContentStore::etagKey( cloudEtag ), absoluteFileName ) )
+              {
+                continue;
+              }
+
               const QString localEtag = FileUtils::fileEtag( absoluteFileName );
 
               if (
@@ -956,10 +980,11 @@ void QFieldCloudProject::download()
 
               if ( cloudEtag == localEtag )
               {
+                contentStore.insert( absoluteFileName, ContentStore::etagKey( cloudEtag ) );
                 continue;
               }
 
-              prepareDownloadTransfer( mSharedDatasetsProjectId, fileName, fileSize, cloudEtag );
+              prepareDownloadTransfer( mSharedDatasetsProjectId, fileName, fileSize, cloudEtag, DownloadScheduler::Priority::Layer );
             }
           }
           emit downloadBytesTotalChanged();
@@ -977,7 +1002,6 @@ void QFieldCloudProject::download()
           return;
         }
 
-        updateActiveFilesToDownload();
         downloadFiles();
       } );
     }
@@ -985,13 +1009,12 @@ void QFieldCloudProject::download()
     {
       QgsLogger::debug( QStringLiteral( "Project %1: packaged files to download - %2 files, namely: %3" ).arg( mId ).arg( mDownloadFileTransfers.count() ).arg( mDownloadFileTransfers.keys().join( ", " ) ) );
 
-      updateActiveFilesToDownload();
       downloadFiles();
     }
   } );
 }
 
-void QFieldCloudProject::prepareDownloadTransfer( const QString &projectId, const QString &fileName, qint64 fileSize, const QString &cloudEtag )
+void QFieldCloudProject::prepareDownloadTransfer( const QString &projectId, const QString &fileName, qint64 fileSize, const QString &cloudEtag, DownloadScheduler::Priority priority )
 {
   const QString fileKey = QStringLiteral( "%1/%2" ).arg( projectId, fileName );
   const QString projectDir = QStringLiteral( "%1/%2/%3" ).arg( QFieldCloudUtils::localCloudDirectory(), mUsername, projectId );
@@ -1000,6 +1023,7 @@ void QFieldCloudProject::prepareDownloadTransfer( const QString &projectId, cons
   transfer.partialFilePath = QDir( projectDir ).filePath( QStringLiteral( "%1.%2.part" ).arg( fileName, cloudEtag ) );
 
   mDownloadFileTransfers.insert( fileKey, transfer );
+  mDownloadScheduler.enqueue( fileKey, fileSize, priority );
 
   // Remove old .part files with different etag
   QDir dir( projectDir );
@@ -1015,99 +1039,66 @@ void QFieldCloudProject::prepareDownloadTransfer( const QString &projectId, cons
   mDownloadBytesTotal += std::max( fileSize, static_cast<qint64>( 0 ) );
 }
 
-void QFieldCloudProject::updateActiveFilesToDownload()
+void QFieldCloudProject::downloadFiles()
 {
   if ( !mCloudConnection )
     return;
 
-  const QStringList fileKeys = mDownloadFileTransfers.keys();
-
-  if ( fileKeys.isEmpty() )
+  // Don't call download project files, if there are no project files
+  if ( mDownloadFileTransfers.isEmpty() )
   {
-    mActiveFilesToDownload.clear();
+    setStatus( ProjectStatus::Idle );
+    mDownloadProgress = 1;
+
+    emit downloadProgressChanged();
+
     return;
   }
 
-  for ( const QString &fileKey : fileKeys )
-  {
-    if ( mDownloadFileTransfers[fileKey].networkReply )
-    {
-      if ( mDownloadFileTransfers[fileKey].networkReply->isFinished() )
-      {
-        if ( mActiveFilesToDownload.removeOne( fileKey ) )
-        {
-          // QgsLogger::debug( QStringLiteral( "Project %1, file `%2`: removed from the list of active download files" ).arg( projectId, fileName ) );
-        }
-        continue;
-      }
-      else
-      {
-        // the request is still active
-        continue;
-      }
-    }
+  QgsLogger::debug( QStringLiteral( "Project %1: scheduling %2 files to download with up to %3 parallel downloads" ).arg( mId ).arg( mDownloadFileTransfers.count() ).arg( mDownloadScheduler.maxParallelDownloads() ) );
 
-    if ( mActiveFilesToDownload.size() >= MAX_PARALLEL_REQUESTS )
-    {
-      return;
-    }
+  mDownloadScheduler.start();
+}
 
-    // QgsLogger::debug( QStringLiteral( "Project %1, file `%2`: appended to the active download files list" ).arg( projectId, fileName ) );
+void QFieldCloudProject::startFileDownload( const QString &fileKey )
+{
+  if ( !mCloudConnection || !mDownloadFileTransfers.contains( fileKey ) )
+    return;
 
-    mActiveFilesToDownload.append( fileKey );
-  }
+  FileTransfer &fileTransfer = mDownloadFileTransfers[fileKey];
 
-  if ( mActiveFilesToDownload.count() > 0 )
+  if ( fileTransfer.networkReply && !fileTransfer.networkReply->isFinished() )
   {
-    QgsLogger::debug( QStringLiteral( "Project %1: active download files list contains %2 files, namely: %3" ).arg( mId ).arg( mActiveFilesToDownload.count() ).arg( mActiveFilesToDownload.join( ", " ) ) );
-  }
-  else
-  {
-    QgsLogger::debug( QStringLiteral( "Project %1: active download files list is empty" ).arg( mId ) );
+    // Download is already in progress
+    return;
   }
-}
 
-void QFieldCloudProject::downloadFiles()
-{
-  // calling updateActiveProjectFilesToDownload() before calling this function is mandatory
-
-  if ( !mCloudConnection )
-    return;
+  const QDir partialDir = QFileInfo( fileTransfer.partialFilePath ).dir();
+  if ( !partialDir.exists() )
+    partialDir.mkpath( "." );
 
-  // Don't call download project files, if there are no project files
-  if ( mActiveFilesToDownload.isEmpty() )
+  // the same content might already be stored locally, e.g. by a previous download or the shared datasets project
+  if ( ContentStore().materialize( ContentStore::etagKey( fileTransfer.etag ), fileTransfer.partialFilePath, ContentStore::canShareContent( fileTransfer.fileName ) ) )
   {
-    setStatus( ProjectStatus::Idle );
-    mDownloadProgress = 1;
+    QgsLogger::debug( QStringLiteral( "Project %1, file `%2`: taken from the local content store." ).arg( mId, fileKey ) );
+
+    mDownloadBytesReceived += fileTransfer.bytesTotal;
+    mDownloadProgress = std::clamp( ( static_cast<double>( mDownloadBytesReceived ) / std::max( mDownloadBytesTotal, static_cast<qint64>( 1 ) ) ), 0., 1. );
+    mDownloadFilesFinished++;
 
+    emit downloadBytesReceivedChanged();
     emit downloadProgressChanged();
 
+    mDownloadScheduler.markFinished( fileKey );
     return;
   }
 
-  QgsLogger::debug( QStringLiteral( "Project %1: active download files list before actual download: %2" ).arg( mId, mActiveFilesToDownload.join( ", " ) ) );
+  NetworkReply *reply = downloadFile( fileTransfer.projectId, fileTransfer.fileName, fileTransfer.projectId == mId );
 
-  for ( const QString &fileKey : std::as_const( mActiveFilesToDownload ) )
+  if ( reply )
   {
-    if ( mDownloadFileTransfers[fileKey].networkReply )
-    {
-      // Download is already in progress
-      continue;
-    }
-
-    FileTransfer &fileTransfer = mDownloadFileTransfers[fileKey];
-
-    NetworkReply *reply = downloadFile( fileTransfer.projectId, fileTransfer.fileName, fileTransfer.projectId == mId );
-
-    const QDir partialDir = QFileInfo( fileTransfer.partialFilePath ).dir();
-    if ( !partialDir.exists() )
-      partialDir.mkpath( "." );
-
-    if ( reply )
-    {
-      fileTransfer.networkReply = reply;
-      downloadFileConnections( fileKey );
-    }
+    mDownloadFileTransfers[fileKey].networkReply = reply;
+    downloadFileConnections( fileKey );
   }
 }
 
@@ -1126,8 +1117,6 @@ void QFieldCloudProject::downloadFileConnections( const QString &fileKey )
     return;
   }
 
-  const QStringList fileKeys = mDownloadFileTransfers.keys();
-
   QgsLogger::debug( QStringLiteral( "Project %1, file `%2`: requested." ).arg( mDownloadFileTransfers[fileKey].projectId, mDownloadFileTransfers[fileKey].fileName ) );
 
   connect( reply, &NetworkReply::redirected, reply, [this, reply, fileKey]( const QUrl &url ) {
@@ -1208,6 +1197,7 @@ void QFieldCloudProject::downloadFileConnections( const QString &fileKey )
     mDownloadBytesReceived -= mDownloadFileTransfers[fileKey].bytesTransferred;
     mDownloadBytesReceived += bytesReceived;
     mDownloadFileTransfers[fileKey].bytesTransferred = bytesReceived;
+    mDownloadScheduler.setBytesReceived( fileKey, mDownloadFileTransfers[fileKey].bytesResumed + bytesReceived );
 
     mDownloadProgress = std::clamp( ( static_cast<double>( mDownloadBytesReceived ) / std::max( mDownloadBytesTotal, static_cast<qint64>( 1 ) ) ), 0., 1. );
 
@@ -1215,7 +1205,7 @@ void QFieldCloudProject::downloadFileConnections( const QString &fileKey )
     emit downloadProgressChanged();
   } );
 
-  connect( reply, &NetworkReply::finished, reply, [this, reply, fileKey, fileKeys]() {
+  connect( reply, &NetworkReply::finished, reply, [this, reply, fileKey]() {
     if ( mPackagingStatus == PackagingAbortStatus )
     {
       return;
@@ -1232,8 +1222,6 @@ void QFieldCloudProject::downloadFileConnections( const QString &fileKey )
       return;
     }
 
-    mDownloadFilesFinished++;
-
     bool hasError = false;
     QString errorMessageDetail;
     QString errorMessage;
@@ -1263,6 +1251,19 @@ void QFieldCloudProject::downloadFileConnections( const QString &fileKey )
         return;
       }
 
+      const bool isRetryable = DownloadScheduler::isRetryableError( rawReply->error(), httpStatus );
+      if ( mDownloadScheduler.markFailed( fileKey, isRetryable ) )
+      {
+        QgsLogger::debug( QStringLiteral( "Project %1, file `%2`: download failed, retry #%3 scheduled. %4" ).arg( mId, fileKey ).arg( mDownloadScheduler.retryCount( fileKey ) ).arg( QFieldCloudConnection::errorString( rawReply ) ) );
+
+        // the retry resumes from the partial file, so the progress is accounted again
+        mDownloadBytesReceived -= mDownloadFileTransfers[fileKey].bytesTransferred + mDownloadFileTransfers[fileKey].bytesResumed;
+        mDownloadFileTransfers[fileKey].bytesTransferred = 0;
+        mDownloadFileTransfers[fileKey].bytesResumed = 0;
+        emit downloadBytesReceivedChanged();
+        return;
+      }
+
       hasError = true;
       errorMessageDetail = QFieldCloudConnection::errorString( rawReply );
       errorMessage = tr( "Network error. Failed to download file `%1`." ).arg( fileKey );
@@ -1288,23 +1289,17 @@ void QFieldCloudProject::downloadFileConnections( const QString &fileKey )
 
     QgsLogger::debug( QStringLiteral( "Package %1, file `%2`: downloaded" ).arg( mId, fileKey ) );
 
-    updateActiveFilesToDownload();
+    mDownloadFilesFinished++;
 
-    if ( mDownloadFilesFinished == fileKeys.count() )
-    {
-      downloadFilesCompleted();
-    }
-    else
-    {
-      downloadFiles();
-    }
+    // starts the next queued files, or completes the download once all files are there
+    mDownloadScheduler.markFinished( fileKey );
   } );
 }
 
 void QFieldCloudProject::downloadFilesCompleted()
 {
   QgsLogger::debug( QStringLiteral( "Project %1: All files downloaded." ).arg( mId ) );
-  Q_ASSERT( mActiveFilesToDownload.size() == 0 );
+  Q_ASSERT( mDownloadScheduler.activeCount() == 0 );
 
   if ( !mDeltaFileWrapper )
   {
@@ -1406,7 +1401,7 @@ NetworkReply *QFieldCloudProject::downloadFile( const QString &projectId, const
   mCloudConnection->setAuthenticationDetails( request );
 
   const QString fileKey = QStringLiteral( "%1/%2" ).arg( projectId, fileName );
-  const FileTransfer &fileTransfer = mDownloadFileTransfers[fileKey];
+  FileTransfer &fileTransfer = mDownloadFileTransfers[fileKey];
   QFile partialFile( fileTransfer.partialFilePath );
 
   if ( partialFile.exists() )
@@ -1422,18 +1417,15 @@ NetworkReply *QFieldCloudProject::downloadFile( const QString &projectId, const
       // Partial file found; resume download using Range header
       request.setRawHeader( "Range", "bytes=" + QByteArray::number( partialSize ) + "-" );
       mDownloadBytesReceived += partialSize;
+      fileTransfer.bytesResumed = partialSize;
+      mDownloadScheduler.setBytesReceived( fileKey, partialSize );
     }
     else if ( partialSize == fileTransfer.bytesTotal )
     {
       // File already fully downloaded and valid; skip download
       mDownloadBytesReceived += partialSize;
       mDownloadFilesFinished++;
-      mActiveFilesToDownload.removeOne( fileKey );
-
-      if ( mActiveFilesToDownload.size() == 0 )
-      {
-        downloadFilesCompleted();
-      }
+      mDownloadScheduler.markFinished( fileKey );
       return nullptr;
     }
   }
@@ -1445,6 +1437,7 @@ NetworkReply *QFieldCloudProject::downloadFile( const QString &projectId, const
 bool QFieldCloudProject::moveDownloadedFilesToPermanentStorage()
 {
   bool hasError = false;
+  ContentStore contentStore;
   const QStringList fileKeys = mDownloadFileTransfers.keys();
 
   for ( const QString &fileKey : fileKeys )
@@ -1481,6 +1474,8 @@ bool QFieldCloudProject::moveDownloadedFilesToPermanentStorage()
     else
     {
       QgsLogger::debug( QStringLiteral( "Moved downloaded file `%1` to `%2`" ).arg( fileTransfer.partialFilePath, finalFilePath ) );
+
+      contentStore.insert( finalFilePath, ContentStore::etagKey( fileTransfer.etag ) );
     }
   }
 
@@ -2089,6 +2084,8 @@ void QFieldCloudProject::cancelDownload()
     mDownloadFileTransfers.remove( fileKey );
   }
 
+  mDownloadScheduler.clear();
+
   QgsMessageLog::logMessage( QStringLiteral( "Download of project id `%1` aborted" ).arg( mId ) );
 
   setPackagingStatus( PackagingAbortStatus );
@@ -2117,6 +2114,9 @@ void QFieldCloudProject::removeLocally()
     setModification( NoModification );
     mCheckout = mCheckout & ~LocalCheckout;
     emit checkoutChanged();
+
+    // the content only referenced by the removed project is not needed anymore
+    ContentStore().removeUnreferenced();
   }
 
   QSettings().remove( QStringLiteral( "QFieldCloud/projects/%1" ).arg( mId ) );
@@ -2259,6 +2259,7 @@ void QFieldCloudProject::setupDeltaFileWrapper()
 {
   const QDir localPath( QStringLiteral( "%1/%2/%3" ).arg( QFieldCloudUtils::localCloudDirectory(), mUsername, mId ) );
   mDeltaFileWrapper.reset( new DeltaFileWrapper( mId, QStringLiteral( "%1/deltafile.json" ).arg( localPath.absolutePath() ) ) );
+  mDeltaFileWrapper->setJournalingEnabled( true );
 
   connect( mDeltaFileWrapper.get(), &DeltaFileWrapper::countChanged, this, [this]() {
     refreshModification();
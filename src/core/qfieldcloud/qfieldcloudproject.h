@@ -17,6 +17,7 @@
 #define QFIELDCLOUDPROJECT_H
 
 #include "deltafilewrapper.h"
+#include "downloadscheduler.h"
 #include "networkmanager.h"
 #include "networkreply.h"
 
@@ -55,6 +56,8 @@ class QFieldCloudProject : public QObject
     Q_PROPERTY( qint64 downloadBytesTotal READ downloadBytesTotal NOTIFY downloadBytesTotalChanged )
     Q_PROPERTY( qint64 downloadBytesReceived READ downloadBytesReceived NOTIFY downloadBytesReceivedChanged )
     Q_PROPERTY( double downloadProgress READ downloadProgress NOTIFY downloadProgressChanged )
+    Q_PROPERTY( double downloadThroughput READ downloadThroughput NOTIFY downloadStatisticsChanged )
+    Q_PROPERTY( qint64 downloadEstimatedRemainingSecs READ downloadEstimatedRemainingSecs NOTIFY downloadStatisticsChanged )
 
     Q_PROPERTY( double pushDeltaProgress READ pushDeltaProgress NOTIFY pushDeltaProgressChanged )
     Q_PROPERTY( DeltaFileStatus deltaFilePushStatus READ deltaFilePushStatus NOTIFY deltaFilePushStatusChanged )
@@ -107,6 +110,7 @@ class QFieldCloudProject : public QObject
         QUrl lastRedirectUrl;
         bool resumableDownload = true;
         int retryCount = 0;
+        qint64 bytesResumed = 0;
     };
 
     //! Whether the project is busy or idle.
@@ -339,6 +343,10 @@ class QFieldCloudProject : public QObject
     qint64 downloadBytesTotal() const { return mDownloadBytesTotal; }
     qint64 downloadBytesReceived() const { return mDownloadBytesReceived; }
     double downloadProgress() const { return mDownloadProgress; }
+    //! Returns the download throughput over the last few seconds, in bytes per second
+    double downloadThroughput() const { return mDownloadScheduler.throughput(); }
+    //! Returns the estimated remaining download time in seconds, or -1 if unknown
+    qint64 downloadEstimatedRemainingSecs() const { return mDownloadScheduler.estimatedRemainingSecs(); }
 
     qint64 uploadBytesTotal() const { return mUploadBytesTotal; }
     qint64 uploadBytesSent() const { return mUploadBytesSent; }
@@ -435,6 +443,7 @@ class QFieldCloudProject : public QObject
     void downloadBytesTotalChanged();
     void downloadBytesReceivedChanged();
     void downloadProgressChanged();
+    void downloadStatisticsChanged();
 
     void uploadBytesTotalChanged();
     void uploadBytesSentChanged();
@@ -462,9 +471,9 @@ class QFieldCloudProject : public QObject
 
   private:
     void download();
-    void prepareDownloadTransfer( const QString &projectId, const QString &fileName, qint64 fileSize, const QString &cloudEtag );
+    void prepareDownloadTransfer( const QString &projectId, const QString &fileName, qint64 fileSize, const QString &cloudEtag, DownloadScheduler::Priority priority );
     void downloadFiles();
-    void updateActiveFilesToDownload();
+    void startFileDownload( const QString &fileKey );
     void downloadFilesCompleted();
 
     void uploadFiles();
@@ -538,7 +547,7 @@ class QFieldCloudProject : public QObject
     QString mPackagingStatusString;
     QStringList mPackagedLayerErrors;
 
-    QStringList mActiveFilesToDownload;
+    DownloadScheduler mDownloadScheduler;
     QMap<QString, FileTransfer> mDownloadFileTransfers;
     int mDownloadFilesFinished = 0;
     int mDownloadFilesFailed = 0;
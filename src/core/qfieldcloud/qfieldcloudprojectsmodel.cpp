@@ -30,6 +30,7 @@
 #include <QTemporaryFile>
 #include <qgis.h>
 #include <qgsapplication.h>
+#include <qgsfeedback.h>
 #include <qgslocalizeddatapathregistry.h>
 #include <qgsmessagelog.h>
 #include <qgsnetworkaccessmanager.h>
@@ -863,26 +864,67 @@ bool QFieldCloudProjectsModel::revertLocalChangesFromCurrentProject()
   if ( !project )
     return false;
 
+  if ( mIsReverting )
+    return false;
+
   DeltaFileWrapper *deltaFileWrapper = mLayerObserver->deltaFileWrapper();
 
   if ( !deltaFileWrapper->toFile() )
     return false;
 
-  if ( !deltaFileWrapper->applyReversed( QgsProject::instance() ) )
+  QgsFeedback *feedback = new QgsFeedback( this );
+  connect( feedback, &QgsFeedback::progressChanged, this, [this]( double progress ) {
+    mRevertProgress = progress / 100.0;
+    emit revertProgressChanged();
+  } );
+
+  // the deltas are applied one batch per event loop iteration, the connection goes away with the feedback
+  connect( deltaFileWrapper, &DeltaFileWrapper::applyFinished, feedback, [this, deltaFileWrapper, feedback]( bool isSuccess ) {
+    disconnect( deltaFileWrapper, &DeltaFileWrapper::applyFinished, feedback, nullptr );
+
+    const bool isCanceled = feedback->isCanceled();
+    feedback->deleteLater();
+
+    bool isReverted = isSuccess;
+    if ( isReverted )
+    {
+      deltaFileWrapper->reset();
+      deltaFileWrapper->resetId();
+      isReverted = deltaFileWrapper->toFile();
+    }
+    else
+    {
+      QgsMessageLog::logMessage( isCanceled ? QStringLiteral( "Reverting local changes has been canceled" ) : QStringLiteral( "Failed to apply reversed" ) );
+    }
+
+    mRevertFeedback = nullptr;
+    mIsReverting = false;
+    emit isRevertingChanged();
+    emit revertFinished( isReverted, isCanceled );
+  } );
+
+  if ( !deltaFileWrapper->applyReversedAsync( QgsProject::instance(), feedback ) )
   {
     QgsMessageLog::logMessage( QStringLiteral( "Failed to apply reversed" ) );
+    delete feedback;
     return false;
   }
 
-  deltaFileWrapper->reset();
-  deltaFileWrapper->resetId();
-
-  if ( !deltaFileWrapper->toFile() )
-    return false;
+  mRevertFeedback = feedback;
+  mRevertProgress = 0.0;
+  mIsReverting = true;
+  emit revertProgressChanged();
+  emit isRevertingChanged();
 
   return true;
 }
 
+void QFieldCloudProjectsModel::cancelRevertLocalChanges()
+{
+  if ( mRevertFeedback )
+    mRevertFeedback->cancel();
+}
+
 bool QFieldCloudProjectsModel::discardLocalChangesFromCurrentProject()
 {
   QFieldCloudProject *project = findProject( mCurrentProjectId );
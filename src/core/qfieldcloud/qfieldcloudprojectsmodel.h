@@ -30,6 +30,7 @@
 class QNetworkRequest;
 class QFieldCloudConnection;
 class LayerObserver;
+class QgsFeedback;
 class QgsMapLayer;
 
 /**
@@ -52,6 +53,11 @@ class QFieldCloudProjectsModel : public QAbstractListModel
     //! Returns TRUE whether the model is creating a project
     Q_PROPERTY( bool isCreating READ isCreating NOTIFY isCreatingChanged )
 
+    //! Returns TRUE whether the local changes of the current project are being reverted
+    Q_PROPERTY( bool isReverting READ isReverting NOTIFY isRevertingChanged )
+    //! The progress of the ongoing revert of local changes, from 0.0 to 1.0
+    Q_PROPERTY( double revertProgress READ revertProgress NOTIFY revertProgressChanged )
+
     //! Currently busy project ids.
     Q_PROPERTY( QSet<QString> busyProjectIds READ busyProjectIds NOTIFY busyProjectIdsChanged )
 
@@ -158,9 +164,20 @@ class QFieldCloudProjectsModel : public QAbstractListModel
     //! Remove local cloud project with given \a projectId from the device storage
     Q_INVOKABLE void removeLocalProject( const QString &projectId );
 
-    //! Reverts the deltas of the current cloud project. The changes would applied in reverse order and opposite methods, e.g. "delete" becomes "create".
+    //! Starts reverting the deltas of the current cloud project. The changes would applied in reverse order and opposite methods, e.g. "delete" becomes "create".
+    //! The deltas are reverted in batches between event loop iterations, so the progress is shown and the revert can be canceled.
+    //! Returns whether the revert has been started, `revertFinished` is emitted once it is over.
     Q_INVOKABLE bool revertLocalChangesFromCurrentProject();
 
+    //! Cancels the ongoing revert of local changes, the layers are rolled back to their state before the revert.
+    Q_INVOKABLE void cancelRevertLocalChanges();
+
+    //! Returns TRUE whether the local changes of the current project are being reverted.
+    bool isReverting() const { return mIsReverting; }
+
+    //! Returns the progress of the ongoing revert of local changes, from 0.0 to 1.0.
+    double revertProgress() const { return mRevertProgress; }
+
     //! Discards the delta records of the current cloud project.
     Q_INVOKABLE bool discardLocalChangesFromCurrentProject();
 
@@ -205,6 +222,10 @@ class QFieldCloudProjectsModel : public QAbstractListModel
     void layerObserverChanged();
     void isRefreshingChanged();
     void isCreatingChanged();
+    void isRevertingChanged();
+    void revertProgressChanged();
+    //! Emitted when the revert started with revertLocalChangesFromCurrentProject() is over, \a isReverted is TRUE on success and \a isCanceled if it has been canceled.
+    void revertFinished( bool isReverted, bool isCanceled );
     void currentProjectIdChanged();
     void currentProjectChanged();
     void busyProjectIdsChanged();
@@ -243,6 +264,10 @@ class QFieldCloudProjectsModel : public QAbstractListModel
     bool mIsRefreshing = false;
     bool mIsCreating = false;
 
+    bool mIsReverting = false;
+    double mRevertProgress = 0.0;
+    QPointer<QgsFeedback> mRevertFeedback;
+
     QString mCurrentProjectId;
     QPointer<QFieldCloudProject> mCurrentProject;
 
@@ -45,6 +45,7 @@
 #include "barcodedecoder.h"
 #include "barcodeimageprovider.h"
 #include "changelogcontents.h"
+#include "commitsnapshotservice.h"
 #include "coordinatereferencesystemutils.h"
 #include "deltafilewrapper.h"
 #include "deltalistmodel.h"
@@ -122,6 +123,7 @@
 #include "qgsquickmaptransform.h"
 #include "recentprojectlistmodel.h"
 #include "referencingfeaturelistmodel.h"
+#include "renderstatisticsmodel.h"
 #include "relationutils.h"
 #include "resourcesource.h"
 #include "rubberbandmodel.h"
@@ -283,8 +285,9 @@ QgisMobileapp::QgisMobileapp( QgsApplication *app, QObject *parent )
   mProject = QgsProject::instance();
   mTrackingModel = new TrackingModel();
   mGpkgFlusher = std::make_unique<QgsGpkgFlusher>( mProject );
-  mLayerObserver = std::make_unique<LayerObserver>( mProject );
-  mFeatureHistory = std::make_unique<FeatureHistory>( mProject, mTrackingModel );
+  mCommitSnapshotService = std::make_unique<CommitSnapshotService>();
+  mLayerObserver = std::make_unique<LayerObserver>( mProject, mCommitSnapshotService.get() );
+  mFeatureHistory = std::make_unique<FeatureHistory>( mProject, mTrackingModel, mCommitSnapshotService.get() );
   mClipboardManager = std::make_unique<ClipboardManager>( this );
   mFlatLayerTree = new FlatLayerTreeModel( mProject->layerTreeRoot(), mProject, this );
   mLegendImageProvider = new LegendImageProvider( mFlatLayerTree->layerTreeModel() );
@@ -485,6 +488,7 @@ void QgisMobileapp::initDeclarative( QQmlEngine *engine )
   qmlRegisterType<ValueMapModel>( "org.qfield", 1, 0, "ValueMapModel" );
   qmlRegisterType<RecentProjectListModel>( "org.qfield", 1, 0, "RecentProjectListModel" );
   qmlRegisterType<ReferencingFeatureListModel>( "org.qfield", 1, 0, "ReferencingFeatureListModel" );
+  qmlRegisterUncreatableType<RenderStatisticsModel>( "org.qfield", 1, 0, "RenderStatisticsModel", "" );
   qmlRegisterType<OrderedRelationModel>( "org.qfield", 1, 0, "OrderedRelationModel" );
   qmlRegisterType<FeatureCheckListModel>( "org.qfield", 1, 0, "FeatureCheckListModel" );
   qmlRegisterType<GeometryEditorsModel>( "org.qfield", 1, 0, "GeometryEditorsModel" );
@@ -56,6 +56,7 @@ class ProjectsImageProvider;
 class TrackingModel;
 class LocatorFiltersModel;
 class QgsProject;
+class CommitSnapshotService;
 class LayerObserver;
 class FeatureHistory;
 class MessageLogModel;
@@ -238,6 +239,7 @@ class QFIELD_CORE_EXPORT QgisMobileapp : public QQmlApplicationEngine
     QString mProjectFileName;
 
     std::unique_ptr<QgsGpkgFlusher> mGpkgFlusher;
+    std::unique_ptr<CommitSnapshotService> mCommitSnapshotService;
     std::unique_ptr<LayerObserver> mLayerObserver;
     std::unique_ptr<FeatureHistory> mFeatureHistory;
     std::unique_ptr<ClipboardManager> mClipboardManager;
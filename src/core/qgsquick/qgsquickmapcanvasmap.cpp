@@ -13,12 +13,17 @@
  *                                                                         *
  ***************************************************************************/
 
+#include "maprendererdiskcache.h"
 #include "qgsquickmapcanvasmap.h"
 #include "qgsquickmapsettings.h"
 
+#include <QFutureWatcher>
+#include <QPointer>
 #include <QQuickWindow>
 #include <QSGSimpleTextureNode>
 #include <QScreen>
+#include <QThread>
+#include <QtConcurrentRun>
 #include <qgis.h>
 #include <qgsannotationlayer.h>
 #include <qgsexpressioncontextutils.h>
@@ -32,11 +37,18 @@
 #include <qgsproject.h>
 #include <qgsvectorlayer.h>
 
+#include <algorithm>
+#include <cmath>
+
+#define MAXIMUM_PARALLEL_PREVIEW_JOBS 4
+#define PREVIEW_JOBS_MEMORY_BUDGET 96 * 1024 * 1024
+#define EXTENT_SAMPLES_WINDOW_MS 500
 
 QgsQuickMapCanvasMap::QgsQuickMapCanvasMap( QQuickItem *parent )
   : QQuickItem( parent )
   , mMapSettings( std::make_unique<QgsQuickMapSettings>() )
   , mCache( std::make_unique<QgsMapRendererCache>() )
+  , mRenderStatistics( new RenderStatisticsModel( this ) )
 {
   connect( this, &QQuickItem::windowChanged, this, &QgsQuickMapCanvasMap::onWindowChanged );
   connect( &mRefreshTimer, &QTimer::timeout, this, [this] { refreshMap(); } );
@@ -52,6 +64,8 @@ QgsQuickMapCanvasMap::QgsQuickMapCanvasMap( QQuickItem *parent )
 
   mMapUpdateTimer.setSingleShot( false );
   mMapUpdateTimer.setInterval( 250 );
+  mMaxParallelPreviewJobs = std::clamp( QThread::idealThreadCount() / 2, 1, MAXIMUM_PARALLEL_PREVIEW_JOBS );
+  mExtentSamplesTimer.start();
   mRefreshTimer.setSingleShot( true );
   setTransformOrigin( QQuickItem::Center );
   setFlags( QQuickItem::ItemHasContents );
@@ -160,15 +174,19 @@ void QgsQuickMapCanvasMap::refreshMap()
   Q_ASSERT( !mJob );
   mJob = new QgsMapRendererParallelJob( mapSettings );
 
-  if ( mIncrementalRendering )
-    mMapUpdateTimer.start();
-
   connect( mJob, &QgsMapRendererJob::renderingLayersFinished, this, &QgsQuickMapCanvasMap::renderJobUpdated );
   connect( mJob, &QgsMapRendererJob::finished, this, &QgsQuickMapCanvasMap::renderJobFinished );
+  // the labeling happens once all layers are rendered
+  connect( mJob, &QgsMapRendererJob::renderingLayersFinished, this, [this, job = mJob] {
+    if ( job == mJob )
+      mLayersRenderedTime = mJobTimer.elapsed();
+  } );
   mJob->setCache( mCache.get() );
   mJob->setLayerRenderingTimeHints( mLastLayerRenderTime );
 
-  mJob->start();
+  // when persisted layer images are being restored, the job starts once they are decoded
+  if ( !mPersistentCache || !restorePersistentCache( mapSettings ) )
+    startJob();
 
   if ( !mSilentRefresh )
   {
@@ -176,6 +194,16 @@ void QgsQuickMapCanvasMap::refreshMap()
   }
 }
 
+void QgsQuickMapCanvasMap::startJob()
+{
+  if ( mIncrementalRendering )
+    mMapUpdateTimer.start();
+
+  mJobTimer.start();
+  mLayersRenderedTime = -1;
+  mJob->start();
+}
+
 void QgsQuickMapCanvasMap::renderJobUpdated()
 {
   if ( !mJob )
@@ -205,6 +233,11 @@ void QgsQuickMapCanvasMap::renderJobFinished()
     QgsMessageLog::logMessage( QStringLiteral( "%1 :: %2" ).arg( error.layerID, error.message ), tr( "Rendering" ) );
   }
 
+  if ( mPersistentCache )
+    updatePersistentCache( errors );
+
+  updateRenderStatistics();
+
   // take labeling results before emitting renderComplete, so labeling map tools
   // connected to signal work with correct results
   delete mLabelingResults;
@@ -251,6 +284,15 @@ void QgsQuickMapCanvasMap::renderJobFinished()
 
 void QgsQuickMapCanvasMap::layerRepaintRequested( bool deferred )
 {
+  if ( mPersistentCache )
+  {
+    if ( QgsMapLayer *layer = qobject_cast<QgsMapLayer *>( sender() ) )
+    {
+      mPersistentCache->invalidate( layer->id() );
+      mPersistentCacheStyleHashes.remove( layer->id() );
+    }
+  }
+
   if ( mMapSettings->outputSize().isNull() )
     return; // the map image size has not been set yet
 
@@ -304,6 +346,17 @@ void QgsQuickMapCanvasMap::onScreenChanged( QScreen *screen )
 
 void QgsQuickMapCanvasMap::onExtentChanged()
 {
+  // the preview jobs are outdated as soon as the map moves
+  stopPreviewJobs();
+
+  const qint64 time = mExtentSamplesTimer.elapsed();
+  while ( !mExtentSamples.isEmpty() && time - mExtentSamples.first().time > EXTENT_SAMPLES_WINDOW_MS )
+  {
+    mExtentSamples.removeFirst();
+  }
+  const QgsMapSettings mapSettings = mMapSettings->mapSettings();
+  mExtentSamples << ExtentSample { time, mapSettings.extent().center(), mapSettings.mapUnitsPerPixel() };
+
   updateTransform();
 
   // And trigger a new rendering job
@@ -312,6 +365,7 @@ void QgsQuickMapCanvasMap::onExtentChanged()
 
 void QgsQuickMapCanvasMap::onRotationChanged()
 {
+  stopPreviewJobs();
   updateTransform();
 
   // And trigger a new rendering job
@@ -597,6 +651,9 @@ void QgsQuickMapCanvasMap::onLayersChanged()
   for ( QgsMapLayer *layer : layers )
   {
     mLayerConnections << connect( layer, &QgsMapLayer::repaintRequested, this, &QgsQuickMapCanvasMap::layerRepaintRequested );
+    mLayerConnections << connect( layer, &QgsMapLayer::styleChanged, this, [this, layerId = layer->id()] {
+      mPersistentCacheStyleHashes.remove( layerId );
+    } );
   }
 
   refresh();
@@ -695,6 +752,136 @@ void QgsQuickMapCanvasMap::clearTemporalCache()
   }
 }
 
+bool QgsQuickMapCanvasMap::restorePersistentCache( const QgsMapSettings &mapSettings )
+{
+  mPersistentCacheKeys.clear();
+
+  // the job keeps the cached images matching its parameters, set them beforehand so the restored images are kept
+  mCache->updateParameters( mapSettings.visibleExtent(), mapSettings.mapToPixel() );
+
+  QList<QPointer<QgsMapLayer>> restoredLayers;
+  QStringList restoredLayerIds;
+  QStringList restoredKeys;
+  const QList<QgsMapLayer *> layers = mapSettings.layers();
+  for ( QgsMapLayer *layer : layers )
+  {
+    if ( !MapRendererDiskCache::isCacheable( layer ) )
+      continue;
+
+    // exporting the style is costly, its hash is kept until the layer style changes
+    auto styleHashIt = mPersistentCacheStyleHashes.constFind( layer->id() );
+    if ( styleHashIt == mPersistentCacheStyleHashes.constEnd() )
+      styleHashIt = mPersistentCacheStyleHashes.insert( layer->id(), MapRendererDiskCache::styleHash( layer ) );
+
+    const QString key = MapRendererDiskCache::key( layer, *styleHashIt, mapSettings );
+    mPersistentCacheKeys.insert( layer->id(), key );
+
+    if ( mCache->hasCacheImage( layer->id() ) || !mPersistentCache->contains( layer->id(), key ) )
+      continue;
+
+    restoredLayers << layer;
+    restoredLayerIds << layer->id();
+    restoredKeys << key;
+  }
+
+  if ( restoredLayers.isEmpty() )
+    return false;
+
+  // the images are decoded on a worker thread, the job might be stopped in the meantime
+  QPointer<QgsMapRendererParallelJob> job = mJob;
+  QFutureWatcher<QList<QImage>> *watcher = new QFutureWatcher<QList<QImage>>( this );
+  connect( watcher, &QFutureWatcherBase::finished, this, [this, watcher, job, restoredLayers, mapSettings] {
+    watcher->deleteLater();
+    if ( !job || job != mJob )
+      return;
+
+    const QList<QImage> images = watcher->result();
+    for ( qsizetype i = 0; i < images.size(); i++ )
+    {
+      if ( restoredLayers.at( i ) && images.at( i ).size() == mapSettings.deviceOutputSize() )
+      {
+        mCache->setCacheImageWithParameters( restoredLayers.at( i )->id(), images.at( i ), mapSettings.visibleExtent(), mapSettings.mapToPixel(), QList<QgsMapLayer *>() << restoredLayers.at( i ) );
+      }
+    }
+
+    startJob();
+  } );
+  watcher->setFuture( QtConcurrent::run( [persistentCache = mPersistentCache, restoredLayerIds, restoredKeys] {
+    QList<QImage> images;
+    for ( qsizetype i = 0; i < restoredLayerIds.size(); i++ )
+      images << persistentCache->image( restoredLayerIds.at( i ), restoredKeys.at( i ) );
+    return images;
+  } ) );
+
+  return true;
+}
+
+void QgsQuickMapCanvasMap::updatePersistentCache( const QgsMapRendererJob::Errors &errors )
+{
+  QSet<QString> failedLayerIds;
+  for ( const QgsMapRendererJob::Error &error : errors )
+    failedLayerIds << error.layerID;
+
+  for ( auto it = mPersistentCacheKeys.constBegin(); it != mPersistentCacheKeys.constEnd(); ++it )
+  {
+    if ( failedLayerIds.contains( it.key() ) || !mCache->hasCacheImage( it.key() ) || mPersistentCache->contains( it.key(), it.value() ) )
+      continue;
+
+    mPersistentCache->insert( it.key(), it.value(), mCache->cacheImage( it.key() ) );
+  }
+  mPersistentCacheKeys.clear();
+}
+
+void QgsQuickMapCanvasMap::updateRenderStatistics()
+{
+  const qint64 jobTime = mJobTimer.elapsed();
+  const qint64 labelingTime = mLayersRenderedTime >= 0 ? jobTime - mLayersRenderedTime : 0;
+
+  const QHash<QgsMapLayer *, int> perLayerRenderingTime = mJob->perLayerRenderingTime();
+  const QStringList layersRedrawnFromCache = mJob->layersRedrawnFromCache();
+  QList<RenderStatisticsModel::LayerRender> layerRenders;
+  const QList<QgsMapLayer *> layers = mJob->mapSettings().layers();
+  for ( QgsMapLayer *layer : layers )
+  {
+    RenderStatisticsModel::LayerRender layerRender;
+    layerRender.layerId = layer->id();
+    layerRender.layerName = layer->name();
+    layerRender.renderTime = perLayerRenderingTime.value( layer, 0 );
+    layerRender.fromCache = layersRedrawnFromCache.contains( layer->id() );
+    layerRenders << layerRender;
+
+    // used as hints by the next render jobs and to skip slow layers in preview jobs
+    if ( !layerRender.fromCache )
+      mLastLayerRenderTime.insert( layer->id(), layerRender.renderTime );
+  }
+
+  mRenderStatistics->addJob( static_cast<int>( jobTime ), static_cast<int>( labelingTime ), layerRenders );
+}
+
+bool QgsQuickMapCanvasMap::persistentCacheEnabled() const
+{
+  return static_cast<bool>( mPersistentCache );
+}
+
+void QgsQuickMapCanvasMap::setPersistentCacheEnabled( bool enabled )
+{
+  if ( persistentCacheEnabled() == enabled )
+    return;
+
+  if ( enabled )
+  {
+    mPersistentCache = std::make_shared<MapRendererDiskCache>();
+  }
+  else
+  {
+    mPersistentCache.reset();
+    mPersistentCacheKeys.clear();
+    mPersistentCacheStyleHashes.clear();
+  }
+
+  emit persistentCacheEnabledChanged();
+}
+
 QList<QgsMapLayer *> filterLayersForRender( const QList<QgsMapLayer *> &layers )
 {
   QList<QgsMapLayer *> filteredLayers;
@@ -757,12 +944,58 @@ void QgsQuickMapCanvasMap::startPreviewJobs()
     return;
   }
 
+  mPreviewJobsOrder = prioritizedPreviewJobsQuadrants();
   schedulePreviewJob( 0 );
 }
 
+QList<int> QgsQuickMapCanvasMap::prioritizedPreviewJobsQuadrants() const
+{
+  QList<int> quadrants = mPreviewJobsQuadrants;
+
+  if ( mExtentSamples.size() > 1 )
+  {
+    // zooming in never reveals areas outside of the rendered map image
+    if ( mExtentSamples.last().mapUnitsPerPixel < mExtentSamples.first().mapUnitsPerPixel * 0.95 )
+      return QList<int>();
+
+    // the recent panning direction, relative to the unrotated map image size
+    QgsMapSettings mapSettings = mImageMapSettings;
+    mapSettings.setRotation( 0 );
+    const QgsRectangle mapRect = mapSettings.visibleExtent();
+    const double dx = mExtentSamples.last().center.x() - mExtentSamples.first().center.x();
+    const double dy = mExtentSamples.last().center.y() - mExtentSamples.first().center.y();
+    const double radians = mImageMapSettings.rotation() * M_PI / 180;
+    const double directionX = ( dx * cos( radians ) + dy * sin( radians ) ) / mapRect.width();
+    const double directionY = ( dy * cos( radians ) - dx * sin( radians ) ) / mapRect.height();
+
+    // ignore jitter below a hundredth of the map size
+    if ( std::hypot( directionX, directionY ) > 0.01 )
+    {
+      auto score = [directionX, directionY]( int quadrant ) {
+        const int offsetX = quadrant % 3 - 1;
+        const int offsetY = 1 - quadrant / 3;
+        const double length = std::hypot( offsetX, offsetY );
+        return length > 0 ? ( offsetX * directionX + offsetY * directionY ) / length : 0.0;
+      };
+      std::stable_sort( quadrants.begin(), quadrants.end(), [&score]( int a, int b ) { return score( a ) > score( b ); } );
+    }
+  }
+
+  // the preview images are kept in memory alongside the map image
+  const qint64 imageSize = mImage.sizeInBytes();
+  if ( imageSize > 0 )
+  {
+    const qsizetype maximumCount = std::max<qsizetype>( 1, PREVIEW_JOBS_MEMORY_BUDGET / imageSize );
+    if ( quadrants.size() > maximumCount )
+      quadrants = quadrants.mid( 0, maximumCount );
+  }
+
+  return quadrants;
+}
+
 void QgsQuickMapCanvasMap::startPreviewJob( int number )
 {
-  int quadrant = mPreviewJobsQuadrants.at( number );
+  int quadrant = mPreviewJobsOrder.at( number );
 
   if ( quadrant == 4 )
     quadrant += 1;
@@ -829,7 +1062,6 @@ void QgsQuickMapCanvasMap::startPreviewJob( int number )
   jobSettings.setOutputImageFormat( QImage::Format_RGBA8888_Premultiplied );
 
   QgsMapRendererQImageJob *job = new QgsMapRendererSequentialJob( jobSettings );
-  job->setProperty( "number", number );
   job->setProperty( "quadrant", quadrant );
   mPreviewJobs.append( job );
   connect( job, &QgsMapRendererJob::finished, this, &QgsQuickMapCanvasMap::previewJobFinished );
@@ -849,6 +1081,7 @@ void QgsQuickMapCanvasMap::stopPreviewJobs()
     }
   }
   mPreviewJobs.clear();
+  mNextPreviewJob = mPreviewJobsOrder.size();
 }
 
 void QgsQuickMapCanvasMap::schedulePreviewJob( int number )
@@ -857,7 +1090,12 @@ void QgsQuickMapCanvasMap::schedulePreviewJob( int number )
   mPreviewTimer.setInterval( Qgis::PREVIEW_JOB_DELAY_MS );
   disconnect( mPreviewTimerConnection );
   mPreviewTimerConnection = connect( &mPreviewTimer, &QTimer::timeout, this, [this, number]() {
-    startPreviewJob( number );
+    // render the first quadrants in parallel, the others follow as jobs finish
+    mNextPreviewJob = number;
+    while ( mPreviewJobs.size() < mMaxParallelPreviewJobs && mNextPreviewJob < mPreviewJobsOrder.size() )
+    {
+      startPreviewJob( mNextPreviewJob++ );
+    }
   } );
   mPreviewTimer.start();
 }
@@ -871,10 +1109,9 @@ void QgsQuickMapCanvasMap::previewJobFinished()
   mPreviewImages.insert( quadrant, job->renderedImage() );
   mPreviewJobs.removeAll( job );
 
-  const int number = job->property( "number" ).toInt() + 1;
-  if ( number < mPreviewJobsQuadrants.size() )
+  if ( mNextPreviewJob < mPreviewJobsOrder.size() )
   {
-    startPreviewJob( number );
+    startPreviewJob( mNextPreviewJob++ );
   }
   delete job;
 
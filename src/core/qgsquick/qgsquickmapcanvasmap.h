@@ -17,10 +17,13 @@
 #define QGSQUICKMAPCANVASMAP_H
 
 #include "qgsquickmapsettings.h"
+#include "renderstatisticsmodel.h"
 
+#include <QElapsedTimer>
 #include <QFutureSynchronizer>
 #include <QQuickItem>
 #include <QTimer>
+#include <qgsmaprendererjob.h>
 #include <qgsmapsettings.h>
 #include <qgspoint.h>
 
@@ -30,6 +33,7 @@ class QgsMapRendererParallelJob;
 class QgsMapRendererQImageJob;
 class QgsMapRendererCache;
 class QgsLabelingResults;
+class MapRendererDiskCache;
 
 /**
  * This class implements a visual Qt Quick Item that does map rendering
@@ -130,9 +134,26 @@ class QgsQuickMapCanvasMap : public QQuickItem
      * 0 (top left)    | 1 (top)    | 2 (top right)
      * 3 (left)        | canvas     | 5 (right)
      * 6 (bottom left) | 7 (bottom) | 8 (bottom right)
+     *
+     * The quadrants lying in the direction of the most recent panning are rendered first,
+     * the others follow in the order of this list.
      */
     Q_PROPERTY( QList<int> previewJobsQuadrants READ previewJobsQuadrants WRITE setPreviewJobsQuadrants NOTIFY previewJobsQuadrantsChanged )
 
+    /**
+     * When the persistentCacheEnabled property is set to true, the rendered images of layers which
+     * cannot be edited are also cached on disk, so reopening a project or returning to a previous
+     * view shows them without rendering them again.
+     */
+    Q_PROPERTY( bool persistentCacheEnabled READ persistentCacheEnabled WRITE setPersistentCacheEnabled NOTIFY persistentCacheEnabledChanged )
+
+    /**
+     * The renderStatistics property holds the timings and cache usage of the finished render jobs, per layer.
+     *
+     * This is a readonly property.
+     */
+    Q_PROPERTY( RenderStatisticsModel *renderStatistics READ renderStatistics CONSTANT )
+
   public:
     //! Create map canvas map
     explicit QgsQuickMapCanvasMap( QQuickItem *parent = nullptr );
@@ -206,6 +227,15 @@ class QgsQuickMapCanvasMap : public QQuickItem
     //!\copydoc QgsQuickMapCanvasMap::previewJobsQuadrants
     void setPreviewJobsQuadrants( const QList<int> &quadrants );
 
+    //!\copydoc QgsQuickMapCanvasMap::persistentCacheEnabled
+    bool persistentCacheEnabled() const;
+
+    //!\copydoc QgsQuickMapCanvasMap::persistentCacheEnabled
+    void setPersistentCacheEnabled( bool enabled );
+
+    //!\copydoc QgsQuickMapCanvasMap::renderStatistics
+    RenderStatisticsModel *renderStatistics() const { return mRenderStatistics; }
+
     /**
      * Returns an image of the last successful map canvas rendering
      */
@@ -256,6 +286,9 @@ class QgsQuickMapCanvasMap : public QQuickItem
     //!\copydoc QgsQuickMapCanvasMap::previewJobsQuadrants
     void smoothChanged() const;
 
+    //!\copydoc QgsQuickMapCanvasMap::persistentCacheEnabled
+    void persistentCacheEnabledChanged();
+
   protected:
     void geometryChange( const QRectF &newGeometry, const QRectF &oldGeometry ) override;
 
@@ -317,12 +350,25 @@ class QgsQuickMapCanvasMap : public QQuickItem
     void updateTransform( bool skipSmooth = false );
     void zoomToFullExtent();
     void clearTemporalCache();
+    QList<int> prioritizedPreviewJobsQuadrants() const;
+    void startJob();
+
+    /**
+     * Restores the persisted images of the layers rendered with \a mapSettings into the cache of the job.
+     * Returns TRUE if images are being decoded, the job is then started once they are restored.
+     */
+    bool restorePersistentCache( const QgsMapSettings &mapSettings );
+    void updatePersistentCache( const QgsMapRendererJob::Errors &errors );
+    void updateRenderStatistics();
 
     std::unique_ptr<QgsQuickMapSettings> mMapSettings;
     bool mPinching = false;
     QPoint mPinchStartPoint;
     QgsMapRendererParallelJob *mJob = nullptr;
     std::unique_ptr<QgsMapRendererCache> mCache;
+    std::shared_ptr<MapRendererDiskCache> mPersistentCache;
+    QHash<QString, QString> mPersistentCacheKeys;
+    QHash<QString, QByteArray> mPersistentCacheStyleHashes;
     QgsLabelingResults *mLabelingResults = nullptr;
     QImage mImage;
     QgsMapSettings mImageMapSettings;
@@ -339,15 +385,32 @@ class QgsQuickMapCanvasMap : public QQuickItem
     bool mForceDeferredLayersRepaint = false;
 
     QHash<QString, int> mLastLayerRenderTime;
+    RenderStatisticsModel *mRenderStatistics = nullptr;
+    QElapsedTimer mJobTimer;
+    qint64 mLayersRenderedTime = -1;
 
     bool mPreviewJobsEnabled = false;
     QList<int> mPreviewJobsQuadrants = { 0, 1, 2, 3, 5, 6, 7, 8 };
     QList<QgsMapRendererQImageJob *> mPreviewJobs;
+    QList<int> mPreviewJobsOrder;
+    int mNextPreviewJob = 0;
+    int mMaxParallelPreviewJobs = 1;
     QTimer mPreviewTimer;
     QMetaObject::Connection mPreviewTimerConnection;
     QMap<int, QImage> mPreviewImages;
 
     QQuickWindow *mWindow = nullptr;
+
+    struct ExtentSample
+    {
+        qint64 time = 0;
+        QgsPointXY center;
+        double mapUnitsPerPixel = 0.0;
+    };
+
+    //! Recent extents, used to predict where the map is heading to
+    QList<ExtentSample> mExtentSamples;
+    QElapsedTimer mExtentSamplesTimer;
 };
 
 #endif // QGSQUICKMAPCANVASMAP_H
@@ -0,0 +1,188 @@
+/***************************************************************************
+  renderstatisticsmodel.cpp - RenderStatisticsModel
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "renderstatisticsmodel.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+#define MAXIMUM_LOG_FILE_SIZE 1024 * 1024
+
+
+RenderStatisticsModel::RenderStatisticsModel( QObject *parent )
+  : QAbstractListModel( parent )
+{
+}
+
+int RenderStatisticsModel::rowCount( const QModelIndex &parent ) const
+{
+  return !parent.isValid() ? static_cast<int>( mLayers.size() ) : 0;
+}
+
+QVariant RenderStatisticsModel::data( const QModelIndex &index, int role ) const
+{
+  if ( !index.isValid() || index.row() >= mLayers.size() )
+    return QVariant();
+
+  const LayerStatistics &layer = mLayers.at( index.row() );
+  switch ( role )
+  {
+    case LayerIdRole:
+      return layer.layerId;
+    case Qt::DisplayRole:
+    case LayerNameRole:
+      return layer.layerName;
+    case LastRenderTimeRole:
+      return layer.lastRenderTime;
+    case AverageRenderTimeRole:
+      return layer.averageRenderTime();
+    case MaximumRenderTimeRole:
+      return layer.maximumRenderTime;
+    case RenderCountRole:
+      return layer.renderCount;
+    case CacheHitsRole:
+      return layer.cacheHits;
+    case CacheMissesRole:
+      return layer.cacheMisses;
+  }
+
+  return QVariant();
+}
+
+QHash<int, QByteArray> RenderStatisticsModel::roleNames() const
+{
+  QHash<int, QByteArray> roles = QAbstractListModel::roleNames();
+  roles[LayerIdRole] = "LayerId";
+  roles[LayerNameRole] = "LayerName";
+  roles[LastRenderTimeRole] = "LastRenderTime";
+  roles[AverageRenderTimeRole] = "AverageRenderTime";
+  roles[MaximumRenderTimeRole] = "MaximumRenderTime";
+  roles[RenderCountRole] = "RenderCount";
+  roles[CacheHitsRole] = "CacheHits";
+  roles[CacheMissesRole] = "CacheMisses";
+  return roles;
+}
+
+void RenderStatisticsModel::addJob( int jobTime, int labelingTime, const QList<LayerRender> &layerRenders )
+{
+  beginResetModel();
+  for ( const LayerRender &layerRender : layerRenders )
+  {
+    auto it = std::find_if( mLayers.begin(), mLayers.end(), [&layerRender]( const LayerStatistics &layer ) { return layer.layerId == layerRender.layerId; } );
+    if ( it == mLayers.end() )
+    {
+      LayerStatistics layer;
+      layer.layerId = layerRender.layerId;
+      mLayers << layer;
+      it = std::prev( mLayers.end() );
+    }
+
+    it->layerName = layerRender.layerName;
+    if ( layerRender.fromCache )
+    {
+      // a cached layer costs nothing, it would hide the actual rendering time in the averages
+      it->cacheHits++;
+      mCacheHits++;
+    }
+    else
+    {
+      it->cacheMisses++;
+      it->lastRenderTime = layerRender.renderTime;
+      it->totalRenderTime += layerRender.renderTime;
+      it->maximumRenderTime = std::max( it->maximumRenderTime, layerRender.renderTime );
+      it->renderCount++;
+      mCacheMisses++;
+    }
+  }
+
+  std::stable_sort( mLayers.begin(), mLayers.end(), []( const LayerStatistics &a, const LayerStatistics &b ) { return a.averageRenderTime() > b.averageRenderTime(); } );
+  endResetModel();
+
+  mJobCount++;
+  mLastJobTime = jobTime;
+  mTotalJobTime += jobTime;
+  mLastLabelingTime = labelingTime;
+  emit statisticsChanged();
+
+  if ( !mLogFilePath.isEmpty() )
+    writeLog( jobTime, labelingTime, layerRenders );
+}
+
+void RenderStatisticsModel::clear()
+{
+  beginResetModel();
+  mLayers.clear();
+  endResetModel();
+
+  mJobCount = 0;
+  mLastJobTime = 0;
+  mTotalJobTime = 0;
+  mLastLabelingTime = 0;
+  mCacheHits = 0;
+  mCacheMisses = 0;
+  emit statisticsChanged();
+}
+
+void RenderStatisticsModel::setLogFilePath( const QString &path )
+{
+  if ( mLogFilePath == path )
+    return;
+
+  mLogFilePath = path;
+  emit logFilePathChanged();
+}
+
+void RenderStatisticsModel::writeLog( int jobTime, int labelingTime, const QList<LayerRender> &layerRenders ) const
+{
+  const QFileInfo fileInfo( mLogFilePath );
+  if ( fileInfo.size() > MAXIMUM_LOG_FILE_SIZE )
+  {
+    const QString backupFilePath = QStringLiteral( "%1.1" ).arg( mLogFilePath );
+    QFile::remove( backupFilePath );
+    QFile::rename( mLogFilePath, backupFilePath );
+  }
+  else if ( !fileInfo.exists() )
+  {
+    QDir().mkpath( fileInfo.absolutePath() );
+  }
+
+  QFile file( mLogFilePath );
+  if ( !file.open( QIODevice::WriteOnly | QIODevice::Append ) )
+    return;
+
+  QJsonArray layers;
+  for ( const LayerRender &layerRender : layerRenders )
+  {
+    layers.append( QJsonObject( { { QStringLiteral( "id" ), layerRender.layerId },
+                                  { QStringLiteral( "name" ), layerRender.layerName },
+                                  { QStringLiteral( "time" ), layerRender.renderTime },
+                                  { QStringLiteral( "cached" ), layerRender.fromCache } } ) );
+  }
+
+  const QJsonObject job( { { QStringLiteral( "timestamp" ), QDateTime::currentDateTime().toString( Qt::ISODateWithMs ) },
+                           { QStringLiteral( "time" ), jobTime },
+                           { QStringLiteral( "labeling_time" ), labelingTime },
+                           { QStringLiteral( "layers" ), layers } } );
+  file.write( QJsonDocument( job ).toJson( QJsonDocument::Compact ) );
+  file.write( "\n" );
+}
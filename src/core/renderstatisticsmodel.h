@@ -0,0 +1,134 @@
+/***************************************************************************
+  renderstatisticsmodel.h - RenderStatisticsModel
+
+ ---------------------
+ begin                : October 2026
+ copyright            : (C) 2026 by OPENGIS.ch
+ email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef RENDERSTATISTICSMODEL_H
+#define RENDERSTATISTICSMODEL_H
+
+#include "qfield_core_export.h"
+
+#include <QAbstractListModel>
+
+/**
+ * \brief A model of the map rendering statistics, with one row per rendered layer.
+ *
+ * The rows are sorted by decreasing average rendering time, so the layers slowing down
+ * the map come first. Each finished render job can also be appended as a JSON line to a
+ * rolling log file, to profile projects on devices.
+ * \ingroup core
+ */
+class QFIELD_CORE_EXPORT RenderStatisticsModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    //! The number of recorded render jobs
+    Q_PROPERTY( int jobCount READ jobCount NOTIFY statisticsChanged )
+    //! The wall time of the last render job, in milliseconds
+    Q_PROPERTY( int lastJobTime READ lastJobTime NOTIFY statisticsChanged )
+    //! The average wall time of the render jobs, in milliseconds
+    Q_PROPERTY( double averageJobTime READ averageJobTime NOTIFY statisticsChanged )
+    //! The time spent labeling and composing the map image in the last render job, in milliseconds
+    Q_PROPERTY( int lastLabelingTime READ lastLabelingTime NOTIFY statisticsChanged )
+    //! The number of layer renders served from the render cache
+    Q_PROPERTY( int cacheHits READ cacheHits NOTIFY statisticsChanged )
+    //! The number of layer renders which were not cached
+    Q_PROPERTY( int cacheMisses READ cacheMisses NOTIFY statisticsChanged )
+
+    /**
+     * The path of the log file the render jobs are appended to, logging is disabled if empty.
+     * Once the file exceeds 1 MB, it is moved to a `.1` backup file replacing any previous one.
+     */
+    Q_PROPERTY( QString logFilePath READ logFilePath WRITE setLogFilePath NOTIFY logFilePathChanged )
+
+  public:
+    enum Roles
+    {
+      LayerIdRole = Qt::UserRole + 1,
+      LayerNameRole,
+      LastRenderTimeRole,
+      AverageRenderTimeRole,
+      MaximumRenderTimeRole,
+      RenderCountRole,
+      CacheHitsRole,
+      CacheMissesRole,
+    };
+    Q_ENUM( Roles )
+
+    //! The statistics of a layer in a single render job
+    struct LayerRender
+    {
+        QString layerId;
+        QString layerName;
+        int renderTime = 0;
+        bool fromCache = false;
+    };
+
+    explicit RenderStatisticsModel( QObject *parent = nullptr );
+
+    int rowCount( const QModelIndex &parent = QModelIndex() ) const override;
+    QVariant data( const QModelIndex &index, int role ) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * Records a finished render job which took \a jobTime milliseconds, including \a labelingTime
+     * milliseconds of labeling and composition, and rendered \a layerRenders.
+     */
+    void addJob( int jobTime, int labelingTime, const QList<LayerRender> &layerRenders );
+
+    //! Clears the recorded statistics
+    Q_INVOKABLE void clear();
+
+    int jobCount() const { return mJobCount; }
+    int lastJobTime() const { return mLastJobTime; }
+    double averageJobTime() const { return mJobCount > 0 ? static_cast<double>( mTotalJobTime ) / mJobCount : 0.0; }
+    int lastLabelingTime() const { return mLastLabelingTime; }
+    int cacheHits() const { return mCacheHits; }
+    int cacheMisses() const { return mCacheMisses; }
+
+    QString logFilePath() const { return mLogFilePath; }
+    void setLogFilePath( const QString &path );
+
+  signals:
+    void statisticsChanged();
+    void logFilePathChanged();
+
+  private:
+    struct LayerStatistics
+    {
+        QString layerId;
+        QString layerName;
+        int lastRenderTime = 0;
+        qint64 totalRenderTime = 0;
+        int maximumRenderTime = 0;
+        int renderCount = 0;
+        int cacheHits = 0;
+        int cacheMisses = 0;
+
+        double averageRenderTime() const { return renderCount > 0 ? static_cast<double>( totalRenderTime ) / renderCount : 0.0; }
+    };
+
+    void writeLog( int jobTime, int labelingTime, const QList<LayerRender> &layerRenders ) const;
+
+    QList<LayerStatistics> mLayers;
+    int mJobCount = 0;
+    int mLastJobTime = 0;
+    qint64 mTotalJobTime = 0;
+    int mLastLabelingTime = 0;
+    int mCacheHits = 0;
+    int mCacheMisses = 0;
+    QString mLogFilePath;
+};
+
+#endif // RENDERSTATISTICSMODEL_H
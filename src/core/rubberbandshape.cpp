@@ -20,6 +20,9 @@
 #include "rubberbandshape.h"
 #include "vertexmodel.h"
 
+#include <algorithm>
+#include <cmath>
+
 RubberbandShape::RubberbandShape( QQuickItem *parent )
   : QQuickItem( parent )
 {
@@ -43,9 +46,10 @@ void RubberbandShape::setModel( RubberbandModel *model )
 
   if ( mRubberbandModel )
   {
-    disconnect( mRubberbandModel, &RubberbandModel::vertexChanged, this, &RubberbandShape::markDirty );
-    disconnect( mRubberbandModel, &RubberbandModel::verticesRemoved, this, &RubberbandShape::markDirty );
-    disconnect( mRubberbandModel, &RubberbandModel::verticesInserted, this, &RubberbandShape::markDirty );
+    disconnect( mRubberbandModel, &RubberbandModel::vertexChanged, this, &RubberbandShape::vertexChanged );
+    disconnect( mRubberbandModel, &RubberbandModel::verticesRemoved, this, &RubberbandShape::verticesRemoved );
+    disconnect( mRubberbandModel, &RubberbandModel::verticesInserted, this, &RubberbandShape::verticesInserted );
+    disconnect( mRubberbandModel, &RubberbandModel::geometryTypeChanged, this, &RubberbandShape::markDirty );
   }
 
 
@@ -53,9 +57,10 @@ void RubberbandShape::setModel( RubberbandModel *model )
 
   if ( mRubberbandModel && !mFreeze )
   {
-    connect( mRubberbandModel, &RubberbandModel::vertexChanged, this, &RubberbandShape::markDirty );
-    connect( mRubberbandModel, &RubberbandModel::verticesRemoved, this, &RubberbandShape::markDirty );
-    connect( mRubberbandModel, &RubberbandModel::verticesInserted, this, &RubberbandShape::markDirty );
+    connect( mRubberbandModel, &RubberbandModel::vertexChanged, this, &RubberbandShape::vertexChanged );
+    connect( mRubberbandModel, &RubberbandModel::verticesRemoved, this, &RubberbandShape::verticesRemoved );
+    connect( mRubberbandModel, &RubberbandModel::verticesInserted, this, &RubberbandShape::verticesInserted );
+    connect( mRubberbandModel, &RubberbandModel::geometryTypeChanged, this, &RubberbandShape::markDirty );
   }
 
   markDirty();
@@ -120,9 +125,10 @@ void RubberbandShape::setFreeze( bool freeze )
     }
     if ( mRubberbandModel )
     {
-      disconnect( mRubberbandModel, &RubberbandModel::vertexChanged, this, &RubberbandShape::markDirty );
-      disconnect( mRubberbandModel, &RubberbandModel::verticesRemoved, this, &RubberbandShape::markDirty );
-      disconnect( mRubberbandModel, &RubberbandModel::verticesInserted, this, &RubberbandShape::markDirty );
+      disconnect( mRubberbandModel, &RubberbandModel::vertexChanged, this, &RubberbandShape::vertexChanged );
+      disconnect( mRubberbandModel, &RubberbandModel::verticesRemoved, this, &RubberbandShape::verticesRemoved );
+      disconnect( mRubberbandModel, &RubberbandModel::verticesInserted, this, &RubberbandShape::verticesInserted );
+      disconnect( mRubberbandModel, &RubberbandModel::geometryTypeChanged, this, &RubberbandShape::markDirty );
     }
     if ( mMapSettings )
     {
@@ -140,9 +146,10 @@ void RubberbandShape::setFreeze( bool freeze )
     }
     if ( mRubberbandModel )
     {
-      connect( mRubberbandModel, &RubberbandModel::vertexChanged, this, &RubberbandShape::markDirty );
-      connect( mRubberbandModel, &RubberbandModel::verticesRemoved, this, &RubberbandShape::markDirty );
-      connect( mRubberbandModel, &RubberbandModel::verticesInserted, this, &RubberbandShape::markDirty );
+      connect( mRubberbandModel, &RubberbandModel::vertexChanged, this, &RubberbandShape::vertexChanged );
+      connect( mRubberbandModel, &RubberbandModel::verticesRemoved, this, &RubberbandShape::verticesRemoved );
+      connect( mRubberbandModel, &RubberbandModel::verticesInserted, this, &RubberbandShape::verticesInserted );
+      connect( mRubberbandModel, &RubberbandModel::geometryTypeChanged, this, &RubberbandShape::markDirty );
     }
     if ( mMapSettings && !mFreeze )
     {
@@ -219,23 +226,142 @@ void RubberbandShape::visibleExtentChanged()
 
 void RubberbandShape::markDirty()
 {
+  loadVertices();
   mDirty = true;
   updateTransform();
 }
 
-void RubberbandShape::createPolylines()
+void RubberbandShape::verticesInserted( int index, int count )
 {
-  const QgsRectangle visibleExtent = mMapSettings->visibleExtent();
-  const double scaleFactor = 1.0 / mMapSettings->mapUnitsPerPoint();
+  if ( mVertices.size() / 2 + count != mRubberbandModel->vertexCount() )
+  {
+    // the model replaced its vertices
+    markDirty();
+    return;
+  }
 
-  mPolylines.clear();
+  mVertices.insert( index * 2, count * 2, 0.0 );
+  for ( int i = index; i < index + count; i++ )
+  {
+    const QgsPoint point = mRubberbandModel->vertexAt( i );
+    mVertices[i * 2] = point.x();
+    mVertices[i * 2 + 1] = point.y();
+  }
 
-  QPolygonF polyline;
-  QVector<QgsPoint> allVertices = QVector<QgsPoint>();
-  Qgis::GeometryType geomType = mGeometryType;
+  updatePolylineFrom( index );
+}
+
+void RubberbandShape::verticesRemoved( int index, int count )
+{
+  if ( mVertices.size() / 2 - count != mRubberbandModel->vertexCount() )
+  {
+    markDirty();
+    return;
+  }
+
+  mVertices.remove( index * 2, count * 2 );
+
+  updatePolylineFrom( index );
+}
+
+void RubberbandShape::vertexChanged( int index )
+{
+  if ( mVertices.size() / 2 != mRubberbandModel->vertexCount() || index < 0 || index >= mRubberbandModel->vertexCount() )
+  {
+    markDirty();
+    return;
+  }
+
+  const QgsPoint point = mRubberbandModel->vertexAt( index );
+  mVertices[index * 2] = point.x();
+  mVertices[index * 2 + 1] = point.y();
+
+  updatePolylineFrom( index );
+}
+
+void RubberbandShape::loadVertices()
+{
+  mVertices.clear();
+
+  QVector<QgsPoint> allVertices;
   if ( mRubberbandModel && !mRubberbandModel->isEmpty() )
   {
     allVertices = mRubberbandModel->vertices();
+  }
+  else if ( mVertexModel && mVertexModel->vertexCount() > 0 )
+  {
+    allVertices = mVertexModel->flatVertices();
+  }
+
+  mVertices.reserve( allVertices.size() * 2 );
+  for ( const QgsPoint &point : std::as_const( allVertices ) )
+  {
+    mVertices << point.x() << point.y();
+  }
+}
+
+void RubberbandShape::updatePolylineFrom( int index )
+{
+  // the polylines type follows the model, e.g. when its first vertex gets added, which requires a full rebuild
+  if ( mDirty || mPolylines.isEmpty() || polylinesGeometryType() != mPolylinesType )
+  {
+    mDirty = true;
+    updateTransform();
+    return;
+  }
+
+  // the last vertex might have been merged into the previous point had it not been the last one,
+  // and a new last vertex left out while it was not, re-project them too
+  int fromIndex = std::min( index, static_cast<int>( mVertices.size() / 2 ) - 1 );
+  if ( mForcedVertexIndex > -1 )
+    fromIndex = std::min( fromIndex, mForcedVertexIndex );
+  fromIndex = std::max( fromIndex, 0 );
+
+  // the polyline vertex indexes are sorted, only the points projected from the preceding vertices are kept
+  const qsizetype keptCount = std::lower_bound( mPolylineVertexIndexes.constBegin(), mPolylineVertexIndexes.constEnd(), fromIndex ) - mPolylineVertexIndexes.constBegin();
+  mPolylines[0].resize( keptCount );
+  mPolylineVertexIndexes.resize( keptCount );
+
+  appendPolylineVertices( fromIndex );
+
+  emit polylinesChanged();
+}
+
+void RubberbandShape::appendPolylineVertices( int index )
+{
+  const double scaleFactor = 1.0 / mGeometryMUPP;
+  const int vertexCount = static_cast<int>( mVertices.size() / 2 );
+
+  QPolygonF &polyline = mPolylines[0];
+  polyline.reserve( polyline.size() + vertexCount - index );
+  mForcedVertexIndex = -1;
+  for ( int i = index; i < vertexCount; i++ )
+  {
+    const QPointF point( ( mVertices.at( i * 2 ) - mGeometryCorner.x() ) * scaleFactor, ( mVertices.at( i * 2 + 1 ) - mGeometryCorner.y() ) * -scaleFactor );
+
+    // skip the vertices too close to the previous point to be told apart at this zoom level, the last vertex is always kept
+    if ( !polyline.isEmpty() )
+    {
+      const QPointF delta = point - polyline.last();
+      if ( std::abs( delta.x() ) + std::abs( delta.y() ) < SIMPLIFICATION_TOLERANCE )
+      {
+        if ( i < vertexCount - 1 )
+          continue;
+
+        mForcedVertexIndex = i;
+      }
+    }
+
+    polyline << point;
+    mPolylineVertexIndexes << i;
+  }
+}
+
+Qgis::GeometryType RubberbandShape::polylinesGeometryType() const
+{
+  Qgis::GeometryType geomType = mGeometryType;
+  if ( mRubberbandModel && !mRubberbandModel->isEmpty() )
+  {
     if ( geomType == Qgis::GeometryType::Null )
     {
       geomType = mRubberbandModel->geometryType();
@@ -243,17 +369,24 @@ void RubberbandShape::createPolylines()
   }
   else if ( mVertexModel && mVertexModel->vertexCount() > 0 )
   {
-    allVertices = mVertexModel->flatVertices();
     if ( geomType == Qgis::GeometryType::Null )
     {
       geomType = mVertexModel->geometryType();
     }
   }
-  for ( const QgsPoint &point : std::as_const( allVertices ) )
-  {
-    polyline << QPointF( ( point.x() - visibleExtent.xMinimum() ) * scaleFactor, ( point.y() - visibleExtent.yMaximum() ) * -scaleFactor );
-  }
-  mPolylines << polyline;
+
+  return geomType;
+}
+
+void RubberbandShape::createPolylines()
+{
+  mPolylines.clear();
+  mPolylineVertexIndexes.clear();
+
+  const Qgis::GeometryType geomType = polylinesGeometryType();
+
+  mPolylines << QPolygonF();
+  appendPolylineVertices( 0 );
 
   if ( geomType != mPolylinesType )
   {
@@ -121,6 +121,9 @@ class RubberbandShape : public QQuickItem
 
   private slots:
     void markDirty();
+    void verticesInserted( int index, int count );
+    void verticesRemoved( int index, int count );
+    void vertexChanged( int index );
     void visibleExtentChanged();
     void rotationChanged();
 
@@ -128,6 +131,21 @@ class RubberbandShape : public QQuickItem
     void updateTransform();
     void createPolylines();
 
+    //! Returns the geometry type the polylines are drawn as, derived from the linked model unless set explicitly
+    Qgis::GeometryType polylinesGeometryType() const;
+
+    //! Reads the vertices of the linked model into the compact vertex store
+    void loadVertices();
+
+    //! Re-projects the polyline from the vertex at \a index onwards, the points of the preceding vertices are left untouched
+    void updatePolylineFrom( int index );
+
+    //! Projects the vertices from \a index onwards and appends them to the polyline, skipping those closer than the simplification tolerance
+    void appendPolylineVertices( int index );
+
+    //! The distance in screen points under which consecutive vertices are merged in the polyline
+    static constexpr double SIMPLIFICATION_TOLERANCE = 0.5;
+
     RubberbandModel *mRubberbandModel = nullptr;
     VertexModel *mVertexModel = nullptr;
     QgsQuickMapSettings *mMapSettings = nullptr;
@@ -140,6 +158,12 @@ class RubberbandShape : public QQuickItem
     QgsPoint mGeometryCorner;
     double mGeometryMUPP = 0.0;
     QList<QPolygonF> mPolylines;
+    //! The index of the vertex each point of the polyline was projected from
+    QVector<int> mPolylineVertexIndexes;
+    //! The index of the last vertex when it is only part of the polyline for being the last one, -1 otherwise
+    int mForcedVertexIndex = -1;
+    //! The vertices of the linked model, as interleaved x and y map coordinates
+    QVector<double> mVertices;
     Qgis::GeometryType mPolylinesType = Qgis::GeometryType::Null;
 };
 
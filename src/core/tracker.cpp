@@ -358,16 +358,31 @@ void Tracker::processPositionInformation( const GnssPositionInformation &positio
 
 void Tracker::replayPositionInformationList( const QList<GnssPositionInformation> &positionInformationList, QgsQuickCoordinateTransformer *coordinateTransformer )
 {
-  const qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+  startReplay();
+  replayPositionInformation( positionInformationList, coordinateTransformer );
+  finishReplay();
+}
+
+void Tracker::startReplay()
+{
+  if ( mIsReplaying )
+    return;
+
+  mReplayStartTime = QDateTime::currentMSecsSinceEpoch();
 
   mIsReplaying = true;
   emit isReplayingChanged();
 
-  const Qgis::GeometryType geometryType = mRubberbandModel->geometryType();
-  const bool isPointGeometry = geometryType == Qgis::GeometryType::Point;
-  mFeatureModel->setBatchMode( isPointGeometry );
-
+  mFeatureModel->setBatchMode( mRubberbandModel->geometryType() == Qgis::GeometryType::Point );
   connect( mRubberbandModel, &RubberbandModel::currentCoordinateChanged, this, &Tracker::positionReceived );
+}
+
+void Tracker::replayPositionInformation( const QList<GnssPositionInformation> &positionInformationList, QgsQuickCoordinateTransformer *coordinateTransformer )
+{
+  if ( !mIsReplaying )
+    return;
+
+  const bool isPointGeometry = mRubberbandModel->geometryType() == Qgis::GeometryType::Point;
   for ( const GnssPositionInformation &positionInformation : positionInformationList )
   {
     if ( mFilterAccuracy && positionInformation.accuracyQuality() == GnssPositionInformation::AccuracyBad )
@@ -380,9 +395,17 @@ void Tracker::replayPositionInformationList( const QList<GnssPositionInformation
     processPositionInformation( positionInformation,
                                 coordinateTransformer ? coordinateTransformer->transformPosition( QgsPoint( positionInformation.longitude(), positionInformation.latitude(), positionInformation.elevation() ) ) : QgsPoint() );
   }
+}
+
+void Tracker::finishReplay()
+{
+  if ( !mIsReplaying )
+    return;
+
   disconnect( mRubberbandModel, &RubberbandModel::currentCoordinateChanged, this, &Tracker::positionReceived );
 
   mFeatureModel->setBatchMode( false );
+  const Qgis::GeometryType geometryType = mRubberbandModel->geometryType();
   const int vertexCount = mRubberbandModel->vertexCount();
   if ( ( geometryType == Qgis::GeometryType::Line && vertexCount > 2 ) || ( geometryType == Qgis::GeometryType::Polygon && vertexCount > 3 ) )
   {
@@ -410,7 +433,7 @@ void Tracker::replayPositionInformationList( const QList<GnssPositionInformation
   }
 
   const qint64 endTime = QDateTime::currentMSecsSinceEpoch();
-  qInfo() << QStringLiteral( "Tracker position information replay duration: %1ms" ).arg( endTime - startTime );
+  qInfo() << QStringLiteral( "Tracker position information replay duration: %1ms" ).arg( endTime - mReplayStartTime );
 }
 
 void Tracker::suspendUntilReplay()
@@ -155,6 +155,18 @@ class Tracker : public QObject
     //! Replays a list of position information taking into account the tracker settings
     void replayPositionInformationList( const QList<GnssPositionInformation> &positionInformationList, QgsQuickCoordinateTransformer *coordinateTransformer = nullptr );
 
+    /**
+     * Starts an incremental replay, the position information is then passed in chunks to replayPositionInformation()
+     * and the tracked feature is only saved once by finishReplay().
+     */
+    void startReplay();
+
+    //! Replays a chunk of position information taking into account the tracker settings, in between startReplay() and finishReplay()
+    void replayPositionInformation( const QList<GnssPositionInformation> &positionInformationList, QgsQuickCoordinateTransformer *coordinateTransformer = nullptr );
+
+    //! Finishes an incremental replay, saving the tracked feature and resuming the tracker if it was suspended
+    void finishReplay();
+
     void suspendUntilReplay();
 
     //! Returns TRUE if GNSS accuracy filtering is enabled
@@ -197,6 +209,7 @@ class Tracker : public QObject
     bool mIsActive = false;
     bool mIsSuspended = false;
     bool mIsReplaying = false;
+    qint64 mReplayStartTime = 0;
 
     RubberbandModel *mRubberbandModel = nullptr;
     FeatureModel *mFeatureModel = nullptr;
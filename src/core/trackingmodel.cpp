@@ -16,9 +16,12 @@
 
 #include "trackingmodel.h"
 
+#include <QTimer>
 #include <qgsproject.h>
 #include <qgsvectorlayerutils.h>
 
+#define REPLAY_CHUNK_SIZE 1000
+
 TrackingModel::TrackingModel( QObject *parent )
   : QAbstractItemModel( parent )
 {
@@ -176,6 +179,62 @@ void TrackingModel::replayPositionInformationList( const QList<GnssPositionInfor
   }
 }
 
+void TrackingModel::replayBackgroundPositionInformation( Positioning *positioning )
+{
+  if ( isReplaying() )
+    return;
+
+  for ( Tracker *tracker : std::as_const( mTrackers ) )
+  {
+    if ( tracker->isSuspended() )
+    {
+      tracker->startReplay();
+      mReplayTrackers << tracker;
+    }
+  }
+
+  mReplayPositioning = positioning;
+  mReplayOffset = 0;
+  // Positions collected after the replay started are not replayed, the trackers resume once done
+  mReplayCount = positioning && !mReplayTrackers.isEmpty() ? positioning->backgroundPositionInformationCount() : 0;
+
+  QTimer::singleShot( 0, this, &TrackingModel::replayNextChunk );
+}
+
+void TrackingModel::replayNextChunk()
+{
+  if ( mReplayPositioning && mReplayOffset < mReplayCount )
+  {
+    const QList<GnssPositionInformation> positionInformationList = mReplayPositioning->getBackgroundPositionInformation( mReplayOffset, std::min( REPLAY_CHUNK_SIZE, mReplayCount - mReplayOffset ) );
+    if ( !positionInformationList.isEmpty() )
+    {
+      for ( const QPointer<Tracker> &tracker : std::as_const( mReplayTrackers ) )
+      {
+        if ( tracker )
+        {
+          tracker->replayPositionInformation( positionInformationList, mReplayPositioning->coordinateTransformer() );
+        }
+      }
+
+      mReplayOffset += positionInformationList.size();
+      QTimer::singleShot( 0, this, &TrackingModel::replayNextChunk );
+      return;
+    }
+  }
+
+  for ( const QPointer<Tracker> &tracker : std::as_const( mReplayTrackers ) )
+  {
+    if ( tracker )
+    {
+      tracker->finishReplay();
+    }
+  }
+
+  mReplayTrackers.clear();
+  mReplayPositioning.clear();
+  emit replayFinished();
+}
+
 void TrackingModel::suspendUntilReplay()
 {
   for ( int i = 0; i < mTrackers.size(); i++ )
@@ -16,6 +16,7 @@
 #ifndef TRACKINGMODEL_H
 #define TRACKINGMODEL_H
 
+#include "positioning.h"
 #include "tracker.h"
 
 #include <QAbstractItemModel>
@@ -71,6 +72,17 @@ class TrackingModel : public QAbstractItemModel
     //! Replays a list of position information for all active trackers
     Q_INVOKABLE void replayPositionInformationList( const QList<GnssPositionInformation> &positionInformationList, QgsQuickCoordinateTransformer *coordinateTransformer = nullptr );
 
+    /**
+     * Replays the position information collected by \a positioning while in background mode for all suspended trackers.
+     * The position information is read and replayed in chunks across event loop iterations, keeping memory usage bounded
+     * and the user interface responsive regardless of the amount of collected positions.
+     * \see replayFinished()
+     */
+    Q_INVOKABLE void replayBackgroundPositionInformation( Positioning *positioning );
+
+    //! Returns TRUE while background position information is being replayed
+    bool isReplaying() const { return !mReplayTrackers.isEmpty(); }
+
     Q_INVOKABLE void suspendUntilReplay();
 
     void reset();
@@ -90,6 +102,12 @@ class TrackingModel : public QAbstractItemModel
     void layerInTrackingChanged( QgsVectorLayer *layer, bool tracking );
     void trackingSetupRequested( QModelIndex trackerIndex, bool skipSettings );
 
+    //! Emitted when the replay of the background position information is finished
+    void replayFinished();
+
+  private slots:
+    void replayNextChunk();
+
   private:
     struct TrackerRequest
     {
@@ -109,6 +127,11 @@ class TrackingModel : public QAbstractItemModel
     QList<Tracker *> mTrackers;
     QList<TrackerRequest> mRequestedTrackers;
 
+    QPointer<Positioning> mReplayPositioning;
+    QList<QPointer<Tracker>> mReplayTrackers;
+    int mReplayOffset = 0;
+    int mReplayCount = 0;
+
     QList<Tracker *>::const_iterator trackerIterator( QgsVectorLayer *layer )
     {
       return std::find_if( mTrackers.constBegin(), mTrackers.constEnd(), [layer]( const Tracker *tracker ) { return tracker->vectorLayer() == layer; } );
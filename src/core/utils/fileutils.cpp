@@ -319,6 +319,30 @@ QString FileUtils::fileEtag( const QString &fileName, int partSize )
   return QString();
 }
 
+bool FileUtils::createHardLink( const QString &fileName, const QString &linkFileName )
+{
+  std::error_code error;
+  fs::create_hard_link( QFileInfo( fileName ).filesystemFilePath(), QFileInfo( linkFileName ).filesystemFilePath(), error );
+
+  return !error;
+}
+
+bool FileUtils::isSameFile( const QString &fileName1, const QString &fileName2 )
+{
+  std::error_code error;
+  const bool isSame = fs::equivalent( QFileInfo( fileName1 ).filesystemFilePath(), QFileInfo( fileName2 ).filesystemFilePath(), error );
+
+  return !error && isSame;
+}
+
+qint64 FileUtils::hardLinkCount( const QString &fileName )
+{
+  std::error_code error;
+  const std::uintmax_t count = fs::hard_link_count( QFileInfo( fileName ).filesystemFilePath(), error );
+
+  return error ? 0 : static_cast<qint64>( count );
+}
+
 void FileUtils::restrictImageSize( const QString &imagePath, int maximumWidthHeight )
 {
   if ( !QFileInfo::exists( imagePath ) )
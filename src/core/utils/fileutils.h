@@ -144,6 +144,22 @@ class QFIELD_CORE_EXPORT FileUtils : public QObject
      */
     Q_INVOKABLE static QString fileEtag( const QString &fileName, int partSize = 8 * 1024 * 1024 );
 
+    /**
+     * Creates a hard link \a linkFileName pointing to the content of \a fileName.
+     * \returns FALSE if the link cannot be created, e.g. the file system does not support hard links or the files are on different volumes.
+     */
+    static bool createHardLink( const QString &fileName, const QString &linkFileName );
+
+    /**
+     * Returns TRUE if \a fileName1 and \a fileName2 are the same file on disk, e.g. hard links to the same content.
+     */
+    static bool isSameFile( const QString &fileName1, const QString &fileName2 );
+
+    /**
+     * Returns the number of hard links to the content of \a fileName, or 0 if it cannot be determined.
+     */
+    static qint64 hardLinkCount( const QString &fileName );
+
     /**
      * Unzip a zip file in an output directory.
      * \param zip The zip filename
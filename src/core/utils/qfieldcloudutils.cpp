@@ -29,6 +29,8 @@
 
 static QString sLocalCloudDirectory;
 
+#define PENDING_ATTACHMENT_REMOVED_MARKER "removed"
+
 
 void QFieldCloudUtils::setLocalCloudDirectory( const QString &path )
 {
@@ -214,6 +216,7 @@ const QMultiMap<QString, QString> QFieldCloudUtils::getPendingAttachments( const
 
     attachmentsFile.open( QFile::ReadWrite | QFile::Text );
     QTextStream attachmentsStream( &attachmentsFile );
+    int removedCount = 0;
     while ( !attachmentsStream.atEnd() )
     {
       const QString line = attachmentsStream.readLine().trimmed();
@@ -221,11 +224,31 @@ const QMultiMap<QString, QString> QFieldCloudUtils::getPendingAttachments( const
 
       // The expected CSV format must have two columns:
       // project_id,file_path
-      if ( values.size() >= 2 )
+      // The file is a journal, removed attachments are appended with a third `removed` column
+      if ( values.size() >= 3 && values.at( 2 ) == QLatin1String( PENDING_ATTACHMENT_REMOVED_MARKER ) )
+      {
+        files.remove( values.at( 0 ), values.at( 1 ) );
+        removedCount++;
+      }
+      else if ( values.size() >= 2 )
       {
         files.insert( values.at( 0 ), values.at( 1 ) );
       }
     }
+
+    // Compact the journal once it holds more removals than pending attachments
+    if ( removedCount > 0 && removedCount >= files.size() )
+    {
+      QString output;
+      for ( auto it = files.constBegin(); it != files.constEnd(); ++it )
+      {
+        output += StringUtils::stringListToCsv( QStringList() << it.key() << it.value() ) + QChar( '\n' );
+      }
+      attachmentsFile.resize( 0 );
+      attachmentsStream.reset();
+      attachmentsStream << output;
+    }
+    attachmentsFile.close();
   }
 
   return files;
@@ -356,22 +379,11 @@ void QFieldCloudUtils::removePendingAttachment( const QString &username, const Q
   QLockFile attachmentsLock( QStringLiteral( "%1/attachments.lock" ).arg( localCloudUSerDirectory ) );
   if ( attachmentsLock.tryLock( 10000 ) )
   {
-    const QString lineToRemove = StringUtils::stringListToCsv( QStringList() << projectId << fileName );
-    QString output;
+    // Journal the removal rather than rewriting the whole file, getPendingAttachments() compacts it
     QFile attachmentsFile( QStringLiteral( "%1/attachments.csv" ).arg( localCloudUSerDirectory ) );
-    attachmentsFile.open( QFile::ReadWrite | QFile::Text );
+    attachmentsFile.open( QFile::Append | QFile::Text );
     QTextStream attachmentsStream( &attachmentsFile );
-    while ( !attachmentsStream.atEnd() )
-    {
-      const QString line = attachmentsStream.readLine();
-      if ( !line.isEmpty() && !line.startsWith( lineToRemove ) )
-      {
-        output += line + QChar( '\n' );
-      }
-    }
-    attachmentsFile.resize( 0 );
-    attachmentsStream.reset();
-    attachmentsStream << output;
+    attachmentsStream << StringUtils::stringListToCsv( QStringList() << projectId << fileName << QStringLiteral( PENDING_ATTACHMENT_REMOVED_MARKER ) ) << Qt::endl;
     attachmentsFile.close();
   }
 }
@@ -144,7 +144,10 @@ class QFieldCloudUtils : public QObject
     //! Returns TRUE if pending attachments are detected.
     Q_INVOKABLE static bool hasPendingAttachments( const QString &username );
 
-    //! Returns the list of attachments that have not yet been uploaded to the cloud.
+    /**
+     * Returns the list of attachments that have not yet been uploaded to the cloud.
+     * The pending attachments file is compacted when it holds more removed attachments than pending ones.
+     */
     static const QMultiMap<QString, QString> getPendingAttachments( const QString &username );
 
     /**
@@ -158,7 +161,7 @@ class QFieldCloudUtils : public QObject
      */
     Q_INVOKABLE static void addPendingAttachments( const QString &username, const QString &projectId, const QStringList &fileNames, QFieldCloudConnection *cloudConnection = nullptr, const bool &checkSumCheck = false );
 
-    //! Removes a \a fileName for a given \a projectId to the pending attachments list
+    //! Removes a \a fileName for a given \a projectId from the pending attachments list, by appending the removal to the list file
     static void removePendingAttachment( const QString &username, const QString &projectId, const QString &fileName );
 
   private:
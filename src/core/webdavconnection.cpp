@@ -20,11 +20,15 @@
 #include "webdavconnection.h"
 
 #include <QDirIterator>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSettings>
 #include <QtWebDAV/qwebdavitem.h>
 #include <qgsapplication.h>
 #include <qgsauthmanager.h>
 
+#define WEBDAV_TRANSFER_READ_BUFFER_SIZE 1024 * 1024
+
 WebdavConnection::WebdavConnection( QObject *parent )
   : QObject( parent )
 {
@@ -94,6 +98,16 @@ void WebdavConnection::setStorePassword( bool storePassword )
   emit storePasswordChanged();
 }
 
+void WebdavConnection::setMaximumParallelTransfers( int maximumParallelTransfers )
+{
+  maximumParallelTransfers = std::max( 1, maximumParallelTransfers );
+  if ( mMaximumParallelTransfers == maximumParallelTransfers )
+    return;
+
+  mMaximumParallelTransfers = maximumParallelTransfers;
+  emit maximumParallelTransfersChanged();
+}
+
 void WebdavConnection::checkStoredPassword()
 {
   mStoredPassword.clear();
@@ -238,6 +252,13 @@ void WebdavConnection::processDirParserFinished()
     {
       applyStoredPassword();
 
+      QSet<QString> remotePaths;
+      for ( const QWebdavItem &item : list )
+      {
+        remotePaths << item.path();
+      }
+      mManifest.prune( mProcessRemotePath, remotePaths, mProcessLocalPath );
+
       QDir localDir( mProcessLocalPath );
       for ( const QWebdavItem &item : list )
       {
@@ -249,8 +270,8 @@ void WebdavConnection::processDirParserFinished()
         {
           if ( mIsDownloadingPath )
           {
-            QFileInfo fileInfo( mProcessLocalPath + item.path().mid( mProcessRemotePath.size() ) );
-            if ( !fileInfo.exists() || ( fileInfo.fileTime( QFileDevice::FileModificationTime ) != item.lastModified() ) )
+            const QFileInfo fileInfo( mProcessLocalPath + item.path().mid( mProcessRemotePath.size() ) );
+            if ( !mManifest.isIdentical( item.path(), item.size(), item.lastModified(), fileInfo ) )
             {
               mWebdavItems << item;
               mBytesTotal += item.size();
@@ -285,10 +306,13 @@ void WebdavConnection::processDirParserFinished()
             file.setFileTime( item.lastModified(), QFileDevice::FileModificationTime );
             file.setFileTime( item.lastModified(), QFileDevice::FileAccessTime );
             file.close();
+
+            mManifest.insert( item.path(), item.size(), item.lastModified() );
           }
         }
       }
       mWebdavLastModified.clear();
+      mManifest.write();
 
       mIsUploadingPath = false;
       emit isUploadingPathChanged();
@@ -298,7 +322,21 @@ void WebdavConnection::processDirParserFinished()
       // Filter files to  upload
       applyStoredPassword();
 
-      QStringList remoteDirs;
+      QHash<QString, qsizetype> localItemIndexes;
+      for ( qsizetype i = 0; i < mLocalItems.size(); i++ )
+      {
+        localItemIndexes.insert( mLocalItems.at( i ).absoluteFilePath(), i );
+      }
+
+      QSet<QString> remotePaths;
+      for ( const QWebdavItem &item : list )
+      {
+        remotePaths << item.path();
+      }
+      mManifest.prune( mProcessRemotePath, remotePaths, mProcessLocalPath );
+
+      QSet<QString> remoteDirs;
+      QSet<qsizetype> identicalItemIndexes;
       for ( const QWebdavItem &item : list )
       {
         if ( item.isDir() )
@@ -307,45 +345,52 @@ void WebdavConnection::processDirParserFinished()
         }
         else
         {
-          QFileInfo fileInfo( mProcessLocalPath + item.path().mid( mProcessRemotePath.size() ) );
-          if ( fileInfo.exists() )
+          const QFileInfo fileInfo( mProcessLocalPath + item.path().mid( mProcessRemotePath.size() ) );
+          auto it = localItemIndexes.constFind( fileInfo.absoluteFilePath() );
+          if ( it != localItemIndexes.constEnd() && mManifest.isIdentical( item.path(), item.size(), item.lastModified(), mLocalItems.at( it.value() ) ) )
           {
-            auto localFileInfo = std::find_if( mLocalItems.begin(), mLocalItems.end(), [&fileInfo]( const QFileInfo &entry ) {
-              return entry.absoluteFilePath() == fileInfo.absoluteFilePath();
-            } );
+            identicalItemIndexes << it.value();
+          }
+        }
+      }
 
-            if ( localFileInfo != mLocalItems.end() )
-            {
-              if ( localFileInfo->fileTime( QFileDevice::FileModificationTime ) == item.lastModified() )
-              {
-                mLocalItems.remove( localFileInfo - mLocalItems.begin(), 1 );
-              }
-            }
+      if ( !identicalItemIndexes.isEmpty() )
+      {
+        QList<QFileInfo> localItems;
+        for ( qsizetype i = 0; i < mLocalItems.size(); i++ )
+        {
+          if ( !identicalItemIndexes.contains( i ) )
+          {
+            localItems << mLocalItems.at( i );
           }
         }
+        mLocalItems = localItems;
       }
 
       mWebdavMkDirs.clear();
+      QSet<QString> webdavMkDirs;
 
       if ( !remoteDirs.contains( mProcessRemotePath ) )
       {
         mWebdavMkDirs << mProcessRemotePath;
+        webdavMkDirs << mProcessRemotePath;
       }
 
       for ( const QFileInfo &fileInfo : mLocalItems )
       {
         // Insure the path exists remotely
         QString remoteDir = mProcessRemotePath + fileInfo.absolutePath().mid( mProcessLocalPath.size() ).replace( QDir::separator(), "/" );
-        if ( !remoteDirs.contains( remoteDir ) && !mWebdavMkDirs.contains( remoteDir ) )
+        if ( !remoteDirs.contains( remoteDir ) && !webdavMkDirs.contains( remoteDir ) )
         {
           const QStringList remoteDirParts = remoteDir.mid( mProcessRemotePath.size() ).split( "/", Qt::SkipEmptyParts );
           remoteDir = mProcessRemotePath;
           for ( const QString &part : remoteDirParts )
           {
             remoteDir += part + "/";
-            if ( !remoteDirs.contains( remoteDir ) && !mWebdavMkDirs.contains( remoteDir ) )
+            if ( !remoteDirs.contains( remoteDir ) && !webdavMkDirs.contains( remoteDir ) )
             {
               mWebdavMkDirs << remoteDir;
+              webdavMkDirs << remoteDir;
             }
           }
         }
@@ -361,57 +406,12 @@ void WebdavConnection::processDirParserFinished()
 
 void WebdavConnection::getWebdavItems()
 {
-  if ( !mWebdavItems.isEmpty() )
+  while ( !mWebdavItems.isEmpty() && mTransfersBytesProcessed.size() < mMaximumParallelTransfers )
   {
-    const QString itemPath = mWebdavItems.first().path();
-    const QDateTime itemLastModified = mWebdavItems.first().lastModified();
-    QNetworkReply *reply = mWebdavConnection.get( itemPath );
-    QTemporaryFile *temporaryFile = new QTemporaryFile( reply );
-    temporaryFile->setFileTemplate( QStringLiteral( "%1%2.XXXXXXXXXXXX" ).arg( mProcessLocalPath, itemPath.mid( mProcessRemotePath.size() ) ) );
-    temporaryFile->open();
-
-    connect( reply, &QNetworkReply::downloadProgress, this, [this, reply, temporaryFile]( qint64 bytesReceived, qint64 bytesTotal ) {
-      mCurrentBytesProcessed = bytesReceived;
-      emit progressChanged();
-
-      temporaryFile->write( reply->readAll() );
-    } );
-
-    connect( reply, &QNetworkReply::finished, this, [this, reply, temporaryFile, itemPath, itemLastModified]() {
-      mBytesProcessed += mCurrentBytesProcessed;
-      mCurrentBytesProcessed = 0;
-      if ( reply->error() == QNetworkReply::NoError )
-      {
-        QFile file( mProcessLocalPath + itemPath.mid( mProcessRemotePath.size() ) );
-        if ( file.exists() )
-        {
-          // Remove pre-existing file
-          file.remove();
-        }
-
-        temporaryFile->write( reply->readAll() );
-        temporaryFile->setAutoRemove( false );
-        temporaryFile->rename( mProcessLocalPath + itemPath.mid( mProcessRemotePath.size() ) );
-        temporaryFile->close();
-        delete temporaryFile;
-
-        // Attach last modified date value coming from the server (cannot be done via QTemporaryFile)
-        file.open( QFile::Append );
-        file.setFileTime( itemLastModified, QFileDevice::FileModificationTime );
-        file.setFileTime( itemLastModified, QFileDevice::FileAccessTime );
-        file.close();
-      }
-      else
-      {
-        mLastError = tr( "Failed to download file %1 due to network error (%2)" ).arg( itemPath ).arg( reply->error() );
-      }
-
-      mWebdavItems.removeFirst();
-      getWebdavItems();
-      reply->deleteLater();
-    } );
+    getWebdavItem( mWebdavItems.takeFirst() );
   }
-  else
+
+  if ( mWebdavItems.isEmpty() && mTransfersBytesProcessed.isEmpty() )
   {
     if ( mIsImportingPath )
     {
@@ -432,18 +432,81 @@ void WebdavConnection::getWebdavItems()
       settings.setValue( QStringLiteral( "lastImportTime" ), QDateTime::currentDateTime() );
       settings.endGroup();
 
+      mManifest.write();
+
       mIsImportingPath = false;
       emit isImportingPathChanged();
       emit importSuccessful( mProcessLocalPath );
     }
     else if ( mIsDownloadingPath )
     {
+      mManifest.write();
+
       mIsDownloadingPath = false;
       emit isDownloadingPathChanged();
     }
   }
 }
 
+void WebdavConnection::getWebdavItem( const QWebdavItem &item )
+{
+  const QString itemPath = item.path();
+  QNetworkReply *reply = mWebdavConnection.get( itemPath );
+  // Limit the memory held by the reply, its content is streamed to the temporary file as it arrives
+  reply->setReadBufferSize( WEBDAV_TRANSFER_READ_BUFFER_SIZE );
+  mTransfersBytesProcessed.insert( reply, 0 );
+
+  QTemporaryFile *temporaryFile = new QTemporaryFile( reply );
+  temporaryFile->setFileTemplate( QStringLiteral( "%1%2.XXXXXXXXXXXX" ).arg( mProcessLocalPath, itemPath.mid( mProcessRemotePath.size() ) ) );
+  temporaryFile->open();
+
+  connect( reply, &QNetworkReply::readyRead, this, [reply, temporaryFile]() {
+    temporaryFile->write( reply->readAll() );
+  } );
+
+  connect( reply, &QNetworkReply::downloadProgress, this, [this, reply]( qint64 bytesReceived, qint64 ) {
+    mTransfersBytesProcessed[reply] = bytesReceived;
+    emit progressChanged();
+  } );
+
+  connect( reply, &QNetworkReply::finished, this, [this, reply, temporaryFile, item]() {
+    mBytesProcessed += mTransfersBytesProcessed.take( reply );
+    emit progressChanged();
+
+    const QString itemPath = item.path();
+    if ( reply->error() == QNetworkReply::NoError )
+    {
+      QFile file( mProcessLocalPath + itemPath.mid( mProcessRemotePath.size() ) );
+      if ( file.exists() )
+      {
+        // Remove pre-existing file
+        file.remove();
+      }
+
+      temporaryFile->write( reply->readAll() );
+      temporaryFile->setAutoRemove( false );
+      temporaryFile->rename( mProcessLocalPath + itemPath.mid( mProcessRemotePath.size() ) );
+      temporaryFile->close();
+      delete temporaryFile;
+
+      // Attach last modified date value coming from the server (cannot be done via QTemporaryFile)
+      file.open( QFile::Append );
+      file.setFileTime( item.lastModified(), QFileDevice::FileModificationTime );
+      file.setFileTime( item.lastModified(), QFileDevice::FileAccessTime );
+      file.close();
+
+      mManifest.insert( item.path(), item.size(), item.lastModified() );
+    }
+    else
+    {
+      mLastError = tr( "Failed to download file %1 due to network error (%2)" ).arg( itemPath ).arg( reply->error() );
+    }
+
+    reply->deleteLater();
+    getWebdavItems();
+  } );
+}
+
 void WebdavConnection::forgetHistory( const QString &url, const QString &username )
 {
   QgsAuthManager *authManager = QgsApplication::authManager();
@@ -583,9 +646,6 @@ void WebdavConnection::putLocalItems()
     QNetworkReply *reply = mWebdavConnection.mkdir( dirPath );
 
     connect( reply, &QNetworkReply::finished, this, [this, reply, dirPath]() {
-      mBytesProcessed += mCurrentBytesProcessed;
-      mCurrentBytesProcessed = 0;
-      emit progressChanged();
       if ( reply->error() != QNetworkReply::NoError )
       {
         mLastError = tr( "Failed to upload file %1 due to network error (%2)" ).arg( dirPath ).arg( reply->error() );
@@ -593,38 +653,15 @@ void WebdavConnection::putLocalItems()
 
       mWebdavMkDirs.removeFirst();
       putLocalItems();
+      reply->deleteLater();
     } );
   }
-  else if ( !mLocalItems.isEmpty() )
+  else if ( !mLocalItems.isEmpty() || !mTransfersBytesProcessed.isEmpty() )
   {
-    const QString itemPath = mLocalItems.first().absoluteFilePath();
-    const QString remoteItemPath = mProcessRemotePath + itemPath.mid( mProcessLocalPath.size() ).replace( QDir::separator(), "/" );
-
-    QFile *file = new QFile( itemPath );
-    file->open( QFile::ReadOnly );
-    QNetworkReply *reply = mWebdavConnection.put( remoteItemPath, file );
-    file->setParent( reply );
-
-    connect( reply, &QNetworkReply::uploadProgress, this, [this, reply]( qint64 bytesSent, qint64 bytesTotal ) {
-      mCurrentBytesProcessed = bytesSent;
-      emit progressChanged();
-    } );
-
-    connect( reply, &QNetworkReply::finished, this, [this, reply, remoteItemPath]() {
-      mBytesProcessed += mCurrentBytesProcessed;
-      mCurrentBytesProcessed = 0;
-      emit progressChanged();
-      if ( reply->error() != QNetworkReply::NoError )
-      {
-        mLastError = tr( "Failed to upload file %1 due to network error (%2)" ).arg( remoteItemPath ).arg( reply->error() );
-      }
-
-      mWebdavLastModified << remoteItemPath;
-
-      mLocalItems.removeFirst();
-      putLocalItems();
-      reply->deleteLater();
-    } );
+    while ( !mLocalItems.isEmpty() && mTransfersBytesProcessed.size() < mMaximumParallelTransfers )
+    {
+      putLocalItem( mLocalItems.takeFirst() );
+    }
   }
   else
   {
@@ -643,6 +680,39 @@ void WebdavConnection::putLocalItems()
   }
 }
 
+void WebdavConnection::putLocalItem( const QFileInfo &fileInfo )
+{
+  const QString itemPath = fileInfo.absoluteFilePath();
+  const QString remoteItemPath = mProcessRemotePath + itemPath.mid( mProcessLocalPath.size() ).replace( QDir::separator(), "/" );
+
+  QFile *file = new QFile( itemPath );
+  file->open( QFile::ReadOnly );
+  QNetworkReply *reply = mWebdavConnection.put( remoteItemPath, file );
+  file->setParent( reply );
+  mTransfersBytesProcessed.insert( reply, 0 );
+
+  connect( reply, &QNetworkReply::uploadProgress, this, [this, reply]( qint64 bytesSent, qint64 ) {
+    mTransfersBytesProcessed[reply] = bytesSent;
+    emit progressChanged();
+  } );
+
+  connect( reply, &QNetworkReply::finished, this, [this, reply, remoteItemPath]() {
+    mBytesProcessed += mTransfersBytesProcessed.take( reply );
+    emit progressChanged();
+    if ( reply->error() != QNetworkReply::NoError )
+    {
+      mLastError = tr( "Failed to upload file %1 due to network error (%2)" ).arg( remoteItemPath ).arg( reply->error() );
+    }
+    else
+    {
+      mWebdavLastModified << remoteItemPath;
+    }
+
+    reply->deleteLater();
+    putLocalItems();
+  } );
+}
+
 void WebdavConnection::importPath( const QString &remotePath, const QString &localPath, QString localFolder )
 {
   if ( mUrl.isEmpty() || mUsername.isEmpty() || ( mPassword.isEmpty() && mStoredPassword.isEmpty() ) )
@@ -667,6 +737,7 @@ void WebdavConnection::importPath( const QString &remotePath, const QString &loc
 
   mProcessRemotePath = remotePath;
   mProcessLocalPath = QDir::cleanPath( localPath + QDir::separator() + localFolder ) + QDir::separator();
+  mManifest.read( mProcessLocalPath );
 
   mWebdavItems.clear();
   mBytesProcessed = 0;
@@ -711,6 +782,7 @@ void WebdavConnection::downloadPath( const QString &localPath )
         mProcessRemotePath = mProcessRemotePath + remoteChildrenPath.join( "/" ) + QStringLiteral( "/" );
       }
       mProcessLocalPath = QDir::cleanPath( localPath ) + QDir::separator();
+      mManifest.read( dir.absolutePath() );
 
       mWebdavItems.clear();
       mBytesProcessed = 0;
@@ -756,6 +828,7 @@ void WebdavConnection::uploadPaths( const QStringList &localPaths )
         QFile webdavConfigurationFile( webdavConfigurationPath );
         webdavConfigurationFile.open( QFile::ReadOnly );
         webdavJson = QJsonDocument::fromJson( webdavConfigurationFile.readAll() );
+        mManifest.read( dir.absolutePath() );
 
         if ( !webdavJson.isEmpty() )
         {
@@ -791,7 +864,7 @@ void WebdavConnection::uploadPaths( const QStringList &localPaths )
         while ( it.hasNext() )
         {
           it.next();
-          if ( it.fileName() != QStringLiteral( "qfield_webdav_configuration.json" ) )
+          if ( it.fileName() != QStringLiteral( "qfield_webdav_configuration.json" ) && it.fileName() != WebdavManifest::fileName() )
           {
             mLocalItems << it.fileInfo();
           }
@@ -877,7 +950,12 @@ double WebdavConnection::progress() const
 {
   if ( ( mIsImportingPath || mIsDownloadingPath || mIsUploadingPath ) && mBytesTotal > 0 )
   {
-    return static_cast<double>( mBytesProcessed + mCurrentBytesProcessed ) / mBytesTotal;
+    qint64 bytesProcessed = mBytesProcessed;
+    for ( const qint64 transferBytesProcessed : mTransfersBytesProcessed )
+    {
+      bytesProcessed += transferBytesProcessed;
+    }
+    return static_cast<double>( bytesProcessed ) / mBytesTotal;
   }
 
   return 0;
@@ -18,7 +18,12 @@
 #ifndef WEBDAVCONNECTION_H
 #define WEBDAVCONNECTION_H
 
+#include "webdavmanifest.h"
+
+#include <QFileInfo>
+#include <QHash>
 #include <QObject>
+#include <QSet>
 #include <QtWebDAV/qwebdav.h>
 #include <QtWebDAV/qwebdavdirparser.h>
 
@@ -43,6 +48,8 @@ class WebdavConnection : public QObject
     Q_PROPERTY( bool isDownloadingPath READ isDownloadingPath NOTIFY isDownloadingPathChanged )
     Q_PROPERTY( bool isUploadingPath READ isUploadingPath NOTIFY isUploadingPathChanged )
 
+    Q_PROPERTY( int maximumParallelTransfers READ maximumParallelTransfers WRITE setMaximumParallelTransfers NOTIFY maximumParallelTransfersChanged )
+
     Q_PROPERTY( QStringList availablePaths READ availablePaths NOTIFY availablePathsChanged )
     Q_PROPERTY( double progress READ progress NOTIFY progressChanged )
     Q_PROPERTY( QString lastError READ lastError NOTIFY lastErrorChanged )
@@ -118,6 +125,16 @@ class WebdavConnection : public QObject
      */
     bool isUploadingPath() const { return mIsUploadingPath; }
 
+    /**
+     * Returns the maximum number of files transferred in parallel during a download or upload operation.
+     */
+    int maximumParallelTransfers() const { return mMaximumParallelTransfers; }
+
+    /**
+     * Sets the maximum number of files transferred in parallel during a download or upload operation.
+     */
+    void setMaximumParallelTransfers( int maximumParallelTransfers );
+
     /**
      * Returns the progress of an ongoing import, download, or upload operation.
      * \note The returned value's range is 0.0 to 1.0.
@@ -203,6 +220,7 @@ class WebdavConnection : public QObject
     void isImportingPathChanged();
     void isDownloadingPathChanged();
     void isUploadingPathChanged();
+    void maximumParallelTransfersChanged();
     void availablePathsChanged();
     void progressChanged();
     void lastErrorChanged();
@@ -221,7 +239,9 @@ class WebdavConnection : public QObject
     void applyStoredPassword();
     void setupConnection();
     void getWebdavItems();
+    void getWebdavItem( const QWebdavItem &item );
     void putLocalItems();
+    void putLocalItem( const QFileInfo &fileInfo );
 
     ///! Computes the common path between two given paths.
     QString getCommonPath( const QString &addressA, const QString &addressB );
@@ -243,11 +263,15 @@ class WebdavConnection : public QObject
     QList<QWebdavItem> mWebdavItems;
     QList<QString> mWebdavMkDirs;
     QList<QFileInfo> mLocalItems;
-    QList<QString> mWebdavLastModified;
+    QSet<QString> mWebdavLastModified;
+
+    int mMaximumParallelTransfers = 4;
+    QHash<QNetworkReply *, qint64> mTransfersBytesProcessed;
+
+    WebdavManifest mManifest;
 
     QString mProcessRemotePath;
     QString mProcessLocalPath;
-    qint64 mCurrentBytesProcessed = 0;
     qint64 mBytesProcessed = 0;
     qint64 mBytesTotal = 0;
 
@@ -0,0 +1,122 @@
+/***************************************************************************
+    webdavmanifest.cpp
+    ---------------------
+    begin                : October 2026
+    copyright            : (C) 2026 by OPENGIS.ch
+    email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "webdavmanifest.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#define WEBDAV_MANIFEST_FILE_NAME "qfield_webdav_manifest.json"
+
+QString WebdavManifest::fileName()
+{
+  return QStringLiteral( WEBDAV_MANIFEST_FILE_NAME );
+}
+
+void WebdavManifest::read( const QString &rootPath )
+{
+  mEntries.clear();
+  mFilePath = QDir( rootPath ).absoluteFilePath( fileName() );
+
+  QFile manifestFile( mFilePath );
+  if ( !manifestFile.open( QFile::ReadOnly ) )
+  {
+    return;
+  }
+
+  const QJsonObject manifest = QJsonDocument::fromJson( manifestFile.readAll() ).object();
+  for ( auto it = manifest.constBegin(); it != manifest.constEnd(); ++it )
+  {
+    const QJsonObject details = it.value().toObject();
+
+    Entry entry;
+    entry.size = details.value( QStringLiteral( "size" ) ).toInteger();
+    entry.lastModified = QDateTime::fromString( details.value( QStringLiteral( "last_modified" ) ).toString(), Qt::ISODateWithMs );
+    mEntries.insert( it.key(), entry );
+  }
+}
+
+void WebdavManifest::write() const
+{
+  if ( mFilePath.isEmpty() )
+  {
+    return;
+  }
+
+  QJsonObject manifest;
+  for ( auto it = mEntries.constBegin(); it != mEntries.constEnd(); ++it )
+  {
+    QJsonObject details;
+    details.insert( QStringLiteral( "size" ), it->size );
+    details.insert( QStringLiteral( "last_modified" ), it->lastModified.toString( Qt::ISODateWithMs ) );
+    manifest.insert( it.key(), details );
+  }
+
+  QFile manifestFile( mFilePath );
+  if ( manifestFile.open( QFile::WriteOnly ) )
+  {
+    manifestFile.write( QJsonDocument( manifest ).toJson( QJsonDocument::Compact ) );
+    manifestFile.close();
+  }
+}
+
+void WebdavManifest::insert( const QString &remotePath, qint64 size, const QDateTime &lastModified )
+{
+  Entry entry;
+  entry.size = size;
+  entry.lastModified = lastModified;
+  mEntries.insert( remotePath, entry );
+}
+
+bool WebdavManifest::isIdentical( const QString &remotePath, qint64 remoteSize, const QDateTime &remoteLastModified, const QFileInfo &fileInfo ) const
+{
+  if ( !fileInfo.exists() )
+  {
+    return false;
+  }
+
+  const QDateTime localLastModified = fileInfo.fileTime( QFileDevice::FileModificationTime );
+  auto it = mEntries.constFind( remotePath );
+  if ( it == mEntries.constEnd() )
+  {
+    // Not transferred since the manifest exists, rely on the last modified date attached to downloaded and uploaded files
+    return localLastModified == remoteLastModified;
+  }
+
+  if ( fileInfo.size() != it->size || localLastModified != it->lastModified )
+  {
+    // The local file was modified since its last transfer
+    return false;
+  }
+
+  return remoteSize == it->size && remoteLastModified == it->lastModified;
+}
+
+void WebdavManifest::prune( const QString &remoteRootPath, const QSet<QString> &remotePaths, const QString &localRootPath )
+{
+  for ( auto it = mEntries.begin(); it != mEntries.end(); )
+  {
+    if ( it.key().startsWith( remoteRootPath ) && ( !remotePaths.contains( it.key() ) || !QFileInfo::exists( localRootPath + it.key().mid( remoteRootPath.size() ) ) ) )
+    {
+      it = mEntries.erase( it );
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
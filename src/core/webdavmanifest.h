@@ -0,0 +1,87 @@
+/***************************************************************************
+    webdavmanifest.h
+    ---------------------
+    begin                : October 2026
+    copyright            : (C) 2026 by OPENGIS.ch
+    email                : info@opengis.ch
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef WEBDAVMANIFEST_H
+#define WEBDAVMANIFEST_H
+
+#include "qfield_core_export.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+
+/**
+ * The state of the files of an imported WebDAV path when they were last transferred, stored alongside the
+ * WebDAV configuration to skip the files which are identical locally and remotely.
+ *
+ * Files are compared by size and last modified date only, the remote entity tags are not exposed by QtWebDAV.
+ * \ingroup core
+ */
+class QFIELD_CORE_EXPORT WebdavManifest
+{
+  public:
+    //! The state of a file when it was last transferred
+    struct Entry
+    {
+        //! The file size, in bytes
+        qint64 size = 0;
+        //! The remote last modified date, also attached to the local file
+        QDateTime lastModified;
+    };
+
+    //! Returns the name of the manifest file stored alongside the WebDAV configuration
+    static QString fileName();
+
+    //! Reads the manifest stored in the \a rootPath folder, the manifest is empty if none was stored yet
+    void read( const QString &rootPath );
+
+    //! Writes the manifest back to the folder it was read from
+    void write() const;
+
+    //! Returns the path of the manifest file, empty if no manifest was read
+    QString filePath() const { return mFilePath; }
+
+    //! Returns the number of recorded files
+    qsizetype count() const { return mEntries.size(); }
+
+    //! Returns TRUE if the file at \a remotePath is recorded
+    bool contains( const QString &remotePath ) const { return mEntries.contains( remotePath ); }
+
+    //! Records the \a size and \a lastModified date of the file at \a remotePath once transferred
+    void insert( const QString &remotePath, qint64 size, const QDateTime &lastModified );
+
+    /**
+     * Returns TRUE if the remote file at \a remotePath, of \a remoteSize and \a remoteLastModified date, is identical to the
+     * local file \a fileInfo. Files which are not recorded fall back to comparing the last modified dates, which are attached to
+     * the transferred files.
+     */
+    bool isIdentical( const QString &remotePath, qint64 remoteSize, const QDateTime &remoteLastModified, const QFileInfo &fileInfo ) const;
+
+    /**
+     * Removes the recorded files below \a remoteRootPath which were deleted, either remotely as they are missing from the
+     * complete \a remotePaths listing or locally from \a localRootPath.
+     */
+    void prune( const QString &remoteRootPath, const QSet<QString> &remotePaths, const QString &localRootPath );
+
+  private:
+    QString mFilePath;
+    QHash<QString, Entry> mEntries;
+};
+
+#endif // WEBDAVMANIFEST_H
@@ -12,6 +12,9 @@ Rectangle {
 
   property alias text: busyMessage.text
   property alias progress: busyProgress.value
+  property bool cancelable: false
+
+  signal canceled
 
   anchors.fill: parent
   color: Theme.darkGraySemiOpaque
@@ -145,4 +148,17 @@ Rectangle {
       return;
     }
   }
+
+  QfButton {
+    id: cancelButton
+    anchors.top: busyMessageShield.bottom
+    anchors.topMargin: 10
+    anchors.horizontalCenter: parent.horizontalCenter
+    visible: busyOverlay.cancelable
+    text: qsTr("Cancel")
+
+    onClicked: {
+      busyOverlay.canceled();
+    }
+  }
 }
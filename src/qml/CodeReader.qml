@@ -74,6 +74,8 @@ QfPopup {
   BarcodeDecoder {
     id: barcodeDecoder
 
+    regionOfInterest: cameraLoader.item ? cameraLoader.item.scanArea : Qt.rect(0, 0, 1, 1)
+
     onDecodedStringChanged: {
       if (decodedString !== '') {
         codeReader.decodedString = decodedString;
@@ -206,6 +208,9 @@ QfPopup {
               property alias camera: captureSession.camera
               property alias sink: videoOutput.videoSink
 
+              // the part of the video frames visible in the viewfinder, normalized to the frame size
+              readonly property rect scanArea: videoOutput.contentRect.width > 0 && videoOutput.contentRect.height > 0 ? Qt.rect(-videoOutput.contentRect.x / videoOutput.contentRect.width, -videoOutput.contentRect.y / videoOutput.contentRect.height, videoOutput.width / videoOutput.contentRect.width, videoOutput.height / videoOutput.contentRect.height) : Qt.rect(0, 0, 1, 1)
+
               CaptureSession {
                 id: captureSession
                 camera: Camera {
@@ -910,6 +910,7 @@ Pane {
 
         model: FeatureListModel {
           id: transferFeatureListModel
+          pageSize: 100
         }
 
         textRole: "displayString"
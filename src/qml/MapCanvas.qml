@@ -34,6 +34,8 @@ Item {
   property alias smooth: mapCanvasWrapper.smooth
   property alias previewJobsEnabled: mapCanvasWrapper.previewJobsEnabled
   property alias previewJobsQuadrants: mapCanvasWrapper.previewJobsQuadrants
+  property alias persistentCacheEnabled: mapCanvasWrapper.persistentCacheEnabled
+  property alias renderStatistics: mapCanvasWrapper.renderStatistics
   property alias forceDeferredLayersRepaint: mapCanvasWrapper.forceDeferredLayersRepaint
 
   property bool interactive: true
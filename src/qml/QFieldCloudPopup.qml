@@ -746,6 +746,38 @@ Popup {
     }
   }
 
+  Connections {
+    id: revertConnection
+    target: busyOverlay
+    enabled: cloudProjectsModel.isReverting
+
+    function onCanceled() {
+      cloudProjectsModel.cancelRevertLocalChanges();
+    }
+  }
+
+  Connections {
+    target: cloudProjectsModel
+
+    function onRevertProgressChanged() {
+      if (cloudProjectsModel.isReverting) {
+        busyOverlay.progress = cloudProjectsModel.revertProgress;
+      }
+    }
+
+    function onRevertFinished(isReverted, isCanceled) {
+      busyOverlay.cancelable = false;
+      busyOverlay.state = "hidden";
+      if (isReverted) {
+        displayToast(qsTr('Local changes reverted'));
+      } else if (isCanceled) {
+        displayToast(qsTr('Reverting local changes canceled'));
+      } else {
+        displayToast(qsTr('Failed to revert changes'), 'error');
+      }
+    }
+  }
+
   QfDialog {
     id: revertDialog
     parent: mainWindow.contentItem
@@ -821,7 +853,10 @@ Popup {
   function revertLocalChangesFromCurrentProject() {
     if (cloudProjectsModel.currentProject && cloudProjectsModel.currentProject.status === QFieldCloudProject.Idle) {
       if (cloudProjectsModel.revertLocalChangesFromCurrentProject()) {
-        displayToast(qsTr('Local changes reverted'));
+        busyOverlay.text = qsTr("Reverting local changes");
+        busyOverlay.progress = 0;
+        busyOverlay.cancelable = true;
+        busyOverlay.state = "visible";
       } else {
         displayToast(qsTr('Failed to revert changes'), 'error');
       }
@@ -219,6 +219,15 @@ Page {
               fillMode: Image.PreserveAspectFit
               width: 48
               height: 48
+
+              Image {
+                anchors.fill: parent
+                visible: type.status === Image.Loading
+                source: visible ? Theme.getThemeVectorIcon('ic_file_green_48dp') : ''
+                sourceSize.width: 92
+                sourceSize.height: 92
+                fillMode: Image.PreserveAspectFit
+              }
             }
 
             ColumnLayout {
@@ -370,6 +379,13 @@ Page {
         }
       }
 
+      BusyIndicator {
+        anchors.centerIn: parent
+
+        visible: localFilesModel.isLoading
+        running: visible
+      }
+
       Connections {
         target: nativeLocalDataPickerButton.__projectSource
 
@@ -29,6 +29,8 @@ Page {
   property alias enableMapRotation: registry.enableMapRotation
   property alias quality: registry.quality
   property alias previewJobsEnabled: registry.previewJobsEnabled
+  property alias persistentRenderCacheEnabled: registry.persistentRenderCacheEnabled
+  property alias renderStatisticsLogging: registry.renderStatisticsLogging
   property alias snapToCommonAngleIsEnabled: registry.snapToCommonAngleIsEnabled
   property alias snapToCommonAngleIsRelative: registry.snapToCommonAngleIsRelative
   property alias snapToCommonAngleDegrees: registry.snapToCommonAngleDegrees
@@ -69,6 +71,8 @@ Page {
     property bool enableMapRotation: true
     property double quality: 1.0
     property bool previewJobsEnabled: true
+    property bool persistentRenderCacheEnabled: false
+    property bool renderStatisticsLogging: false
 
     property bool snapToCommonAngleIsEnabled: false
     property bool snapToCommonAngleIsRelative: true
@@ -187,6 +191,18 @@ Page {
       settingAlias: "previewJobsEnabled"
       isVisible: true
     }
+    ListElement {
+      title: qsTr("Keep rendered basemaps between sessions")
+      description: qsTr("If enabled, the rendered images of layers which cannot be edited, such as basemaps, are stored on the device so they show up immediately when reopening a project.")
+      settingAlias: "persistentRenderCacheEnabled"
+      isVisible: true
+    }
+    ListElement {
+      title: qsTr("Log map rendering statistics")
+      description: qsTr("If enabled, the rendering time of each layer is logged to the file 'logs/render_statistics.log' in the QField directory, to help finding the layers slowing down the map.")
+      settingAlias: "renderStatisticsLogging"
+      isVisible: true
+    }
     ListElement {
       title: qsTr("Enable auto-save mode")
       description: qsTr("If enabled, newly-added features are stored as soon as it has having a valid geometry and the constraints are fulfilled and edited atributes are commited immediately.")
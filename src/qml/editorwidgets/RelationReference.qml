@@ -28,6 +28,7 @@ EditorWidgetBase {
     appExpressionContextScopesGenerator: appScopesGenerator
     filterExpression: config['FilterExpression'] ? config['FilterExpression'] : ""
     allowMulti: false
+    pageSize: 100
 
     // passing "" instead of undefined, so the model is cleared on adding new features
     // attributeValue has to be the last one set to make sure the property’s value is handled properly (e.g. allow multiple)
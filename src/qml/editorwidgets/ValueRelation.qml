@@ -43,6 +43,7 @@ EditorWidgetBase {
 
     searchTerm: allowMulti ? searchBar.searchTerm : ""
     sortCheckedFirst: allowMulti && !isEnabled
+    pageSize: 100
 
     onListUpdated: {
       valueChangeRequested(attributeValue, attributeValue === "");
@@ -380,10 +380,14 @@ ApplicationWindow {
     repeat: false
     onTriggered: {
       mapCanvasMap.freeze('trackerreplay');
-      let list = positionSource.getBackgroundPositionInformation();
-      // Qt bug weirdly returns an empty list on first invokation to source, call twice to insure we've got the actual list
-      list = positionSource.getBackgroundPositionInformation();
-      trackingModel.replayPositionInformationList(list, positionSource.coordinateTransformer);
+      trackingModel.replayBackgroundPositionInformation(positionSource);
+    }
+  }
+
+  Connections {
+    target: trackingModel
+
+    function onReplayFinished() {
       mapCanvasMap.unfreeze('trackerreplay');
       busyOverlay.state = "hidden";
     }
@@ -636,6 +640,8 @@ ApplicationWindow {
       quality: qfieldSettings.quality
       smooth: gnssButton.followActive
       previewJobsEnabled: qfieldSettings.previewJobsEnabled
+      persistentCacheEnabled: qfieldSettings.persistentRenderCacheEnabled
+      renderStatistics.logFilePath: qfieldSettings.renderStatisticsLogging ? platformUtilities.applicationDirectory() + "/logs/render_statistics.log" : ""
       forceDeferredLayersRepaint: trackings.count > 0
       freehandDigitizing: freehandButton.freehandDigitizing && freehandHandler.active
 
@@ -106,3 +106,78 @@ TEST_CASE( "AttributeFormModel" )
     std::unique_ptr<QAbstractItemModelTester> modelTester = std::make_unique<QAbstractItemModelTester>( modelTest.get(), QAbstractItemModelTester::FailureReportingMode::Fatal );
   }
 }
+
+TEST_CASE( "AttributeFormModelDependencies" )
+{
+  // the fields are declared in the reverse order of their default values dependencies
+  std::unique_ptr<QgsVectorLayer> layer = std::make_unique<QgsVectorLayer>( QStringLiteral( "Point?crs=EPSG:3857&field=fid:integer&field=c:string&field=b:string&field=a:string&field=unrelated:string" ), QStringLiteral( "Input Layer" ), QStringLiteral( "memory" ) );
+  REQUIRE( layer->isValid() );
+
+  layer->setDefaultValueDefinition( 1, QgsDefaultValue( QStringLiteral( "coalesce(\"b\",'') || 'c'" ), true ) );
+  layer->setDefaultValueDefinition( 2, QgsDefaultValue( QStringLiteral( "coalesce(\"a\",'') || 'b'" ), true ) );
+  layer->setDefaultValueDefinition( 4, QgsDefaultValue( QStringLiteral( "'unrelated'" ), true ) );
+
+  std::unique_ptr<AttributeFormModel> attributeFormModel = std::make_unique<AttributeFormModel>();
+  std::unique_ptr<FeatureModel> featureModel = std::make_unique<FeatureModel>();
+  attributeFormModel->setFeatureModel( featureModel.get() );
+  featureModel->setCurrentLayer( layer.get() );
+  featureModel->resetFeature();
+  featureModel->resetAttributes();
+
+  REQUIRE( attributeFormModel->setData( attributeFormModel->index( 3, 0 ), QStringLiteral( "a" ), AttributeFormModel::AttributeValue ) );
+
+  // the transitive dependent is updated once its own dependency got updated
+  REQUIRE( attributeFormModel->attribute( QStringLiteral( "b" ) ) == QStringLiteral( "ab" ) );
+  REQUIRE( attributeFormModel->attribute( QStringLiteral( "c" ) ) == QStringLiteral( "abc" ) );
+  REQUIRE( attributeFormModel->data( attributeFormModel->index( 1, 0 ), AttributeFormModel::AttributeValue ) == QStringLiteral( "abc" ) );
+
+  // default values not depending on the changed field are left untouched
+  REQUIRE( attributeFormModel->setData( attributeFormModel->index( 4, 0 ), QStringLiteral( "edited" ), AttributeFormModel::AttributeValue ) );
+  REQUIRE( attributeFormModel->setData( attributeFormModel->index( 3, 0 ), QStringLiteral( "z" ), AttributeFormModel::AttributeValue ) );
+  REQUIRE( attributeFormModel->attribute( QStringLiteral( "c" ) ) == QStringLiteral( "zbc" ) );
+  REQUIRE( attributeFormModel->attribute( QStringLiteral( "unrelated" ) ) == QStringLiteral( "edited" ) );
+}
+
+TEST_CASE( "AttributeFormModelBenchmark", "[.][benchmark]" )
+{
+  // a large form of chained default values, with a constraint and an alias expression on each field
+  const int fieldCount = 150;
+  QString uri = QStringLiteral( "Point?crs=EPSG:3857" );
+  for ( int i = 0; i < fieldCount; i++ )
+    uri += QStringLiteral( "&field=field_%1:string" ).arg( i );
+
+  std::unique_ptr<QgsVectorLayer> layer = std::make_unique<QgsVectorLayer>( uri, QStringLiteral( "Input Layer" ), QStringLiteral( "memory" ) );
+  REQUIRE( layer->isValid() );
+
+  QgsEditFormConfig editFormConfig = layer->editFormConfig();
+  for ( int i = 0; i < fieldCount; i++ )
+  {
+    const QString fieldName = QStringLiteral( "field_%1" ).arg( i );
+    // only every tenth field starts a new chain of dependent default values
+    if ( i % 10 != 0 )
+      layer->setDefaultValueDefinition( i, QgsDefaultValue( QStringLiteral( "upper(coalesce(\"field_%1\",''))" ).arg( i - 1 ), true ) );
+    layer->setConstraintExpression( i, QStringLiteral( "length(\"%1\") < 100" ).arg( fieldName ) );
+
+    QgsPropertyCollection properties = editFormConfig.dataDefinedFieldProperties( fieldName );
+    QgsProperty property;
+    property.setExpressionString( QStringLiteral( "'%1 (' || length(coalesce(\"%1\",'')) || ')'" ).arg( fieldName ) );
+    property.setActive( true );
+    properties.setProperty( QgsEditFormConfig::DataDefinedProperty::Alias, property );
+    editFormConfig.setDataDefinedFieldProperties( fieldName, properties );
+  }
+  layer->setEditFormConfig( editFormConfig );
+
+  std::unique_ptr<AttributeFormModel> attributeFormModel = std::make_unique<AttributeFormModel>();
+  std::unique_ptr<FeatureModel> featureModel = std::make_unique<FeatureModel>();
+  attributeFormModel->setFeatureModel( featureModel.get() );
+  featureModel->setCurrentLayer( layer.get() );
+  featureModel->resetFeature();
+  featureModel->resetAttributes();
+
+  const QModelIndex index = attributeFormModel->index( 50, 0 );
+  BENCHMARK( "Keystroke in a 150 fields form" )
+  {
+    static int keystroke = 0;
+    return attributeFormModel->setData( index, QStringLiteral( "value %1" ).arg( keystroke++ ), AttributeFormModel::AttributeValue );
+  };
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+                        test_barcodedecoder.cpp
+                        -----------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "barcodedecoder.h"
+#include "catch2.h"
+
+#include <QSignalSpy>
+#include <QVideoFrame>
+
+#include <cstring>
+
+
+static QImage readFrameImage()
+{
+  // a 640x480 camera frame luminance with an EAN-13 barcode
+  return QImage( QStringLiteral( "%1/barcode_frame.pgm" ).arg( TEST_DATA_DIR ) ).convertToFormat( QImage::Format_Grayscale8 );
+}
+
+
+static QVideoFrame nv12Frame( const QImage &image )
+{
+  QVideoFrame frame( QVideoFrameFormat( image.size(), QVideoFrameFormat::Format_NV12 ) );
+  if ( !frame.map( QVideoFrame::WriteOnly ) )
+    return QVideoFrame();
+
+  for ( int y = 0; y < image.height(); y++ )
+    std::memcpy( frame.bits( 0 ) + y * frame.bytesPerLine( 0 ), image.constScanLine( y ), image.width() );
+  std::memset( frame.bits( 1 ), 128, frame.mappedBytes( 1 ) );
+
+  frame.unmap();
+  return frame;
+}
+
+
+TEST_CASE( "BarcodeDecoder" )
+{
+  const QImage image = readFrameImage();
+  REQUIRE( !image.isNull() );
+
+  const QVideoFrame frame = nv12Frame( image );
+  REQUIRE( frame.isValid() );
+
+  SECTION( "LuminanceImage" )
+  {
+    REQUIRE( BarcodeDecoder::luminanceImage( frame ) == image );
+
+    const QImage region = BarcodeDecoder::luminanceImage( frame, QRectF( 0.25, 0.25, 0.5, 0.5 ) );
+    REQUIRE( region.size() == QSize( 320, 240 ) );
+    REQUIRE( region == image.copy( 160, 120, 320, 240 ) );
+
+    REQUIRE( BarcodeDecoder::luminanceImage( frame, QRectF( 2, 2, 1, 1 ) ).isNull() );
+  }
+
+  SECTION( "RotatedLuminanceImage" )
+  {
+    QVideoFrame rotatedFrame( frame );
+#if QT_VERSION >= QT_VERSION_CHECK( 6, 7, 0 )
+    rotatedFrame.setRotation( QtVideo::Rotation::Clockwise90 );
+#else
+    rotatedFrame.setRotationAngle( QVideoFrame::Rotation90 );
+#endif
+
+    // the left half of the frame as displayed is the bottom half of the unrotated frame data
+    REQUIRE( BarcodeDecoder::luminanceImage( rotatedFrame, QRectF( 0, 0, 0.5, 1 ) ) == image.copy( 0, 240, 640, 240 ) );
+  }
+
+
+  SECTION( "DecodeString" )
+  {
+    REQUIRE( BarcodeDecoder::decodeString( image ) == QStringLiteral( "4006381333931" ) );
+    REQUIRE( BarcodeDecoder::decodeString( BarcodeDecoder::luminanceImage( frame, QRectF( 0.1, 0.25, 0.8, 0.5 ) ) ) == QStringLiteral( "4006381333931" ) );
+    REQUIRE( BarcodeDecoder::decodeString( BarcodeDecoder::luminanceImage( frame, QRectF( 0, 0, 1, 0.25 ) ) ).isEmpty() );
+  }
+
+
+  SECTION( "DecodeVideoFrame" )
+  {
+    BarcodeDecoder decoder;
+    QSignalSpy spy( &decoder, &BarcodeDecoder::decodedStringChanged );
+
+    decoder.decodeVideoFrame( frame );
+
+    // the decoding thread is still busy with the first frame, the second one is not read
+    decoder.decodeVideoFrame( frame );
+    REQUIRE( decoder.droppedFramesCount() == 1 );
+
+    REQUIRE( spy.wait() );
+    REQUIRE( decoder.decodedString() == QStringLiteral( "4006381333931" ) );
+
+    decoder.clearDecodedString();
+    REQUIRE( decoder.decodedString().isEmpty() );
+  }
+}
+
+
+TEST_CASE( "BarcodeDecoderBenchmark", "[.][benchmark]" )
+{
+  const QImage image = readFrameImage();
+  REQUIRE( !image.isNull() );
+
+  const QVideoFrame frame = nv12Frame( image );
+  REQUIRE( frame.isValid() );
+
+  BENCHMARK( "Convert the frame to ARGB32 and decode" )
+  {
+    return BarcodeDecoder::decodeString( frame.toImage().convertToFormat( QImage::Format_ARGB32 ) );
+  };
+
+  BENCHMARK( "Decode the frame luminance" )
+  {
+    return BarcodeDecoder::decodeString( BarcodeDecoder::luminanceImage( frame ) );
+  };
+
+  BENCHMARK( "Decode the frame luminance region of interest" )
+  {
+    return BarcodeDecoder::decodeString( BarcodeDecoder::luminanceImage( frame, QRectF( 0.1, 0.25, 0.8, 0.5 ) ) );
+  };
+}
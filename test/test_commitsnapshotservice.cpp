@@ -0,0 +1,186 @@
+/***************************************************************************
+                        test_commitsnapshotservice.cpp
+                        ------------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "commitsnapshotservice.h"
+#include "featurehistory.h"
+#include "layerobserver.h"
+#include "utils/qfieldcloudutils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <qgsproject.h>
+#include <qgsvectorlayer.h>
+
+
+TEST_CASE( "CommitSnapshotService" )
+{
+  QTemporaryDir settingsDir;
+  REQUIRE( settingsDir.isValid() );
+  REQUIRE( QDir( settingsDir.path() ).mkpath( QStringLiteral( "cloud_projects/TEST_PROJECT_ID" ) ) );
+
+  QFieldCloudUtils::setLocalCloudDirectory( settingsDir.path() );
+  QFile projectFile( QStringLiteral( "%1/cloud_projects/TEST_PROJECT_ID/project.qgs" ).arg( settingsDir.path() ) );
+  REQUIRE( projectFile.open( QIODevice::WriteOnly ) );
+  REQUIRE( projectFile.flush() );
+
+  QgsProject::instance()->setFileName( projectFile.fileName() );
+
+  std::unique_ptr<QgsVectorLayer> vl = std::make_unique<QgsVectorLayer>( QStringLiteral( "Point?crs=EPSG:3857&field=fid:integer&field=str:string" ), QStringLiteral( "vl" ), QStringLiteral( "memory" ) );
+  vl->setCustomProperty( QStringLiteral( "QFieldSync/action" ), QStringLiteral( "CLOUD" ) );
+  vl->setCustomProperty( QStringLiteral( "QFieldSync/sourceDataPrimaryKeys" ), QStringLiteral( "fid" ) );
+  REQUIRE( vl->isValid() );
+
+  // a bulk edit, spanning several data provider requests
+  const int featuresCount = CommitSnapshotService::CHUNK_SIZE * 2 + 500;
+  QgsFeatureList features;
+  for ( int i = 1; i <= featuresCount; i++ )
+  {
+    QgsFeature f( vl->fields() );
+    f.setAttribute( QStringLiteral( "fid" ), i );
+    f.setAttribute( QStringLiteral( "str" ), QStringLiteral( "string%1" ).arg( i ) );
+    f.setGeometry( QgsGeometry( new QgsPoint( i, i ) ) );
+    features << f;
+  }
+  REQUIRE( vl->dataProvider()->addFeatures( features ) );
+
+  CommitSnapshotService service;
+
+  SECTION( "SharedSnapshot" )
+  {
+    QObject firstConsumer;
+    QObject secondConsumer;
+    service.watchLayer( vl.get(), &firstConsumer );
+    service.watchLayer( vl.get(), &secondConsumer );
+    REQUIRE( service.consumersCount( vl.get() ) == 2 );
+
+    QgsFeatureMap firstSnapshot;
+    QgsFeatureMap secondSnapshot;
+    QObject::connect( vl.get(), &QgsVectorLayer::beforeCommitChanges, &firstConsumer, [&] { firstSnapshot = service.snapshot( vl.get() ); } );
+    QObject::connect( vl.get(), &QgsVectorLayer::beforeCommitChanges, &secondConsumer, [&] { secondSnapshot = service.snapshot( vl.get() ); } );
+
+    REQUIRE( vl->startEditing() );
+    REQUIRE( vl->changeAttributeValue( 1, 1, QStringLiteral( "changed" ) ) );
+    REQUIRE( vl->deleteFeature( 2 ) );
+    REQUIRE( vl->commitChanges() );
+
+    REQUIRE( firstSnapshot.size() == 2 );
+    REQUIRE( firstSnapshot.value( 1 ).attribute( 1 ) == QStringLiteral( "string1" ) );
+    REQUIRE( firstSnapshot.contains( 2 ) );
+    REQUIRE( secondSnapshot.keys() == firstSnapshot.keys() );
+
+    CommitSnapshotService::Statistics statistics = service.statistics();
+    REQUIRE( statistics.snapshotsCount == 2 );
+    REQUIRE( statistics.providerReadsCount == 1 );
+    REQUIRE( statistics.requestsCount == 1 );
+    REQUIRE( statistics.featuresReadCount == 2 );
+    REQUIRE( statistics.featuresSavedCount == 2 );
+
+    // the next commit reads the features again
+    REQUIRE( vl->startEditing() );
+    REQUIRE( vl->changeAttributeValue( 1, 1, QStringLiteral( "changed again" ) ) );
+    REQUIRE( vl->commitChanges() );
+
+    REQUIRE( firstSnapshot.value( 1 ).attribute( 1 ) == QStringLiteral( "changed" ) );
+    REQUIRE( secondSnapshot.value( 1 ).attribute( 1 ) == QStringLiteral( "changed" ) );
+
+    statistics = service.statistics();
+    REQUIRE( statistics.providerReadsCount == 2 );
+    REQUIRE( statistics.featuresSavedCount == 3 );
+
+    service.unwatchLayer( vl.get(), &secondConsumer );
+    REQUIRE( service.consumersCount( vl.get() ) == 1 );
+
+    service.resetStatistics();
+    REQUIRE( service.statistics().snapshotsCount == 0 );
+  }
+
+
+  SECTION( "RequiresCompleteFeatures" )
+  {
+    QObject firstConsumer;
+    QObject secondConsumer;
+    service.watchLayer( vl.get(), &firstConsumer, CommitSnapshotService::SnapshotContent::ChangedValues );
+    REQUIRE_FALSE( service.requiresCompleteFeatures( vl.get() ) );
+
+    service.watchLayer( vl.get(), &secondConsumer );
+    REQUIRE( service.requiresCompleteFeatures( vl.get() ) );
+
+    service.watchLayer( vl.get(), &secondConsumer, CommitSnapshotService::SnapshotContent::ChangedValues );
+    REQUIRE( service.consumersCount( vl.get() ) == 2 );
+    REQUIRE_FALSE( service.requiresCompleteFeatures( vl.get() ) );
+
+    service.watchLayer( vl.get(), &firstConsumer, CommitSnapshotService::SnapshotContent::CompleteFeatures );
+    service.unwatchLayer( vl.get(), &firstConsumer );
+    REQUIRE_FALSE( service.requiresCompleteFeatures( vl.get() ) );
+  }
+
+
+  SECTION( "LayerObserverOnly" )
+  {
+    std::unique_ptr<LayerObserver> layerObserver = std::make_unique<LayerObserver>( QgsProject::instance(), &service );
+
+    REQUIRE( QgsProject::instance()->addMapLayer( vl.get(), false, false ) );
+    REQUIRE( service.consumersCount( vl.get() ) == 1 );
+    REQUIRE_FALSE( service.requiresCompleteFeatures( vl.get() ) );
+
+    REQUIRE( vl->startEditing() );
+    REQUIRE( vl->changeAttributeValue( 1, 1, QStringLiteral( "changed" ) ) );
+    REQUIRE( vl->commitChanges() );
+
+    // only the changed values are read, without the shared snapshot
+    REQUIRE( service.statistics().providerReadsCount == 0 );
+    REQUIRE( layerObserver->lastSnapshotStatistics().featuresCount == 1 );
+    REQUIRE( layerObserver->lastSnapshotStatistics().attributeValuesCount == 1 );
+
+    layerObserver->setSnapshotMode( LayerObserver::SnapshotMode::FullSnapshot );
+    REQUIRE( service.requiresCompleteFeatures( vl.get() ) );
+
+    QgsProject::instance()->takeMapLayer( vl.get() );
+  }
+
+
+  SECTION( "LayerObserverAndFeatureHistory" )
+  {
+    std::unique_ptr<LayerObserver> layerObserver = std::make_unique<LayerObserver>( QgsProject::instance(), &service );
+    std::unique_ptr<FeatureHistory> featureHistory = std::make_unique<FeatureHistory>( QgsProject::instance(), nullptr, &service );
+
+    REQUIRE( QgsProject::instance()->addMapLayer( vl.get(), false, false ) );
+    REQUIRE( service.consumersCount( vl.get() ) == 2 );
+
+    REQUIRE( vl->startEditing() );
+    for ( int i = 1; i <= featuresCount; i++ )
+      REQUIRE( vl->changeAttributeValue( i, 1, QStringLiteral( "changed%1" ).arg( i ) ) );
+    REQUIRE( vl->commitChanges() );
+
+    // the features are read once for both observers
+    const CommitSnapshotService::Statistics statistics = service.statistics();
+    REQUIRE( statistics.snapshotsCount == 2 );
+    REQUIRE( statistics.providerReadsCount == 1 );
+    REQUIRE( statistics.requestsCount == 3 );
+    REQUIRE( statistics.featuresReadCount == featuresCount );
+    REQUIRE( statistics.featuresSavedCount == featuresCount );
+
+    const LayerObserver::SnapshotStatistics layerObserverStatistics = layerObserver->lastSnapshotStatistics();
+    REQUIRE( layerObserverStatistics.featuresCount == featuresCount );
+    REQUIRE( layerObserverStatistics.geometriesCount == featuresCount );
+
+    QgsProject::instance()->takeMapLayer( vl.get() );
+  }
+}
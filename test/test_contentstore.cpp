@@ -0,0 +1,133 @@
+/***************************************************************************
+                        test_contentstore.cpp
+                        ---------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "catch2.h"
+#include "qfieldcloud/contentstore.h"
+#include "utils/fileutils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+
+
+static QByteArray readAll( const QString &fileName )
+{
+  QFile file( fileName );
+  return file.open( QIODevice::ReadOnly ) ? file.readAll() : QByteArray();
+}
+
+
+TEST_CASE( "ContentStore" )
+{
+  QTemporaryDir tmpDir;
+  REQUIRE( tmpDir.isValid() );
+
+  const QDir dir( tmpDir.path() );
+  ContentStore store( dir.filePath( QStringLiteral( ".store" ) ) );
+
+  const QString projectAFileName = dir.filePath( QStringLiteral( "projectA/basemap.tif" ) );
+  const QString projectBFileName = dir.filePath( QStringLiteral( "projectB/basemap.tif" ) );
+  REQUIRE( QDir().mkpath( dir.filePath( QStringLiteral( "projectA" ) ) ) );
+  {
+    QFile file( projectAFileName );
+    REQUIRE( file.open( QIODevice::WriteOnly ) );
+    file.write( "raster content" );
+  }
+
+  const QString key = ContentStore::etagKey( FileUtils::fileEtag( projectAFileName ) );
+  REQUIRE( !key.isEmpty() );
+
+  SECTION( "InsertAndMaterialize" )
+  {
+    REQUIRE( !store.contains( key ) );
+    REQUIRE( !store.materialize( key, projectBFileName, true ) );
+
+    REQUIRE( store.insert( projectAFileName, key ) );
+    REQUIRE( store.contains( key ) );
+    REQUIRE( store.isMaterialized( key, projectAFileName ) );
+
+    REQUIRE( store.materialize( key, projectBFileName, true ) );
+    REQUIRE( readAll( projectBFileName ) == QByteArray( "raster content" ) );
+    REQUIRE( store.isMaterialized( key, projectBFileName ) );
+    REQUIRE( FileUtils::hardLinkCount( projectAFileName ) == 3 );
+  }
+
+
+  SECTION( "MaterializeCopy" )
+  {
+    REQUIRE( store.insert( projectAFileName, key ) );
+
+    const QString copyFileName = dir.filePath( QStringLiteral( "projectB/data.gpkg" ) );
+    REQUIRE( store.materialize( key, copyFileName, false ) );
+    REQUIRE( readAll( copyFileName ) == QByteArray( "raster content" ) );
+    REQUIRE( !store.isMaterialized( key, copyFileName ) );
+  }
+
+
+  SECTION( "ModifiedInPlace" )
+  {
+    REQUIRE( store.insert( projectAFileName, key ) );
+
+    // make sure the modification time changes
+    QThread::msleep( 20 );
+
+    QFile file( projectAFileName );
+    REQUIRE( file.open( QIODevice::Append ) );
+    file.write( "edited" );
+    file.close();
+
+    REQUIRE( !store.contains( key ) );
+    REQUIRE( !store.isMaterialized( key, projectAFileName ) );
+
+    // the modified object is removed instead of being materialized
+    REQUIRE( !store.materialize( key, projectBFileName, true ) );
+    REQUIRE( !QFile::exists( store.objectPath( key ) ) );
+    REQUIRE( readAll( projectAFileName ) == QByteArray( "raster contentedited" ) );
+  }
+
+
+  SECTION( "EditableContentNotStored" )
+  {
+    const QString gpkgFileName = dir.filePath( QStringLiteral( "projectA/data.gpkg" ) );
+    REQUIRE( QFile::copy( projectAFileName, gpkgFileName ) );
+
+    REQUIRE( !store.insert( gpkgFileName, key ) );
+    REQUIRE( !store.contains( key ) );
+    REQUIRE( FileUtils::hardLinkCount( gpkgFileName ) == 1 );
+  }
+
+
+  SECTION( "RemoveUnreferenced" )
+  {
+    REQUIRE( store.insert( projectAFileName, key ) );
+    REQUIRE( store.removeUnreferenced() == 0 );
+
+    REQUIRE( QFile::remove( projectAFileName ) );
+    REQUIRE( store.removeUnreferenced() == 1 );
+    REQUIRE( !store.contains( key ) );
+  }
+
+
+  SECTION( "CanShareContent" )
+  {
+    REQUIRE( ContentStore::canShareContent( QStringLiteral( "basemap.TIF" ) ) );
+    REQUIRE( ContentStore::canShareContent( QStringLiteral( "tiles.mbtiles" ) ) );
+    REQUIRE( !ContentStore::canShareContent( QStringLiteral( "data.gpkg" ) ) );
+    REQUIRE( !ContentStore::canShareContent( QStringLiteral( "DCIM/photo.jpg" ) ) );
+  }
+}
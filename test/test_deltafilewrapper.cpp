@@ -25,6 +25,7 @@
 #include "utils/qfieldcloudutils.h"
 
 #include <QFileInfo>
+#include <QSignalSpy>
 #include <qgsproject.h>
 
 QT_BEGIN_NAMESPACE
@@ -234,6 +235,78 @@ TEST_CASE( "DeltaFileWrapper" )
   }
 
 
+  SECTION( "ExistingFileRoundTrip" )
+  {
+    // the second delta misses the "localLayerName" key and has an unknown "extra" key, both should survive as they are
+    const QByteArray existingContents = QByteArrayLiteral( R""""(
+          {
+            "deltas":[
+              {
+                "clientId": "22222222-2222-2222-2222-222222222222",
+                "exportId": "33333333-3333-3333-3333-333333333333",
+                "localLayerCrs": "EPSG:3857",
+                "localLayerId": "dummyLayerIdL1",
+                "localLayerName": "layer_name",
+                "localPk": "1",
+                "method": "patch",
+                "new": {
+                  "attributes": {
+                    "int": 43
+                  },
+                  "is_snapshot": false
+                },
+                "old": {
+                  "attributes": {
+                    "int": 42,
+                    "str": "stringy"
+                  },
+                  "geometry": null,
+                  "is_snapshot": true
+                },
+                "sourceLayerId": "dummyLayerIdS1",
+                "sourcePk": "1",
+                "uuid": "11111111-1111-1111-1111-111111111111"
+              },
+              {
+                "clientId": "22222222-2222-2222-2222-222222222222",
+                "exportId": "33333333-3333-3333-3333-333333333333",
+                "extra": [1, 2],
+                "localLayerCrs": "EPSG:3857",
+                "localLayerId": "dummyLayerIdL1",
+                "localPk": "2",
+                "method": "create",
+                "new": {
+                  "attributes": {
+                    "attachment": "attachment.jpg"
+                  },
+                  "files_sha256": {
+                    "attachment.jpg": null
+                  },
+                  "geometry": "Point (1 2)"
+                },
+                "sourceLayerId": "dummyLayerIdS1",
+                "sourcePk": "2",
+                "uuid": "22222222-2222-2222-2222-222222222222"
+              }
+            ],
+            "files":[],
+            "id":"11111111-1111-1111-1111-111111111111",
+            "project":"projectId",
+            "version":"1.0"
+          }
+        )"""" );
+    REQUIRE( tmpDeltaFile.write( existingContents ) );
+    tmpDeltaFile.flush();
+    DeltaFileWrapper dfw( projectId, tmpDeltaFile.fileName() );
+    REQUIRE( dfw.errorType() == DeltaFileWrapper::ErrorType::NoError );
+    REQUIRE( dfw.count() == 2 );
+
+    QJsonObject expectedRoot = QJsonDocument::fromJson( existingContents ).object();
+    expectedRoot.insert( QStringLiteral( "project" ), projectId );
+    REQUIRE( dfw.toJson() == QJsonDocument( expectedRoot ).toJson() );
+  }
+
+
   SECTION( "NoErrorNonExistingFile" )
   {
     QString fileName( workDir.filePath( QUuid::createUuid().toString() ) );
@@ -673,6 +746,42 @@ TEST_CASE( "DeltaFileWrapper" )
   }
 
 
+  SECTION( "Journal" )
+  {
+    QString fileName = workDir.filePath( QUuid::createUuid().toString() );
+    std::unique_ptr<DeltaFileWrapper> dfw1 = std::make_unique<DeltaFileWrapper>( projectId, fileName );
+    dfw1->setJournalingEnabled( true );
+    dfw1->addCreate( project, layer->id(), layer->id(), QStringLiteral( "fid" ), QStringLiteral( "fid" ), QgsFeature( QgsFields(), 100 ) );
+    dfw1->addCreate( project, layer->id(), layer->id(), QStringLiteral( "fid" ), QStringLiteral( "fid" ), QgsFeature( QgsFields(), 101 ) );
+
+    REQUIRE( dfw1->toFile() );
+    REQUIRE( !dfw1->isDirty() );
+    REQUIRE( QFileInfo::exists( dfw1->journalFileName() ) );
+
+    // the delta file itself is left untouched, the changes are in the journal
+    QFile deltaFile( fileName );
+    REQUIRE( deltaFile.open( QIODevice::ReadOnly ) );
+    REQUIRE( getDeltasArray( deltaFile.readAll() ).size() == 0 );
+    deltaFile.close();
+
+    const QString expectedPushPayload = QString( QJsonDocument( normalizeDeltasSchema( dfw1->deltas() ) ).toJson() );
+    const QString expectedId = dfw1->id();
+    dfw1.reset();
+
+    // a new instance replays the journal, as it would after a crash
+    DeltaFileWrapper dfw2( projectId, fileName );
+    REQUIRE( !dfw2.hasError() );
+    REQUIRE( dfw2.count() == 2 );
+    REQUIRE( dfw2.id() == expectedId );
+    REQUIRE( QString( QJsonDocument( normalizeDeltasSchema( dfw2.deltas() ) ).toJson() ) == expectedPushPayload );
+
+    REQUIRE( dfw2.compact() );
+    REQUIRE( !QFileInfo::exists( dfw2.journalFileName() ) );
+    REQUIRE( deltaFile.open( QIODevice::ReadOnly ) );
+    REQUIRE( getDeltasArray( deltaFile.readAll() ).size() == 2 );
+  }
+
+
   SECTION( "Append" )
   {
     DeltaFileWrapper dfw1( projectId, workDir.filePath( QUuid::createUuid().toString() ) );
@@ -2068,6 +2177,153 @@ TEST_CASE( "DeltaFileWrapper" )
   }
 
 
+  SECTION( "ApplyWithFeedback" )
+  {
+    QTemporaryFile deltaFile;
+
+    REQUIRE( deltaFile.open() );
+    REQUIRE( deltaFile.write( QStringLiteral( R""""(
+        {
+          "deltas": [
+            {
+              "uuid": "11111111-1111-1111-1111-111111111111",
+              "clientId": "22222222-2222-2222-2222-222222222222",
+              "exportId": "33333333-3333-3333-3333-333333333333",
+              "localLayerId": "%1",
+              "localPk": "1",
+              "sourceLayerId": "%1",
+              "sourcePk": "1",
+              "method": "patch",
+              "new": {
+                "attributes": {
+                  "str": "patched"
+                },
+                "geometry": null
+              },
+              "old": {
+                "attributes": {
+                  "str": "stringy"
+                },
+                "geometry": null
+              }
+            }
+          ],
+          "files": [],
+          "id": "11111111-1111-1111-1111-111111111111",
+          "project": "projectId",
+          "version": "1.0"
+        }
+      )"""" )
+                                .arg( layer->id() )
+                                .toUtf8() ) );
+    REQUIRE( deltaFile.flush() );
+
+    DeltaFileWrapper dfw( projectId, deltaFile.fileName() );
+
+    const auto strValue = [&layer]() {
+      QgsFeature feature;
+      layer->getFeatures( QgsFeatureRequest( QgsExpression( " fid = 1 " ) ) ).nextFeature( feature );
+      return feature.attribute( QStringLiteral( "str" ) ).toString();
+    };
+
+    // canceled application leaves the layer untouched
+    QgsFeedback canceledFeedback;
+    canceledFeedback.cancel();
+
+    REQUIRE( !dfw.apply( project, &canceledFeedback ) );
+    REQUIRE( !layer->isEditable() );
+    REQUIRE( strValue() == QStringLiteral( "stringy" ) );
+
+    QgsFeedback feedback;
+
+    REQUIRE( dfw.apply( project, &feedback ) );
+    REQUIRE( feedback.progress() == 100.0 );
+    REQUIRE( strValue() == QStringLiteral( "patched" ) );
+
+    REQUIRE( dfw.applyReversed( project, &feedback ) );
+    REQUIRE( strValue() == QStringLiteral( "stringy" ) );
+  }
+
+
+  SECTION( "ApplyReversedAsync" )
+  {
+    QTemporaryFile deltaFile;
+
+    REQUIRE( deltaFile.open() );
+    REQUIRE( deltaFile.write( QStringLiteral( R""""(
+        {
+          "deltas": [
+            {
+              "uuid": "11111111-1111-1111-1111-111111111111",
+              "clientId": "22222222-2222-2222-2222-222222222222",
+              "exportId": "33333333-3333-3333-3333-333333333333",
+              "localLayerId": "%1",
+              "localPk": "1",
+              "sourceLayerId": "%1",
+              "sourcePk": "1",
+              "method": "patch",
+              "new": {
+                "attributes": {
+                  "str": "patched"
+                },
+                "geometry": null
+              },
+              "old": {
+                "attributes": {
+                  "str": "stringy"
+                },
+                "geometry": null
+              }
+            }
+          ],
+          "files": [],
+          "id": "11111111-1111-1111-1111-111111111111",
+          "project": "projectId",
+          "version": "1.0"
+        }
+      )"""" )
+                                .arg( layer->id() )
+                                .toUtf8() ) );
+    REQUIRE( deltaFile.flush() );
+
+    DeltaFileWrapper dfw( projectId, deltaFile.fileName() );
+    QSignalSpy applyFinishedSpy( &dfw, &DeltaFileWrapper::applyFinished );
+
+    const auto strValue = [&layer]() {
+      QgsFeature feature;
+      layer->getFeatures( QgsFeatureRequest( QgsExpression( " fid = 1 " ) ) ).nextFeature( feature );
+      return feature.attribute( QStringLiteral( "str" ) ).toString();
+    };
+
+    REQUIRE( dfw.apply( project ) );
+    REQUIRE( strValue() == QStringLiteral( "patched" ) );
+
+    // the application starts on the next event loop iteration and the layer is in edit mode meanwhile
+    QgsFeedback canceledFeedback;
+
+    REQUIRE( dfw.applyReversedAsync( project, &canceledFeedback ) );
+    REQUIRE( !dfw.applyReversedAsync( project ) );
+    REQUIRE( !dfw.apply( project ) );
+    REQUIRE( layer->isEditable() );
+
+    canceledFeedback.cancel();
+
+    REQUIRE( applyFinishedSpy.wait() );
+    REQUIRE( applyFinishedSpy.takeFirst().at( 0 ).toBool() == false );
+    REQUIRE( !layer->isEditable() );
+    REQUIRE( strValue() == QStringLiteral( "patched" ) );
+
+    QgsFeedback feedback;
+
+    REQUIRE( dfw.applyReversedAsync( project, &feedback ) );
+    REQUIRE( applyFinishedSpy.wait() );
+    REQUIRE( applyFinishedSpy.takeFirst().at( 0 ).toBool() == true );
+    REQUIRE( feedback.progress() == 100.0 );
+    REQUIRE( !layer->isEditable() );
+    REQUIRE( strValue() == QStringLiteral( "stringy" ) );
+  }
+
+
   SECTION( "AddCreateWithJoinedLayer" )
   {
     QgsVectorLayerJoinInfo ji;
@@ -2315,3 +2571,50 @@ TEST_CASE( "DeltaFileWrapper" )
   project->removeMapLayer( layer.get() );
   project->removeMapLayer( joinedLayer.get() );
 }
+
+
+TEST_CASE( "DeltaFileWrapperBenchmark", "[.][benchmark]" )
+{
+  QgsProject *project = QgsProject::instance();
+  QTemporaryDir workDir;
+
+  REQUIRE( workDir.isValid() );
+
+  std::unique_ptr<QgsVectorLayer> layer = std::make_unique<QgsVectorLayer>( QStringLiteral( "Point?crs=EPSG:3857&field=fid:integer&field=int:integer&field=str:string" ), QStringLiteral( "layer_name" ), QStringLiteral( "memory" ) );
+
+  REQUIRE( layer->isValid() );
+
+  const int featuresCount = 50000;
+  QgsFeatureList oldFeatures;
+  QgsFeatureList newFeatures;
+  QgsFeatureList newerFeatures;
+
+  for ( int i = 1; i <= featuresCount; i++ )
+  {
+    QgsFeature f( layer->fields(), i );
+    f.setAttribute( QStringLiteral( "fid" ), i );
+    f.setAttribute( QStringLiteral( "int" ), i );
+    f.setAttribute( QStringLiteral( "str" ), QStringLiteral( "stringy" ) );
+    oldFeatures << f;
+
+    f.setAttribute( QStringLiteral( "int" ), i + 1 );
+    newFeatures << f;
+
+    f.setAttribute( QStringLiteral( "str" ), QStringLiteral( "pingy" ) );
+    newerFeatures << f;
+  }
+
+  BENCHMARK( "Merge 50k patches" )
+  {
+    DeltaFileWrapper dfw( QStringLiteral( "TEST_PROJECT_ID" ), workDir.filePath( QUuid::createUuid().toString() ) );
+
+    for ( int i = 0; i < featuresCount; i++ )
+      dfw.addPatch( project, layer->id(), layer->id(), QStringLiteral( "fid" ), QStringLiteral( "fid" ), oldFeatures[i], newFeatures[i] );
+
+    // every second round of patches gets merged into the existing deltas
+    for ( int i = 0; i < featuresCount; i++ )
+      dfw.addPatch( project, layer->id(), layer->id(), QStringLiteral( "fid" ), QStringLiteral( "fid" ), newFeatures[i], newerFeatures[i] );
+
+    return dfw.count();
+  };
+}
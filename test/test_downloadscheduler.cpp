@@ -0,0 +1,327 @@
+/***************************************************************************
+                        test_downloadscheduler.cpp
+                        --------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "downloadscheduler.h"
+
+#include <QNetworkAccessManager>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+
+#include <memory>
+
+
+TEST_CASE( "DownloadScheduler" )
+{
+  DownloadScheduler scheduler;
+  // stands in for the network, records the order in which the files are requested
+  QStringList requested;
+  QObject::connect( &scheduler, &DownloadScheduler::downloadRequested, &scheduler, [&requested]( const QString &fileKey ) {
+    requested << fileKey;
+  } );
+
+  SECTION( "Priority" )
+  {
+    REQUIRE( DownloadScheduler::priorityForFile( QStringLiteral( "project.qgs" ), false ) == DownloadScheduler::Priority::ProjectFile );
+    REQUIRE( DownloadScheduler::priorityForFile( QStringLiteral( "project.QGZ" ), false ) == DownloadScheduler::Priority::ProjectFile );
+    REQUIRE( DownloadScheduler::priorityForFile( QStringLiteral( "data.gpkg" ), false ) == DownloadScheduler::Priority::Layer );
+    REQUIRE( DownloadScheduler::priorityForFile( QStringLiteral( "DCIM/photo.jpg" ), true ) == DownloadScheduler::Priority::Attachment );
+
+    scheduler.setMaxParallelDownloads( 1 );
+    scheduler.enqueue( QStringLiteral( "p/DCIM/photo1.jpg" ), 10, DownloadScheduler::Priority::Attachment );
+    scheduler.enqueue( QStringLiteral( "p/data.gpkg" ), 10, DownloadScheduler::Priority::Layer );
+    scheduler.enqueue( QStringLiteral( "p/DCIM/photo2.jpg" ), 10, DownloadScheduler::Priority::Attachment );
+    scheduler.enqueue( QStringLiteral( "p/project.qgs" ), 10, DownloadScheduler::Priority::ProjectFile );
+    scheduler.enqueue( QStringLiteral( "p/tiles.mbtiles" ), 10, DownloadScheduler::Priority::Layer );
+
+    QSignalSpy finishedSpy( &scheduler, &DownloadScheduler::finished );
+
+    scheduler.start();
+    while ( scheduler.activeCount() > 0 )
+      scheduler.markFinished( requested.last() );
+
+    REQUIRE( requested == QStringList( { QStringLiteral( "p/project.qgs" ), QStringLiteral( "p/data.gpkg" ), QStringLiteral( "p/tiles.mbtiles" ), QStringLiteral( "p/DCIM/photo1.jpg" ), QStringLiteral( "p/DCIM/photo2.jpg" ) } ) );
+    REQUIRE( finishedSpy.count() == 1 );
+    REQUIRE( scheduler.finishedCount() == 5 );
+    REQUIRE( scheduler.bytesReceived() == 50 );
+  }
+
+
+  SECTION( "Parallelism" )
+  {
+    scheduler.setMaxParallelDownloads( 3 );
+    for ( int i = 0; i < 10; i++ )
+      scheduler.enqueue( QStringLiteral( "p/file%1.jpg" ).arg( i ), 100, DownloadScheduler::Priority::Attachment );
+
+    scheduler.start();
+    REQUIRE( requested.size() == 3 );
+    REQUIRE( scheduler.activeCount() == 3 );
+    REQUIRE( scheduler.queuedCount() == 7 );
+
+    scheduler.setBytesReceived( requested.at( 0 ), 50 );
+    REQUIRE( scheduler.bytesReceived() == 50 );
+    REQUIRE( scheduler.bytesTotal() == 1000 );
+
+    scheduler.markFinished( requested.at( 0 ) );
+    REQUIRE( requested.size() == 4 );
+    REQUIRE( scheduler.activeCount() == 3 );
+    REQUIRE( scheduler.bytesReceived() == 100 );
+
+    scheduler.setMaxParallelDownloads( 5 );
+    REQUIRE( requested.size() == 6 );
+    REQUIRE( scheduler.activeCount() == 5 );
+  }
+
+
+  SECTION( "SynchronousFinish" )
+  {
+    // files already present locally are reported as finished right from the request
+    QObject::connect( &scheduler, &DownloadScheduler::downloadRequested, &scheduler, [&scheduler]( const QString &fileKey ) {
+      scheduler.markFinished( fileKey );
+    } );
+
+    QSignalSpy finishedSpy( &scheduler, &DownloadScheduler::finished );
+
+    scheduler.setMaxParallelDownloads( 2 );
+    for ( int i = 0; i < 5; i++ )
+      scheduler.enqueue( QStringLiteral( "p/file%1.jpg" ).arg( i ), 100, DownloadScheduler::Priority::Attachment );
+
+    scheduler.start();
+
+    REQUIRE( requested.size() == 5 );
+    REQUIRE( scheduler.finishedCount() == 5 );
+    REQUIRE( finishedSpy.count() == 1 );
+  }
+
+
+  SECTION( "RetryWithBackoff" )
+  {
+    scheduler.setRetryBaseDelayMs( 10 );
+    scheduler.setMaxRetries( 2 );
+
+    REQUIRE( scheduler.retryDelayMs( 0 ) == 10 );
+    REQUIRE( scheduler.retryDelayMs( 1 ) == 20 );
+    REQUIRE( scheduler.retryDelayMs( 2 ) == 40 );
+
+    scheduler.enqueue( QStringLiteral( "p/data.gpkg" ), 100, DownloadScheduler::Priority::Layer );
+    scheduler.start();
+    REQUIRE( requested.size() == 1 );
+
+    scheduler.setBytesReceived( QStringLiteral( "p/data.gpkg" ), 60 );
+    REQUIRE( scheduler.markFailed( QStringLiteral( "p/data.gpkg" ), true ) );
+    REQUIRE( scheduler.bytesReceived() == 0 );
+    REQUIRE( scheduler.queuedCount() == 1 );
+    REQUIRE( scheduler.activeCount() == 0 );
+
+    REQUIRE( QSignalSpy( &scheduler, &DownloadScheduler::downloadRequested ).wait( 1000 ) );
+    REQUIRE( requested.size() == 2 );
+    REQUIRE( scheduler.retryCount( QStringLiteral( "p/data.gpkg" ) ) == 1 );
+
+    REQUIRE( scheduler.markFailed( QStringLiteral( "p/data.gpkg" ), true ) );
+    REQUIRE( QSignalSpy( &scheduler, &DownloadScheduler::downloadRequested ).wait( 1000 ) );
+    REQUIRE( requested.size() == 3 );
+
+    // no retries left
+    REQUIRE( !scheduler.markFailed( QStringLiteral( "p/data.gpkg" ), true ) );
+    REQUIRE( scheduler.failedCount() == 1 );
+    REQUIRE( scheduler.retriesCount() == 2 );
+  }
+
+
+  SECTION( "RetryFreesSlot" )
+  {
+    scheduler.setRetryBaseDelayMs( 60000 );
+    scheduler.setMaxParallelDownloads( 1 );
+
+    scheduler.enqueue( QStringLiteral( "p/data.gpkg" ), 100, DownloadScheduler::Priority::Layer );
+    scheduler.enqueue( QStringLiteral( "p/DCIM/photo.jpg" ), 100, DownloadScheduler::Priority::Attachment );
+    scheduler.start();
+    REQUIRE( requested.size() == 1 );
+
+    // the queued file does not wait for the retry backoff
+    REQUIRE( scheduler.markFailed( QStringLiteral( "p/data.gpkg" ), true ) );
+    REQUIRE( requested == QStringList( { QStringLiteral( "p/data.gpkg" ), QStringLiteral( "p/DCIM/photo.jpg" ) } ) );
+    REQUIRE( scheduler.activeCount() == 1 );
+    REQUIRE( scheduler.queuedCount() == 1 );
+  }
+
+
+  SECTION( "RetryKeepsPriority" )
+  {
+    scheduler.setRetryBaseDelayMs( 10 );
+    scheduler.setMaxParallelDownloads( 1 );
+
+    scheduler.enqueue( QStringLiteral( "p/DCIM/photo.jpg" ), 100, DownloadScheduler::Priority::Attachment );
+    scheduler.start();
+    REQUIRE( requested.size() == 1 );
+
+    scheduler.enqueue( QStringLiteral( "p/data.gpkg" ), 100, DownloadScheduler::Priority::Layer );
+    scheduler.enqueue( QStringLiteral( "p/tiles.mbtiles" ), 100, DownloadScheduler::Priority::Layer );
+
+    // the retried attachment does not overtake the pending layers
+    REQUIRE( scheduler.markFailed( QStringLiteral( "p/DCIM/photo.jpg" ), true ) );
+    REQUIRE( QSignalSpy( &scheduler, &DownloadScheduler::downloadRequested ).wait( 1000 ) );
+    while ( scheduler.activeCount() > 0 )
+      scheduler.markFinished( requested.last() );
+
+    REQUIRE( requested == QStringList( { QStringLiteral( "p/DCIM/photo.jpg" ), QStringLiteral( "p/data.gpkg" ), QStringLiteral( "p/tiles.mbtiles" ), QStringLiteral( "p/DCIM/photo.jpg" ) } ) );
+  }
+
+
+  SECTION( "NonRetryableFailureStopsQueue" )
+  {
+    QSignalSpy finishedSpy( &scheduler, &DownloadScheduler::finished );
+
+    scheduler.setMaxParallelDownloads( 1 );
+    scheduler.enqueue( QStringLiteral( "p/project.qgs" ), 100, DownloadScheduler::Priority::ProjectFile );
+    scheduler.enqueue( QStringLiteral( "p/data.gpkg" ), 100, DownloadScheduler::Priority::Layer );
+    scheduler.start();
+
+    REQUIRE( !scheduler.markFailed( QStringLiteral( "p/project.qgs" ), false ) );
+    REQUIRE( requested.size() == 1 );
+    REQUIRE( scheduler.queuedCount() == 1 );
+    REQUIRE( finishedSpy.count() == 0 );
+  }
+
+
+  SECTION( "RetryableErrors" )
+  {
+    REQUIRE( DownloadScheduler::isRetryableError( QNetworkReply::TimeoutError, 0 ) );
+    REQUIRE( DownloadScheduler::isRetryableError( QNetworkReply::UnknownContentError, 503 ) );
+    REQUIRE( DownloadScheduler::isRetryableError( QNetworkReply::UnknownContentError, 429 ) );
+    REQUIRE( !DownloadScheduler::isRetryableError( QNetworkReply::ContentNotFoundError, 404 ) );
+    REQUIRE( !DownloadScheduler::isRetryableError( QNetworkReply::AuthenticationRequiredError, 401 ) );
+  }
+
+
+  SECTION( "ThroughputAndEta" )
+  {
+    scheduler.enqueue( QStringLiteral( "p/data.gpkg" ), 1000, DownloadScheduler::Priority::Layer );
+    scheduler.start();
+
+    REQUIRE( scheduler.throughput() == 0.0 );
+    REQUIRE( scheduler.estimatedRemainingSecs() == -1 );
+
+    scheduler.setBytesReceived( QStringLiteral( "p/data.gpkg" ), 100 );
+    QThread::msleep( 50 );
+    scheduler.setBytesReceived( QStringLiteral( "p/data.gpkg" ), 200 );
+
+    REQUIRE( scheduler.throughput() > 0.0 );
+    REQUIRE( scheduler.estimatedRemainingSecs() >= 0 );
+  }
+}
+
+
+TEST_CASE( "DownloadSchedulerHttp" )
+{
+  // stands in for the QFieldCloud file storage, the first request of `retried.gpkg` fails with a server error
+  QTcpServer server;
+  REQUIRE( server.listen( QHostAddress::LocalHost ) );
+
+  const QHash<QString, qint64> fileSizes {
+    { QStringLiteral( "/project.qgs" ), 1024 },
+    { QStringLiteral( "/retried.gpkg" ), 64 * 1024 },
+    { QStringLiteral( "/DCIM/photo1.jpg" ), 16 * 1024 },
+    { QStringLiteral( "/DCIM/photo2.jpg" ), 16 * 1024 },
+    { QStringLiteral( "/DCIM/photo3.jpg" ), 16 * 1024 },
+  };
+
+  QStringList servedPaths;
+  QObject::connect( &server, &QTcpServer::newConnection, &server, [&] {
+    while ( QTcpSocket *socket = server.nextPendingConnection() )
+    {
+      std::shared_ptr<QByteArray> request = std::make_shared<QByteArray>();
+      QObject::connect( socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater );
+      QObject::connect( socket, &QTcpSocket::readyRead, socket, [&, socket, request] {
+        request->append( socket->readAll() );
+        if ( !request->contains( "\r\n\r\n" ) || socket->property( "answered" ).toBool() )
+          return;
+
+        socket->setProperty( "answered", true );
+
+        const QString path = QString::fromLatin1( request->split( ' ' ).value( 1 ) );
+        const bool fails = path == QLatin1String( "/retried.gpkg" ) && !servedPaths.contains( path );
+        servedPaths << path;
+
+        if ( fails )
+        {
+          socket->write( "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n" );
+        }
+        else
+        {
+          const qint64 size = fileSizes.value( path );
+          socket->write( QStringLiteral( "HTTP/1.1 200 OK\r\nContent-Length: %1\r\nConnection: close\r\n\r\n" ).arg( size ).toLatin1() );
+          socket->write( QByteArray( size, 'x' ) );
+        }
+        socket->disconnectFromHost();
+      } );
+    }
+  } );
+
+  DownloadScheduler scheduler;
+  scheduler.setMaxParallelDownloads( 2 );
+  scheduler.setRetryBaseDelayMs( 500 );
+
+  // transfers the requested files and reports back to the scheduler, like QFieldCloudProject does
+  QNetworkAccessManager networkAccessManager;
+  QHash<QString, qint64> downloadedSizes;
+  QObject::connect( &scheduler, &DownloadScheduler::downloadRequested, &scheduler, [&]( const QString &fileKey ) {
+    QNetworkReply *reply = networkAccessManager.get( QNetworkRequest( QUrl( QStringLiteral( "http://127.0.0.1:%1%2" ).arg( server.serverPort() ).arg( fileKey ) ) ) );
+    QObject::connect( reply, &QNetworkReply::downloadProgress, &scheduler, [&scheduler, fileKey]( qint64 bytesReceived, qint64 ) {
+      scheduler.setBytesReceived( fileKey, bytesReceived );
+    } );
+    QObject::connect( reply, &QNetworkReply::finished, &scheduler, [&, reply, fileKey] {
+      reply->deleteLater();
+
+      const int httpStatus = reply->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
+      if ( reply->error() != QNetworkReply::NoError )
+      {
+        scheduler.markFailed( fileKey, DownloadScheduler::isRetryableError( reply->error(), httpStatus ) );
+        return;
+      }
+
+      downloadedSizes.insert( fileKey, reply->readAll().size() );
+      scheduler.markFinished( fileKey );
+    } );
+  } );
+
+  qint64 bytesTotal = 0;
+  for ( auto it = fileSizes.constBegin(); it != fileSizes.constEnd(); ++it )
+  {
+    scheduler.enqueue( it.key(), it.value(), DownloadScheduler::priorityForFile( it.key(), it.key().startsWith( QLatin1String( "/DCIM/" ) ) ) );
+    bytesTotal += it.value();
+  }
+
+  QSignalSpy finishedSpy( &scheduler, &DownloadScheduler::finished );
+  scheduler.start();
+  REQUIRE( finishedSpy.wait( 10000 ) );
+
+  REQUIRE( scheduler.finishedCount() == fileSizes.size() );
+  REQUIRE( scheduler.failedCount() == 0 );
+  REQUIRE( scheduler.retriesCount() == 1 );
+  REQUIRE( scheduler.bytesTotal() == bytesTotal );
+  REQUIRE( scheduler.bytesReceived() == bytesTotal );
+  for ( auto it = fileSizes.constBegin(); it != fileSizes.constEnd(); ++it )
+    REQUIRE( downloadedSizes.value( it.key() ) == it.value() );
+
+  // the attachments are downloaded while the failed layer waits for its retry
+  REQUIRE( servedPaths.size() == fileSizes.size() + 1 );
+  REQUIRE( servedPaths.last() == QStringLiteral( "/retried.gpkg" ) );
+}
@@ -81,3 +81,127 @@ TEST_CASE( "FeatureHistory" )
   history->redo();
   REQUIRE( !history->isRedoAvailable() );
 }
+
+
+TEST_CASE( "FeatureHistoryMemoryBudget" )
+{
+  std::unique_ptr<QgsProject> project = std::make_unique<QgsProject>();
+  std::unique_ptr<FeatureHistory> history = std::make_unique<FeatureHistory>( project.get() );
+
+  std::unique_ptr<QgsVectorLayer> vl = std::make_unique<QgsVectorLayer>( QStringLiteral( "Polygon?crs=epsg:3946&field=fid:integer&field=str:string" ), QStringLiteral( "vl" ), QStringLiteral( "memory" ) );
+
+  const QgsGeometry geometry = QgsGeometry::fromWkt( QStringLiteral( "Polygon (((8 8, 9 8, 8 9, 8 8)))" ) );
+  const QgsGeometry changedGeometry = QgsGeometry::fromWkt( QStringLiteral( "Polygon (((8 8, 10 8, 8 10, 8 8)))" ) );
+  QgsFeature f = FeatureUtils::createFeature( vl.get(), geometry );
+  f.setAttribute( 1, QStringLiteral( "original" ) );
+  vl->dataProvider()->addFeature( f );
+
+  project->addMapLayer( vl.get() );
+
+  QEventLoop loop;
+  QObject::connect( history.get(), &FeatureHistory::isUndoAvailableChanged, &loop, &QEventLoop::quit );
+
+  REQUIRE( history->memoryUsage() == 0 );
+
+  vl->startEditing();
+  vl->changeAttributeValue( 1, 1, QStringLiteral( "changed" ) );
+  vl->changeGeometry( 1, changedGeometry );
+  vl->commitChanges();
+  loop.exec();
+
+  REQUIRE( history->isUndoAvailable() );
+  REQUIRE( history->memoryUsage() > 0 );
+
+  SECTION( "InMemory" )
+  {
+    REQUIRE( history->undo() );
+    REQUIRE( vl->getFeature( 1 ).attribute( 1 ) == QStringLiteral( "original" ) );
+    REQUIRE( vl->getFeature( 1 ).geometry().equals( geometry ) );
+    REQUIRE( history->memoryUsage() > 0 );
+
+    REQUIRE( history->redo() );
+    REQUIRE( vl->getFeature( 1 ).attribute( 1 ) == QStringLiteral( "changed" ) );
+    REQUIRE( vl->getFeature( 1 ).geometry().equals( changedGeometry ) );
+  }
+
+  SECTION( "Spilled" )
+  {
+    // all the steps are spilled to the history file
+    history->setMemoryBudget( 0 );
+    REQUIRE( history->memoryUsage() == 0 );
+
+    REQUIRE( history->undo() );
+    REQUIRE( vl->getFeature( 1 ).attribute( 1 ) == QStringLiteral( "original" ) );
+    REQUIRE( vl->getFeature( 1 ).geometry().equals( geometry ) );
+    REQUIRE( history->memoryUsage() == 0 );
+
+    REQUIRE( history->redo() );
+    REQUIRE( vl->getFeature( 1 ).attribute( 1 ) == QStringLiteral( "changed" ) );
+    REQUIRE( vl->getFeature( 1 ).geometry().equals( changedGeometry ) );
+    REQUIRE( history->undoMessage() == QStringLiteral( "Undo modifications on 1 feature(s) on layer vl." ) );
+  }
+}
+
+
+TEST_CASE( "FeatureHistoryFileCompaction" )
+{
+  std::unique_ptr<QgsProject> project = std::make_unique<QgsProject>();
+  std::unique_ptr<FeatureHistory> history = std::make_unique<FeatureHistory>( project.get() );
+
+  std::unique_ptr<QgsVectorLayer> vl = std::make_unique<QgsVectorLayer>( QStringLiteral( "Polygon?crs=epsg:3946&field=fid:integer&field=str:string" ), QStringLiteral( "vl" ), QStringLiteral( "memory" ) );
+
+  const QgsGeometry geometry = QgsGeometry::fromWkt( QStringLiteral( "Polygon (((8 8, 9 8, 8 9, 8 8)))" ) );
+  QgsFeatureList features;
+  for ( int i = 1; i <= 50; i++ )
+  {
+    QgsFeature f = FeatureUtils::createFeature( vl.get(), geometry );
+    f.setAttribute( 1, QStringLiteral( "original" ) );
+    features << f;
+  }
+  vl->dataProvider()->addFeatures( features );
+
+  project->addMapLayer( vl.get() );
+
+  QEventLoop loop;
+  QObject::connect( history.get(), &FeatureHistory::isUndoAvailableChanged, &loop, &QEventLoop::quit );
+
+  // all the steps are spilled to the history file
+  history->setMemoryBudget( 0 );
+
+  vl->startEditing();
+  vl->changeAttributeValue( 1, 1, QStringLiteral( "first" ) );
+  vl->commitChanges();
+  loop.exec();
+
+  vl->startEditing();
+  for ( int i = 1; i <= 50; i++ )
+    vl->changeAttributeValue( i, 1, QStringLiteral( "second" ) );
+  vl->commitChanges();
+  loop.exec();
+
+  REQUIRE( history->undo() );
+  REQUIRE( history->undo() );
+  REQUIRE( vl->getFeature( 1 ).attribute( 1 ) == QStringLiteral( "original" ) );
+  REQUIRE( history->redo() );
+  REQUIRE( vl->getFeature( 1 ).attribute( 1 ) == QStringLiteral( "first" ) );
+
+  // the first undo step taken back and the large redo step are left in the history file
+  const qint64 historyFileSize = history->historyFileSize();
+  REQUIRE( historyFileSize > 0 );
+
+  // a new step clears the redo steps, the undo step left is moved to the start of the history file
+  vl->startEditing();
+  vl->changeAttributeValue( 1, 1, QStringLiteral( "third" ) );
+  vl->commitChanges();
+  loop.exec();
+
+  REQUIRE( history->historyFileSize() < historyFileSize );
+  REQUIRE( history->memoryUsage() == 0 );
+
+  REQUIRE( history->undo() );
+  REQUIRE( vl->getFeature( 1 ).attribute( 1 ) == QStringLiteral( "first" ) );
+  REQUIRE( history->undo() );
+  REQUIRE( vl->getFeature( 1 ).attribute( 1 ) == QStringLiteral( "original" ) );
+  REQUIRE( vl->getFeature( 2 ).attribute( 1 ) == QStringLiteral( "original" ) );
+  REQUIRE( !history->isUndoAvailable() );
+}
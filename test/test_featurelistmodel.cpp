@@ -0,0 +1,126 @@
+/***************************************************************************
+                        test_featurelistmodel.cpp
+                        -------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "featurechecklistmodel.h"
+#include "featurelistmodel.h"
+
+#include <QSignalSpy>
+#include <qgsvectorlayer.h>
+
+
+TEST_CASE( "FeatureListModel" )
+{
+  std::unique_ptr<QgsVectorLayer> layer = std::make_unique<QgsVectorLayer>( QStringLiteral( "Point?crs=EPSG:3857&field=id:integer&field=name:string&field=category:string" ), QStringLiteral( "layer" ), QStringLiteral( "memory" ) );
+  REQUIRE( layer->isValid() );
+
+  const QStringList names = { QStringLiteral( "delta" ), QStringLiteral( "Alpha" ), QStringLiteral( "charlie" ), QStringLiteral( "Bravo" ), QStringLiteral( "echo" ) };
+  const QStringList categories = { QStringLiteral( "b" ), QStringLiteral( "b" ), QStringLiteral( "a" ), QStringLiteral( "a" ), QStringLiteral( "b" ) };
+  QgsFeatureList features;
+  for ( int i = 0; i < names.size(); i++ )
+  {
+    QgsFeature feature( layer->fields() );
+    feature.setAttribute( QStringLiteral( "id" ), i + 1 );
+    feature.setAttribute( QStringLiteral( "name" ), names.at( i ) );
+    feature.setAttribute( QStringLiteral( "category" ), categories.at( i ) );
+    features << feature;
+  }
+  REQUIRE( layer->dataProvider()->addFeatures( features ) );
+
+  FeatureListModel model;
+  QSignalSpy entriesCountSpy( &model, &FeatureListModel::entriesCountChanged );
+
+  model.setKeyField( QStringLiteral( "id" ) );
+  model.setDisplayValueField( QStringLiteral( "name" ) );
+
+  auto displayStrings = [&model]() {
+    QStringList strings;
+    for ( int i = 0; i < model.rowCount(); i++ )
+      strings << model.dataFromRowIndex( i, FeatureListModel::DisplayStringRole ).toString();
+    return strings;
+  };
+
+  SECTION( "OrderByValue" )
+  {
+    model.setOrderByValue( true );
+    model.setCurrentLayer( layer.get() );
+    REQUIRE( entriesCountSpy.wait( 5000 ) );
+
+    REQUIRE( displayStrings() == QStringList( { QStringLiteral( "Alpha" ), QStringLiteral( "Bravo" ), QStringLiteral( "charlie" ), QStringLiteral( "delta" ), QStringLiteral( "echo" ) } ) );
+  }
+
+
+  SECTION( "OrderByGroup" )
+  {
+    model.setGroupField( QStringLiteral( "category" ) );
+    model.setCurrentLayer( layer.get() );
+    REQUIRE( entriesCountSpy.wait( 5000 ) );
+
+    REQUIRE( displayStrings() == QStringList( { QStringLiteral( "Bravo" ), QStringLiteral( "charlie" ), QStringLiteral( "Alpha" ), QStringLiteral( "delta" ), QStringLiteral( "echo" ) } ) );
+  }
+
+
+  SECTION( "Paging" )
+  {
+    model.setOrderByValue( true );
+    model.setPageSize( 2 );
+    model.setCurrentLayer( layer.get() );
+    REQUIRE( entriesCountSpy.wait( 5000 ) );
+
+    REQUIRE( model.entriesCount() == 5 );
+    REQUIRE( model.rowCount() == 2 );
+    REQUIRE( model.canFetchMore( QModelIndex() ) );
+
+    model.fetchMore( QModelIndex() );
+    REQUIRE( model.rowCount() == 4 );
+
+    // finding a row beyond the fetched ones fetches it
+    REQUIRE( model.findKey( 5 ) == 4 );
+    REQUIRE( model.rowCount() == 5 );
+    REQUIRE( !model.canFetchMore( QModelIndex() ) );
+
+    model.setPageSize( 0 );
+    REQUIRE( model.rowCount() == 5 );
+  }
+
+  SECTION( "CheckListPaging" )
+  {
+    FeatureCheckListModel checkListModel;
+    FeatureListModel *sourceModel = qobject_cast<FeatureListModel *>( checkListModel.sourceModel() );
+    QSignalSpy sourceEntriesCountSpy( sourceModel, &FeatureListModel::entriesCountChanged );
+
+    checkListModel.setKeyField( QStringLiteral( "id" ) );
+    checkListModel.setDisplayValueField( QStringLiteral( "name" ) );
+    checkListModel.setOrderByValue( true );
+    checkListModel.setPageSize( 2 );
+    checkListModel.setCurrentLayer( layer.get() );
+    REQUIRE( sourceEntriesCountSpy.wait( 5000 ) );
+    REQUIRE( checkListModel.rowCount() == 2 );
+
+    // searching covers the rows not fetched yet
+    checkListModel.setSearchTerm( QStringLiteral( "echo" ) );
+    REQUIRE( checkListModel.rowCount() == 1 );
+
+    checkListModel.setSearchTerm( QString() );
+    REQUIRE( checkListModel.rowCount() == 2 );
+
+    // the multiple values list shows all rows
+    checkListModel.setAllowMulti( true );
+    REQUIRE( checkListModel.rowCount() == 5 );
+  }
+}
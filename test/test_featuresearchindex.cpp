@@ -0,0 +1,176 @@
+/***************************************************************************
+                        test_featuresearchindex.cpp
+                        ---------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "locator/featuresearchindex.h"
+
+#include <QSignalSpy>
+#include <qgsexpressioncontextutils.h>
+#include <qgsvectorlayer.h>
+
+
+static std::unique_ptr<QgsVectorLayer> createLayer( const QStringList &names )
+{
+  std::unique_ptr<QgsVectorLayer> layer = std::make_unique<QgsVectorLayer>( QStringLiteral( "Point?crs=EPSG:3857&field=id:integer&field=name:string&field=comment:string" ), QStringLiteral( "layer" ), QStringLiteral( "memory" ) );
+  layer->setDisplayExpression( QStringLiteral( "'Feature ' || \"id\"" ) );
+
+  QgsFeatureList features;
+  for ( int i = 0; i < names.size(); i++ )
+  {
+    QgsFeature feature( layer->fields() );
+    feature.setAttribute( QStringLiteral( "id" ), i + 1 );
+    feature.setAttribute( QStringLiteral( "name" ), names.at( i ) );
+    features << feature;
+  }
+  layer->dataProvider()->addFeatures( features );
+  return layer;
+}
+
+
+TEST_CASE( "FeatureSearchIndex" )
+{
+  std::unique_ptr<QgsVectorLayer> layer = createLayer( { QStringLiteral( "Rue du Marché" ), QStringLiteral( "Marktgasse" ), QStringLiteral( "Bahnhofstrasse" ), QStringLiteral( "Route de la Gare" ) } );
+  REQUIRE( layer->isValid() );
+
+  // small layers are only indexed on demand
+  REQUIRE( !FeatureSearchIndex::isIndexable( layer.get() ) );
+  REQUIRE( !FeatureSearchIndex::indexForLayer( layer.get() ) );
+  layer->setCustomProperty( QStringLiteral( "QFieldSync/search_index" ), true );
+  REQUIRE( FeatureSearchIndex::isIndexable( layer.get() ) );
+
+  FeatureSearchIndex *index = FeatureSearchIndex::indexForLayer( layer.get() );
+  REQUIRE( index );
+  REQUIRE( FeatureSearchIndex::indexForLayer( layer.get() ) == index );
+
+  QgsFeatureIds candidates;
+  if ( !index->isReady() )
+  {
+    REQUIRE( !index->candidates( QStringLiteral( "markt" ), candidates ) );
+    QSignalSpy readySpy( index, &FeatureSearchIndex::readyChanged );
+    REQUIRE( readySpy.wait( 5000 ) );
+  }
+  REQUIRE( index->isReady() );
+
+  SECTION( "Candidates" )
+  {
+    REQUIRE( index->candidates( QStringLiteral( "MARKT" ), candidates ) );
+    REQUIRE( candidates == QgsFeatureIds( { 2 } ) );
+
+    // every part of the search string between wildcards must match
+    REQUIRE( index->candidates( QStringLiteral( "rue marché" ), candidates ) );
+    REQUIRE( candidates == QgsFeatureIds( { 1 } ) );
+    REQUIRE( index->candidates( QStringLiteral( "ro%gare" ), candidates ) );
+    REQUIRE( candidates == QgsFeatureIds( { 4 } ) );
+    REQUIRE( index->candidates( QStringLiteral( "strasse zurich" ), candidates ) );
+    REQUIRE( candidates.isEmpty() );
+
+    // the display expression is indexed too
+    REQUIRE( index->candidates( QStringLiteral( "feature" ), candidates ) );
+    REQUIRE( candidates == QgsFeatureIds( { 1, 2, 3, 4 } ) );
+
+    // too short to narrow down the search
+    REQUIRE( !index->candidates( QStringLiteral( "ma" ), candidates ) );
+    REQUIRE( !index->candidates( QStringLiteral( "ru de" ), candidates ) );
+  }
+
+
+  SECTION( "Edits" )
+  {
+    REQUIRE( layer->startEditing() );
+    REQUIRE( layer->changeAttributeValue( 3, 1, QStringLiteral( "Marktplatz" ) ) );
+
+    QgsFeature feature( layer->fields() );
+    feature.setAttribute( QStringLiteral( "id" ), 5 );
+    feature.setAttribute( QStringLiteral( "name" ), QStringLiteral( "Untere Gasse" ) );
+    REQUIRE( layer->addFeature( feature ) );
+
+    // edited features are always candidates, the locator filters do the actual matching
+    REQUIRE( index->candidates( QStringLiteral( "markt" ), candidates ) );
+    REQUIRE( candidates.contains( 2 ) );
+    REQUIRE( candidates.contains( 3 ) );
+    REQUIRE( candidates.contains( feature.id() ) );
+    REQUIRE( candidates.size() == 3 );
+
+    REQUIRE( layer->commitChanges() );
+    REQUIRE( index->isReady() );
+    REQUIRE( index->candidates( QStringLiteral( "markt" ), candidates ) );
+    REQUIRE( candidates.contains( 3 ) );
+
+    QSignalSpy readySpy( index, &FeatureSearchIndex::readyChanged );
+    layer->setDisplayExpression( QStringLiteral( "\"name\"" ) );
+    REQUIRE( !index->isReady() );
+    REQUIRE( readySpy.wait( 5000 ) );
+    REQUIRE( index->isReady() );
+    REQUIRE( index->candidates( QStringLiteral( "markt" ), candidates ) );
+    REQUIRE( candidates == QgsFeatureIds( { 2, 3 } ) );
+  }
+}
+
+
+TEST_CASE( "FeatureSearchIndexBenchmark", "[.][benchmark]" )
+{
+  const QStringList words = { QStringLiteral( "Rue" ), QStringLiteral( "Chemin" ), QStringLiteral( "Allee" ), QStringLiteral( "Weg" ), QStringLiteral( "Strasse" ), QStringLiteral( "Gasse" ), QStringLiteral( "Platz" ), QStringLiteral( "Ring" ) };
+  QStringList names;
+  for ( int i = 0; i < 200000; i++ )
+  {
+    names << QStringLiteral( "%1 %2 %3" ).arg( words.at( i % words.size() ) ).arg( i ).arg( words.at( ( i / words.size() ) % words.size() ) );
+  }
+
+  std::unique_ptr<QgsVectorLayer> layer = createLayer( names );
+  REQUIRE( layer->isValid() );
+  REQUIRE( FeatureSearchIndex::isIndexable( layer.get() ) );
+
+  FeatureSearchIndex *index = FeatureSearchIndex::indexForLayer( layer.get() );
+  QSignalSpy readySpy( index, &FeatureSearchIndex::readyChanged );
+  REQUIRE( readySpy.wait( 60000 ) );
+
+  const QString filterString = QStringLiteral( "\"name\" ILIKE '%chemin%1234%'" );
+
+  BENCHMARK( "ILIKE scan of 200000 features" )
+  {
+    QgsFeatureRequest request;
+    request.setFilterExpression( filterString );
+    int count = 0;
+    QgsFeature feature;
+    QgsFeatureIterator it = layer->getFeatures( request );
+    while ( it.nextFeature( feature ) )
+      count++;
+    return count;
+  };
+
+  BENCHMARK( "Search index candidates of 200000 features" )
+  {
+    QgsExpressionContext context;
+    context.appendScopes( QgsExpressionContextUtils::globalProjectLayerScopes( layer.get() ) );
+    QgsExpression expression( filterString );
+    expression.prepare( &context );
+
+    QgsFeatureIds candidates;
+    index->candidates( QStringLiteral( "chemin 1234" ), candidates );
+    int count = 0;
+    QgsFeature feature;
+    QgsFeatureIterator it = layer->getFeatures( QgsFeatureRequest( candidates ) );
+    while ( it.nextFeature( feature ) )
+    {
+      context.setFeature( feature );
+      if ( expression.evaluate( &context ).toBool() )
+        count++;
+    }
+    return count;
+  };
+}
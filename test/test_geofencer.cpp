@@ -0,0 +1,135 @@
+/***************************************************************************
+                        test_geofencer.cpp
+                        ------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "positioning/geofencer.h"
+
+#include <QSignalSpy>
+#include <qgsvectorlayer.h>
+
+
+static std::unique_ptr<QgsVectorLayer> createAreasLayer()
+{
+  std::unique_ptr<QgsVectorLayer> layer = std::make_unique<QgsVectorLayer>( QStringLiteral( "Polygon?crs=EPSG:3857&field=name:string" ), QStringLiteral( "areas" ), QStringLiteral( "memory" ) );
+  layer->setDisplayExpression( QStringLiteral( "\"name\"" ) );
+  return layer;
+}
+
+static void addArea( QgsVectorLayer *layer, const QString &name, const QgsGeometry &geometry )
+{
+  QgsFeature feature( layer->fields() );
+  feature.setAttribute( QStringLiteral( "name" ), name );
+  feature.setGeometry( geometry );
+  layer->dataProvider()->addFeature( feature );
+}
+
+
+TEST_CASE( "Geofencer" )
+{
+  std::unique_ptr<QgsVectorLayer> layer = createAreasLayer();
+  REQUIRE( layer->isValid() );
+
+  addArea( layer.get(), QStringLiteral( "A" ), QgsGeometry::fromWkt( QStringLiteral( "Polygon ((0 0, 10 0, 10 10, 0 10, 0 0))" ) ) );
+  addArea( layer.get(), QStringLiteral( "B" ), QgsGeometry::fromWkt( QStringLiteral( "Polygon ((20 0, 30 0, 30 10, 20 10, 20 0))" ) ) );
+  // a triangle sharing its bounding box with C, but not its bottom-right corner
+  addArea( layer.get(), QStringLiteral( "C" ), QgsGeometry::fromWkt( QStringLiteral( "Polygon ((40 0, 50 10, 40 10, 40 0))" ) ) );
+  // overlaps A
+  addArea( layer.get(), QStringLiteral( "D" ), QgsGeometry::fromWkt( QStringLiteral( "Polygon ((5 5, 15 5, 15 15, 5 15, 5 5))" ) ) );
+
+  Geofencer geofencer;
+  geofencer.setActive( true );
+  geofencer.setPositionCrs( QgsCoordinateReferenceSystem( QStringLiteral( "EPSG:3857" ) ) );
+  geofencer.setPosition( QgsPoint( 2, 2 ) );
+
+  QSignalSpy isWithinSpy( &geofencer, &Geofencer::isWithinChanged );
+  geofencer.setAreasLayer( layer.get() );
+  REQUIRE( isWithinSpy.wait( 5000 ) );
+
+  REQUIRE( geofencer.isWithin() );
+  REQUIRE( geofencer.isWithinAreaName() == QStringLiteral( "A" ) );
+
+  geofencer.setPosition( QgsPoint( 25, 5 ) );
+  REQUIRE( geofencer.isWithinAreaName() == QStringLiteral( "B" ) );
+  REQUIRE( geofencer.lastWithinAreaName() == QStringLiteral( "A" ) );
+
+  // within the bounding box of C only
+  geofencer.setPosition( QgsPoint( 48, 2 ) );
+  REQUIRE( !geofencer.isWithin() );
+  REQUIRE( geofencer.lastWithinAreaName() == QStringLiteral( "B" ) );
+
+  geofencer.setPosition( QgsPoint( 42, 8 ) );
+  REQUIRE( geofencer.isWithinAreaName() == QStringLiteral( "C" ) );
+
+  // the first area in the layer order wins when entering overlapping areas
+  geofencer.setPosition( QgsPoint( 100, 100 ) );
+  REQUIRE( !geofencer.isWithin() );
+  geofencer.setPosition( QgsPoint( 7, 7 ) );
+  REQUIRE( geofencer.isWithinAreaName() == QStringLiteral( "A" ) );
+
+  // leaving A into D
+  geofencer.setPosition( QgsPoint( 12, 12 ) );
+  REQUIRE( geofencer.isWithinAreaName() == QStringLiteral( "D" ) );
+
+  geofencer.setBehavior( Geofencer::AlertWhenOutsideGeofencedArea );
+  REQUIRE( !geofencer.isAlerting() );
+  geofencer.setPosition( QgsPoint( -5, -5 ) );
+  REQUIRE( geofencer.isAlerting() );
+}
+
+
+TEST_CASE( "GeofencerBenchmark", "[.][benchmark]" )
+{
+  std::unique_ptr<QgsVectorLayer> layer = createAreasLayer();
+  REQUIRE( layer->isValid() );
+
+  // a 100 x 50 grid of complex areas
+  const int columns = 100;
+  const int rows = 50;
+  for ( int i = 0; i < columns; i++ )
+  {
+    for ( int j = 0; j < rows; j++ )
+    {
+      addArea( layer.get(), QStringLiteral( "%1-%2" ).arg( i ).arg( j ), QgsGeometry::fromPointXY( QgsPointXY( i * 100 + 50, j * 100 + 50 ) ).buffer( 45, 64 ) );
+    }
+  }
+
+  Geofencer geofencer;
+  geofencer.setActive( true );
+  geofencer.setPositionCrs( QgsCoordinateReferenceSystem( QStringLiteral( "EPSG:3857" ) ) );
+  geofencer.setPosition( QgsPoint( 50, 50 ) );
+
+  QSignalSpy isWithinSpy( &geofencer, &Geofencer::isWithinChanged );
+  geofencer.setAreasLayer( layer.get() );
+  REQUIRE( isWithinSpy.wait( 30000 ) );
+
+  // a walk through the areas, one fix per meter
+  QList<QgsPoint> positions;
+  for ( int i = 0; i < 1000; i++ )
+    positions << QgsPoint( 50 + i, 50 + i % 100 );
+
+  BENCHMARK( "1000 fixes within 5000 areas" )
+  {
+    int withinCount = 0;
+    for ( const QgsPoint &position : std::as_const( positions ) )
+    {
+      geofencer.setPosition( position );
+      withinCount += geofencer.isWithin() ? 1 : 0;
+    }
+    return withinCount;
+  };
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+                        test_identifytool.cpp
+                        ---------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "identifytool.h"
+#include "multifeaturelistmodel.h"
+#include "qgsquickmapsettings.h"
+
+#include <QSettings>
+#include <QSignalSpy>
+#include <qgsvectorlayer.h>
+
+
+TEST_CASE( "IdentifyTool" )
+{
+  std::unique_ptr<QgsVectorLayer> layer = std::make_unique<QgsVectorLayer>( QStringLiteral( "Point?crs=EPSG:3857&field=fid:integer" ), QStringLiteral( "points" ), QStringLiteral( "memory" ) );
+  QgsFeatureList features;
+  for ( int i = 0; i < 1000; i++ )
+  {
+    QgsFeature feature( layer->fields() );
+    feature.setAttribute( 0, i );
+    feature.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( 50, 50 ) ) );
+    features << feature;
+  }
+  layer->dataProvider()->addFeatures( features );
+
+  // the identify results are capped by the configured limit, the features outnumber it to keep the jobs busy
+  const int identifyLimit = QSettings().value( "/QField/identify/limit", 200 ).toInt();
+  const int expectedCount = std::min( identifyLimit, static_cast<int>( features.size() ) );
+
+  QgsQuickMapSettings mapSettings;
+  mapSettings.setDestinationCrs( QgsCoordinateReferenceSystem( QStringLiteral( "EPSG:3857" ) ) );
+  mapSettings.setOutputSize( QSize( 100, 100 ) );
+  mapSettings.setExtent( QgsRectangle( 0, 0, 100, 100 ) );
+  mapSettings.setLayers( QList<QgsMapLayer *>() << layer.get() );
+
+  MultiFeatureListModel model;
+
+  IdentifyTool identifyTool;
+  identifyTool.setMapSettings( &mapSettings );
+  identifyTool.setModel( &model );
+
+  QSignalSpy finishedSpy( &identifyTool, &IdentifyTool::identifyFinished );
+
+  auto waitForFinished = [&finishedSpy]( int timeout ) {
+    if ( finishedSpy.isEmpty() )
+      finishedSpy.wait( timeout );
+  };
+
+  SECTION( "Identify" )
+  {
+    identifyTool.identify( QPointF( 50, 50 ) );
+    waitForFinished( 5000 );
+
+    REQUIRE( finishedSpy.count() == 1 );
+    REQUIRE( model.count() == expectedCount );
+  }
+
+  SECTION( "CancelInFlight" )
+  {
+    identifyTool.identify( QPointF( 50, 50 ) );
+    identifyTool.cancel();
+
+    // the canceled jobs finish in the background, none of their results may reach the model
+    waitForFinished( 1000 );
+
+    REQUIRE( finishedSpy.isEmpty() );
+    REQUIRE( model.count() == 0 );
+
+    // a new identify after a cancel is not affected by the canceled one
+    identifyTool.identify( QPointF( 50, 50 ) );
+    waitForFinished( 5000 );
+
+    REQUIRE( finishedSpy.count() == 1 );
+    REQUIRE( model.count() == expectedCount );
+  }
+
+  SECTION( "LayerDeletedInFlight" )
+  {
+    identifyTool.identify( QPointF( 50, 50 ) );
+
+    // the job results are only handled back on the main thread, after the layer is gone
+    mapSettings.setLayers( QList<QgsMapLayer *>() );
+    layer.reset();
+
+    waitForFinished( 5000 );
+
+    REQUIRE( finishedSpy.count() == 1 );
+    REQUIRE( model.count() == 0 );
+  }
+}
@@ -218,4 +218,52 @@ TEST_CASE( "LayerObserver" )
     REQUIRE( mLayer->commitChanges() );
     REQUIRE( getDeltaOperations( mLayerObserver->deltaFileWrapper()->fileName() ) == QStringList( { "patch", "patch" } ) );
   }
+
+
+  SECTION( "SnapshotChangedValuesOnly" )
+  {
+    REQUIRE( mLayerObserver->snapshotMode() == LayerObserver::SnapshotMode::ChangedValuesSnapshot );
+
+    QgsFeature f1 = mLayer->getFeature( 2 );
+    f1.setAttribute( QStringLiteral( "str" ), QStringLiteral( "string2_new" ) );
+
+    REQUIRE( mLayer->startEditing() );
+    REQUIRE( mLayer->updateFeature( f1 ) );
+    REQUIRE( mLayer->commitChanges() );
+    REQUIRE( getDeltaOperations( mLayerObserver->deltaFileWrapper()->fileName() ) == QStringList( { "patch" } ) );
+
+    const LayerObserver::SnapshotStatistics statistics = mLayerObserver->lastSnapshotStatistics();
+    REQUIRE( statistics.layerId == mLayer->id() );
+    REQUIRE( statistics.featuresCount == 1 );
+    REQUIRE( statistics.attributeValuesCount == 1 );
+    REQUIRE( statistics.geometriesCount == 0 );
+    REQUIRE( statistics.requestsCount == 1 );
+
+    const QJsonArray deltas = mLayerObserver->deltaFileWrapper()->deltas();
+    const QJsonObject oldData = deltas.at( 0 ).toObject().value( QStringLiteral( "old" ) ).toObject();
+    const QJsonObject newData = deltas.at( 0 ).toObject().value( QStringLiteral( "new" ) ).toObject();
+    // the unchanged values of the old feature snapshot are completed from the new feature
+    REQUIRE( oldData.value( QStringLiteral( "attributes" ) ).toObject() == QJsonObject( { { QStringLiteral( "fid" ), 2 }, { QStringLiteral( "str" ), QStringLiteral( "string2" ) } } ) );
+    REQUIRE( newData.value( QStringLiteral( "attributes" ) ).toObject() == QJsonObject( { { QStringLiteral( "str" ), QStringLiteral( "string2_new" ) } } ) );
+    REQUIRE( !oldData.value( QStringLiteral( "geometry" ) ).toString().isEmpty() );
+  }
+
+
+  SECTION( "SnapshotFull" )
+  {
+    mLayerObserver->setSnapshotMode( LayerObserver::SnapshotMode::FullSnapshot );
+
+    QgsFeature f1 = mLayer->getFeature( 2 );
+    f1.setAttribute( QStringLiteral( "str" ), QStringLiteral( "string2_new" ) );
+
+    REQUIRE( mLayer->startEditing() );
+    REQUIRE( mLayer->updateFeature( f1 ) );
+    REQUIRE( mLayer->commitChanges() );
+    REQUIRE( getDeltaOperations( mLayerObserver->deltaFileWrapper()->fileName() ) == QStringList( { "patch" } ) );
+
+    const LayerObserver::SnapshotStatistics statistics = mLayerObserver->lastSnapshotStatistics();
+    REQUIRE( statistics.featuresCount == 1 );
+    REQUIRE( statistics.attributeValuesCount == 2 );
+    REQUIRE( statistics.geometriesCount == 1 );
+  }
 }
@@ -0,0 +1,58 @@
+/***************************************************************************
+                        test_localfilesimageprovider.cpp
+                        --------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "catch2.h"
+#include "localfilesimageprovider.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+
+
+static bool writeFile( const QString &fileName, const QDateTime &lastModified )
+{
+  QFile file( fileName );
+  if ( !file.open( QFile::WriteOnly ) )
+    return false;
+
+  file.write( QByteArray( "thumbnail" ) );
+  file.flush();
+  return file.setFileTime( lastModified, QFileDevice::FileModificationTime );
+}
+
+
+TEST_CASE( "LocalFilesImageProvider" )
+{
+  QTemporaryDir dir;
+  REQUIRE( dir.isValid() );
+
+  SECTION( "PruneCache" )
+  {
+    const QDateTime now = QDateTime::currentDateTime();
+    REQUIRE( writeFile( dir.filePath( QStringLiteral( "recent.png" ) ), now.addDays( -1 ) ) );
+    REQUIRE( writeFile( dir.filePath( QStringLiteral( "old.png" ) ), now.addDays( -40 ) ) );
+    REQUIRE( writeFile( dir.filePath( QStringLiteral( "old.png.1234.tmp" ) ), now.addDays( -40 ) ) );
+    REQUIRE( writeFile( dir.filePath( QStringLiteral( "other.txt" ) ), now.addDays( -40 ) ) );
+
+    LocalFilesImageProvider::pruneCache( dir.path(), 30 );
+
+    REQUIRE( QFile::exists( dir.filePath( QStringLiteral( "recent.png" ) ) ) );
+    REQUIRE_FALSE( QFile::exists( dir.filePath( QStringLiteral( "old.png" ) ) ) );
+    REQUIRE_FALSE( QFile::exists( dir.filePath( QStringLiteral( "old.png.1234.tmp" ) ) ) );
+    REQUIRE( QFile::exists( dir.filePath( QStringLiteral( "other.txt" ) ) ) );
+  }
+}
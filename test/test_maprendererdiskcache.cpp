@@ -0,0 +1,140 @@
+/***************************************************************************
+                        test_maprendererdiskcache.cpp
+                        -----------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "maprendererdiskcache.h"
+
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <qgsmapsettings.h>
+#include <qgsvectorlayer.h>
+
+
+static QImage createImage( const QColor &color )
+{
+  QImage image( 64, 32, QImage::Format_ARGB32_Premultiplied );
+  image.fill( color );
+  return image;
+}
+
+
+TEST_CASE( "MapRendererDiskCache" )
+{
+  QTemporaryDir tmpDir;
+  REQUIRE( tmpDir.isValid() );
+
+  std::unique_ptr<QgsVectorLayer> layer = std::make_unique<QgsVectorLayer>( QStringLiteral( "Point?crs=EPSG:3857&field=name:string" ), QStringLiteral( "layer" ), QStringLiteral( "memory" ) );
+  REQUIRE( layer->isValid() );
+
+  QgsMapSettings mapSettings;
+  mapSettings.setDestinationCrs( QgsCoordinateReferenceSystem( QStringLiteral( "EPSG:3857" ) ) );
+  mapSettings.setOutputSize( QSize( 64, 32 ) );
+  mapSettings.setExtent( QgsRectangle( 0, 0, 640, 320 ) );
+  mapSettings.setLayers( QList<QgsMapLayer *>() << layer.get() );
+
+  SECTION( "Cacheable" )
+  {
+    // editable layers are never persisted
+    REQUIRE( !MapRendererDiskCache::isCacheable( layer.get() ) );
+    layer->setReadOnly( true );
+    REQUIRE( MapRendererDiskCache::isCacheable( layer.get() ) );
+    REQUIRE( !MapRendererDiskCache::isCacheable( nullptr ) );
+  }
+
+
+  SECTION( "Key" )
+  {
+    const QString key = MapRendererDiskCache::key( layer.get(), mapSettings );
+    REQUIRE( key == MapRendererDiskCache::key( layer.get(), mapSettings ) );
+    REQUIRE( key == MapRendererDiskCache::key( layer.get(), MapRendererDiskCache::styleHash( layer.get() ), mapSettings ) );
+
+    // a sub-pixel difference of extent keeps the key
+    QgsMapSettings otherMapSettings = mapSettings;
+    otherMapSettings.setExtent( QgsRectangle( 0.0001, 0, 640.0001, 320 ) );
+    REQUIRE( MapRendererDiskCache::key( layer.get(), otherMapSettings ) == key );
+
+    otherMapSettings.setExtent( QgsRectangle( 100, 0, 740, 320 ) );
+    REQUIRE( MapRendererDiskCache::key( layer.get(), otherMapSettings ) != key );
+
+    otherMapSettings = mapSettings;
+    otherMapSettings.setOutputDpi( mapSettings.outputDpi() * 2 );
+    REQUIRE( MapRendererDiskCache::key( layer.get(), otherMapSettings ) != key );
+
+    const QByteArray styleHash = MapRendererDiskCache::styleHash( layer.get() );
+    layer->setOpacity( 0.5 );
+    REQUIRE( MapRendererDiskCache::styleHash( layer.get() ) != styleHash );
+    REQUIRE( MapRendererDiskCache::key( layer.get(), mapSettings ) != key );
+  }
+
+
+  SECTION( "InsertAndInvalidate" )
+  {
+    const QString key = MapRendererDiskCache::key( layer.get(), mapSettings );
+    {
+      MapRendererDiskCache cache( tmpDir.path() );
+      REQUIRE( !cache.contains( layer->id(), key ) );
+      REQUIRE( cache.image( layer->id(), key ).isNull() );
+      cache.insert( layer->id(), key, createImage( Qt::red ) );
+    }
+
+    // the images outlive the cache instance
+    MapRendererDiskCache cache( tmpDir.path() );
+    REQUIRE( cache.contains( layer->id(), key ) );
+    const QImage image = cache.image( layer->id(), key );
+    REQUIRE( image.size() == QSize( 64, 32 ) );
+    REQUIRE( image.pixelColor( 10, 10 ) == QColor( Qt::red ) );
+
+    cache.invalidate( layer->id() );
+    REQUIRE( !cache.contains( layer->id(), key ) );
+    REQUIRE( cache.image( layer->id(), key ).isNull() );
+  }
+
+
+  SECTION( "Eviction" )
+  {
+    qint64 imageSize = 0;
+    {
+      MapRendererDiskCache cache( tmpDir.path() );
+      cache.insert( layer->id(), QStringLiteral( "a" ), createImage( Qt::red ) );
+    }
+    imageSize = QFileInfo( QStringLiteral( "%1/%2/a.png" ).arg( tmpDir.path(), layer->id() ) ).size();
+    REQUIRE( imageSize > 0 );
+
+    MapRendererDiskCache cache( tmpDir.path(), imageSize * 5 / 2 );
+    QThread::msleep( 20 );
+    {
+      MapRendererDiskCache writingCache( tmpDir.path(), imageSize * 5 / 2 );
+      writingCache.insert( layer->id(), QStringLiteral( "b" ), createImage( Qt::green ) );
+    }
+
+    // reading an image marks it as recently used
+    QThread::msleep( 20 );
+    REQUIRE( !cache.image( layer->id(), QStringLiteral( "a" ) ).isNull() );
+    QThread::msleep( 20 );
+
+    {
+      MapRendererDiskCache writingCache( tmpDir.path(), imageSize * 5 / 2 );
+      writingCache.insert( layer->id(), QStringLiteral( "c" ), createImage( Qt::blue ) );
+    }
+
+    REQUIRE( cache.contains( layer->id(), QStringLiteral( "a" ) ) );
+    REQUIRE( !cache.contains( layer->id(), QStringLiteral( "b" ) ) );
+    REQUIRE( cache.contains( layer->id(), QStringLiteral( "c" ) ) );
+  }
+}
@@ -0,0 +1,254 @@
+/***************************************************************************
+                        test_nmeatokenizer.cpp
+                        ----------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "catch2.h"
+#include "positioning/nmeagnssreceiver.h"
+#include "positioning/nmeatokenizer.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <cstring>
+
+
+static QByteArray readNmeaLog( const QString &fileName )
+{
+  QFile file( QStringLiteral( "%1/../nmea_server/%2" ).arg( TEST_DATA_DIR, fileName ) );
+  return file.open( QIODevice::ReadOnly ) ? file.readAll() : QByteArray();
+}
+
+
+/**
+ * A sequential device delivering the data in chunks, like a serial, bluetooth or TCP device does
+ */
+class ChunkedDevice : public QIODevice
+{
+  public:
+    ChunkedDevice()
+    {
+      open( QIODevice::ReadOnly );
+    }
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override { return mData.size() + QIODevice::bytesAvailable(); }
+
+    void deliver( const QByteArray &chunk )
+    {
+      mData.append( chunk );
+      emit readyRead();
+    }
+
+  protected:
+    qint64 readData( char *data, qint64 maxSize ) override
+    {
+      const qint64 size = std::min<qint64>( maxSize, mData.size() );
+      std::memcpy( data, mData.constData(), size );
+      mData.remove( 0, size );
+      return size;
+    }
+
+    qint64 writeData( const char *, qint64 ) override { return -1; }
+
+  private:
+    QByteArray mData;
+};
+
+
+TEST_CASE( "NmeaTokenizer" )
+{
+  NmeaTokenizer tokenizer;
+  QByteArrayView sentence;
+
+  SECTION( "Sentences" )
+  {
+    tokenizer.feed( QByteArrayView( "$GNGSA,M,3,04,06*34\r\n\r\n$GNRMC,153412.00,A" ) );
+    REQUIRE( tokenizer.nextSentence( sentence ) );
+    REQUIRE( sentence == QByteArrayView( "$GNGSA,M,3,04,06*34" ) );
+
+    // the second sentence is incomplete
+    REQUIRE( !tokenizer.nextSentence( sentence ) );
+
+    tokenizer.feed( QByteArrayView( ",4631.67305924,N*70\n$GNGST" ) );
+    REQUIRE( tokenizer.nextSentence( sentence ) );
+    REQUIRE( sentence == QByteArrayView( "$GNRMC,153412.00,A,4631.67305924,N*70" ) );
+    REQUIRE( !tokenizer.nextSentence( sentence ) );
+
+    tokenizer.clear();
+    tokenizer.feed( QByteArrayView( "$GNGST,153412.00\r\n" ) );
+    REQUIRE( tokenizer.nextSentence( sentence ) );
+    REQUIRE( sentence == QByteArrayView( "$GNGST,153412.00" ) );
+  }
+
+
+  SECTION( "Device" )
+  {
+    QBuffer buffer;
+    REQUIRE( buffer.open( QIODevice::ReadWrite ) );
+    buffer.write( "$GNGSA,M,3*34\r\n$GNRMC,1534" );
+    buffer.seek( 0 );
+
+    tokenizer.feed( &buffer );
+    REQUIRE( tokenizer.nextSentence( sentence ) );
+    REQUIRE( sentence == QByteArrayView( "$GNGSA,M,3*34" ) );
+    REQUIRE( !tokenizer.nextSentence( sentence ) );
+
+    // the data is peeked, it can still be read from the device
+    REQUIRE( buffer.readAll() == QByteArray( "$GNGSA,M,3*34\r\n$GNRMC,1534" ) );
+  }
+
+
+  SECTION( "DeviceUnreadData" )
+  {
+    QBuffer buffer;
+    REQUIRE( buffer.open( QIODevice::ReadWrite ) );
+    buffer.write( "$GN" );
+    buffer.seek( 0 );
+
+    // the partial sentence is left unread in the device by its other readers
+    tokenizer.feed( &buffer );
+    tokenizer.skipUnreadData( &buffer );
+    REQUIRE( !tokenizer.nextSentence( sentence ) );
+
+    buffer.write( "GST,1*4E\n" );
+    buffer.seek( 0 );
+
+    tokenizer.feed( &buffer );
+    REQUIRE( tokenizer.nextSentence( sentence ) );
+    REQUIRE( sentence == QByteArrayView( "$GNGST,1*4E" ) );
+    REQUIRE( !tokenizer.nextSentence( sentence ) );
+  }
+
+
+  SECTION( "Garbage" )
+  {
+    tokenizer.feed( QByteArray( NmeaTokenizer::MAX_SENTENCE_LENGTH + 1, 'x' ) );
+    REQUIRE( !tokenizer.nextSentence( sentence ) );
+
+    tokenizer.feed( QByteArrayView( "\n$GNGST,1*4E\n" ) );
+    REQUIRE( tokenizer.nextSentence( sentence ) );
+    REQUIRE( sentence == QByteArrayView( "$GNGST,1*4E" ) );
+  }
+
+
+  SECTION( "Fields" )
+  {
+    NmeaTokenizer::Fields fields;
+    NmeaTokenizer::splitFields( QByteArrayView( "$GNGSA,M,3,,1.5*34" ), fields );
+    REQUIRE( fields.size() == 5 );
+    REQUIRE( fields.at( 0 ) == QByteArrayView( "$GNGSA" ) );
+    REQUIRE( fields.at( 2 ).toInt() == 3 );
+    REQUIRE( fields.at( 3 ).isEmpty() );
+    REQUIRE( fields.at( 4 ).toDouble() == 1.5 );
+
+    NmeaTokenizer::splitFields( QByteArrayView( "$PTAX" ), fields );
+    REQUIRE( fields.size() == 1 );
+  }
+
+
+  SECTION( "Log" )
+  {
+    const QByteArray log = readNmeaLog( QStringLiteral( "happyMonch2WithIMU.txt" ) );
+    REQUIRE( !log.isEmpty() );
+
+    // fed in small chunks, like a serial or bluetooth device does
+    int sentenceCount = 0;
+    int imuSentenceCount = 0;
+    for ( qsizetype i = 0; i < log.size(); i += 64 )
+    {
+      tokenizer.feed( QByteArrayView( log ).sliced( i, std::min<qsizetype>( 64, log.size() - i ) ) );
+      while ( tokenizer.nextSentence( sentence ) )
+      {
+        sentenceCount++;
+        if ( sentence.startsWith( "$INS.NAVI" ) )
+          imuSentenceCount++;
+      }
+    }
+
+    REQUIRE( sentenceCount == log.count( '\n' ) );
+    REQUIRE( imuSentenceCount == 32 );
+  }
+}
+
+
+TEST_CASE( "NmeaGnssReceiverLogging" )
+{
+  QTemporaryDir logDir;
+  REQUIRE( logDir.isValid() );
+
+  ChunkedDevice device;
+  NmeaGnssReceiver receiver;
+  receiver.initNmeaConnection( &device );
+  receiver.startLogging( logDir.path() );
+
+  // the first chunk is too short to be read by QgsNmeaConnection, it stays in the device for the next chunk
+  device.deliver( QByteArray( "$GPG" ) );
+  device.deliver( QByteArray( "GA,153412.00,4631.67305924,N,00636.04430522,E,4,12,0.6,423.8,M,48.4,M,,*6B\r\n$IN" ) );
+  device.deliver( QByteArray( "S.NAVI,1*00\r\n" ) );
+
+  receiver.stopLogging();
+
+  const QStringList logFiles = QDir( logDir.path() ).entryList( { QStringLiteral( "nmea-*.log" ) }, QDir::Files );
+  REQUIRE( logFiles.size() == 1 );
+
+  QFile logFile( QDir( logDir.path() ).filePath( logFiles.first() ) );
+  REQUIRE( logFile.open( QIODevice::ReadOnly ) );
+  REQUIRE( logFile.readAll() == QByteArray( "$GPGGA,153412.00,4631.67305924,N,00636.04430522,E,4,12,0.6,423.8,M,48.4,M,,*6B\n$INS.NAVI,1*00\n" ) );
+}
+
+
+TEST_CASE( "NmeaTokenizerBenchmark", "[.][benchmark]" )
+{
+  QByteArray log;
+  for ( const QString &fileName : { QStringLiteral( "TrimbleR1.txt" ), QStringLiteral( "happyWithIMU.txt" ), QStringLiteral( "happyMonch2WithIMU.txt" ) } )
+    log.append( readNmeaLog( fileName ) );
+  REQUIRE( !log.isEmpty() );
+
+  BENCHMARK( "Split sentences and fields as strings" )
+  {
+    double sum = 0;
+    const QStringList sentences = QString::fromLatin1( log ).split( QStringLiteral( "\r\n" ) );
+    for ( const QString &sentence : sentences )
+    {
+      const QStringList fields = sentence.split( '*' ).first().split( ',' );
+      if ( fields.size() > 2 )
+        sum += fields.at( 2 ).toDouble();
+    }
+    return sum;
+  };
+
+  BENCHMARK( "Tokenize sentences and fields" )
+  {
+    double sum = 0;
+    NmeaTokenizer tokenizer;
+    NmeaTokenizer::Fields fields;
+    QByteArrayView sentence;
+    for ( qsizetype i = 0; i < log.size(); i += 512 )
+    {
+      tokenizer.feed( QByteArrayView( log ).sliced( i, std::min<qsizetype>( 512, log.size() - i ) ) );
+      while ( tokenizer.nextSentence( sentence ) )
+      {
+        NmeaTokenizer::splitFields( sentence, fields );
+        if ( fields.size() > 2 )
+          sum += fields.at( 2 ).toDouble();
+      }
+    }
+    return sum;
+  };
+}
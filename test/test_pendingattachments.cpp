@@ -0,0 +1,147 @@
+/***************************************************************************
+                        test_pendingattachments.cpp
+                        ---------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "qfieldcloudconnection.h"
+#include "utils/qfieldcloudutils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <memory>
+
+
+static void writeFile( const QString &fileName, const QByteArray &content )
+{
+  QFile file( fileName );
+  REQUIRE( file.open( QIODevice::WriteOnly ) );
+  file.write( content );
+}
+
+
+TEST_CASE( "PendingAttachments" )
+{
+  QTemporaryDir tmpDir;
+  REQUIRE( tmpDir.isValid() );
+  QFieldCloudUtils::setLocalCloudDirectory( tmpDir.path() );
+
+  const QString username = QStringLiteral( "user" );
+  const QString projectId = QStringLiteral( "00000000-0000-0000-0000-000000000001" );
+  const QDir projectDir( QStringLiteral( "%1/%2/%3" ).arg( tmpDir.path(), username, projectId ) );
+  REQUIRE( QDir().mkpath( projectDir.filePath( QStringLiteral( "DCIM" ) ) ) );
+  writeFile( projectDir.filePath( QStringLiteral( "project.qgs" ) ), QByteArray() );
+
+  QStringList fileNames;
+  for ( int i = 0; i < 10; i++ )
+  {
+    fileNames << projectDir.filePath( QStringLiteral( "DCIM/photo_%1.jpg" ).arg( i ) );
+    writeFile( fileNames.last(), QByteArray( 1024, 'x' ) );
+  }
+
+  QFieldCloudUtils::addPendingAttachments( username, projectId, fileNames );
+  REQUIRE( QFieldCloudUtils::getPendingAttachments( username ).size() == 10 );
+
+  SECTION( "Journal" )
+  {
+    const QString attachmentsFileName = QStringLiteral( "%1/%2/attachments.csv" ).arg( tmpDir.path(), username );
+    const qint64 size = QFileInfo( attachmentsFileName ).size();
+
+    QFieldCloudUtils::removePendingAttachment( username, projectId, fileNames.at( 0 ) );
+    REQUIRE( QFileInfo( attachmentsFileName ).size() > size );
+    REQUIRE( QFieldCloudUtils::getPendingAttachments( username ).size() == 9 );
+    REQUIRE( !QFieldCloudUtils::getPendingAttachments( username ).contains( projectId, fileNames.at( 0 ) ) );
+
+    // an attachment added back after its removal is pending again
+    QFieldCloudUtils::addPendingAttachments( username, projectId, { fileNames.at( 0 ) } );
+    REQUIRE( QFieldCloudUtils::getPendingAttachments( username ).contains( projectId, fileNames.at( 0 ) ) );
+
+    for ( const QString &fileName : std::as_const( fileNames ) )
+      QFieldCloudUtils::removePendingAttachment( username, projectId, fileName );
+
+    // reading the journal compacts it
+    REQUIRE( QFieldCloudUtils::getPendingAttachments( username ).isEmpty() );
+    REQUIRE( QFileInfo( attachmentsFileName ).size() == 0 );
+  }
+
+
+  SECTION( "Upload" )
+  {
+    // a local server answering uploads after a short delay, with a 404 for the deleted photo on the server side
+    QTcpServer server;
+    REQUIRE( server.listen( QHostAddress::LocalHost ) );
+
+    int activeCount = 0;
+    int maximumActiveCount = 0;
+    QStringList uploadedPaths;
+    QObject::connect( &server, &QTcpServer::newConnection, &server, [&] {
+      while ( QTcpSocket *socket = server.nextPendingConnection() )
+      {
+        std::shared_ptr<QByteArray> request = std::make_shared<QByteArray>();
+        QObject::connect( socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater );
+        QObject::connect( socket, &QTcpSocket::readyRead, socket, [&, socket, request] {
+          request->append( socket->readAll() );
+          const qsizetype headerEnd = request->indexOf( "\r\n\r\n" );
+          if ( headerEnd < 0 || socket->property( "answered" ).toBool() )
+            return;
+
+          const QRegularExpressionMatch match = QRegularExpression( QStringLiteral( "content-length:\\s*(\\d+)" ), QRegularExpression::CaseInsensitiveOption ).match( QString::fromLatin1( request->left( headerEnd ) ) );
+          if ( request->size() < headerEnd + 4 + ( match.hasMatch() ? match.captured( 1 ).toLongLong() : 0 ) )
+            return;
+
+          socket->setProperty( "answered", true );
+          activeCount++;
+          maximumActiveCount = std::max( maximumActiveCount, activeCount );
+
+          const QString path = QString::fromLatin1( request->split( ' ' ).value( 1 ) );
+          QTimer::singleShot( 50, socket, [&, socket, path] {
+            activeCount--;
+            uploadedPaths << path;
+            socket->write( path.contains( QStringLiteral( "photo_3" ) ) ? "HTTP/1.1 404 Not Found\r\n" : "HTTP/1.1 201 Created\r\n" );
+            socket->write( "Content-Length: 0\r\nConnection: close\r\n\r\n" );
+            socket->disconnectFromHost();
+          } );
+        } );
+      }
+    } );
+
+    // deleted from the device, it is not uploaded
+    REQUIRE( QFile::remove( fileNames.at( 9 ) ) );
+
+    QFieldCloudConnection connection;
+    connection.setUrl( QStringLiteral( "http://127.0.0.1:%1" ).arg( server.serverPort() ) );
+    connection.setUsername( username );
+
+    QSignalSpy finishedSpy( &connection, &QFieldCloudConnection::pendingAttachmentsUploadFinished );
+    REQUIRE( connection.uploadPendingAttachments() > 0 );
+    REQUIRE( finishedSpy.wait( 30000 ) );
+
+    REQUIRE( uploadedPaths.size() == 9 );
+    REQUIRE( uploadedPaths.contains( QStringLiteral( "/api/v1/files/%1/DCIM/photo_0.jpg/" ).arg( projectId ) ) );
+    REQUIRE( maximumActiveCount > 1 );
+    REQUIRE( maximumActiveCount <= 4 );
+
+    REQUIRE( QFieldCloudUtils::getPendingAttachments( username ).isEmpty() );
+  }
+}
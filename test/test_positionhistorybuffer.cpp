@@ -0,0 +1,128 @@
+/***************************************************************************
+                        test_positionhistorybuffer.cpp
+                        ------------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "positioning/positionhistorybuffer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTimeZone>
+
+#include <cmath>
+
+
+static GnssPositionInformation positionInformation( int index )
+{
+  return GnssPositionInformation( 46.0 + index * 0.0001, 7.0 + index * 0.0001, 500.0 + index, 1.5, 90.0, QList<QgsSatelliteInfo>(),
+                                  1.2, 0.8, 0.9, 2.5, 4.0,
+                                  QDateTime::fromMSecsSinceEpoch( 1790000000000 + index * 1000, QTimeZone( QTimeZone::Initialization::UTC ) ),
+                                  QChar( 'A' ), 3, 4, 12, QChar( 'A' ), QList<int>(), true, 0.1, 2.0, 0, QStringLiteral( "internal" ),
+                                  false, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(),
+                                  180.0 );
+}
+
+
+TEST_CASE( "PositionHistoryBuffer" )
+{
+  QTemporaryDir tmpDir;
+  REQUIRE( tmpDir.isValid() );
+
+  const QString filePath = QDir( tmpDir.path() ).filePath( QStringLiteral( "positioning.background.history" ) );
+
+  SECTION( "AppendAndRead" )
+  {
+    PositionHistoryBuffer writer( filePath, 10 );
+    REQUIRE( writer.create() );
+    REQUIRE( writer.count() == 0 );
+
+    for ( int i = 0; i < 3; i++ )
+      REQUIRE( writer.append( positionInformation( i ) ) );
+
+    // the reader sees the positions appended through the writer mapping
+    PositionHistoryBuffer reader( filePath );
+    REQUIRE( reader.open() );
+    REQUIRE( reader.capacity() == 10 );
+    REQUIRE( reader.count() == 3 );
+    REQUIRE( !reader.append( positionInformation( 3 ) ) );
+
+    const QList<GnssPositionInformation> positions = reader.read( 1 );
+    REQUIRE( positions.size() == 2 );
+
+    const GnssPositionInformation expected = positionInformation( 1 );
+    REQUIRE( positions.at( 0 ).latitude() == expected.latitude() );
+    REQUIRE( positions.at( 0 ).longitude() == expected.longitude() );
+    REQUIRE( positions.at( 0 ).elevation() == expected.elevation() );
+    REQUIRE( positions.at( 0 ).utcDateTime() == expected.utcDateTime() );
+    REQUIRE( positions.at( 0 ).hacc() == expected.hacc() );
+    REQUIRE( positions.at( 0 ).fixMode() == expected.fixMode() );
+    REQUIRE( positions.at( 0 ).satellitesUsed() == expected.satellitesUsed() );
+    REQUIRE( positions.at( 0 ).satInfoComplete() );
+    REQUIRE( positions.at( 0 ).sourceName() == QStringLiteral( "internal" ) );
+    REQUIRE( std::isnan( positions.at( 0 ).imuRoll() ) );
+
+    writer.append( positionInformation( 3 ) );
+    REQUIRE( reader.count() == 4 );
+  }
+
+
+  SECTION( "Overwrite" )
+  {
+    PositionHistoryBuffer writer( filePath, 4 );
+    REQUIRE( writer.create() );
+
+    for ( int i = 0; i < 10; i++ )
+      writer.append( positionInformation( i ) );
+
+    REQUIRE( writer.count() == 4 );
+    REQUIRE( writer.droppedCount() == 6 );
+    REQUIRE( QFile( filePath ).size() < 1024 );
+
+    // the oldest positions were overwritten
+    const QList<GnssPositionInformation> positions = writer.read( 0 );
+    REQUIRE( positions.size() == 4 );
+    for ( int i = 0; i < positions.size(); i++ )
+      REQUIRE( positions.at( i ).utcDateTime() == positionInformation( 6 + i ).utcDateTime() );
+
+    // chunked reads
+    REQUIRE( writer.read( 1, 2 ).size() == 2 );
+    REQUIRE( writer.read( 1, 2 ).at( 1 ).utcDateTime() == positionInformation( 8 ).utcDateTime() );
+    REQUIRE( writer.read( 3, 10 ).size() == 1 );
+    REQUIRE( writer.read( 4, 10 ).isEmpty() );
+
+    // creating the buffer again discards the collected positions
+    REQUIRE( writer.create() );
+    REQUIRE( writer.count() == 0 );
+  }
+
+
+  SECTION( "InvalidFile" )
+  {
+    PositionHistoryBuffer reader( filePath );
+    REQUIRE( !reader.open() );
+
+    QFile file( filePath );
+    REQUIRE( file.open( QIODevice::WriteOnly ) );
+    file.write( QByteArray( 512, 'x' ) );
+    file.close();
+
+    REQUIRE( !reader.open() );
+    REQUIRE( reader.count() == 0 );
+    REQUIRE( reader.read( 0 ).isEmpty() );
+  }
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+                        test_renderstatisticsmodel.cpp
+                        ------------------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "catch2.h"
+#include "renderstatisticsmodel.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+
+TEST_CASE( "RenderStatisticsModel" )
+{
+  RenderStatisticsModel model;
+
+  auto layerRender = []( const QString &layerId, int renderTime, bool fromCache = false ) {
+    RenderStatisticsModel::LayerRender render;
+    render.layerId = layerId;
+    render.layerName = layerId.toUpper();
+    render.renderTime = renderTime;
+    render.fromCache = fromCache;
+    return render;
+  };
+
+  SECTION( "Statistics" )
+  {
+    model.addJob( 120, 20, { layerRender( QStringLiteral( "roads" ), 40 ), layerRender( QStringLiteral( "orthophoto" ), 90 ) } );
+    model.addJob( 60, 10, { layerRender( QStringLiteral( "roads" ), 50 ), layerRender( QStringLiteral( "orthophoto" ), 0, true ) } );
+
+    REQUIRE( model.jobCount() == 2 );
+    REQUIRE( model.lastJobTime() == 60 );
+    REQUIRE( model.averageJobTime() == 90.0 );
+    REQUIRE( model.lastLabelingTime() == 10 );
+    REQUIRE( model.cacheHits() == 1 );
+    REQUIRE( model.cacheMisses() == 3 );
+
+    // the slowest layer comes first, cache hits do not lower its average
+    REQUIRE( model.rowCount() == 2 );
+    REQUIRE( model.data( model.index( 0, 0 ), RenderStatisticsModel::LayerIdRole ).toString() == QStringLiteral( "orthophoto" ) );
+    REQUIRE( model.data( model.index( 0, 0 ), RenderStatisticsModel::LayerNameRole ).toString() == QStringLiteral( "ORTHOPHOTO" ) );
+    REQUIRE( model.data( model.index( 0, 0 ), RenderStatisticsModel::AverageRenderTimeRole ).toDouble() == 90.0 );
+    REQUIRE( model.data( model.index( 0, 0 ), RenderStatisticsModel::CacheHitsRole ).toInt() == 1 );
+    REQUIRE( model.data( model.index( 1, 0 ), RenderStatisticsModel::AverageRenderTimeRole ).toDouble() == 45.0 );
+    REQUIRE( model.data( model.index( 1, 0 ), RenderStatisticsModel::LastRenderTimeRole ).toInt() == 50 );
+    REQUIRE( model.data( model.index( 1, 0 ), RenderStatisticsModel::MaximumRenderTimeRole ).toInt() == 50 );
+
+    model.clear();
+    REQUIRE( model.rowCount() == 0 );
+    REQUIRE( model.jobCount() == 0 );
+  }
+
+
+  SECTION( "Log" )
+  {
+    QTemporaryDir tmpDir;
+    REQUIRE( tmpDir.isValid() );
+
+    const QString logFilePath = QStringLiteral( "%1/logs/render_statistics.log" ).arg( tmpDir.path() );
+    model.setLogFilePath( logFilePath );
+    model.addJob( 120, 20, { layerRender( QStringLiteral( "roads" ), 40 ) } );
+    model.addJob( 60, 10, { layerRender( QStringLiteral( "roads" ), 0, true ) } );
+
+    QFile file( logFilePath );
+    REQUIRE( file.open( QIODevice::ReadOnly ) );
+    const QList<QByteArray> lines = file.readAll().trimmed().split( '\n' );
+    REQUIRE( lines.size() == 2 );
+
+    const QJsonObject job = QJsonDocument::fromJson( lines.at( 0 ) ).object();
+    REQUIRE( job.value( QStringLiteral( "time" ) ).toInt() == 120 );
+    REQUIRE( job.value( QStringLiteral( "labeling_time" ) ).toInt() == 20 );
+    REQUIRE( job.value( QStringLiteral( "layers" ) ).toArray().at( 0 ).toObject().value( QStringLiteral( "name" ) ).toString() == QStringLiteral( "ROADS" ) );
+  }
+}
@@ -0,0 +1,171 @@
+/***************************************************************************
+                        test_rubberbandshape.cpp
+                        --------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#define QFIELDTEST_MAIN
+#include "catch2.h"
+#include "qgsquickmapsettings.h"
+#include "rubberbandmodel.h"
+#include "rubberbandshape.h"
+
+#include <QSignalSpy>
+
+using Catch::Approx;
+
+
+TEST_CASE( "RubberbandShape" )
+{
+  QgsQuickMapSettings mapSettings;
+  mapSettings.setDestinationCrs( QgsCoordinateReferenceSystem( QStringLiteral( "EPSG:3857" ) ) );
+  mapSettings.setOutputSize( QSize( 100, 100 ) );
+  mapSettings.setExtent( QgsRectangle( 0, 0, 100, 100 ) );
+
+  RubberbandModel model;
+  model.setGeometryType( Qgis::GeometryType::Line );
+  model.setCurrentCoordinate( QgsPoint( 10, 10 ) );
+
+  RubberbandShape shape;
+  shape.setMapSettings( &mapSettings );
+  shape.setModel( &model );
+
+  QSignalSpy polylinesSpy( &shape, &RubberbandShape::polylinesChanged );
+
+  // a shape linked to the model afterwards projects all the vertices at once
+  const auto rebuiltPolylines = [&mapSettings, &model]() {
+    RubberbandShape rebuiltShape;
+    rebuiltShape.setMapSettings( &mapSettings );
+    rebuiltShape.setModel( &model );
+    return rebuiltShape.polylines();
+  };
+
+  const auto checkPolylines = [&shape, &rebuiltPolylines, &polylinesSpy]() {
+    REQUIRE( !polylinesSpy.isEmpty() );
+    polylinesSpy.clear();
+
+    const QList<QPolygonF> polylines = shape.polylines();
+    const QList<QPolygonF> expectedPolylines = rebuiltPolylines();
+    REQUIRE( polylines.size() == expectedPolylines.size() );
+    for ( int i = 0; i < polylines.size(); i++ )
+    {
+      REQUIRE( polylines.at( i ).size() == expectedPolylines.at( i ).size() );
+      for ( int j = 0; j < polylines.at( i ).size(); j++ )
+      {
+        REQUIRE( polylines.at( i ).at( j ).x() == Approx( expectedPolylines.at( i ).at( j ).x() ) );
+        REQUIRE( polylines.at( i ).at( j ).y() == Approx( expectedPolylines.at( i ).at( j ).y() ) );
+      }
+    }
+  };
+
+  REQUIRE( shape.polylinesType() == Qgis::GeometryType::Line );
+  REQUIRE( shape.polylines().size() == 1 );
+  REQUIRE( shape.polylines().at( 0 ).size() == 1 );
+
+  SECTION( "InsertVertices" )
+  {
+    model.addVertexFromPoint( QgsPoint( 20, 20 ) );
+    checkPolylines();
+    model.addVertexFromPoint( QgsPoint( 40, 30 ) );
+    checkPolylines();
+
+    // vertices closer than the simplification tolerance are merged, unless last
+    model.addVertexFromPoint( QgsPoint( 40.1, 30.1 ) );
+    checkPolylines();
+    model.addVertexFromPoint( QgsPoint( 40.2, 30.2 ) );
+    checkPolylines();
+    model.addVertexFromPoint( QgsPoint( 60, 70 ) );
+    checkPolylines();
+
+    // inserted in the middle, at the current coordinate
+    model.insertVertices( 1, 2 );
+    checkPolylines();
+  }
+
+  SECTION( "ChangeVertices" )
+  {
+    model.addVertexFromPoint( QgsPoint( 20, 20 ) );
+    model.addVertexFromPoint( QgsPoint( 40, 30 ) );
+    model.addVertexFromPoint( QgsPoint( 60, 70 ) );
+    checkPolylines();
+
+    model.setVertex( 1, QgsPoint( 25, 15 ) );
+    checkPolylines();
+
+    // moved next to the previous vertex, merged then split again
+    model.setVertex( 2, QgsPoint( 25.1, 15.1 ) );
+    checkPolylines();
+    model.setVertex( 2, QgsPoint( 50, 50 ) );
+    checkPolylines();
+
+    // the last vertex is kept when close to the previous one, and merged no more once it is not last
+    model.setVertex( model.vertexCount() - 1, QgsPoint( 50.2, 50.2 ) );
+    checkPolylines();
+    model.addVertexFromPoint( QgsPoint( 80, 80 ) );
+    checkPolylines();
+
+    model.setCurrentCoordinate( QgsPoint( 90, 10 ) );
+    checkPolylines();
+
+    model.setVertex( 0, QgsPoint( 5, 95 ) );
+    checkPolylines();
+  }
+
+  SECTION( "RemoveVertices" )
+  {
+    model.addVertexFromPoint( QgsPoint( 20, 20 ) );
+    model.addVertexFromPoint( QgsPoint( 20.1, 20.1 ) );
+    model.addVertexFromPoint( QgsPoint( 40, 30 ) );
+    model.addVertexFromPoint( QgsPoint( 60, 70 ) );
+    model.addVertexFromPoint( QgsPoint( 60.2, 70.2 ) );
+    checkPolylines();
+
+    model.removeVertex();
+    checkPolylines();
+
+    model.removeVertices( 1, 2 );
+    checkPolylines();
+
+    // the vertex left last after the removal was merged into the previous one
+    model.removeVertices( model.vertexCount() - 1, 1 );
+    checkPolylines();
+
+    model.removeVertices( 0, 1 );
+    checkPolylines();
+  }
+
+  SECTION( "GeometryTypeChange" )
+  {
+    QSignalSpy polylinesTypeSpy( &shape, &RubberbandShape::polylinesTypeChanged );
+
+    model.addVertexFromPoint( QgsPoint( 20, 20 ) );
+    model.addVertexFromPoint( QgsPoint( 40, 30 ) );
+    checkPolylines();
+
+    model.setGeometryType( Qgis::GeometryType::Polygon );
+    checkPolylines();
+    REQUIRE( polylinesTypeSpy.count() == 1 );
+    REQUIRE( shape.polylinesType() == Qgis::GeometryType::Polygon );
+
+    // the incremental updates go on with the new geometry type
+    model.addVertexFromPoint( QgsPoint( 60, 70 ) );
+    checkPolylines();
+    model.setVertex( 1, QgsPoint( 25, 15 ) );
+    checkPolylines();
+    model.removeVertices( 1, 1 );
+    checkPolylines();
+    REQUIRE( polylinesTypeSpy.count() == 1 );
+    REQUIRE( shape.polylinesType() == Qgis::GeometryType::Polygon );
+  }
+}
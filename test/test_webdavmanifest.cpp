@@ -0,0 +1,114 @@
+/***************************************************************************
+                        test_webdavmanifest.cpp
+                        --------------------
+  begin                : Oct 2026
+  copyright            : (C) 2026 by OPENGIS.ch
+  email                : info@opengis.ch
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "catch2.h"
+#include "webdavmanifest.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+
+static bool writeFile( const QString &fileName, const QByteArray &content, const QDateTime &lastModified )
+{
+  QFile file( fileName );
+  if ( !file.open( QFile::WriteOnly ) )
+    return false;
+
+  file.write( content );
+  file.flush();
+  return file.setFileTime( lastModified, QFileDevice::FileModificationTime );
+}
+
+
+TEST_CASE( "WebdavManifest" )
+{
+  QTemporaryDir dir;
+  REQUIRE( dir.isValid() );
+
+  const QString localRootPath = dir.path() + QStringLiteral( "/" );
+  const QString remoteRootPath = QStringLiteral( "/project/" );
+  const QDateTime lastModified = QDateTime::fromSecsSinceEpoch( QDateTime::currentSecsSinceEpoch() - 3600 );
+
+  REQUIRE( writeFile( localRootPath + QStringLiteral( "a.txt" ), QByteArray( "content" ), lastModified ) );
+  REQUIRE( writeFile( localRootPath + QStringLiteral( "b.txt" ), QByteArray( "other content" ), lastModified ) );
+
+  WebdavManifest manifest;
+  manifest.read( dir.path() );
+  REQUIRE( manifest.count() == 0 );
+  REQUIRE( manifest.filePath() == dir.filePath( WebdavManifest::fileName() ) );
+
+  SECTION( "ReadWrite" )
+  {
+    manifest.insert( remoteRootPath + QStringLiteral( "a.txt" ), 7, lastModified );
+    manifest.insert( remoteRootPath + QStringLiteral( "b.txt" ), 13, lastModified );
+    manifest.write();
+    REQUIRE( QFile::exists( manifest.filePath() ) );
+
+    WebdavManifest readManifest;
+    readManifest.read( dir.path() );
+    REQUIRE( readManifest.count() == 2 );
+    REQUIRE( readManifest.contains( remoteRootPath + QStringLiteral( "a.txt" ) ) );
+    REQUIRE( readManifest.contains( remoteRootPath + QStringLiteral( "b.txt" ) ) );
+
+    // the recorded state survives the round trip
+    REQUIRE( readManifest.isIdentical( remoteRootPath + QStringLiteral( "a.txt" ), 7, lastModified, QFileInfo( localRootPath + QStringLiteral( "a.txt" ) ) ) );
+    REQUIRE( !readManifest.isIdentical( remoteRootPath + QStringLiteral( "a.txt" ), 8, lastModified, QFileInfo( localRootPath + QStringLiteral( "a.txt" ) ) ) );
+  }
+
+  SECTION( "IsIdentical" )
+  {
+    const QString remotePath = remoteRootPath + QStringLiteral( "a.txt" );
+    const QFileInfo fileInfo( localRootPath + QStringLiteral( "a.txt" ) );
+
+    // files not recorded compare their last modified date only
+    REQUIRE( manifest.isIdentical( remotePath, 100, lastModified, fileInfo ) );
+    REQUIRE( !manifest.isIdentical( remotePath, 7, lastModified.addSecs( 60 ), fileInfo ) );
+
+    manifest.insert( remotePath, 7, lastModified );
+    REQUIRE( manifest.isIdentical( remotePath, 7, lastModified, fileInfo ) );
+
+    // modified remotely
+    REQUIRE( !manifest.isIdentical( remotePath, 7, lastModified.addSecs( 60 ), fileInfo ) );
+    REQUIRE( !manifest.isIdentical( remotePath, 8, lastModified, fileInfo ) );
+
+    // modified locally
+    REQUIRE( writeFile( localRootPath + QStringLiteral( "a.txt" ), QByteArray( "changed content" ), lastModified ) );
+    REQUIRE( !manifest.isIdentical( remotePath, 7, lastModified, QFileInfo( localRootPath + QStringLiteral( "a.txt" ) ) ) );
+
+    // deleted locally
+    REQUIRE( !manifest.isIdentical( remoteRootPath + QStringLiteral( "c.txt" ), 7, lastModified, QFileInfo( localRootPath + QStringLiteral( "c.txt" ) ) ) );
+  }
+
+  SECTION( "Prune" )
+  {
+    manifest.insert( remoteRootPath + QStringLiteral( "a.txt" ), 7, lastModified );
+    manifest.insert( remoteRootPath + QStringLiteral( "b.txt" ), 13, lastModified );
+    manifest.insert( QStringLiteral( "/elsewhere/c.txt" ), 1, lastModified );
+
+    // b.txt was deleted remotely, files outside of the listed path are kept
+    manifest.prune( remoteRootPath, QSet<QString>() << remoteRootPath + QStringLiteral( "a.txt" ), localRootPath );
+    REQUIRE( manifest.count() == 2 );
+    REQUIRE( manifest.contains( remoteRootPath + QStringLiteral( "a.txt" ) ) );
+    REQUIRE( !manifest.contains( remoteRootPath + QStringLiteral( "b.txt" ) ) );
+    REQUIRE( manifest.contains( QStringLiteral( "/elsewhere/c.txt" ) ) );
+
+    // a.txt was deleted locally
+    REQUIRE( QFile::remove( localRootPath + QStringLiteral( "a.txt" ) ) );
+    manifest.prune( remoteRootPath, QSet<QString>() << remoteRootPath + QStringLiteral( "a.txt" ), localRootPath );
+    REQUIRE( !manifest.contains( remoteRootPath + QStringLiteral( "a.txt" ) ) );
+  }
+}